@@ -7,7 +7,21 @@
 #include "InferenceModule.hpp"
 
 #include "agent/DirectInferenceAgent.hpp"
+#include "logic/CompiledRulesCache.hpp"
+#include "searcher/templateSearcher/FormulaMetadataCache.hpp"
 
 using namespace inference;
 
 SC_MODULE_REGISTER(InferenceModule)->Agent<DirectInferenceAgent>();
+
+void InferenceModule::Initialize(ScMemoryContext *)
+{
+  FormulaMetadataCache::setShared(std::make_shared<FormulaMetadataCache>());
+  CompiledRulesCache::setShared(std::make_shared<CompiledRulesCache>());
+}
+
+void InferenceModule::Shutdown(ScMemoryContext *)
+{
+  CompiledRulesCache::setShared(nullptr);
+  FormulaMetadataCache::setShared(nullptr);
+}
@@ -10,4 +10,8 @@
 
 class InferenceModule : public ScModule
 {
+public:
+  /// Create formula metadata and compiled rules caches shared by inference managers while sc-memory is initialized
+  void Initialize(ScMemoryContext * context) override;
+  void Shutdown(ScMemoryContext * context) override;
 };
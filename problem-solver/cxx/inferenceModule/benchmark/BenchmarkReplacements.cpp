@@ -0,0 +1,73 @@
+/*
+ * This source file is part of an OSTIS project. For the latest info, see http://ostis.net
+ * Distributed under the MIT License
+ * (See accompanying file COPYING.MIT or copy at http://opensource.org/licenses/MIT)
+ */
+
+#include "BenchmarkReplacements.hpp"
+
+#include <cmath>
+
+namespace inference::replacementsBenchmark
+{
+// Offset 0 is not used by sc-memory, so offsets in each segment start from 1
+size_t constexpr kSegmentSize = 65535;
+
+ScAddr getAddr(size_t index)
+{
+  return ScAddr(sc_addr{
+      static_cast<sc_addr_seg>(index / kSegmentSize + 1), static_cast<sc_addr_offset>(index % kSegmentSize + 1)});
+}
+
+ScAddrVector getKeys(size_t keysAmount, size_t keysOffset)
+{
+  ScAddrVector keys;
+  for (size_t keyIndex = 0; keyIndex < keysAmount; ++keyIndex)
+    keys.push_back(getAddr(keysOffset + keyIndex));
+  return keys;
+}
+
+namespace
+{
+size_t getCombinationsAmount(size_t base, size_t keysAmount)
+{
+  size_t combinationsAmount = 1;
+  for (size_t keyIndex = 0; keyIndex < keysAmount; ++keyIndex)
+    combinationsAmount *= base;
+  return combinationsAmount;
+}
+}  // namespace
+
+size_t getDistinctValuesAmount(size_t columnsAmount, size_t keysAmount)
+{
+  // pow may be rounded in both directions, so the amount is adjusted to be the least enough one
+  auto valuesAmount = static_cast<size_t>(std::pow(static_cast<double>(columnsAmount), 1.0 / keysAmount));
+  valuesAmount = valuesAmount > 1 ? valuesAmount - 1 : 1;
+  while (getCombinationsAmount(valuesAmount, keysAmount) < columnsAmount)
+    ++valuesAmount;
+  return valuesAmount;
+}
+
+Replacements createDistinctReplacements(ScAddrVector const & keys, size_t columnsAmount)
+{
+  Replacements replacements(keys);
+  size_t const keysAmount = keys.size();
+  if (keysAmount == 0)
+    return replacements;
+
+  size_t const base = getDistinctValuesAmount(columnsAmount, keysAmount);
+  replacements.reserve(columnsAmount);
+  for (size_t columnIndex = 0; columnIndex < columnsAmount; ++columnIndex)
+  {
+    ScAddr * column = replacements.addColumn();
+    size_t digits = columnIndex;
+    for (size_t keyIndex = 0; keyIndex < keysAmount; ++keyIndex)
+    {
+      column[keyIndex] = getAddr(digits % base);
+      digits /= base;
+    }
+  }
+  return replacements;
+}
+
+}  // namespace inference::replacementsBenchmark
@@ -0,0 +1,29 @@
+/*
+ * This source file is part of an OSTIS project. For the latest info, see http://ostis.net
+ * Distributed under the MIT License
+ * (See accompanying file COPYING.MIT or copy at http://opensource.org/licenses/MIT)
+ */
+
+#pragma once
+
+#include "utils/Replacements.hpp"
+
+namespace inference::replacementsBenchmark
+{
+/// Synthetic addr of the element with the given index, there is no need in sc-memory to create it
+ScAddr getAddr(size_t index);
+
+/// Keys that do not intersect with values created by `getAddr` for indices less than `keysOffset`
+ScAddrVector getKeys(size_t keysAmount, size_t keysOffset = 1 << 30);
+
+/// Amount of values that is enough to create `columnsAmount` distinct columns for `keysAmount` keys
+size_t getDistinctValuesAmount(size_t columnsAmount, size_t keysAmount);
+
+/**
+ * @brief Create replacements with distinct columns. Values of each column are digits of the column index in the base
+ * returned by `getDistinctValuesAmount`, so values are taken from a small pool as in a real
+ * knowledge base, and the same values are used for different keys
+ */
+Replacements createDistinctReplacements(ScAddrVector const & keys, size_t columnsAmount);
+
+}  // namespace inference::replacementsBenchmark
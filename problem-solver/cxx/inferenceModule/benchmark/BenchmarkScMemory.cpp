@@ -0,0 +1,33 @@
+/*
+ * This source file is part of an OSTIS project. For the latest info, see http://ostis.net
+ * Distributed under the MIT License
+ * (See accompanying file COPYING.MIT or copy at http://opensource.org/licenses/MIT)
+ */
+
+#include "BenchmarkScMemory.hpp"
+
+namespace inference::replacementsBenchmark
+{
+void ScMemoryBenchmark::SetUp(::benchmark::State const & state)
+{
+  sc_memory_params params;
+  sc_memory_params_clear(&params);
+  params.dump_memory = SC_FALSE;
+  params.dump_memory_statistics = SC_FALSE;
+  params.clear = SC_TRUE;
+  params.storage = "inference-benchmarks-kb";
+  ScMemory::LogMute();
+  ScMemory::Initialize(params);
+  context = std::make_unique<ScMemoryContext>();
+  generateKnowledgeBase(state);
+}
+
+void ScMemoryBenchmark::TearDown(::benchmark::State const &)
+{
+  clear();
+  context.reset();
+  ScMemory::Shutdown(false);
+  ScMemory::LogUnmute();
+}
+
+}  // namespace inference::replacementsBenchmark
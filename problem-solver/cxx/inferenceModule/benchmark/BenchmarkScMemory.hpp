@@ -0,0 +1,34 @@
+/*
+ * This source file is part of an OSTIS project. For the latest info, see http://ostis.net
+ * Distributed under the MIT License
+ * (See accompanying file COPYING.MIT or copy at http://opensource.org/licenses/MIT)
+ */
+
+#pragma once
+
+#include <memory>
+
+#include <sc-memory/sc_memory.hpp>
+
+#include <benchmark/benchmark.h>
+
+namespace inference::replacementsBenchmark
+{
+/// Fixture that initializes empty sc-memory for each benchmark run and generates its knowledge base
+class ScMemoryBenchmark : public ::benchmark::Fixture
+{
+public:
+  void SetUp(::benchmark::State const & state) override;
+
+  void TearDown(::benchmark::State const & state) override;
+
+protected:
+  std::unique_ptr<ScMemoryContext> context;
+
+  virtual void generateKnowledgeBase(::benchmark::State const & state) = 0;
+
+  /// Release objects that use sc-memory, it is called before sc-memory is shut down
+  virtual void clear() = 0;
+};
+
+}  // namespace inference::replacementsBenchmark
@@ -0,0 +1,14 @@
+find_package(benchmark REQUIRED)
+
+set(CMAKE_RUNTIME_OUTPUT_DIRECTORY ${SC_BIN_PATH}/inference-benchmarks)
+
+file(GLOB_RECURSE BENCHMARK_SOURCES "${CMAKE_CURRENT_LIST_DIR}/*.cpp" "${CMAKE_CURRENT_LIST_DIR}/*.hpp")
+
+add_executable(inference-module-benchmarks ${BENCHMARK_SOURCES})
+target_link_libraries(inference-module-benchmarks
+    LINK_PRIVATE benchmark::benchmark
+    LINK_PRIVATE sc-memory
+    LINK_PRIVATE inferenceModule)
+target_include_directories(inference-module-benchmarks
+    PRIVATE ${CMAKE_CURRENT_LIST_DIR}
+    PRIVATE ${SC_MEMORY_SRC})
@@ -0,0 +1,132 @@
+/*
+ * This source file is part of an OSTIS project. For the latest info, see http://ostis.net
+ * Distributed under the MIT License
+ * (See accompanying file COPYING.MIT or copy at http://opensource.org/licenses/MIT)
+ */
+
+#include "BenchmarkScMemory.hpp"
+
+#include "keynodes/InferenceKeynodes.hpp"
+#include "logic/ConjunctionExpressionNode.hpp"
+#include "logic/ConjunctionPlanner.hpp"
+#include "logic/TemplateExpressionNode.hpp"
+#include "searcher/templateSearcher/TemplateSearcherGeneral.hpp"
+
+#include <benchmark/benchmark.h>
+
+namespace inference::replacementsBenchmark
+{
+size_t constexpr kSelectiveClassElementsAmount = 16;
+size_t constexpr kConjunctionOperandsAmount = 3;
+
+/**
+ * Knowledge base with the conjunction `class_0 _-> _x; class_1 _-> _x; class_2 _-> _x` generated in sc-memory. The
+ * first class has all elements, the second one has every fourth of them and the last one has 16 of them, so in the
+ * rule order the biggest atom is searched first, and the planner puts the last atom first by arcs of its class
+ */
+class ConjunctionPlanFixture : public ScMemoryBenchmark
+{
+protected:
+  std::shared_ptr<TemplateSearcherGeneral> templateSearcher;
+  std::unique_ptr<ConjunctionExpressionNode> conjunction;
+
+  LogicEvaluationContext createEvaluationContext() const
+  {
+    LogicEvaluationContext evaluationContext;
+    evaluationContext.context = context.get();
+    evaluationContext.templateSearcher = templateSearcher;
+    return evaluationContext;
+  }
+
+  void computeConjunction(::benchmark::State & state, bool isPlanned)
+  {
+    size_t replacementsAmount = 0;
+    for (auto _ : state)
+    {
+      LogicEvaluationContext evaluationContext = createEvaluationContext();
+      // A new planner for each computation, so atoms are estimated by arcs instead of their previous computations
+      if (isPlanned)
+        evaluationContext.conjunctionPlanner = std::make_shared<ConjunctionPlanner>();
+      LogicFormulaResult result;
+      conjunction->compute(evaluationContext, result);
+      replacementsAmount = result.replacements.getCombinationsAmount();
+      ::benchmark::DoNotOptimize(replacementsAmount);
+    }
+    if (replacementsAmount != kSelectiveClassElementsAmount)
+      state.SkipWithError("Conjunction has unexpected amount of replacements");
+  }
+
+  void generateKnowledgeBase(::benchmark::State const & state) override
+  {
+    auto const elementsAmount = static_cast<size_t>(state.range(0));
+    ScAddr const & variable = context->GenerateNode(ScType::NodeVar);
+    std::vector<ScAddr> classes;
+    OperatorLogicExpressionNode::OperandsVector operands;
+    for (size_t operandIndex = 0; operandIndex < kConjunctionOperandsAmount; ++operandIndex)
+    {
+      ScAddr const & elementsClass = context->GenerateNode(ScType::NodeConstClass);
+      ScAddr const & formula = context->GenerateNode(ScType::NodeConstStruct);
+      ScAddr const & arc = context->GenerateConnector(ScType::EdgeAccessVarPosPerm, elementsClass, variable);
+      for (ScAddr const & formulaElement : {elementsClass, arc, variable})
+        context->GenerateConnector(ScType::EdgeAccessConstPosPerm, formula, formulaElement);
+      context->GenerateConnector(ScType::EdgeAccessConstPosPerm, InferenceKeynodes::atomic_logical_formula, formula);
+      classes.push_back(elementsClass);
+      operands.push_back(std::make_shared<TemplateExpressionNode>(formula));
+    }
+    conjunction = std::make_unique<ConjunctionExpressionNode>(operands);
+
+    size_t const selectiveClassStride = elementsAmount / kSelectiveClassElementsAmount;
+    for (size_t elementIndex = 0; elementIndex < elementsAmount; ++elementIndex)
+    {
+      ScAddr const & element = context->GenerateNode(ScType::NodeConst);
+      context->GenerateConnector(ScType::EdgeAccessConstPosPerm, classes[0], element);
+      if (elementIndex % 4 == 0)
+        context->GenerateConnector(ScType::EdgeAccessConstPosPerm, classes[1], element);
+      if (elementIndex % selectiveClassStride == 0)
+        context->GenerateConnector(ScType::EdgeAccessConstPosPerm, classes[2], element);
+    }
+    templateSearcher = std::make_shared<TemplateSearcherGeneral>(context.get());
+    templateSearcher->setReplacementsUsingType(REPLACEMENTS_ALL);
+  }
+
+  void clear() override
+  {
+    conjunction.reset();
+    templateSearcher.reset();
+  }
+};
+
+BENCHMARK_DEFINE_F(ConjunctionPlanFixture, BM_ConjunctionInRuleOrder)(::benchmark::State & state)
+{
+  computeConjunction(state, false);
+}
+
+/// Atoms are ordered by `GetElementEdgesAndOutgoingArcsCount` of their classes and bound by the selective atom
+BENCHMARK_DEFINE_F(ConjunctionPlanFixture, BM_ConjunctionInPlannedOrder)(::benchmark::State & state)
+{
+  LogicEvaluationContext const evaluationContext = createEvaluationContext();
+  std::vector<LogicExpressionNode const *> operands;
+  for (std::shared_ptr<LogicExpressionNode> const & operand : conjunction->getOperands())
+    operands.push_back(operand.get());
+  ConjunctionPlanner planner;
+  for (ConjunctionPlanner::Step const & step : planner.plan(evaluationContext, operands))
+  {
+    if (step.source != ConjunctionPlanner::EstimationSource::ARCS_COUNT)
+    {
+      state.SkipWithError("Conjunction operand is not estimated by arcs count");
+      return;
+    }
+  }
+  computeConjunction(state, true);
+}
+
+BENCHMARK_REGISTER_F(ConjunctionPlanFixture, BM_ConjunctionInRuleOrder)
+    ->Arg(1 << 12)
+    ->Arg(1 << 16)
+    ->Unit(::benchmark::kMillisecond);
+BENCHMARK_REGISTER_F(ConjunctionPlanFixture, BM_ConjunctionInPlannedOrder)
+    ->Arg(1 << 12)
+    ->Arg(1 << 16)
+    ->Unit(::benchmark::kMillisecond);
+
+}  // namespace inference::replacementsBenchmark
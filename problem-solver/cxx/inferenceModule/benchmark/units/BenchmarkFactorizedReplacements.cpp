@@ -0,0 +1,79 @@
+/*
+ * This source file is part of an OSTIS project. For the latest info, see http://ostis.net
+ * Distributed under the MIT License
+ * (See accompanying file COPYING.MIT or copy at http://opensource.org/licenses/MIT)
+ */
+
+#include "BenchmarkReplacements.hpp"
+
+#include "utils/FactorizedReplacements.hpp"
+#include "utils/ReplacementsUtils.hpp"
+
+#include <benchmark/benchmark.h>
+
+namespace inference::replacementsBenchmark
+{
+size_t constexpr kSelectedValuesStep = 100;
+
+/**
+ * Operands of the disjunction of two atoms with disjoint keys and a conjunction operand that keeps every 100th value
+ * of the first key, as in the rule `(a(x) || b(y)) && c(x)`
+ */
+void createDisjunctionOperands(size_t columnsAmount, Replacements & first, Replacements & second, Replacements & filter)
+{
+  ScAddrVector const & keys = getKeys(2);
+  first = Replacements(ScAddrVector{keys[0]});
+  second = Replacements(ScAddrVector{keys[1]});
+  filter = Replacements(ScAddrVector{keys[0]});
+  for (size_t columnIndex = 0; columnIndex < columnsAmount; ++columnIndex)
+  {
+    first.addColumn()[0] = getAddr(columnIndex);
+    second.addColumn()[0] = getAddr(columnIndex);
+    if (columnIndex % kSelectedValuesStep == 0)
+      filter.addColumn()[0] = getAddr(columnIndex);
+  }
+}
+
+void BM_DisjunctionWithDifferentKeysMaterialized(::benchmark::State & state)
+{
+  auto const columnsAmount = static_cast<size_t>(state.range(0));
+  Replacements first;
+  Replacements second;
+  Replacements filter;
+  createDisjunctionOperands(columnsAmount, first, second, filter);
+  for (auto _ : state)
+  {
+    Replacements result;
+    ReplacementsUtils::uniteReplacements(first, second, result);
+    ReplacementsUtils::narrowWith(result, filter);
+    ::benchmark::DoNotOptimize(result.getColumnsAmount());
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * columnsAmount * 2));
+}
+
+void BM_DisjunctionWithDifferentKeysFactorized(::benchmark::State & state)
+{
+  auto const columnsAmount = static_cast<size_t>(state.range(0));
+  Replacements first;
+  Replacements second;
+  Replacements filter;
+  createDisjunctionOperands(columnsAmount, first, second, filter);
+  FactorizedReplacements const factorizedFirst(first);
+  FactorizedReplacements const factorizedSecond(second);
+  FactorizedReplacements const factorizedFilter(filter);
+  for (auto _ : state)
+  {
+    FactorizedReplacements result;
+    FactorizedReplacements::unite(factorizedFirst, factorizedSecond, result);
+    result.narrowWith(factorizedFilter);
+    Replacements table;
+    result.expand(table);
+    ::benchmark::DoNotOptimize(table.getColumnsAmount());
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * columnsAmount * 2));
+}
+
+BENCHMARK(BM_DisjunctionWithDifferentKeysMaterialized)->Arg(100)->Arg(1000)->Unit(::benchmark::kMillisecond);
+BENCHMARK(BM_DisjunctionWithDifferentKeysFactorized)->Arg(100)->Arg(1000)->Unit(::benchmark::kMillisecond);
+
+}  // namespace inference::replacementsBenchmark
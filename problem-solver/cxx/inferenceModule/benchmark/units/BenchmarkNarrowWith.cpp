@@ -0,0 +1,87 @@
+/*
+ * This source file is part of an OSTIS project. For the latest info, see http://ostis.net
+ * Distributed under the MIT License
+ * (See accompanying file COPYING.MIT or copy at http://opensource.org/licenses/MIT)
+ */
+
+#include "BenchmarkReplacements.hpp"
+
+#include "utils/ReplacementsUtils.hpp"
+
+#include <benchmark/benchmark.h>
+
+namespace inference::replacementsBenchmark
+{
+size_t constexpr kConjunctionOperandsAmount = 10;
+
+/**
+ * Operands of the conjunction with keys `keys[0]` and `keys[1]`. Each of them misses every 20th pair of values, so
+ * the conjunction keeps about a half of the accumulator columns
+ */
+std::vector<Replacements> createConjunctionOperands(ScAddrVector const & keys, size_t valuesAmount)
+{
+  std::vector<Replacements> operands;
+  for (size_t operandIndex = 0; operandIndex < kConjunctionOperandsAmount; ++operandIndex)
+  {
+    Replacements operand(ScAddrVector{keys[0], keys[1]});
+    for (size_t firstValue = 0; firstValue < valuesAmount; ++firstValue)
+    {
+      for (size_t secondValue = 0; secondValue < valuesAmount; ++secondValue)
+      {
+        if ((firstValue * valuesAmount + secondValue) % 20 == operandIndex)
+          continue;
+        ScAddr * column = operand.addColumn();
+        column[0] = getAddr(firstValue);
+        column[1] = getAddr(secondValue);
+      }
+    }
+    operands.push_back(std::move(operand));
+  }
+  return operands;
+}
+
+template <typename Conjunction>
+void computeConjunction(::benchmark::State & state, Conjunction conjunction)
+{
+  auto const columnsAmount = static_cast<size_t>(state.range(0));
+  Replacements const & firstOperand = createDistinctReplacements(getKeys(3), columnsAmount);
+  std::vector<Replacements> const & operands =
+      createConjunctionOperands(firstOperand.getKeys(), getDistinctValuesAmount(columnsAmount, 3));
+
+  for (auto _ : state)
+  {
+    Replacements result = firstOperand;
+    for (Replacements const & operand : operands)
+      conjunction(result, operand);
+    ::benchmark::DoNotOptimize(result.getColumnsAmount());
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * columnsAmount * kConjunctionOperandsAmount));
+}
+
+// Conjunction as it was computed before: the result of each intersection is built as a new table and then copied
+void BM_ConjunctionByIntersection(::benchmark::State & state)
+{
+  computeConjunction(
+      state,
+      [](Replacements & result, Replacements const & operand)
+      {
+        Replacements intersection;
+        ReplacementsUtils::intersectReplacements(result, operand, intersection);
+        result = intersection;
+      });
+}
+
+void BM_ConjunctionByNarrowing(::benchmark::State & state)
+{
+  computeConjunction(
+      state,
+      [](Replacements & result, Replacements const & operand)
+      {
+        ReplacementsUtils::narrowWith(result, operand);
+      });
+}
+
+BENCHMARK(BM_ConjunctionByIntersection)->RangeMultiplier(10)->Range(1000, 1000000)->Unit(::benchmark::kMillisecond);
+BENCHMARK(BM_ConjunctionByNarrowing)->RangeMultiplier(10)->Range(1000, 1000000)->Unit(::benchmark::kMillisecond);
+
+}  // namespace inference::replacementsBenchmark
@@ -0,0 +1,76 @@
+/*
+ * This source file is part of an OSTIS project. For the latest info, see http://ostis.net
+ * Distributed under the MIT License
+ * (See accompanying file COPYING.MIT or copy at http://opensource.org/licenses/MIT)
+ */
+
+#include "BenchmarkReplacements.hpp"
+
+#include "utils/ReplacementsUtils.hpp"
+#include "utils/ThreadPool.hpp"
+
+#include <limits>
+#include <thread>
+
+#include <benchmark/benchmark.h>
+
+namespace inference::replacementsBenchmark
+{
+namespace
+{
+/**
+ * Prime multiplier is coprime with the columns amounts of the benchmark, so column indices multiplied by it modulo the
+ * columns amount are a permutation of them and columns are not sorted by common keys
+ */
+size_t constexpr kShuffleMultiplier = 2654435761;
+
+/**
+ * Each column of the first table matches one column of the second table by the common key on average, values of the
+ * common key are shuffled, so tables are joined by hashing
+ */
+void createJoinedReplacements(size_t columnsAmount, Replacements & first, Replacements & second)
+{
+  ScAddrVector const & keys = getKeys(3);
+  first = Replacements(ScAddrVector{keys[0], keys[1]});
+  second = Replacements(ScAddrVector{keys[1], keys[2]});
+  first.reserve(columnsAmount);
+  second.reserve(columnsAmount);
+  for (size_t columnIndex = 0; columnIndex < columnsAmount; ++columnIndex)
+  {
+    ScAddr * firstColumn = first.addColumn();
+    firstColumn[0] = getAddr(columnIndex);
+    firstColumn[1] = getAddr(columnIndex * kShuffleMultiplier % columnsAmount);
+    ScAddr * secondColumn = second.addColumn();
+    secondColumn[0] = getAddr(columnIndex);
+    secondColumn[1] = getAddr(columnsAmount - columnIndex);
+  }
+}
+}  // namespace
+
+void BM_ParallelHashJoin(::benchmark::State & state)
+{
+  auto const columnsAmount = static_cast<size_t>(state.range(0));
+  Replacements first;
+  Replacements second;
+  createJoinedReplacements(columnsAmount, first, second);
+
+  size_t const parallelColumnsThreshold = ReplacementsUtils::getParallelColumnsThreshold();
+  ReplacementsUtils::setParallelColumnsThreshold(state.range(1) > 1 ? 0 : std::numeric_limits<size_t>::max());
+  ThreadPool::setSharedThreadsAmount(static_cast<size_t>(state.range(1)));
+  for (auto _ : state)
+  {
+    Replacements intersection;
+    ReplacementsUtils::intersectReplacements(first, second, intersection);
+    ::benchmark::DoNotOptimize(intersection.getColumnsAmount());
+  }
+  ReplacementsUtils::setParallelColumnsThreshold(parallelColumnsThreshold);
+  ThreadPool::setSharedThreadsAmount(std::thread::hardware_concurrency());
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * columnsAmount));
+}
+
+BENCHMARK(BM_ParallelHashJoin)
+    ->ArgsProduct({{100000, 1000000}, {1, 2, 4, 8, 16}})
+    ->UseRealTime()
+    ->Unit(::benchmark::kMillisecond);
+
+}  // namespace inference::replacementsBenchmark
@@ -0,0 +1,45 @@
+/*
+ * This source file is part of an OSTIS project. For the latest info, see http://ostis.net
+ * Distributed under the MIT License
+ * (See accompanying file COPYING.MIT or copy at http://opensource.org/licenses/MIT)
+ */
+
+#include "BenchmarkReplacements.hpp"
+
+#include "utils/ReplacementsUtils.hpp"
+
+#include <benchmark/benchmark.h>
+
+namespace inference::replacementsBenchmark
+{
+/**
+ * Remove duplicates from the table where every distinct column is repeated twice: first all distinct columns, then
+ * all of them again. Time per column should not grow with the table size
+ */
+void BM_RemoveDuplicateColumns(::benchmark::State & state)
+{
+  auto const columnsAmount = static_cast<size_t>(state.range(0));
+  auto const keysAmount = static_cast<size_t>(state.range(1));
+  Replacements const & distinctReplacements = createDistinctReplacements(getKeys(keysAmount), columnsAmount / 2);
+  Replacements replacements = distinctReplacements;
+  for (size_t columnIndex = 0; columnIndex < distinctReplacements.getColumnsAmount(); ++columnIndex)
+    replacements.addColumn(distinctReplacements.getColumn(columnIndex));
+
+  for (auto _ : state)
+  {
+    state.PauseTiming();
+    Replacements replacementsWithDuplicates = replacements;
+    state.ResumeTiming();
+    ReplacementsUtils::removeDuplicateColumns(replacementsWithDuplicates);
+    ::benchmark::DoNotOptimize(replacementsWithDuplicates.getColumnsAmount());
+  }
+  state.SetComplexityN(static_cast<int64_t>(columnsAmount));
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * columnsAmount));
+}
+
+BENCHMARK(BM_RemoveDuplicateColumns)
+    ->ArgsProduct({::benchmark::CreateRange(1000, 1000000, 10), {3}})
+    ->Complexity(::benchmark::oN)
+    ->Unit(::benchmark::kMillisecond);
+
+}  // namespace inference::replacementsBenchmark
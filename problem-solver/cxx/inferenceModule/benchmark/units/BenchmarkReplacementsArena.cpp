@@ -0,0 +1,69 @@
+/*
+ * This source file is part of an OSTIS project. For the latest info, see http://ostis.net
+ * Distributed under the MIT License
+ * (See accompanying file COPYING.MIT or copy at http://opensource.org/licenses/MIT)
+ */
+
+#include "BenchmarkReplacements.hpp"
+
+#include "utils/ReplacementsArena.hpp"
+#include "utils/ReplacementsUtils.hpp"
+
+#include <benchmark/benchmark.h>
+
+namespace inference::replacementsBenchmark
+{
+size_t constexpr kFormulaAtomsAmount = 8;
+
+/**
+ * Replacements are created, narrowed and united as they are while a formula is used: every atom is found as a new
+ * table, atoms narrow results of two conjunctions and the results are united
+ */
+void useFormula(std::vector<Replacements> const & atoms)
+{
+  Replacements firstConjunction = atoms[0];
+  Replacements secondConjunction = atoms[1];
+  for (size_t atomIndex = 2; atomIndex < atoms.size(); ++atomIndex)
+  {
+    Replacements const atom = atoms[atomIndex];
+    ReplacementsUtils::narrowWith(atomIndex % 2 ? secondConjunction : firstConjunction, atom);
+  }
+  Replacements result;
+  ReplacementsUtils::uniteReplacements(firstConjunction, secondConjunction, result);
+  ::benchmark::DoNotOptimize(result.getColumnsAmount());
+}
+
+std::vector<Replacements> createFormulaAtoms(size_t columnsAmount)
+{
+  // Atoms have the same keys, so narrowing does not multiply columns and only allocations depend on the arena
+  ScAddrVector const & keys = getKeys(2);
+  std::vector<Replacements> atoms;
+  for (size_t atomIndex = 0; atomIndex < kFormulaAtomsAmount; ++atomIndex)
+    atoms.push_back(createDistinctReplacements(keys, columnsAmount - atomIndex * columnsAmount / 16));
+  return atoms;
+}
+
+void BM_UseFormulaWithHeap(::benchmark::State & state)
+{
+  std::vector<Replacements> const & atoms = createFormulaAtoms(static_cast<size_t>(state.range(0)));
+  for (auto _ : state)
+    useFormula(atoms);
+}
+
+void BM_UseFormulaWithArena(::benchmark::State & state)
+{
+  std::vector<Replacements> const & atoms = createFormulaAtoms(static_cast<size_t>(state.range(0)));
+  ReplacementsArena arena;
+  for (auto _ : state)
+  {
+    arena.reset();
+    ReplacementsArena::Scope const arenaScope(arena);
+    useFormula(atoms);
+  }
+  state.counters["bytes_per_formula"] = static_cast<double>(arena.getStatistics().maxFormulaAllocatedBytes);
+}
+
+BENCHMARK(BM_UseFormulaWithHeap)->RangeMultiplier(10)->Range(10, 10000)->Unit(::benchmark::kMicrosecond);
+BENCHMARK(BM_UseFormulaWithArena)->RangeMultiplier(10)->Range(10, 10000)->Unit(::benchmark::kMicrosecond);
+
+}  // namespace inference::replacementsBenchmark
@@ -0,0 +1,84 @@
+/*
+ * This source file is part of an OSTIS project. For the latest info, see http://ostis.net
+ * Distributed under the MIT License
+ * (See accompanying file COPYING.MIT or copy at http://opensource.org/licenses/MIT)
+ */
+
+#include "BenchmarkReplacements.hpp"
+
+#include "utils/ReplacementsHash.hpp"
+
+#include <algorithm>
+#include <numeric>
+#include <unordered_map>
+
+#include <benchmark/benchmark.h>
+
+namespace inference::replacementsBenchmark
+{
+using HashFunction = uint64_t (*)(ScAddr const * column, std::vector<size_t> const & keysIndices);
+
+// Hash that was used for replacements columns before, it is kept here to compare collisions rate
+uint64_t hashColumnByOffsets(ScAddr const * column, std::vector<size_t> const & keysIndices)
+{
+  std::vector<size_t> const primes = {7, 13, 17, 19, 31, 41, 43};
+  size_t offsets = 0;
+  for (size_t i = 0; i < keysIndices.size(); ++i)
+    offsets += column[keysIndices[i]].GetRealAddr().offset * primes.at(i % primes.size());
+  return offsets / std::max<size_t>(keysIndices.size(), 1);
+}
+
+/**
+ * Hash all columns of the table with distinct columns and put them to buckets as joins do. Bucket sizes are reported
+ * as counters: `avg_bucket` is the amount of columns compared with each other in joins per column, for a good hash it
+ * is near 1
+ */
+void hashColumns(::benchmark::State & state, HashFunction hashFunction)
+{
+  auto const columnsAmount = static_cast<size_t>(state.range(0));
+  auto const keysAmount = static_cast<size_t>(state.range(1));
+  Replacements const & replacements = createDistinctReplacements(getKeys(keysAmount), columnsAmount);
+  std::vector<size_t> keysIndices(keysAmount);
+  std::iota(keysIndices.begin(), keysIndices.end(), 0);
+
+  std::unordered_map<uint64_t, size_t> bucketSizes;
+  for (auto _ : state)
+  {
+    bucketSizes.clear();
+    bucketSizes.reserve(columnsAmount);
+    for (size_t columnIndex = 0; columnIndex < columnsAmount; ++columnIndex)
+      ++bucketSizes[hashFunction(replacements.getColumnValues(columnIndex), keysIndices)];
+    ::benchmark::DoNotOptimize(bucketSizes.size());
+  }
+
+  size_t maxBucketSize = 0;
+  size_t comparisonsAmount = 0;
+  for (auto const & bucketSize : bucketSizes)
+  {
+    maxBucketSize = std::max(maxBucketSize, bucketSize.second);
+    comparisonsAmount += bucketSize.second * bucketSize.second;
+  }
+  state.counters["buckets"] = static_cast<double>(bucketSizes.size());
+  state.counters["max_bucket"] = static_cast<double>(maxBucketSize);
+  state.counters["avg_bucket"] = static_cast<double>(comparisonsAmount) / static_cast<double>(columnsAmount);
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * columnsAmount));
+}
+
+void BM_ReplacementsHash(::benchmark::State & state)
+{
+  hashColumns(state, &ReplacementsHash::hashColumn);
+}
+
+void BM_ReplacementsHashByOffsets(::benchmark::State & state)
+{
+  hashColumns(state, &hashColumnByOffsets);
+}
+
+BENCHMARK(BM_ReplacementsHash)
+    ->ArgsProduct({{10000, 100000, 1000000}, {1, 2, 3, 5}})
+    ->Unit(::benchmark::kMillisecond);
+BENCHMARK(BM_ReplacementsHashByOffsets)
+    ->ArgsProduct({{10000, 100000}, {1, 2, 3, 5}})
+    ->Unit(::benchmark::kMillisecond);
+
+}  // namespace inference::replacementsBenchmark
@@ -0,0 +1,93 @@
+/*
+ * This source file is part of an OSTIS project. For the latest info, see http://ostis.net
+ * Distributed under the MIT License
+ * (See accompanying file COPYING.MIT or copy at http://opensource.org/licenses/MIT)
+ */
+
+#include "BenchmarkReplacements.hpp"
+
+#include "utils/ReplacementsKernels.hpp"
+
+#include <numeric>
+
+#include <benchmark/benchmark.h>
+
+namespace inference::replacementsBenchmark
+{
+/// Run the benchmark with the instruction set, it is skipped if the CPU does not support it
+template <typename Kernel>
+void runKernel(::benchmark::State & state, ReplacementsKernels::InstructionSet instructionSet, Kernel kernel)
+{
+  if (instructionSet > ReplacementsKernels::getSupportedInstructionSet())
+  {
+    state.SkipWithError("Instruction set is not supported by CPU");
+    return;
+  }
+  ReplacementsKernels::InstructionSet const previousInstructionSet = ReplacementsKernels::getInstructionSet();
+  ReplacementsKernels::setInstructionSet(instructionSet);
+
+  auto const columnsAmount = static_cast<size_t>(state.range(0));
+  auto const keysAmount = static_cast<size_t>(state.range(1));
+  Replacements const & replacements = createDistinctReplacements(getKeys(keysAmount), columnsAmount);
+  std::vector<size_t> keysIndices(keysAmount);
+  std::iota(keysIndices.begin(), keysIndices.end(), 0);
+  for (auto _ : state)
+    kernel(replacements, keysIndices);
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * columnsAmount));
+
+  ReplacementsKernels::setInstructionSet(previousInstructionSet);
+}
+
+void hashColumns(Replacements const & replacements, std::vector<size_t> const & keysIndices)
+{
+  std::vector<uint64_t> hashes;
+  ReplacementsKernels::hashColumns(replacements, keysIndices, hashes);
+  ::benchmark::DoNotOptimize(hashes.data());
+}
+
+// Each column is compared with itself, so all values are compared without early exit
+void compareColumns(Replacements const & replacements, std::vector<size_t> const & keysIndices)
+{
+  size_t equalColumnsAmount = 0;
+  for (size_t columnIndex = 0; columnIndex < replacements.getColumnsAmount(); ++columnIndex)
+  {
+    ScAddr const * column = replacements.getColumnValues(columnIndex);
+    equalColumnsAmount += ReplacementsKernels::areValuesEqual(column, keysIndices, column, keysIndices);
+  }
+  ::benchmark::DoNotOptimize(equalColumnsAmount);
+}
+
+void BM_HashColumnsScalar(::benchmark::State & state)
+{
+  runKernel(state, ReplacementsKernels::SCALAR, &hashColumns);
+}
+
+void BM_HashColumnsAvx2(::benchmark::State & state)
+{
+  runKernel(state, ReplacementsKernels::AVX2, &hashColumns);
+}
+
+void BM_CompareColumnsScalar(::benchmark::State & state)
+{
+  runKernel(state, ReplacementsKernels::SCALAR, &compareColumns);
+}
+
+void BM_CompareColumnsAvx2(::benchmark::State & state)
+{
+  runKernel(state, ReplacementsKernels::AVX2, &compareColumns);
+}
+
+BENCHMARK(BM_HashColumnsScalar)
+    ->ArgsProduct({::benchmark::CreateRange(10000, 10000000, 10), {3}})
+    ->Unit(::benchmark::kMillisecond);
+BENCHMARK(BM_HashColumnsAvx2)
+    ->ArgsProduct({::benchmark::CreateRange(10000, 10000000, 10), {3}})
+    ->Unit(::benchmark::kMillisecond);
+BENCHMARK(BM_CompareColumnsScalar)
+    ->ArgsProduct({::benchmark::CreateRange(10000, 10000000, 10), {4, 8, 16}})
+    ->Unit(::benchmark::kMillisecond);
+BENCHMARK(BM_CompareColumnsAvx2)
+    ->ArgsProduct({::benchmark::CreateRange(10000, 10000000, 10), {4, 8, 16}})
+    ->Unit(::benchmark::kMillisecond);
+
+}  // namespace inference::replacementsBenchmark
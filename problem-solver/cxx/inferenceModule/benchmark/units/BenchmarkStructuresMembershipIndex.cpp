@@ -0,0 +1,131 @@
+/*
+ * This source file is part of an OSTIS project. For the latest info, see http://ostis.net
+ * Distributed under the MIT License
+ * (See accompanying file COPYING.MIT or copy at http://opensource.org/licenses/MIT)
+ */
+
+#include "BenchmarkScMemory.hpp"
+
+#include "searcher/templateSearcher/TemplateSearcherInStructures.hpp"
+
+#include <benchmark/benchmark.h>
+
+namespace inference::replacementsBenchmark
+{
+size_t constexpr kInputStructureElementsAmount = 1'000'000;
+size_t constexpr kCheckedElementsAmount = 10'000;
+
+/// Searcher that checks elements by the index of input structures
+class TemplateSearcherByIndex : public TemplateSearcherInStructures
+{
+public:
+  using TemplateSearcherInStructures::isValidElement;
+  using TemplateSearcherInStructures::TemplateSearcherInStructures;
+};
+
+/// Searcher that checks elements as they were checked before the index: structures of the element are iterated
+class TemplateSearcherByStructuresIteration : public TemplateSearcherInStructures
+{
+public:
+  using TemplateSearcherInStructures::TemplateSearcherInStructures;
+
+  bool isValidElement(ScAddr const & element) const override
+  {
+    ScIterator3Ptr const & structuresIterator =
+        context->CreateIterator3(ScType::NodeConstStruct, ScType::EdgeAccessConstPosPerm, element);
+    while (structuresIterator->Next())
+    {
+      if (inputStructures.count(structuresIterator->Get(0)))
+        return true;
+    }
+    return false;
+  }
+};
+
+/**
+ * Input structure with 10^6 elements generated in sc-memory. Every second checked element belongs to it, and each of
+ * the checked elements belongs to `state.range(0)` other structures, which are added after the input structure
+ */
+class StructuresMembershipFixture : public ScMemoryBenchmark
+{
+protected:
+  ScAddrUnorderedSet inputStructures;
+  ScAddrVector checkedElements;
+
+  void generateKnowledgeBase(::benchmark::State const & state) override
+  {
+    ScAddr const & inputStructure = context->GenerateNode(ScType::NodeConstStruct);
+    inputStructures = {inputStructure};
+    for (size_t elementIndex = 0; elementIndex < kInputStructureElementsAmount; ++elementIndex)
+    {
+      ScAddr const & element = context->GenerateNode(ScType::NodeConst);
+      context->GenerateConnector(ScType::EdgeAccessConstPosPerm, inputStructure, element);
+      if (elementIndex < kCheckedElementsAmount / 2)
+        checkedElements.push_back(element);
+    }
+    for (size_t checkedIndex = kCheckedElementsAmount / 2; checkedIndex < kCheckedElementsAmount; ++checkedIndex)
+      checkedElements.push_back(context->GenerateNode(ScType::NodeConst));
+
+    auto const structuresAmount = static_cast<size_t>(state.range(0));
+    for (size_t structureIndex = 0; structureIndex < structuresAmount; ++structureIndex)
+    {
+      ScAddr const & structure = context->GenerateNode(ScType::NodeConstStruct);
+      for (ScAddr const & element : checkedElements)
+        context->GenerateConnector(ScType::EdgeAccessConstPosPerm, structure, element);
+    }
+  }
+
+  void clear() override
+  {
+    checkedElements.clear();
+  }
+
+  template <class Searcher>
+  void checkElements(::benchmark::State & state, Searcher const & searcher)
+  {
+    size_t validElementsAmount = 0;
+    for (auto _ : state)
+    {
+      validElementsAmount = 0;
+      for (ScAddr const & element : checkedElements)
+        validElementsAmount += searcher.isValidElement(element);
+      ::benchmark::DoNotOptimize(validElementsAmount);
+    }
+    if (validElementsAmount != kCheckedElementsAmount / 2)
+      state.SkipWithError("Unexpected amount of elements of the input structure");
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * kCheckedElementsAmount));
+  }
+};
+
+BENCHMARK_DEFINE_F(StructuresMembershipFixture, BM_MembershipByStructuresIteration)(::benchmark::State & state)
+{
+  TemplateSearcherByStructuresIteration const searcher(context.get(), inputStructures);
+  checkElements(state, searcher);
+}
+
+BENCHMARK_DEFINE_F(StructuresMembershipFixture, BM_MembershipByIndex)(::benchmark::State & state)
+{
+  TemplateSearcherByIndex const searcher(context.get(), inputStructures);
+  checkElements(state, searcher);
+}
+
+/// Index is built when input structures are set for an inference, its cost is paid by the first searches
+BENCHMARK_DEFINE_F(StructuresMembershipFixture, BM_MembershipIndexBuild)(::benchmark::State & state)
+{
+  TemplateSearcherByIndex searcher(context.get());
+  for (auto _ : state)
+    searcher.setInputStructures(inputStructures);
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * kInputStructureElementsAmount));
+}
+
+BENCHMARK_REGISTER_F(StructuresMembershipFixture, BM_MembershipByStructuresIteration)
+    ->Arg(10)
+    ->Arg(100)
+    ->Unit(::benchmark::kMillisecond);
+BENCHMARK_REGISTER_F(StructuresMembershipFixture, BM_MembershipByIndex)
+    ->Arg(10)
+    ->Arg(100)
+    ->Unit(::benchmark::kMillisecond);
+BENCHMARK_REGISTER_F(StructuresMembershipFixture, BM_MembershipIndexBuild)->Arg(0)->Unit(::benchmark::kMillisecond);
+
+}  // namespace inference::replacementsBenchmark
@@ -14,6 +14,7 @@
 #include "manager/solutionTreeManager/SolutionTreeManager.hpp"
 #include "manager/inferenceManager/DirectInferenceManagerAll.hpp"
 #include "manager/inferenceManager/DirectInferenceManagerTarget.hpp"
+#include "manager/inferenceManager/ReteInferenceManager.hpp"
 
 using namespace inference;
 
@@ -22,41 +23,9 @@ std::unique_ptr<InferenceManagerAbstract> InferenceManagerFactory::constructDire
     InferenceConfig const & inferenceFlowConfig)
 {
   std::unique_ptr<DirectInferenceManagerAll> strategyAll = std::make_unique<DirectInferenceManagerAll>(context);
-  std::shared_ptr<SolutionTreeManagerAbstract> solutionTreeManager;
-  if (inferenceFlowConfig.solutionTreeType == TREE_FULL)
-  {
-    solutionTreeManager = std::make_unique<SolutionTreeManager>(context);
-  }
-  else if (inferenceFlowConfig.solutionTreeType == TREE_ONLY_OUTPUT_STRUCTURE)
-  {
-    solutionTreeManager = std::make_unique<SolutionTreeManagerEmpty>(context);
-  }
-  strategyAll->setSolutionTreeManager(solutionTreeManager);
-
-  std::shared_ptr<TemplateManagerAbstract> templateManager = std::make_shared<TemplateManagerFixedArguments>(context);
-  templateManager->setReplacementsUsingType(inferenceFlowConfig.replacementsUsingType);
-  templateManager->setGenerationType(inferenceFlowConfig.generationType);
-  templateManager->setFillingType(inferenceFlowConfig.fillingType);
-  strategyAll->setTemplateManager(templateManager);
-
-  std::shared_ptr<TemplateSearcherAbstract> templateSearcher;
-  if (inferenceFlowConfig.searchType == SEARCH_IN_ALL_KB)
-  {
-    templateSearcher = std::make_shared<TemplateSearcherGeneral>(context);
-  }
-  else if (inferenceFlowConfig.searchType == SEARCH_IN_STRUCTURES)
-  {
-    templateSearcher = std::make_shared<TemplateSearcherInStructures>(context);
-  }
-  else if (inferenceFlowConfig.searchType == SEARCH_ONLY_ACCESS_EDGES_IN_STRUCTURES)
-  {
-    templateSearcher = std::make_shared<TemplateSearcherOnlyAccessEdgesInStructures>(context);
-  }
-  templateSearcher->setReplacementsUsingType(inferenceFlowConfig.replacementsUsingType);
-  templateSearcher->setOutputStructureFillingType(inferenceFlowConfig.fillingType);
-  templateSearcher->setAtomicLogicalFormulaSearchBeforeGenerationType(
-      inferenceFlowConfig.atomicLogicalFormulaSearchBeforeGenerationType);
-  strategyAll->setTemplateSearcher(templateSearcher);
+  configureInferenceManager(
+      context, inferenceFlowConfig, std::make_shared<TemplateManagerFixedArguments>(context), *strategyAll);
+  strategyAll->setRulesEvaluationType(inferenceFlowConfig.rulesEvaluationType);
 
   return strategyAll;
 }
@@ -67,7 +36,27 @@ std::unique_ptr<InferenceManagerAbstract> InferenceManagerFactory::constructDire
 {
   std::unique_ptr<DirectInferenceManagerTarget> strategyTarget =
       std::make_unique<DirectInferenceManagerTarget>(context);
+  configureInferenceManager(context, inferenceFlowConfig, std::make_shared<TemplateManager>(context), *strategyTarget);
+
+  return strategyTarget;
+}
+
+std::unique_ptr<InferenceManagerAbstract> InferenceManagerFactory::constructReteInferenceManager(
+    ScMemoryContext * context,
+    InferenceConfig const & inferenceFlowConfig)
+{
+  std::unique_ptr<ReteInferenceManager> strategyRete = std::make_unique<ReteInferenceManager>(context);
+  configureInferenceManager(context, inferenceFlowConfig, std::make_shared<TemplateManager>(context), *strategyRete);
 
+  return strategyRete;
+}
+
+void InferenceManagerFactory::configureInferenceManager(
+    ScMemoryContext * context,
+    InferenceConfig const & inferenceFlowConfig,
+    std::shared_ptr<TemplateManagerAbstract> const & templateManager,
+    InferenceManagerAbstract & inferenceManager)
+{
   std::shared_ptr<SolutionTreeManagerAbstract> solutionTreeManager;
   if (inferenceFlowConfig.solutionTreeType == TREE_FULL)
   {
@@ -77,13 +66,12 @@ std::unique_ptr<InferenceManagerAbstract> InferenceManagerFactory::constructDire
   {
     solutionTreeManager = std::make_unique<SolutionTreeManagerEmpty>(context);
   }
-  strategyTarget->setSolutionTreeManager(solutionTreeManager);
+  inferenceManager.setSolutionTreeManager(solutionTreeManager);
 
-  std::shared_ptr<TemplateManagerAbstract> templateManager = std::make_shared<TemplateManager>(context);
   templateManager->setReplacementsUsingType(inferenceFlowConfig.replacementsUsingType);
   templateManager->setGenerationType(inferenceFlowConfig.generationType);
   templateManager->setFillingType(inferenceFlowConfig.fillingType);
-  strategyTarget->setTemplateManager(templateManager);
+  inferenceManager.setTemplateManager(templateManager);
 
   std::shared_ptr<TemplateSearcherAbstract> templateSearcher;
   if (inferenceFlowConfig.searchType == SEARCH_IN_ALL_KB)
@@ -102,7 +90,7 @@ std::unique_ptr<InferenceManagerAbstract> InferenceManagerFactory::constructDire
   templateSearcher->setOutputStructureFillingType(inferenceFlowConfig.fillingType);
   templateSearcher->setAtomicLogicalFormulaSearchBeforeGenerationType(
       inferenceFlowConfig.atomicLogicalFormulaSearchBeforeGenerationType);
-  strategyTarget->setTemplateSearcher(templateSearcher);
-
-  return strategyTarget;
+  inferenceManager.setTemplateSearcher(templateSearcher);
+  inferenceManager.setResultsLimit(inferenceFlowConfig.resultsLimit);
+  inferenceManager.setOperandsEvaluationType(inferenceFlowConfig.operandsEvaluationType);
 }
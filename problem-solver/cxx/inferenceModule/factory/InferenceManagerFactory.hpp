@@ -20,5 +20,17 @@ public:
   static std::unique_ptr<InferenceManagerAbstract> constructDirectInferenceManagerTarget(
       ScMemoryContext * context,
       InferenceConfig const & inferenceFlowConfig);
+
+  static std::unique_ptr<InferenceManagerAbstract> constructReteInferenceManager(
+      ScMemoryContext * context,
+      InferenceConfig const & inferenceFlowConfig);
+
+private:
+  /// Set solution tree manager, template manager and template searcher that are common for all inference managers
+  static void configureInferenceManager(
+      ScMemoryContext * context,
+      InferenceConfig const & inferenceFlowConfig,
+      std::shared_ptr<TemplateManagerAbstract> const & templateManager,
+      InferenceManagerAbstract & inferenceManager);
 };
 }  // namespace inference
@@ -49,6 +49,18 @@ enum AtomicLogicalFormulaSearchBeforeGenerationType
   SEARCH_WITHOUT_REPLACEMENTS = 2
 };
 
+enum OperandsEvaluationType
+{
+  OPERANDS_SEQUENTIALLY = 1,
+  OPERANDS_IN_PARALLEL = 2
+};
+
+enum RulesEvaluationType
+{
+  RULES_SEQUENTIALLY = 1,
+  RULES_IN_PARALLEL = 2
+};
+
 struct InferenceConfig
 {
   GenerationType generationType;
@@ -57,6 +69,12 @@ struct InferenceConfig
   SearchType searchType;
   OutputStructureFillingType fillingType;
   AtomicLogicalFormulaSearchBeforeGenerationType atomicLogicalFormulaSearchBeforeGenerationType;
+  /// Amount of replacements of a rule premise that is enough to apply the rule, 0 if all replacements are used
+  size_t resultsLimit = 0;
+  /// Search atoms of conjunctions and disjunctions independently of each other on threads of the shared pool
+  OperandsEvaluationType operandsEvaluationType = OPERANDS_SEQUENTIALLY;
+  /// Compute premises of all rules of a priority set concurrently, it is used by `DirectInferenceManagerAll` only
+  RulesEvaluationType rulesEvaluationType = RULES_SEQUENTIALLY;
 };
 
 struct InferenceParams
@@ -0,0 +1,162 @@
+/*
+ * This source file is part of an OSTIS project. For the latest info, see http://ostis.net
+ * Distributed under the MIT License
+ * (See accompanying file COPYING.MIT or copy at http://opensource.org/licenses/MIT)
+ */
+
+#include "CompiledRulesCache.hpp"
+
+#include "LogicExpression.hpp"
+
+namespace inference
+{
+std::mutex CompiledRulesCache::sharedCacheMutex;
+std::shared_ptr<CompiledRulesCache> CompiledRulesCache::sharedCache;
+
+CompiledRulesCache::~CompiledRulesCache()
+{
+  clear();
+}
+
+std::shared_ptr<LogicExpressionNode const> CompiledRulesCache::getExpression(
+    ScMemoryContext * context,
+    std::shared_ptr<FormulaMetadataCache> const & formulaMetadataCache,
+    ScAddr const & formulaRoot)
+{
+  {
+    std::lock_guard<std::mutex> const lock(expressionsMutex);
+    auto const & expressionIterator = expressions.find(formulaRoot);
+    if (expressionIterator != expressions.cend())
+    {
+      ++hitsAmount;
+      return expressionIterator->second;
+    }
+  }
+
+  ++missesAmount;
+  FormulasSubscriptions formulasSubscriptions;
+  {
+    std::lock_guard<std::mutex> const lock(expressionsMutex);
+    auto const & subscriptionsIterator = subscriptions.find(formulaRoot);
+    if (subscriptionsIterator != subscriptions.cend())
+    {
+      formulasSubscriptions.swap(subscriptionsIterator->second);
+      subscriptions.erase(subscriptionsIterator);
+    }
+  }
+
+  // Tree is built again while it has sub formulas without subscriptions, because their changes made before they were
+  // subscribed to are not noticed. Changes of subscribed formulas are noticed by the generation of the root
+  std::shared_ptr<LogicExpressionNode const> expression;
+  ScAddrVector builtFormulas;
+  size_t generation = 0;
+  bool isSubscribed = false;
+  while (!isSubscribed)
+  {
+    generation = getGeneration(formulaRoot);
+    LogicExpression logicExpression(context, formulaMetadataCache);
+    expression = logicExpression.build(formulaRoot);
+    builtFormulas = logicExpression.getBuiltFormulas();
+    isSubscribed = subscribe(formulaRoot, builtFormulas, formulasSubscriptions);
+  }
+
+  // Subscriptions of formulas removed from the rule are destroyed out of the lock as in `clear`
+  ScAddrUnorderedSet const builtFormulasSet(builtFormulas.cbegin(), builtFormulas.cend());
+  for (auto formulaIterator = formulasSubscriptions.begin(); formulaIterator != formulasSubscriptions.end();)
+  {
+    if (builtFormulasSet.count(formulaIterator->first))
+      ++formulaIterator;
+    else
+      formulaIterator = formulasSubscriptions.erase(formulaIterator);
+  }
+
+  FormulasSubscriptions replacedSubscriptions;
+  {
+    std::lock_guard<std::mutex> const lock(expressionsMutex);
+    FormulasSubscriptions & rootSubscriptions = subscriptions[formulaRoot];
+    replacedSubscriptions.swap(rootSubscriptions);
+    rootSubscriptions.swap(formulasSubscriptions);
+    if (generations[formulaRoot] == generation)
+      expressions.insert_or_assign(formulaRoot, expression);
+  }
+  return expression;
+}
+
+CompiledRulesCache::Statistics CompiledRulesCache::getStatistics() const
+{
+  return {hitsAmount, missesAmount, invalidationsAmount};
+}
+
+// Subscriptions are destroyed out of the lock, because their destruction waits for callbacks that take the lock
+void CompiledRulesCache::clear()
+{
+  std::unordered_map<ScAddr, FormulasSubscriptions, ScAddrHashFunc> clearedSubscriptions;
+  {
+    std::lock_guard<std::mutex> const lock(expressionsMutex);
+    expressions.clear();
+    clearedSubscriptions.swap(subscriptions);
+  }
+  clearedSubscriptions.clear();
+}
+
+std::shared_ptr<CompiledRulesCache> CompiledRulesCache::getShared()
+{
+  std::lock_guard<std::mutex> const lock(sharedCacheMutex);
+  return sharedCache;
+}
+
+void CompiledRulesCache::setShared(std::shared_ptr<CompiledRulesCache> const & cache)
+{
+  std::shared_ptr<CompiledRulesCache> previousCache = cache;
+  std::lock_guard<std::mutex> const lock(sharedCacheMutex);
+  sharedCache.swap(previousCache);
+}
+
+size_t CompiledRulesCache::getGeneration(ScAddr const & formulaRoot) const
+{
+  std::lock_guard<std::mutex> const lock(expressionsMutex);
+  auto const & generationIterator = generations.find(formulaRoot);
+  return generationIterator == generations.cend() ? 0 : generationIterator->second;
+}
+
+bool CompiledRulesCache::subscribe(
+    ScAddr const & formulaRoot,
+    ScAddrVector const & formulas,
+    FormulasSubscriptions & formulasSubscriptions)
+{
+  auto const & invalidateFormula = [this, formulaRoot](auto const &)
+  {
+    invalidate(formulaRoot);
+  };
+  using GenerateOutgoingArcEvent = ScEventAfterGenerateOutgoingArc<ScType::EdgeAccessConstPosPerm>;
+  using EraseOutgoingArcEvent = ScEventBeforeEraseOutgoingArc<ScType::EdgeAccessConstPosPerm>;
+  using GenerateIncomingArcEvent = ScEventAfterGenerateIncomingArc<ScType::EdgeAccessConstPosPerm>;
+  using EraseIncomingArcEvent = ScEventBeforeEraseIncomingArc<ScType::EdgeAccessConstPosPerm>;
+
+  bool areAllSubscribed = true;
+  std::lock_guard<std::mutex> const lock(eventsContextMutex);
+  if (!eventsContext)
+    eventsContext = std::make_unique<ScAgentContext>();
+  for (ScAddr const & formula : formulas)
+  {
+    if (formulasSubscriptions.count(formula))
+      continue;
+    areAllSubscribed = false;
+    formulasSubscriptions[formula] = {
+        eventsContext->CreateElementaryEventSubscription<GenerateOutgoingArcEvent>(formula, invalidateFormula),
+        eventsContext->CreateElementaryEventSubscription<EraseOutgoingArcEvent>(formula, invalidateFormula),
+        eventsContext->CreateElementaryEventSubscription<GenerateIncomingArcEvent>(formula, invalidateFormula),
+        eventsContext->CreateElementaryEventSubscription<EraseIncomingArcEvent>(formula, invalidateFormula)};
+  }
+  return areAllSubscribed;
+}
+
+void CompiledRulesCache::invalidate(ScAddr const & formulaRoot)
+{
+  std::lock_guard<std::mutex> const lock(expressionsMutex);
+  ++generations[formulaRoot];
+  if (expressions.erase(formulaRoot))
+    ++invalidationsAmount;
+}
+
+}  // namespace inference
@@ -0,0 +1,96 @@
+/*
+ * This source file is part of an OSTIS project. For the latest info, see http://ostis.net
+ * Distributed under the MIT License
+ * (See accompanying file COPYING.MIT or copy at http://opensource.org/licenses/MIT)
+ */
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include <sc-memory/sc_agent.hpp>
+#include <sc-memory/sc_memory.hpp>
+
+#include "searcher/templateSearcher/FormulaMetadataCache.hpp"
+
+#include "LogicExpressionNode.hpp"
+
+namespace inference
+{
+/**
+ * Compiled logic expression trees keyed by the formula root. Trees keep no state of formula usage, so one tree is used
+ * by all inference managers. Tree of a formula is removed from the cache when an access arc from or to the formula or
+ * any of its sub formulas is generated or erased. Subscriptions follow the sub formulas of the last built tree.
+ */
+class CompiledRulesCache
+{
+public:
+  struct Statistics
+  {
+    size_t hitsAmount = 0;
+    size_t missesAmount = 0;
+    size_t invalidationsAmount = 0;
+  };
+
+  CompiledRulesCache() = default;
+  ~CompiledRulesCache();
+
+  CompiledRulesCache(CompiledRulesCache const & other) = delete;
+  CompiledRulesCache & operator=(CompiledRulesCache const & other) = delete;
+
+  /**
+   * @brief Get expression tree of the formula, it is built if the formula is not in the cache
+   * @param context context to read the formula with
+   * @param formulaMetadataCache metadata of formulas used to classify the formula and its sub formulas
+   * @param formulaRoot main key sc-element of the rule
+   */
+  std::shared_ptr<LogicExpressionNode const> getExpression(
+      ScMemoryContext * context,
+      std::shared_ptr<FormulaMetadataCache> const & formulaMetadataCache,
+      ScAddr const & formulaRoot);
+
+  Statistics getStatistics() const;
+  /// Remove all trees and unsubscribe from their events, statistics are kept
+  void clear();
+
+  /// Cache used by inference managers by default, it is empty if the inference module is not initialized
+  static std::shared_ptr<CompiledRulesCache> getShared();
+  static void setShared(std::shared_ptr<CompiledRulesCache> const & cache);
+
+private:
+  /// Subscriptions to events of the formulas a tree is built from, keyed by these formulas
+  using FormulasSubscriptions =
+      std::unordered_map<ScAddr, std::vector<std::shared_ptr<ScEventSubscription>>, ScAddrHashFunc>;
+
+  std::unique_ptr<ScAgentContext> eventsContext;
+  std::mutex eventsContextMutex;
+  mutable std::mutex expressionsMutex;
+  std::unordered_map<ScAddr, std::shared_ptr<LogicExpressionNode const>, ScAddrHashFunc> expressions;
+  std::unordered_map<ScAddr, FormulasSubscriptions, ScAddrHashFunc> subscriptions;
+  /// Amounts of invalidations of formula roots, a tree is not cached if its root was invalidated while it was built
+  std::unordered_map<ScAddr, size_t, ScAddrHashFunc> generations;
+  std::atomic<size_t> hitsAmount = 0;
+  std::atomic<size_t> missesAmount = 0;
+  std::atomic<size_t> invalidationsAmount = 0;
+
+  static std::mutex sharedCacheMutex;
+  static std::shared_ptr<CompiledRulesCache> sharedCache;
+
+  size_t getGeneration(ScAddr const & formulaRoot) const;
+  /**
+   * @brief Subscribe to events of the formulas that have no subscriptions yet
+   * @param formulasSubscriptions in and out param, subscriptions of the formula root
+   * @returns true if all formulas already had subscriptions
+   */
+  bool subscribe(
+      ScAddr const & formulaRoot,
+      ScAddrVector const & formulas,
+      FormulasSubscriptions & formulasSubscriptions);
+  void invalidate(ScAddr const & formulaRoot);
+};
+
+}  // namespace inference
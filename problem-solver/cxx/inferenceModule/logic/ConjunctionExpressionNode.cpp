@@ -6,42 +6,85 @@
 
 #include "ConjunctionExpressionNode.hpp"
 
-ConjunctionExpressionNode::ConjunctionExpressionNode(
-    ScMemoryContext * context,
-    OperatorLogicExpressionNode::OperandsVector & operands)
-  : context(context)
+#include <optional>
+
+#include "ConjunctionPlanner.hpp"
+
+ConjunctionExpressionNode::ConjunctionExpressionNode(OperatorLogicExpressionNode::OperandsVector & operands)
 {
   for (auto & operand : operands)
     this->operands.emplace_back(std::move(operand));
 }
 
-void ConjunctionExpressionNode::compute(LogicFormulaResult & result) const
+void ConjunctionExpressionNode::compute(LogicEvaluationContext & evaluationContext, LogicFormulaResult & result) const
 {
   result.value = false;
-  vector<TemplateExpressionNode *> formulasWithoutConstants;
-  vector<TemplateExpressionNode *> formulasToGenerate;
+  vector<TemplateExpressionNode const *> formulasWithoutConstants;
+  vector<TemplateExpressionNode const *> formulasToGenerate;
+  vector<LogicExpressionNode const *> operandsToCompute;
 
   for (auto const & operand : operands)
   {
-    operand->setArgumentVector(argumentVector);
-    auto atom = dynamic_cast<TemplateExpressionNode *>(operand.get());
+    auto atom = dynamic_cast<TemplateExpressionNode const *>(operand.get());
     if (atom)
     {
-      if (!FormulaClassifier::isFormulaWithConst(context, atom->getFormula()))
+      if (!atom->getMetadata(evaluationContext)->isFormulaWithConst)
       {
         SC_LOG_DEBUG("Found formula without constants in conjunction");
         formulasWithoutConstants.push_back(atom);
         continue;
       }
-      if (FormulaClassifier::isFormulaToGenerate(context, atom->getFormula()))
+      if (atom->getMetadata(evaluationContext)->isFormulaToGenerate)
       {
         SC_LOG_DEBUG("Found formula to generate in conjunction");
         formulasToGenerate.push_back(atom);
         continue;
       }
     }
+    operandsToCompute.push_back(operand.get());
+  }
+
+  // Replacements of an operand are intersected with other operands, so all of them are needed. Only the last atom
+  // searched with replacements of other operands is limited, because each of its replacements is in the result
+  size_t const resultsLimit = evaluationContext.resultsLimit;
+  ResultsLimitScope const operandsLimitScope(evaluationContext, 0);
+
+  std::shared_ptr<ConjunctionPlanner> const & planner = evaluationContext.conjunctionPlanner;
+  std::vector<ConjunctionPlanner::Step> steps;
+  if (planner && operandsToCompute.size() > 1)
+  {
+    steps = planner->plan(evaluationContext, operandsToCompute);
+    SC_LOG_DEBUG("Conjunction plan:" << ConjunctionPlanner::dump(evaluationContext.context, operandsToCompute, steps));
+  }
+  // Atoms searched in parallel are not searched with replacements of previous operands
+  std::vector<std::optional<LogicFormulaResult>> atomsResults;
+  TemplateExpressionNode::computeInParallel(evaluationContext, operandsToCompute, atomsResults);
+  for (size_t stepIndex = 0; stepIndex < operandsToCompute.size(); ++stepIndex)
+  {
+    size_t const operandIndex = steps.empty() ? stepIndex : steps[stepIndex].operandIndex;
+    LogicExpressionNode const * operand = operandsToCompute[operandIndex];
+    std::optional<LogicFormulaResult> & atomResult = atomsResults[operandIndex];
     LogicFormulaResult lastResult;
-    operand->compute(lastResult);
+    auto atom = dynamic_cast<TemplateExpressionNode const *>(operand);
+    if (atom && !atomResult && result.value && planner &&
+        planner->isBoundSearchUsed(evaluationContext, *atom, result.replacements))
+    {
+      SC_LOG_DEBUG("Search atom of conjunction with " << result.replacements.getCombinationsAmount() << " bindings");
+      bool const isLastStep = stepIndex + 1 == operandsToCompute.size() && formulasWithoutConstants.empty() &&
+                              formulasToGenerate.empty();
+      ResultsLimitScope const stepLimitScope(evaluationContext, isLastStep ? resultsLimit : 0);
+      lastResult = atom->find(evaluationContext, result.replacements);
+    }
+    else
+    {
+      if (atomResult)
+        lastResult = std::move(*atomResult);
+      else
+        operand->compute(evaluationContext, lastResult);
+      // Only independently computed atoms are remembered, replacements of bound search depend on the bindings
+      if (atom && planner)
+        planner->recordCardinality(atom->getFormula(), lastResult.replacements.getCombinationsAmount());
+    }
     if (!lastResult.value)
     {
       result.value = false;
@@ -53,7 +96,7 @@ void ConjunctionExpressionNode::compute(LogicFormulaResult & result) const
       result = lastResult;
     else
     {
-      ReplacementsUtils::intersectReplacements(result.replacements, lastResult.replacements, result.replacements);
+      result.replacements.narrowWith(lastResult.replacements);
       if (result.replacements.empty())
       {
         result.value = false;
@@ -65,7 +108,9 @@ void ConjunctionExpressionNode::compute(LogicFormulaResult & result) const
   }
   for (auto const & atom : formulasWithoutConstants)  // atoms without constants are processed here
   {
-    LogicFormulaResult lastResult = atom->find(result.replacements);
+    bool const isLastStep = atom == formulasWithoutConstants.back() && formulasToGenerate.empty();
+    ResultsLimitScope const stepLimitScope(evaluationContext, isLastStep ? resultsLimit : 0);
+    LogicFormulaResult lastResult = atom->find(evaluationContext, result.replacements);
     if (!lastResult.value)
     {
       result.value = false;
@@ -73,7 +118,7 @@ void ConjunctionExpressionNode::compute(LogicFormulaResult & result) const
       result.replacements = {};
       return;
     }
-    ReplacementsUtils::intersectReplacements(result.replacements, lastResult.replacements, result.replacements);
+    result.replacements.narrowWith(lastResult.replacements);
     if (result.replacements.empty())
     {
       result.value = false;
@@ -85,7 +130,7 @@ void ConjunctionExpressionNode::compute(LogicFormulaResult & result) const
   for (auto const & formulaToGenerate : formulasToGenerate)  // atoms which should be generated are processed here
   {
     LogicFormulaResult lastResult;
-    formulaToGenerate->generate(result.replacements, lastResult);
+    formulaToGenerate->generate(evaluationContext, result.replacements, lastResult);
     if (!lastResult.value)
     {
       result.value = false;
@@ -93,7 +138,7 @@ void ConjunctionExpressionNode::compute(LogicFormulaResult & result) const
       result.replacements = {};
       return;
     }
-    ReplacementsUtils::intersectReplacements(result.replacements, lastResult.replacements, result.replacements);
+    result.replacements.narrowWith(lastResult.replacements);
     if (result.replacements.empty())
     {
       result.value = false;
@@ -102,24 +147,29 @@ void ConjunctionExpressionNode::compute(LogicFormulaResult & result) const
       return;
     }
   }
+  if (resultsLimit != 0)
+    result.replacements.limit(resultsLimit);
 }
 
-void ConjunctionExpressionNode::generate(Replacements & replacements, LogicFormulaResult & result)
+void ConjunctionExpressionNode::generate(
+    LogicEvaluationContext & evaluationContext,
+    FactorizedReplacements & replacements,
+    LogicFormulaResult & result) const
 {
   LogicFormulaResult fail = {false, false, {}};
   result = {true, false, replacements};
   for (auto const & operand : operands)
   {
     LogicFormulaResult lastResult;
-    operand->generate(result.replacements, lastResult);
+    operand->generate(evaluationContext, result.replacements, lastResult);
     if (!lastResult.value)
     {
       result = fail;
       return;
     }
     result.isGenerated |= lastResult.isGenerated;
-    ReplacementsUtils::intersectReplacements(result.replacements, lastResult.replacements, result.replacements);
-    if (ReplacementsUtils::getColumnsAmount(result.replacements) == 0)
+    result.replacements.narrowWith(lastResult.replacements);
+    if (result.replacements.empty())
     {
       result = fail;
       return;
@@ -13,14 +13,14 @@ using namespace inference;
 class ConjunctionExpressionNode : public OperatorLogicExpressionNode
 {
 public:
-  explicit ConjunctionExpressionNode(ScMemoryContext * context, OperandsVector & operands);
+  explicit ConjunctionExpressionNode(OperandsVector & operands);
 
-  void compute(LogicFormulaResult & result) const override;
+  void compute(LogicEvaluationContext & evaluationContext, LogicFormulaResult & result) const override;
 
-  void generate(Replacements & replacements, LogicFormulaResult & result) override;
+  void generate(
+      LogicEvaluationContext & evaluationContext,
+      FactorizedReplacements & replacements,
+      LogicFormulaResult & result) const override;
 
   ScAddr getFormula() const override;
-
-private:
-  ScMemoryContext * context;
 };
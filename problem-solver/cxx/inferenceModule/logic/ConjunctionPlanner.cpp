@@ -0,0 +1,199 @@
+/*
+ * This source file is part of an OSTIS project. For the latest info, see http://ostis.net
+ * Distributed under the MIT License
+ * (See accompanying file COPYING.MIT or copy at http://opensource.org/licenses/MIT)
+ */
+
+#include "ConjunctionPlanner.hpp"
+
+#include <algorithm>
+#include <sstream>
+#include <unordered_set>
+
+#include "TemplateExpressionNode.hpp"
+
+namespace inference
+{
+std::vector<ConjunctionPlanner::Step> ConjunctionPlanner::plan(
+    LogicEvaluationContext const & evaluationContext,
+    std::vector<LogicExpressionNode const *> const & operands)
+{
+  std::vector<Step> steps;
+  steps.reserve(operands.size());
+  for (size_t operandIndex = 0; operandIndex < operands.size(); ++operandIndex)
+  {
+    Step & step = steps.emplace_back(estimate(evaluationContext, operands[operandIndex]));
+    step.operandIndex = operandIndex;
+  }
+  order(steps);
+
+  ++plansAmount;
+  for (size_t stepIndex = 0; stepIndex < steps.size(); ++stepIndex)
+  {
+    if (steps[stepIndex].operandIndex != stepIndex)
+    {
+      ++reorderedPlansAmount;
+      break;
+    }
+  }
+  return steps;
+}
+
+bool ConjunctionPlanner::isBoundSearchUsed(
+    LogicEvaluationContext const & evaluationContext,
+    TemplateExpressionNode const & atom,
+    FactorizedReplacements const & bindings)
+{
+  if (!evaluationContext.argumentVector.empty() ||
+      evaluationContext.templateSearcher->getReplacementsUsingType() != ReplacementsUsingType::REPLACEMENTS_ALL ||
+      bindings.empty() || bindings.getCombinationsAmount() > boundSearchThreshold)
+    return false;
+
+  ScAddrUnorderedSet const & variables = atom.getMetadata(evaluationContext)->variables;
+  ScAddrVector const & keys = bindings.getKeys();
+  if (std::none_of(
+          keys.cbegin(),
+          keys.cend(),
+          [&variables](ScAddr const & key)
+          {
+            return variables.count(key);
+          }))
+    return false;
+
+  ++boundSearchesAmount;
+  return true;
+}
+
+void ConjunctionPlanner::setBoundSearchThreshold(size_t threshold)
+{
+  boundSearchThreshold = threshold;
+}
+
+size_t ConjunctionPlanner::getBoundSearchThreshold() const
+{
+  return boundSearchThreshold;
+}
+
+void ConjunctionPlanner::recordCardinality(ScAddr const & formula, size_t cardinality)
+{
+  std::lock_guard<std::mutex> const lock(cardinalitiesMutex);
+  previousCardinalities.insert_or_assign(formula, cardinality);
+}
+
+ConjunctionPlanner::Statistics ConjunctionPlanner::getStatistics() const
+{
+  return {plansAmount, reorderedPlansAmount, boundSearchesAmount};
+}
+
+void ConjunctionPlanner::order(std::vector<Step> & steps)
+{
+  std::stable_sort(
+      steps.begin(),
+      steps.end(),
+      [](Step const & first, Step const & second)
+      {
+        return first.estimatedCardinality < second.estimatedCardinality;
+      });
+}
+
+std::string ConjunctionPlanner::dump(
+    ScMemoryContext * context,
+    std::vector<LogicExpressionNode const *> const & operands,
+    std::vector<Step> const & steps)
+{
+  static std::string const sourcesNames[] = {"previous computation", "constant bound", "arcs count", "unknown"};
+  std::stringstream stream;
+  for (Step const & step : steps)
+  {
+    ScAddr const & formula = operands[step.operandIndex]->getFormula();
+    stream << "\n  " << step.operandIndex << ": "
+           << (formula.IsValid() ? context->GetElementSystemIdentifier(formula) : "complex formula");
+    if (step.source != EstimationSource::UNKNOWN)
+      stream << ", " << step.estimatedCardinality;
+    stream << " (" << sourcesNames[static_cast<size_t>(step.source)] << ")";
+  }
+  return stream.str();
+}
+
+ConjunctionPlanner::Step ConjunctionPlanner::estimate(
+    LogicEvaluationContext const & evaluationContext,
+    LogicExpressionNode const * operand) const
+{
+  Step step;
+  auto const * atom = dynamic_cast<TemplateExpressionNode const *>(operand);
+  if (!atom)
+    return step;
+
+  {
+    std::lock_guard<std::mutex> const lock(cardinalitiesMutex);
+    auto const & cardinalityIterator = previousCardinalities.find(atom->getFormula());
+    if (cardinalityIterator != previousCardinalities.cend())
+      return {0, cardinalityIterator->second, EstimationSource::PREVIOUS_COMPUTATION};
+  }
+
+  // Triples are taken one by one, the most selective of the rest is taken first. A triple whose arc or both ends are
+  // bound by constants or by variables of the taken triples only filters replacements, a triple with a constant end
+  // multiplies them by arcs of the constant. The atom is not estimated if no triple left is bound or has a constant
+  // end, because amount of arcs of an element of a variable is unknown
+  ScMemoryContext * context = evaluationContext.context;
+  std::vector<std::array<FormulaMetadata::TemplateItem, 3>> triples = atom->getMetadata(evaluationContext)->triples;
+  if (triples.empty())
+    return step;
+  std::vector<size_t> constantsArcsAmounts;
+  constantsArcsAmounts.reserve(triples.size());
+  for (std::array<FormulaMetadata::TemplateItem, 3> const & triple : triples)
+  {
+    // Constants have no name in the compiled triples
+    size_t arcsAmount = kUnknownCardinality;
+    if (triple[0].name.empty())
+      arcsAmount = context->GetElementEdgesAndOutgoingArcsCount(triple[0].addr);
+    else if (triple[2].name.empty())
+      arcsAmount = context->GetElementEdgesAndIncomingArcsCount(triple[2].addr);
+    constantsArcsAmounts.push_back(arcsAmount);
+  }
+
+  std::unordered_set<std::string> boundVariables;
+  auto const & isBound = [&boundVariables](FormulaMetadata::TemplateItem const & item)
+  {
+    return item.name.empty() || boundVariables.count(item.name);
+  };
+  step = {0, 1, EstimationSource::CONSTANT_BOUND};
+  while (!triples.empty())
+  {
+    size_t selectedTripleIndex = 0;
+    size_t selectedTripleCardinality = kUnknownCardinality;
+    for (size_t tripleIndex = 0; tripleIndex < triples.size(); ++tripleIndex)
+    {
+      std::array<FormulaMetadata::TemplateItem, 3> const & triple = triples[tripleIndex];
+      size_t const tripleCardinality = isBound(triple[1]) || (isBound(triple[0]) && isBound(triple[2]))
+                                           ? 1
+                                           : constantsArcsAmounts[tripleIndex];
+      if (tripleCardinality < selectedTripleCardinality)
+      {
+        selectedTripleIndex = tripleIndex;
+        selectedTripleCardinality = tripleCardinality;
+      }
+    }
+    if (selectedTripleCardinality == kUnknownCardinality)
+      return {};
+
+    if (selectedTripleCardinality > 1)
+    {
+      step.source = EstimationSource::ARCS_COUNT;
+      step.estimatedCardinality =
+          step.estimatedCardinality > (kUnknownCardinality - 1) / selectedTripleCardinality
+              ? kUnknownCardinality - 1
+              : step.estimatedCardinality * selectedTripleCardinality;
+    }
+    for (FormulaMetadata::TemplateItem const & item : triples[selectedTripleIndex])
+    {
+      if (!item.name.empty())
+        boundVariables.insert(item.name);
+    }
+    triples.erase(triples.begin() + static_cast<std::ptrdiff_t>(selectedTripleIndex));
+    constantsArcsAmounts.erase(constantsArcsAmounts.begin() + static_cast<std::ptrdiff_t>(selectedTripleIndex));
+  }
+  return step;
+}
+
+}  // namespace inference
@@ -0,0 +1,122 @@
+/*
+ * This source file is part of an OSTIS project. For the latest info, see http://ostis.net
+ * Distributed under the MIT License
+ * (See accompanying file COPYING.MIT or copy at http://opensource.org/licenses/MIT)
+ */
+
+#pragma once
+
+#include <atomic>
+#include <limits>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <sc-memory/sc_memory.hpp>
+
+#include "LogicExpressionNode.hpp"
+
+class TemplateExpressionNode;
+
+namespace inference
+{
+/**
+ * Orders operands of conjunctions by estimated amount of their replacements, so the most selective operands are
+ * computed first and next intersections are made with small tables. Amount of replacements of an atomic formula is
+ * taken from its previous computation, otherwise it is estimated by all its triples: a triple with a bound arc or
+ * bound source and target only filters replacements, a triple with a constant source or target multiplies them by
+ * arcs of the constant. Elements are bound by constants and by variables of the triples estimated before. Atoms with
+ * a triple that can't be estimated and operands without estimation keep their order after estimated ones.
+ *
+ * An atom planned after other operands is searched with their replacements as template params if there are not more
+ * of them than the bound search threshold, so the atom is looked up for the known values instead of being searched in
+ * the whole knowledge base and intersected with them.
+ */
+class ConjunctionPlanner
+{
+public:
+  static size_t constexpr kUnknownCardinality = std::numeric_limits<size_t>::max();
+  static size_t constexpr kDefaultBoundSearchThreshold = 1000;
+
+  enum class EstimationSource
+  {
+    PREVIOUS_COMPUTATION,
+    CONSTANT_BOUND,
+    ARCS_COUNT,
+    UNKNOWN
+  };
+
+  struct Step
+  {
+    size_t operandIndex = 0;
+    size_t estimatedCardinality = kUnknownCardinality;
+    EstimationSource source = EstimationSource::UNKNOWN;
+  };
+
+  struct Statistics
+  {
+    size_t plansAmount = 0;
+    /// Amount of plans whose order differs from the order of operands in the formula
+    size_t reorderedPlansAmount = 0;
+    /// Amount of atoms searched with replacements of the operands computed before them
+    size_t boundSearchesAmount = 0;
+  };
+
+  ConjunctionPlanner() = default;
+
+  ConjunctionPlanner(ConjunctionPlanner const & other) = delete;
+  ConjunctionPlanner & operator=(ConjunctionPlanner const & other) = delete;
+
+  /**
+   * @brief Estimate operands of the conjunction and order them by estimations
+   * @param evaluationContext formula usage, its context and formula metadata are used to estimate atomic formulas
+   * @param operands operands of the conjunction to compute in the given order if nothing is estimated
+   * @returns steps of the plan, each of them refers to an operand by its index in `operands`
+   */
+  std::vector<Step> plan(
+      LogicEvaluationContext const & evaluationContext,
+      std::vector<LogicExpressionNode const *> const & operands);
+
+  /**
+   * @brief Check if the atom should be searched with replacements of the operands computed before it. Atoms of
+   * formulas used with arguments are not, because their params are created from arguments by the template manager.
+   * Atoms are not searched with replacements if only the first replacements are used, because the first found
+   * replacements for each of them differ from the first found replacements in the whole knowledge base
+   * @param bindings replacements of the operands computed before the atom
+   */
+  bool isBoundSearchUsed(
+      LogicEvaluationContext const & evaluationContext,
+      TemplateExpressionNode const & atom,
+      FactorizedReplacements const & bindings);
+
+  /// Maximum amount of replacements to search an atom with them, atoms are searched independently if it is 0
+  void setBoundSearchThreshold(size_t threshold);
+  size_t getBoundSearchThreshold() const;
+
+  /// Remember amount of replacements of the atomic formula, it is used as estimation when the formula is planned next
+  void recordCardinality(ScAddr const & formula, size_t cardinality);
+
+  Statistics getStatistics() const;
+
+  /// Stable sort of steps by estimated cardinality, steps with equal estimations keep their order
+  static void order(std::vector<Step> & steps);
+
+  /// Returns description of the plan with identifiers of the formulas to log it
+  static std::string dump(
+      ScMemoryContext * context,
+      std::vector<LogicExpressionNode const *> const & operands,
+      std::vector<Step> const & steps);
+
+private:
+  mutable std::mutex cardinalitiesMutex;
+  std::unordered_map<ScAddr, size_t, ScAddrHashFunc> previousCardinalities;
+  std::atomic<size_t> plansAmount = 0;
+  std::atomic<size_t> reorderedPlansAmount = 0;
+  std::atomic<size_t> boundSearchesAmount = 0;
+  std::atomic<size_t> boundSearchThreshold = kDefaultBoundSearchThreshold;
+
+  Step estimate(LogicEvaluationContext const & evaluationContext, LogicExpressionNode const * operand) const;
+};
+
+}  // namespace inference
@@ -6,44 +6,58 @@
 
 #include "DisjunctionExpressionNode.hpp"
 
-DisjunctionExpressionNode::DisjunctionExpressionNode(
-    ScMemoryContext * context,
-    OperatorLogicExpressionNode::OperandsVector & operands)
-  : context(context)
+#include <optional>
+
+DisjunctionExpressionNode::DisjunctionExpressionNode(OperatorLogicExpressionNode::OperandsVector & operands)
 {
   for (auto & operand : operands)
     this->operands.emplace_back(std::move(operand));
 }
 
-void DisjunctionExpressionNode::compute(LogicFormulaResult & result) const
+void DisjunctionExpressionNode::compute(LogicEvaluationContext & evaluationContext, LogicFormulaResult & result) const
 {
   result.value = false;
-  vector<TemplateExpressionNode *> formulasWithoutConstants;
-  vector<TemplateExpressionNode *> formulasToGenerate;
+  vector<TemplateExpressionNode const *> formulasWithoutConstants;
+  vector<TemplateExpressionNode const *> formulasToGenerate;
+  vector<LogicExpressionNode const *> operandsToCompute;
 
   for (auto const & operand : operands)
   {
-    operand->setArgumentVector(argumentVector);
-    auto atom = dynamic_cast<TemplateExpressionNode *>(operand.get());
+    auto atom = dynamic_cast<TemplateExpressionNode const *>(operand.get());
     if (atom)
     {
-      if (!FormulaClassifier::isFormulaWithConst(context, atom->getFormula()))
+      if (!atom->getMetadata(evaluationContext)->isFormulaWithConst)
       {
         SC_LOG_DEBUG("Found formula without constants in disjunction");
         formulasWithoutConstants.push_back(atom);
         continue;
       }
-      if (FormulaClassifier::isFormulaToGenerate(context, atom->getFormula()))
+      if (atom->getMetadata(evaluationContext)->isFormulaToGenerate)
       {
         SC_LOG_DEBUG("Found formula to generate in disjunction");
         formulasToGenerate.push_back(atom);
         continue;
       }
     }
+    operandsToCompute.push_back(operand.get());
+  }
+
+  // Next operands are not searched if operands computed before have enough replacements. Atoms searched in parallel
+  // are united in the order of operands, so the same replacements are kept
+  size_t const resultsLimit = evaluationContext.resultsLimit;
+  bool isResultsLimitReached = false;
+  std::vector<std::optional<LogicFormulaResult>> atomsResults;
+  TemplateExpressionNode::computeInParallel(evaluationContext, operandsToCompute, atomsResults);
+  for (size_t operandIndex = 0; operandIndex < operandsToCompute.size() && !isResultsLimitReached; ++operandIndex)
+  {
     LogicFormulaResult lastResult;
-    operand->compute(lastResult);
+    if (atomsResults[operandIndex])
+      lastResult = std::move(*atomsResults[operandIndex]);
+    else
+      operandsToCompute[operandIndex]->compute(evaluationContext, lastResult);
     result.value |= lastResult.value;
-    ReplacementsUtils::uniteReplacements(result.replacements, lastResult.replacements, result.replacements);
+    FactorizedReplacements::unite(result.replacements, lastResult.replacements, result.replacements);
+    isResultsLimitReached = resultsLimit != 0 && result.replacements.limit(resultsLimit) == resultsLimit;
   }
   if (result.replacements.empty())
   {
@@ -54,20 +68,26 @@ void DisjunctionExpressionNode::compute(LogicFormulaResult & result) const
   }
   for (auto const & atom : formulasWithoutConstants)
   {
-    LogicFormulaResult lastResult = atom->find(result.replacements);
+    if (isResultsLimitReached)
+      break;
+    LogicFormulaResult lastResult = atom->find(evaluationContext, result.replacements);
     result.value |= lastResult.value;
-    ReplacementsUtils::uniteReplacements(result.replacements, lastResult.replacements, result.replacements);
+    FactorizedReplacements::unite(result.replacements, lastResult.replacements, result.replacements);
+    isResultsLimitReached = resultsLimit != 0 && result.replacements.limit(resultsLimit) == resultsLimit;
   }
   for (auto const & formulaToGenerate : formulasToGenerate)
   {
     LogicFormulaResult lastResult;
-    formulaToGenerate->generate(result.replacements, lastResult);
+    formulaToGenerate->generate(evaluationContext, result.replacements, lastResult);
     result.value |= lastResult.value;
-    ReplacementsUtils::uniteReplacements(result.replacements, lastResult.replacements, result.replacements);
+    FactorizedReplacements::unite(result.replacements, lastResult.replacements, result.replacements);
   }
 }
 
-void DisjunctionExpressionNode::generate(Replacements & replacements, LogicFormulaResult & result)
+void DisjunctionExpressionNode::generate(
+    LogicEvaluationContext & evaluationContext,
+    FactorizedReplacements & replacements,
+    LogicFormulaResult & result) const
 {
   result = {false, false, {}};
 }
@@ -13,14 +13,14 @@ using namespace inference;
 class DisjunctionExpressionNode : public OperatorLogicExpressionNode
 {
 public:
-  explicit DisjunctionExpressionNode(ScMemoryContext * context, OperandsVector & operands);
+  explicit DisjunctionExpressionNode(OperandsVector & operands);
 
-  void compute(LogicFormulaResult & result) const override;
+  void compute(LogicEvaluationContext & evaluationContext, LogicFormulaResult & result) const override;
 
-  void generate(Replacements & replacements, LogicFormulaResult & result) override;
+  void generate(
+      LogicEvaluationContext & evaluationContext,
+      FactorizedReplacements & replacements,
+      LogicFormulaResult & result) const override;
 
   ScAddr getFormula() const override;
-
-private:
-  ScMemoryContext * context;
 };
@@ -6,34 +6,43 @@
 
 #include "EquivalenceExpressionNode.hpp"
 
-EquivalenceExpressionNode::EquivalenceExpressionNode(
-    ScMemoryContext * context,
-    OperatorLogicExpressionNode::OperandsVector & operands)
-  : context(context)
+EquivalenceExpressionNode::EquivalenceExpressionNode(OperatorLogicExpressionNode::OperandsVector & operands)
 {
   for (auto & operand : operands)
     this->operands.emplace_back(std::move(operand));
 }
 
-void EquivalenceExpressionNode::compute(LogicFormulaResult & result) const
+void EquivalenceExpressionNode::compute(LogicEvaluationContext & evaluationContext, LogicFormulaResult & result) const
+{
+  // Operands of equivalence are computed without formula arguments and with all their replacements
+  ResultsLimitScope const resultsLimitScope(evaluationContext, 0);
+  ScAddrVector argumentVector;
+  argumentVector.swap(evaluationContext.argumentVector);
+  computeOperands(evaluationContext, result);
+  argumentVector.swap(evaluationContext.argumentVector);
+}
+
+void EquivalenceExpressionNode::computeOperands(
+    LogicEvaluationContext & evaluationContext,
+    LogicFormulaResult & result) const
 {
   vector<LogicFormulaResult> subFormulaResults;
   result.value = false;
 
-  vector<TemplateExpressionNode *> formulasWithoutConstants;
-  vector<TemplateExpressionNode *> formulasToGenerate;
+  vector<TemplateExpressionNode const *> formulasWithoutConstants;
+  vector<TemplateExpressionNode const *> formulasToGenerate;
   for (auto const & operand : operands)
   {
-    auto atom = dynamic_cast<TemplateExpressionNode *>(operand.get());
+    auto atom = dynamic_cast<TemplateExpressionNode const *>(operand.get());
     if (atom)
     {
-      if (!FormulaClassifier::isFormulaWithConst(context, atom->getFormula()))
+      if (!atom->getMetadata(evaluationContext)->isFormulaWithConst)
       {
         SC_LOG_DEBUG("Found formula without constants in equivalence");
         formulasWithoutConstants.push_back(atom);
         continue;
       }
-      if (FormulaClassifier::isFormulaToGenerate(context, atom->getFormula()))
+      if (atom->getMetadata(evaluationContext)->isFormulaToGenerate)
       {
         SC_LOG_DEBUG("Found formula to generate in equivalence");
         formulasToGenerate.push_back(atom);
@@ -41,7 +50,7 @@ void EquivalenceExpressionNode::compute(LogicFormulaResult & result) const
       }
     }
     LogicFormulaResult subFormulaResult;
-    operand->compute(subFormulaResult);
+    operand->compute(evaluationContext, subFormulaResult);
     subFormulaResults.push_back(subFormulaResult);
   }
   SC_LOG_DEBUG("Processed " << subFormulaResults.size() << " formulas in equivalence");
@@ -55,7 +64,7 @@ void EquivalenceExpressionNode::compute(LogicFormulaResult & result) const
   {
     SC_LOG_DEBUG("Processing formula without constants");
     auto formulaWithoutConstants = formulasWithoutConstants[0];
-    subFormulaResults.push_back(formulaWithoutConstants->find(subFormulaResults[0].replacements));
+    subFormulaResults.push_back(formulaWithoutConstants->find(evaluationContext, subFormulaResults[0].replacements));
   }
 
   if (!formulasToGenerate.empty())
@@ -63,23 +72,25 @@ void EquivalenceExpressionNode::compute(LogicFormulaResult & result) const
     SC_LOG_DEBUG("Processing formula to generate");
     auto formulaToGenerate = formulasToGenerate[0];
     LogicFormulaResult generationResult;
-    formulaToGenerate->generate(subFormulaResults[0].replacements, generationResult);
+    formulaToGenerate->generate(evaluationContext, subFormulaResults[0].replacements, generationResult);
     subFormulaResults.push_back(generationResult);
   }
   result.value = subFormulaResults[0].value == subFormulaResults[1].value;
   if (result.value)
-    ReplacementsUtils::intersectReplacements(
-        subFormulaResults[0].replacements, subFormulaResults[1].replacements, result.replacements);
+  {
+    subFormulaResults[0].replacements.narrowWith(subFormulaResults[1].replacements);
+    result.replacements = std::move(subFormulaResults[0].replacements);
+  }
   return;
 
-  auto leftAtom = dynamic_cast<TemplateExpressionNode *>(operands[0].get());
-  bool isLeftGenerated = (leftAtom) && FormulaClassifier::isFormulaToGenerate(context, leftAtom->getFormula());
+  auto leftAtom = dynamic_cast<TemplateExpressionNode const *>(operands[0].get());
+  bool isLeftGenerated = (leftAtom) && leftAtom->getMetadata(evaluationContext)->isFormulaToGenerate;
 
-  auto rightAtom = dynamic_cast<TemplateExpressionNode *>(operands[1].get());
-  bool isRightGenerated = (rightAtom) && FormulaClassifier::isFormulaToGenerate(context, rightAtom->getFormula());
+  auto rightAtom = dynamic_cast<TemplateExpressionNode const *>(operands[1].get());
+  bool isRightGenerated = (rightAtom) && rightAtom->getMetadata(evaluationContext)->isFormulaToGenerate;
 
-  bool leftHasConstants = (leftAtom) && FormulaClassifier::isFormulaWithConst(context, leftAtom->getFormula());
-  bool rightHasConstants = (rightAtom) && FormulaClassifier::isFormulaWithConst(context, rightAtom->getFormula());
+  bool leftHasConstants = (leftAtom) && leftAtom->getMetadata(evaluationContext)->isFormulaWithConst;
+  bool rightHasConstants = (rightAtom) && rightAtom->getMetadata(evaluationContext)->isFormulaWithConst;
 
   SC_LOG_DEBUG("Left has constants = " << leftHasConstants);
   SC_LOG_DEBUG("Right has constants = " << rightHasConstants);
@@ -90,14 +101,14 @@ void EquivalenceExpressionNode::compute(LogicFormulaResult & result) const
   if (!isLeftGenerated)
   {
     SC_LOG_DEBUG("*** Left part of equivalence shouldn't be generated");
-    operands[0]->compute(leftResult);
+    operands[0]->compute(evaluationContext, leftResult);
     if (isRightGenerated)
     {
-      rightAtom->generate(leftResult.replacements, rightResult);
+      rightAtom->generate(evaluationContext, leftResult.replacements, rightResult);
     }
     else
     {
-      operands[1]->compute(rightResult);
+      operands[1]->compute(evaluationContext, rightResult);
     }
   }
   else
@@ -110,17 +121,23 @@ void EquivalenceExpressionNode::compute(LogicFormulaResult & result) const
     else
     {
       SC_LOG_DEBUG("*** Right part shouldn't be generated");
-      operands[1]->compute(rightResult);
-      leftAtom->generate(rightResult.replacements, leftResult);
+      operands[1]->compute(evaluationContext, rightResult);
+      leftAtom->generate(evaluationContext, rightResult.replacements, leftResult);
     }
   }
 
   result.value = leftResult.value == rightResult.value;
   if (rightResult.value)
-    ReplacementsUtils::intersectReplacements(leftResult.replacements, rightResult.replacements, result.replacements);
+  {
+    leftResult.replacements.narrowWith(rightResult.replacements);
+    result.replacements = std::move(leftResult.replacements);
+  }
 }
 
-void EquivalenceExpressionNode::generate(Replacements & replacements, LogicFormulaResult & result)
+void EquivalenceExpressionNode::generate(
+    LogicEvaluationContext & evaluationContext,
+    FactorizedReplacements & replacements,
+    LogicFormulaResult & result) const
 {
   result = {false, false, {}};
 }
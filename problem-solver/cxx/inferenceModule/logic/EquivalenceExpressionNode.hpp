@@ -13,14 +13,17 @@ using namespace inference;
 class EquivalenceExpressionNode : public OperatorLogicExpressionNode
 {
 public:
-  explicit EquivalenceExpressionNode(ScMemoryContext * context, OperandsVector & operands);
+  explicit EquivalenceExpressionNode(OperandsVector & operands);
 
-  void compute(LogicFormulaResult & result) const override;
+  void compute(LogicEvaluationContext & evaluationContext, LogicFormulaResult & result) const override;
 
-  void generate(Replacements & replacements, LogicFormulaResult & result) override;
+  void generate(
+      LogicEvaluationContext & evaluationContext,
+      FactorizedReplacements & replacements,
+      LogicFormulaResult & result) const override;
 
   ScAddr getFormula() const override;
 
 private:
-  ScMemoryContext * context;
+  void computeOperands(LogicEvaluationContext & evaluationContext, LogicFormulaResult & result) const;
 };
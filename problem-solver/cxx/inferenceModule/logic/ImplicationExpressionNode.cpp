@@ -6,10 +6,9 @@
 
 #include "ImplicationExpressionNode.hpp"
 
-ImplicationExpressionNode::ImplicationExpressionNode(
-    ScMemoryContext * context,
-    OperatorLogicExpressionNode::OperandsVector & operands)
-  : context(context)
+#include "ConjunctionExpressionNode.hpp"
+
+ImplicationExpressionNode::ImplicationExpressionNode(OperatorLogicExpressionNode::OperandsVector & operands)
 {
   for (auto & operand : operands)
     this->operands.emplace_back(std::move(operand));
@@ -20,31 +19,130 @@ ImplicationExpressionNode::ImplicationExpressionNode(
  * @param result is a LogicFormulaResult{bool: value, value: isGenerated, Replacements: replacements}
  * @return result from param
  */
-void ImplicationExpressionNode::compute(LogicFormulaResult & result) const
+void ImplicationExpressionNode::compute(LogicEvaluationContext & evaluationContext, LogicFormulaResult & result) const
 {
-  LogicExpressionNode * premiseAtom = operands[0].get();
-  premiseAtom->setArgumentVector(argumentVector);
+  LogicFormulaResult premiseResult;
+  computePremise(evaluationContext, premiseResult);
+  generateConclusion(evaluationContext, premiseResult, result);
+}
 
-  LogicExpressionNode * conclusionAtom = operands[1].get();
-  conclusionAtom->setArgumentVector(argumentVector);
+void ImplicationExpressionNode::computePremise(
+    LogicEvaluationContext & evaluationContext,
+    LogicFormulaResult & premiseResult) const
+{
+  LogicExpressionNode const * premiseAtom = operands[0].get();
 
   // Compute premise formula, get replacements with found constructions
-  LogicFormulaResult premiseResult;
-  premiseAtom->compute(premiseResult);
+  premiseAtom->compute(evaluationContext, premiseResult);
+  // Conclusion is generated only for the needed amount of premise replacements
+  if (evaluationContext.resultsLimit != 0)
+    premiseResult.replacements.limit(evaluationContext.resultsLimit);
+}
+
+// Atoms to generate are generated by the conjunction, and atoms without variables have no replacements to join
+bool ImplicationExpressionNode::getPremiseAtoms(
+    LogicEvaluationContext const & evaluationContext,
+    std::vector<TemplateExpressionNode const *> & atoms) const
+{
+  LogicExpressionNode const * premise = operands[0].get();
+  std::vector<LogicExpressionNode const *> premiseOperands;
+  if (auto const * conjunction = dynamic_cast<ConjunctionExpressionNode const *>(premise))
+  {
+    for (std::shared_ptr<LogicExpressionNode> const & operand : conjunction->getOperands())
+      premiseOperands.push_back(operand.get());
+  }
+  else
+    premiseOperands.push_back(premise);
+
+  for (LogicExpressionNode const * operand : premiseOperands)
+  {
+    auto const * atom = dynamic_cast<TemplateExpressionNode const *>(operand);
+    if (!atom)
+      return false;
+    std::shared_ptr<FormulaMetadata const> const metadata = atom->getMetadata(evaluationContext);
+    if (metadata->isFormulaToGenerate || metadata->variables.empty())
+      return false;
+    atoms.push_back(atom);
+  }
+  return !atoms.empty();
+}
+
+// Atoms are searched without template params of arguments, and all new replacements are found, so the premise is not
+// computed by new elements if arguments are set or only first replacements are searched
+bool ImplicationExpressionNode::canComputePremiseDelta(LogicEvaluationContext const & evaluationContext) const
+{
+  if (!evaluationContext.argumentVector.empty() ||
+      evaluationContext.templateSearcher->getReplacementsUsingType() == REPLACEMENTS_FIRST)
+    return false;
+  std::vector<TemplateExpressionNode const *> atoms;
+  return getPremiseAtoms(evaluationContext, atoms);
+}
+
+bool ImplicationExpressionNode::computePremiseDelta(
+    LogicEvaluationContext & evaluationContext,
+    ScAddrVector const & newElements,
+    LogicFormulaResult & premiseResult) const
+{
+  std::vector<TemplateExpressionNode const *> atoms;
+  if (!canComputePremiseDelta(evaluationContext) || !getPremiseAtoms(evaluationContext, atoms))
+    return false;
+
+  ScAddrVector newArcs;
+  ScAddrUnorderedSet newArcsSet;
+  TemplateExpressionNode::selectArcs(evaluationContext.context, newElements, newArcs, newArcsSet);
+  ResultsLimitScope const atomsLimitScope(evaluationContext, 0);
+  Replacements premiseReplacements;
+  for (size_t atomIndex = 0; atomIndex < atoms.size() && !newArcs.empty(); ++atomIndex)
+  {
+    Replacements atomDelta;
+    atoms[atomIndex]->findDelta(evaluationContext, newArcs, newArcsSet, atomDelta);
+    if (atomDelta.empty())
+      continue;
+    FactorizedReplacements replacements(std::move(atomDelta));
+    for (size_t otherAtomIndex = 0; otherAtomIndex < atoms.size() && !replacements.empty(); ++otherAtomIndex)
+    {
+      if (otherAtomIndex == atomIndex)
+        continue;
+      LogicFormulaResult const otherAtomResult = atoms[otherAtomIndex]->find(evaluationContext, replacements);
+      if (!otherAtomResult.value)
+        replacements = {};
+      else
+        replacements.narrowWith(otherAtomResult.replacements);
+    }
+    if (!replacements.empty())
+      ReplacementsUtils::uniteReplacements(premiseReplacements, replacements.materialize(), premiseReplacements);
+  }
+  premiseResult.replacements = FactorizedReplacements(std::move(premiseReplacements));
+  premiseResult.value = !premiseResult.replacements.empty();
+  premiseResult.isGenerated = false;
+  return true;
+}
+
+void ImplicationExpressionNode::generateConclusion(
+    LogicEvaluationContext & evaluationContext,
+    LogicFormulaResult & premiseResult,
+    LogicFormulaResult & result) const
+{
+  LogicExpressionNode const * conclusionAtom = operands[1].get();
 
   // Generate conclusion using computed premise replacements
   LogicFormulaResult conclusionResult;
-  conclusionAtom->generate(premiseResult.replacements, conclusionResult);
+  conclusionAtom->generate(evaluationContext, premiseResult.replacements, conclusionResult);
 
   // Implication value (a -> b) is equal to ((!a) || b)
   result.value = !premiseResult.value || conclusionResult.value;
   result.isGenerated = conclusionResult.isGenerated;
   if (conclusionResult.value)
-    ReplacementsUtils::intersectReplacements(
-        premiseResult.replacements, conclusionResult.replacements, result.replacements);
+  {
+    premiseResult.replacements.narrowWith(conclusionResult.replacements);
+    result.replacements = std::move(premiseResult.replacements);
+  }
 }
 
-void ImplicationExpressionNode::generate(Replacements & replacements, LogicFormulaResult & result)
+void ImplicationExpressionNode::generate(
+    LogicEvaluationContext & evaluationContext,
+    FactorizedReplacements & replacements,
+    LogicFormulaResult & result) const
 {
   result = {false, false, {}};
 }
@@ -13,14 +13,53 @@ using namespace inference;
 class ImplicationExpressionNode : public OperatorLogicExpressionNode
 {
 public:
-  explicit ImplicationExpressionNode(ScMemoryContext * context, OperandsVector & operands);
+  explicit ImplicationExpressionNode(OperandsVector & operands);
 
-  void compute(LogicFormulaResult & result) const override;
+  void compute(LogicEvaluationContext & evaluationContext, LogicFormulaResult & result) const override;
 
-  void generate(Replacements & replacements, LogicFormulaResult & result) override;
+  /// Compute the premise, its replacements are limited by the results limit of the evaluation context
+  void computePremise(LogicEvaluationContext & evaluationContext, LogicFormulaResult & premiseResult) const;
 
-  ScAddr getFormula() const override;
+  /**
+   * @brief Collect atoms of the premise if it is an atom or a conjunction of atoms
+   * @returns false if the premise has other operands, atoms to generate or atoms without variables
+   */
+  bool getPremiseAtoms(
+      LogicEvaluationContext const & evaluationContext,
+      std::vector<TemplateExpressionNode const *> & atoms) const;
+
+  /// Check if the premise may be computed by `computePremiseDelta` with the evaluation context
+  bool canComputePremiseDelta(LogicEvaluationContext const & evaluationContext) const;
+
+  /**
+   * @brief Compute only premise replacements that contain new arcs. Replacements of each premise atom with new arcs
+   * are joined with all replacements of other atoms, so a premise replacement is found if it has a new arc in any of
+   * its atoms, and replacements found before the arcs were generated are not found again
+   * @param newElements elements generated or added to the output structure since the premise was computed before,
+   * elements that are not arcs are skipped
+   * @param premiseResult out param, its replacements are not limited by the results limit of the evaluation context
+   * @returns false if the premise can't be computed by new elements, see `canComputePremiseDelta`
+   */
+  bool computePremiseDelta(
+      LogicEvaluationContext & evaluationContext,
+      ScAddrVector const & newElements,
+      LogicFormulaResult & premiseResult) const;
 
-private:
-  ScMemoryContext * context;
+  /**
+   * @brief Generate the conclusion by replacements of the computed premise, so `compute` is `computePremise` followed
+   * by `generateConclusion`. The premise may be computed with another evaluation context
+   * @param premiseResult result of `computePremise`, its replacements are narrowed by the conclusion
+   * @param result out param, result of the implication
+   */
+  void generateConclusion(
+      LogicEvaluationContext & evaluationContext,
+      LogicFormulaResult & premiseResult,
+      LogicFormulaResult & result) const;
+
+  void generate(
+      LogicEvaluationContext & evaluationContext,
+      FactorizedReplacements & replacements,
+      LogicFormulaResult & result) const override;
+
+  ScAddr getFormula() const override;
 };
@@ -18,21 +18,16 @@
 
 LogicExpression::LogicExpression(
     ScMemoryContext * context,
-    std::shared_ptr<TemplateSearcherAbstract> templateSearcher,
-    std::shared_ptr<TemplateManagerAbstract> templateManager,
-    std::shared_ptr<SolutionTreeManagerAbstract> solutionTreeManager,
-    ScAddr const & outputStructure)
+    std::shared_ptr<FormulaMetadataCache> formulaMetadataCache)
   : context(context)
-  , templateSearcher(std::move(templateSearcher))
-  , templateManager(std::move(templateManager))
-  , solutionTreeManager(std::move(solutionTreeManager))
-  , outputStructure(outputStructure)
+  , formulaMetadataCache(std::move(formulaMetadataCache))
 {
 }
 
 std::shared_ptr<LogicExpressionNode> LogicExpression::build(ScAddr const & formula)
 {
-  int formulaType = FormulaClassifier::typeOfFormula(context, formula);
+  builtFormulas.push_back(formula);
+  int formulaType = formulaMetadataCache->getMetadata(formula)->type;
   switch (formulaType)
   {
   case FormulaClassifier::ATOMIC:
@@ -117,17 +112,12 @@ OperatorLogicExpressionNode::OperandsVector LogicExpression::resolveOperandsForI
 std::shared_ptr<LogicExpressionNode> LogicExpression::buildAtomicFormula(ScAddr const & formula)
 {
   SC_LOG_DEBUG(context->GetElementSystemIdentifier(formula) << " is atomic logical formula");
-  if (!templateManager->getArguments().empty())
-  {
-    std::vector<ScTemplateParams> params = templateManager->createTemplateParams(formula);
-    if (!params.empty() && paramsSet.empty())
-    {
-      paramsSet = std::move(params);
-    }
-  }
+  return std::make_shared<TemplateExpressionNode>(formula);
+}
 
-  return std::make_shared<TemplateExpressionNode>(
-      context, templateSearcher, templateManager, solutionTreeManager, outputStructure, formula);
+ScAddrVector const & LogicExpression::getBuiltFormulas() const
+{
+  return builtFormulas;
 }
 
 std::shared_ptr<LogicExpressionNode> LogicExpression::buildConjunctionFormula(ScAddr const & formula)
@@ -135,7 +125,7 @@ std::shared_ptr<LogicExpressionNode> LogicExpression::buildConjunctionFormula(Sc
   SC_LOG_DEBUG(context->GetElementSystemIdentifier(formula) << " is a conjunction tuple");
   OperatorLogicExpressionNode::OperandsVector operands = resolveTupleOperands(formula);
   if (!operands.empty())
-    return std::make_unique<ConjunctionExpressionNode>(context, operands);
+    return std::make_unique<ConjunctionExpressionNode>(operands);
   else
     SC_THROW_EXCEPTION(utils::ExceptionItemNotFound, "Conjunction must have operands");
 }
@@ -145,7 +135,7 @@ std::shared_ptr<LogicExpressionNode> LogicExpression::buildDisjunctionFormula(Sc
   SC_LOG_DEBUG(context->GetElementSystemIdentifier(formula) << " is a disjunction tuple");
   OperatorLogicExpressionNode::OperandsVector operands = resolveTupleOperands(formula);
   if (!operands.empty())
-    return std::make_unique<DisjunctionExpressionNode>(context, operands);
+    return std::make_unique<DisjunctionExpressionNode>(operands);
   else
     SC_THROW_EXCEPTION(utils::ExceptionItemNotFound, "Disjunction must have operands");
 }
@@ -166,7 +156,7 @@ std::shared_ptr<LogicExpressionNode> LogicExpression::buildImplicationEdgeFormul
   SC_LOG_DEBUG(context->GetElementSystemIdentifier(formula) << " is an implication edge");
   OperatorLogicExpressionNode::OperandsVector operands = resolveEdgeOperands(formula);
   if (operands.size() == 2)
-    return std::make_unique<ImplicationExpressionNode>(context, operands);
+    return std::make_unique<ImplicationExpressionNode>(operands);
   else
     SC_THROW_EXCEPTION(
         utils::ExceptionItemNotFound,
@@ -178,7 +168,7 @@ std::shared_ptr<LogicExpressionNode> LogicExpression::buildImplicationTupleFormu
   SC_LOG_DEBUG(context->GetElementSystemIdentifier(formula) << " is an implication tuple");
   OperatorLogicExpressionNode::OperandsVector operands = resolveOperandsForImplicationTuple(formula);
   if (operands.size() == 2)
-    return std::make_unique<ImplicationExpressionNode>(context, operands);
+    return std::make_unique<ImplicationExpressionNode>(operands);
   else
     SC_THROW_EXCEPTION(
         utils::ExceptionItemNotFound,
@@ -190,7 +180,7 @@ std::shared_ptr<LogicExpressionNode> LogicExpression::buildEquivalenceEdgeFormul
   SC_LOG_DEBUG(context->GetElementSystemIdentifier(formula) << " is an equivalence edge");
   OperatorLogicExpressionNode::OperandsVector operands = resolveEdgeOperands(formula);
   if (operands.size() == 2)
-    return std::make_unique<EquivalenceExpressionNode>(context, operands);
+    return std::make_unique<EquivalenceExpressionNode>(operands);
   else
     SC_THROW_EXCEPTION(
         utils::ExceptionItemNotFound,
@@ -202,7 +192,7 @@ std::shared_ptr<LogicExpressionNode> LogicExpression::buildEquivalenceTupleFormu
   SC_LOG_DEBUG(context->GetElementSystemIdentifier(formula) << " is an equivalence tuple");
   OperatorLogicExpressionNode::OperandsVector operands = resolveTupleOperands(formula);
   if (operands.size() == 2)
-    return std::make_unique<EquivalenceExpressionNode>(context, operands);
+    return std::make_unique<EquivalenceExpressionNode>(operands);
   else
     SC_THROW_EXCEPTION(
         utils::ExceptionItemNotFound,
@@ -28,12 +28,7 @@ using namespace inference;
 class LogicExpression
 {
 public:
-  LogicExpression(
-      ScMemoryContext * context,
-      std::shared_ptr<TemplateSearcherAbstract> templateSearcher,
-      std::shared_ptr<TemplateManagerAbstract> templateManager,
-      std::shared_ptr<SolutionTreeManagerAbstract> solutionTreeManager,
-      ScAddr const & outputStructure);
+  LogicExpression(ScMemoryContext * context, std::shared_ptr<FormulaMetadataCache> formulaMetadataCache);
 
   std::shared_ptr<LogicExpressionNode> build(ScAddr const & formula);
 
@@ -50,13 +45,11 @@ public:
   OperatorLogicExpressionNode::OperandsVector resolveEdgeOperands(ScAddr const & edge);
   OperatorLogicExpressionNode::OperandsVector resolveOperandsForImplicationTuple(ScAddr const & tuple);
 
+  /// Formulas and sub formulas the built expression trees consist of
+  ScAddrVector const & getBuiltFormulas() const;
+
 private:
   ScMemoryContext * context;
-  std::vector<ScTemplateParams> paramsSet;
-
-  std::shared_ptr<TemplateSearcherAbstract> templateSearcher;
-  std::shared_ptr<TemplateManagerAbstract> templateManager;
-  std::shared_ptr<SolutionTreeManagerAbstract> solutionTreeManager;
-
-  ScAddr outputStructure;
+  std::shared_ptr<FormulaMetadataCache> formulaMetadataCache;
+  ScAddrVector builtFormulas;
 };
@@ -6,42 +6,89 @@
 
 #pragma once
 
+#include "manager/templateManager/TemplateManagerAbstract.hpp"
+#include "searcher/templateSearcher/TemplateSearcherAbstract.hpp"
+
+#include "utils/FactorizedReplacements.hpp"
 #include "utils/Types.hpp"
 
 namespace inference
 {
+class ConjunctionPlanner;
+class ThreadPool;
 
 struct LogicFormulaResult
 {
   bool value = false;
   bool isGenerated = false;
-  Replacements replacements{};
+  FactorizedReplacements replacements{};
 };
 
-class LogicExpressionNode
+/// State of one formula usage, it is passed to nodes so compiled expression trees are shared between usages
+struct LogicEvaluationContext
 {
-public:
-  LogicExpressionNode() = default;
-
-  virtual void compute(LogicFormulaResult & result) const = 0;
-  virtual ScAddr getFormula() const = 0;
-  virtual ~LogicExpressionNode() = default;
-
-  virtual void generate(Replacements & replacements, LogicFormulaResult & result) = 0;
+  ScMemoryContext * context = nullptr;
+  std::shared_ptr<TemplateSearcherAbstract> templateSearcher;
+  /// Searcher in the whole knowledge base with the settings of `templateSearcher`
+  std::shared_ptr<TemplateSearcherAbstract> templateSearcherGeneral;
+  std::shared_ptr<TemplateManagerAbstract> templateManager;
+  ScAddr outputStructure;
+  ScAddrVector argumentVector;
+  std::unordered_set<ScAddr, ScAddrHashFunc> outputStructureElements;
+  /// Planner of conjunctions operands order, operands are computed in the formula order if it is not set
+  std::shared_ptr<ConjunctionPlanner> conjunctionPlanner;
+  /**
+   * Amount of replacements that is enough for the result of the computed node, all of them are needed if it is 0.
+   * A node may return more replacements, and it returns less of them only if there are no more
+   */
+  size_t resultsLimit = 0;
+  /// Pool to search atoms of conjunctions and disjunctions concurrently, operands are computed one by one without it
+  std::shared_ptr<ThreadPool> operandsThreadPool;
+  /**
+   * Elements of constructions generated or added to the output structure while the formula is used, managers find
+   * rules affected by them
+   */
+  ScAddrVector generatedElements;
+};
 
-  void setArgumentVector(ScAddrVector const & otherArgumentVector)
+/// Set results limit of the evaluation context while an operand is computed, the previous limit is restored after
+class ResultsLimitScope
+{
+public:
+  ResultsLimitScope(LogicEvaluationContext & evaluationContext, size_t resultsLimit)
+    : evaluationContext(evaluationContext)
+    , previousResultsLimit(evaluationContext.resultsLimit)
   {
-    argumentVector = otherArgumentVector;
+    evaluationContext.resultsLimit = resultsLimit;
   }
 
-  void setOutputStructureElements(std::unordered_set<ScAddr, ScAddrHashFunc> const & otherOutputStructureElements)
+  ~ResultsLimitScope()
   {
-    outputStructureElements = otherOutputStructureElements;
+    evaluationContext.resultsLimit = previousResultsLimit;
   }
 
-protected:
-  ScAddrVector argumentVector;
-  std::unordered_set<ScAddr, ScAddrHashFunc> outputStructureElements;
+  ResultsLimitScope(ResultsLimitScope const & other) = delete;
+  ResultsLimitScope & operator=(ResultsLimitScope const & other) = delete;
+
+private:
+  LogicEvaluationContext & evaluationContext;
+  size_t previousResultsLimit;
+};
+
+/// Node of a compiled logic expression tree, it is immutable and keeps no state of formula usage
+class LogicExpressionNode
+{
+public:
+  LogicExpressionNode() = default;
+
+  virtual void compute(LogicEvaluationContext & evaluationContext, LogicFormulaResult & result) const = 0;
+  virtual ScAddr getFormula() const = 0;
+  virtual ~LogicExpressionNode() = default;
+
+  virtual void generate(
+      LogicEvaluationContext & evaluationContext,
+      FactorizedReplacements & replacements,
+      LogicFormulaResult & result) const = 0;
 };
 
 class OperatorLogicExpressionNode : public LogicExpressionNode
@@ -49,6 +96,11 @@ class OperatorLogicExpressionNode : public LogicExpressionNode
 public:
   using OperandsVector = std::vector<std::shared_ptr<LogicExpressionNode>>;
 
+  OperandsVector const & getOperands() const
+  {
+    return operands;
+  }
+
 protected:
   OperandsVector operands;
 };
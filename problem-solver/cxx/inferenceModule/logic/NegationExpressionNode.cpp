@@ -11,14 +11,22 @@ NegationExpressionNode::NegationExpressionNode(std::shared_ptr<LogicExpressionNo
   operands.emplace_back(std::move(operand));
 }
 
-void NegationExpressionNode::compute(LogicFormulaResult & result) const
+void NegationExpressionNode::compute(LogicEvaluationContext & evaluationContext, LogicFormulaResult & result) const
 {
-  operands[0]->compute(result);
+  // Operand of negation is computed without formula arguments and with all its replacements
+  ResultsLimitScope const resultsLimitScope(evaluationContext, 0);
+  ScAddrVector argumentVector;
+  argumentVector.swap(evaluationContext.argumentVector);
+  operands[0]->compute(evaluationContext, result);
+  argumentVector.swap(evaluationContext.argumentVector);
   SC_LOG_DEBUG("Sub formula in negation returned " << (result.value ? "true" : "false"));
   result.value = !result.value;
 }
 
-void NegationExpressionNode::generate(Replacements & replacements, LogicFormulaResult & result)
+void NegationExpressionNode::generate(
+    LogicEvaluationContext & evaluationContext,
+    FactorizedReplacements & replacements,
+    LogicFormulaResult & result) const
 {
   result = {false, false, {}};
 }
@@ -15,9 +15,12 @@ class NegationExpressionNode : public OperatorLogicExpressionNode
 public:
   explicit NegationExpressionNode(std::shared_ptr<LogicExpressionNode> operand);
 
-  void compute(LogicFormulaResult & result) const override;
+  void compute(LogicEvaluationContext & evaluationContext, LogicFormulaResult & result) const override;
 
-  void generate(Replacements & replacements, LogicFormulaResult & result) override;
+  void generate(
+      LogicEvaluationContext & evaluationContext,
+      FactorizedReplacements & replacements,
+      LogicFormulaResult & result) const override;
 
   ScAddr getFormula() const override;
 };
@@ -0,0 +1,93 @@
+/*
+ * This source file is part of an OSTIS project. For the latest info, see http://ostis.net
+ * Distributed under the MIT License
+ * (See accompanying file COPYING.MIT or copy at http://opensource.org/licenses/MIT)
+ */
+
+#include "PremisesIndex.hpp"
+
+#include "ImplicationExpressionNode.hpp"
+#include "TemplateExpressionNode.hpp"
+
+namespace inference
+{
+void PremisesIndex::addFormula(
+    FormulaMetadataCache & formulaMetadataCache,
+    size_t formulaIndex,
+    LogicExpressionNode const & expressionRoot)
+{
+  LogicExpressionNode const * premise = &expressionRoot;
+  if (auto const * implication = dynamic_cast<ImplicationExpressionNode const *>(&expressionRoot))
+    premise = implication->getOperands()[0].get();
+
+  bool isUnbound = false;
+  addAtoms(formulaMetadataCache, formulaIndex, *premise, isUnbound);
+  if (isUnbound)
+    unboundFormulas.push_back(formulaIndex);
+  ++formulasAmount;
+}
+
+void PremisesIndex::findAffectedFormulas(
+    ScMemoryContext * context,
+    ScAddrVector const & elements,
+    std::set<size_t> & formulasIndices) const
+{
+  formulasIndices.insert(unboundFormulas.cbegin(), unboundFormulas.cend());
+  if (formulasByConstants.empty())
+    return;
+
+  ScAddrUnorderedSet checkedElements;
+  for (ScAddr const & element : elements)
+  {
+    if (!checkedElements.insert(element).second || !context->GetElementType(element).IsEdge())
+      continue;
+    auto const [source, target] = context->GetConnectorIncidentElements(element);
+    for (ScAddr const & incidentElement : {source, target})
+    {
+      auto const & formulasIterator = formulasByConstants.find(incidentElement);
+      if (formulasIterator != formulasByConstants.cend())
+        formulasIndices.insert(formulasIterator->second.cbegin(), formulasIterator->second.cend());
+    }
+  }
+}
+
+size_t PremisesIndex::getFormulasAmount() const
+{
+  return formulasAmount;
+}
+
+void PremisesIndex::addAtoms(
+    FormulaMetadataCache & formulaMetadataCache,
+    size_t formulaIndex,
+    LogicExpressionNode const & expression,
+    bool & isUnbound)
+{
+  if (auto const * atom = dynamic_cast<TemplateExpressionNode const *>(&expression))
+  {
+    std::shared_ptr<FormulaMetadata const> const metadata = formulaMetadataCache.getMetadata(atom->getFormula());
+    for (std::array<FormulaMetadata::TemplateItem, 3> const & triple : metadata->triples)
+    {
+      // Constants have no name in the compiled triples
+      bool isTripleBound = false;
+      for (FormulaMetadata::TemplateItem const * item : {&triple[0], &triple[2]})
+      {
+        if (!item->name.empty())
+          continue;
+        isTripleBound = true;
+        std::vector<size_t> & formulas = formulasByConstants[item->addr];
+        if (formulas.empty() || formulas.back() != formulaIndex)
+          formulas.push_back(formulaIndex);
+      }
+      isUnbound |= !isTripleBound;
+    }
+    return;
+  }
+
+  if (auto const * operatorExpression = dynamic_cast<OperatorLogicExpressionNode const *>(&expression))
+  {
+    for (std::shared_ptr<LogicExpressionNode> const & operand : operatorExpression->getOperands())
+      addAtoms(formulaMetadataCache, formulaIndex, *operand, isUnbound);
+  }
+}
+
+}  // namespace inference
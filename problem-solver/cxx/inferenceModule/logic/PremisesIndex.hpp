@@ -0,0 +1,68 @@
+/*
+ * This source file is part of an OSTIS project. For the latest info, see http://ostis.net
+ * Distributed under the MIT License
+ * (See accompanying file COPYING.MIT or copy at http://opensource.org/licenses/MIT)
+ */
+
+#pragma once
+
+#include <set>
+#include <unordered_map>
+#include <vector>
+
+#include <sc-memory/sc_memory.hpp>
+
+#include "searcher/templateSearcher/FormulaMetadataCache.hpp"
+
+#include "LogicExpressionNode.hpp"
+
+namespace inference
+{
+/**
+ * Formulas keyed by constant sources and targets of triples of their premises. A triple of a premise may match a
+ * generated arc only if its constant source or target is the source or target of the arc, so after a generation only
+ * formulas found by the generated arcs are used again. Triples without constant source and target may match any arc,
+ * formulas with such triples are always found. Premise of an implication is its first operand, other formulas are
+ * premises as a whole. Atoms under negations are indexed too, so found formulas are a superset of affected ones.
+ */
+class PremisesIndex
+{
+public:
+  /**
+   * @brief Index triples of atoms of the formula premise
+   * @param formulaMetadataCache metadata of atomic formulas with their compiled triples
+   * @param formulaIndex identifier of the formula in results of `findAffectedFormulas`
+   * @param expressionRoot root of expression tree of the formula
+   */
+  void addFormula(
+      FormulaMetadataCache & formulaMetadataCache,
+      size_t formulaIndex,
+      LogicExpressionNode const & expressionRoot);
+
+  /**
+   * @brief Find formulas whose premises may match arcs among the elements
+   * @param context context to read the elements with
+   * @param elements generated elements, elements that are not arcs are skipped
+   * @param formulasIndices out param, indices of found formulas are added here
+   */
+  void findAffectedFormulas(
+      ScMemoryContext * context,
+      ScAddrVector const & elements,
+      std::set<size_t> & formulasIndices) const;
+
+  size_t getFormulasAmount() const;
+
+private:
+  std::unordered_map<ScAddr, std::vector<size_t>, ScAddrHashFunc> formulasByConstants;
+  /// Formulas with triples that may match any arc
+  std::vector<size_t> unboundFormulas;
+  size_t formulasAmount = 0;
+
+  void addAtoms(
+      FormulaMetadataCache & formulaMetadataCache,
+      size_t formulaIndex,
+      LogicExpressionNode const & expression,
+      bool & isUnbound);
+};
+
+}  // namespace inference
@@ -0,0 +1,200 @@
+/*
+ * This source file is part of an OSTIS project. For the latest info, see http://ostis.net
+ * Distributed under the MIT License
+ * (See accompanying file COPYING.MIT or copy at http://opensource.org/licenses/MIT)
+ */
+
+#include "ReteNetwork.hpp"
+
+#include <numeric>
+
+#include "ConjunctionPlanner.hpp"
+#include "ImplicationExpressionNode.hpp"
+#include "TemplateExpressionNode.hpp"
+
+#include "utils/ReplacementsUtils.hpp"
+
+namespace inference
+{
+bool ReteNetwork::addRule(
+    LogicEvaluationContext const & evaluationContext,
+    size_t ruleIndex,
+    std::shared_ptr<LogicExpressionNode const> const & expressionRoot)
+{
+  auto const * implication = dynamic_cast<ImplicationExpressionNode const *>(expressionRoot.get());
+  std::vector<TemplateExpressionNode const *> atoms;
+  if (!implication || !implication->getPremiseAtoms(evaluationContext, atoms))
+    return false;
+
+  // Atoms are joined in order of amounts of their replacements, so the first beta memories are the smallest
+  std::vector<ConjunctionPlanner::Step> steps(atoms.size());
+  for (size_t atomIndex = 0; atomIndex < atoms.size(); ++atomIndex)
+  {
+    size_t const alphaMemoryIndex = getAlphaMemory(evaluationContext, expressionRoot, *atoms[atomIndex]);
+    steps[atomIndex].operandIndex = alphaMemoryIndex;
+    steps[atomIndex].estimatedCardinality = alphaMemories[alphaMemoryIndex].replacements.getColumnsAmount();
+  }
+  ConjunctionPlanner::order(steps);
+
+  RuleNode & rule = rules[ruleIndex];
+  rule.betaMemories.resize(steps.size());
+  for (size_t position = 0; position < steps.size(); ++position)
+  {
+    size_t const alphaMemoryIndex = steps[position].operandIndex;
+    rule.alphaMemoriesIndices.push_back(alphaMemoryIndex);
+    alphaMemoriesUsages[alphaMemoryIndex].emplace_back(ruleIndex, position);
+    Replacements const & alphaReplacements = alphaMemories[alphaMemoryIndex].replacements;
+    if (position == 0)
+      rule.betaMemories[position] = alphaReplacements;
+    else
+      join(rule.betaMemories[position - 1], alphaReplacements, rule.betaMemories[position]);
+  }
+  rule.activation = rule.betaMemories.back();
+  return true;
+}
+
+void ReteNetwork::update(
+    LogicEvaluationContext const & evaluationContext,
+    ScAddrVector const & generatedElements,
+    std::set<size_t> & activatedRules)
+{
+  ScAddrVector generatedArcs;
+  ScAddrUnorderedSet generatedArcsSet;
+  TemplateExpressionNode::selectArcs(evaluationContext.context, generatedElements, generatedArcs, generatedArcsSet);
+  if (generatedArcs.empty())
+    return;
+
+  for (size_t alphaMemoryIndex = 0; alphaMemoryIndex < alphaMemories.size(); ++alphaMemoryIndex)
+  {
+    AlphaMemory & alphaMemory = alphaMemories[alphaMemoryIndex];
+    Replacements foundReplacements;
+    statistics.deltaSearchesAmount +=
+        alphaMemory.atom->findDelta(evaluationContext, generatedArcs, generatedArcsSet, foundReplacements);
+    if (foundReplacements.empty())
+      continue;
+    Replacements delta;
+    ReplacementsUtils::subtractReplacements(foundReplacements, alphaMemory.replacements, delta);
+    if (delta.empty())
+      continue;
+
+    // The alpha memory is extended after the delta is propagated to all positions of the atom, so the delta is joined
+    // with the old replacements of the atom where it is used several times in one premise
+    for (auto const & [ruleIndex, position] : alphaMemoriesUsages[alphaMemoryIndex])
+    {
+      propagate(ruleIndex, position, delta);
+      if (!rules.at(ruleIndex).activation.empty())
+        activatedRules.insert(ruleIndex);
+    }
+    ReplacementsUtils::uniteReplacements(alphaMemory.replacements, delta, alphaMemory.replacements);
+  }
+}
+
+// Activation has no duplicate columns, so its first columns are the distinct replacements the limit keeps
+bool ReteNetwork::takeActivation(size_t ruleIndex, size_t columnsLimit, Replacements & premiseReplacements)
+{
+  auto const & ruleIterator = rules.find(ruleIndex);
+  if (ruleIterator == rules.cend() || ruleIterator->second.activation.empty())
+    return false;
+  Replacements & activation = ruleIterator->second.activation;
+  size_t const columnsAmount = activation.getColumnsAmount();
+  if (columnsLimit == 0 || columnsAmount <= columnsLimit)
+  {
+    premiseReplacements = std::move(activation);
+    activation = Replacements();
+  }
+  else
+  {
+    premiseReplacements = Replacements(activation.getKeys());
+    premiseReplacements.reserve(columnsLimit);
+    for (size_t columnIndex = 0; columnIndex < columnsLimit; ++columnIndex)
+      premiseReplacements.addColumn(activation.getColumn(columnIndex));
+    std::vector<size_t> restColumns(columnsAmount - columnsLimit);
+    std::iota(restColumns.begin(), restColumns.end(), columnsLimit);
+    activation.keepColumns(restColumns);
+  }
+  statistics.activatedReplacementsAmount += premiseReplacements.getColumnsAmount();
+  return true;
+}
+
+bool ReteNetwork::hasActivation(size_t ruleIndex) const
+{
+  auto const & ruleIterator = rules.find(ruleIndex);
+  return ruleIterator != rules.cend() && !ruleIterator->second.activation.empty();
+}
+
+ReteNetwork::Statistics ReteNetwork::getStatistics() const
+{
+  Statistics networkStatistics = statistics;
+  networkStatistics.rulesAmount = rules.size();
+  networkStatistics.alphaMemoriesAmount = alphaMemories.size();
+  return networkStatistics;
+}
+
+size_t ReteNetwork::getAlphaMemory(
+    LogicEvaluationContext const & evaluationContext,
+    std::shared_ptr<LogicExpressionNode const> const & expressionRoot,
+    TemplateExpressionNode const & atom)
+{
+  auto const & [alphaMemoryIterator, isCreated] = alphaMemoriesIndices.emplace(atom.getFormula(), alphaMemories.size());
+  if (isCreated)
+  {
+    AlphaMemory & alphaMemory = alphaMemories.emplace_back();
+    // The pointer to the atom owns the whole tree, the tree may be erased from the cache of compiled rules
+    alphaMemory.atom = std::shared_ptr<TemplateExpressionNode const>(expressionRoot, &atom);
+    atom.findAll(evaluationContext, ScTemplateParams(), alphaMemory.replacements);
+    alphaMemoriesUsages.emplace_back();
+  }
+  return alphaMemoryIterator->second;
+}
+
+/**
+ * Delta of the k-th beta memory is the delta of the previous beta memory joined with the k-th alpha memory, and the
+ * delta of the alpha memory at the position is joined with the previous beta memory. Only columns that are not in a
+ * beta memory are passed further, the delta of the last beta memory is added to the rule activation
+ */
+void ReteNetwork::propagate(size_t ruleIndex, size_t position, Replacements const & alphaDelta)
+{
+  RuleNode & rule = rules.at(ruleIndex);
+  Replacements delta;
+  if (position == 0)
+    delta = alphaDelta;
+  else
+    join(rule.betaMemories[position - 1], alphaDelta, delta);
+
+  for (size_t betaPosition = position; betaPosition < rule.betaMemories.size(); ++betaPosition)
+  {
+    if (betaPosition != position)
+    {
+      Replacements nextDelta;
+      join(delta, alphaMemories[rule.alphaMemoriesIndices[betaPosition]].replacements, nextDelta);
+      delta = std::move(nextDelta);
+    }
+    addNewColumns(rule.betaMemories[betaPosition], delta);
+    if (delta.empty())
+      return;
+  }
+  ReplacementsUtils::uniteReplacements(rule.activation, delta, rule.activation);
+}
+
+void ReteNetwork::join(Replacements const & first, Replacements const & second, Replacements & result)
+{
+  if (first.empty() || second.empty())
+  {
+    result = Replacements();
+    return;
+  }
+  ReplacementsUtils::intersectReplacements(first, second, result);
+}
+
+void ReteNetwork::addNewColumns(Replacements & memory, Replacements & delta)
+{
+  if (delta.empty())
+    return;
+  Replacements newColumns;
+  ReplacementsUtils::subtractReplacements(delta, memory, newColumns);
+  delta = std::move(newColumns);
+  if (!delta.empty())
+    ReplacementsUtils::uniteReplacements(memory, delta, memory);
+}
+
+}  // namespace inference
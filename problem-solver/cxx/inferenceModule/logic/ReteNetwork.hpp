@@ -0,0 +1,121 @@
+/*
+ * This source file is part of an OSTIS project. For the latest info, see http://ostis.net
+ * Distributed under the MIT License
+ * (See accompanying file COPYING.MIT or copy at http://opensource.org/licenses/MIT)
+ */
+
+#pragma once
+
+#include <memory>
+#include <set>
+#include <unordered_map>
+#include <vector>
+
+#include <sc-memory/sc_memory.hpp>
+
+#include "utils/Replacements.hpp"
+
+#include "LogicExpressionNode.hpp"
+
+class TemplateExpressionNode;
+
+namespace inference
+{
+/**
+ * Incremental match network of rules premises. Each atomic formula of premises is an alpha memory with all its
+ * replacements, alpha memories are shared by rules with the same atoms. Premise of a rule is a chain of beta memories,
+ * the k-th of them keeps the join of the first k + 1 atoms of the premise. Memories are kept between firings: when
+ * arcs are generated only replacements of atoms containing these arcs are searched, and this delta is joined through
+ * the beta chains. So each rule is activated only by premise replacements that were not passed to it before, and the
+ * work after a generation depends on the generated arcs instead of the size of the knowledge base.
+ *
+ * Memories are allocated out of the replacements arena, so the network must not be used in an arena scope.
+ */
+class ReteNetwork
+{
+public:
+  struct Statistics
+  {
+    size_t rulesAmount = 0;
+    size_t alphaMemoriesAmount = 0;
+    /// Amount of atoms searched with source and target of a generated arc
+    size_t deltaSearchesAmount = 0;
+    /// Amount of premise replacements passed to rules
+    size_t activatedReplacementsAmount = 0;
+  };
+
+  /**
+   * @brief Add the rule to the network if its premise is an atom or a conjunction of atoms with variables. Memories of
+   * its atoms are filled when they are created, all replacements of the premise become the first activation of the rule
+   * @param evaluationContext usage state of the rule, its searcher and context are used to search atoms
+   * @param ruleIndex identifier of the rule in activations
+   * @param expressionRoot root of expression tree of the rule, alpha memories of its atoms share ownership of it
+   * @returns false if the rule is not an implication or its premise can't be compiled to the network
+   */
+  bool addRule(
+      LogicEvaluationContext const & evaluationContext,
+      size_t ruleIndex,
+      std::shared_ptr<LogicExpressionNode const> const & expressionRoot);
+
+  /**
+   * @brief Search replacements of atoms with the generated arcs and join them with memories of other atoms
+   * @param evaluationContext usage state with the searcher the rules were added with
+   * @param generatedElements elements generated or added to the output structure since the previous update, elements
+   * that are not arcs are skipped
+   * @param activatedRules out param, indices of rules that got new premise replacements are added here
+   */
+  void update(
+      LogicEvaluationContext const & evaluationContext,
+      ScAddrVector const & generatedElements,
+      std::set<size_t> & activatedRules);
+
+  /**
+   * @brief Take premise replacements of the rule that were not taken before
+   * @param columnsLimit amount of replacements to take, the rest of them are taken next time. All of them are taken if
+   * it is 0
+   * @param premiseReplacements out param, new replacements of the premise will be placed here
+   * @returns false if the rule has no new replacements or it is not in the network
+   */
+  bool takeActivation(size_t ruleIndex, size_t columnsLimit, Replacements & premiseReplacements);
+  /// Check if the rule has premise replacements that were not taken yet
+  bool hasActivation(size_t ruleIndex) const;
+
+  Statistics getStatistics() const;
+
+private:
+  struct AlphaMemory
+  {
+    /// Atom of the expression tree of the first rule with it, the tree is kept alive while the memory exists
+    std::shared_ptr<TemplateExpressionNode const> atom;
+    Replacements replacements;
+  };
+
+  struct RuleNode
+  {
+    /// Indices of alpha memories of premise atoms in the join order
+    std::vector<size_t> alphaMemoriesIndices;
+    std::vector<Replacements> betaMemories;
+    Replacements activation;
+  };
+
+  std::vector<AlphaMemory> alphaMemories;
+  std::unordered_map<ScAddr, size_t, ScAddrHashFunc> alphaMemoriesIndices;
+  std::unordered_map<size_t, RuleNode> rules;
+  /// Rules and positions of atoms in their chains for each alpha memory
+  std::vector<std::vector<std::pair<size_t, size_t>>> alphaMemoriesUsages;
+  Statistics statistics;
+
+  size_t getAlphaMemory(
+      LogicEvaluationContext const & evaluationContext,
+      std::shared_ptr<LogicExpressionNode const> const & expressionRoot,
+      TemplateExpressionNode const & atom);
+  /// Propagate the delta of the alpha memory through the chain of the rule from the position of the atom
+  void propagate(size_t ruleIndex, size_t position, Replacements const & alphaDelta);
+
+  /// Join as `ReplacementsUtils::intersectReplacements` does, but the join with empty replacements is empty
+  static void join(Replacements const & first, Replacements const & second, Replacements & result);
+  /// Add columns of `delta` that are not in `memory` to it, `delta` keeps only these columns
+  static void addNewColumns(Replacements & memory, Replacements & delta);
+};
+
+}  // namespace inference
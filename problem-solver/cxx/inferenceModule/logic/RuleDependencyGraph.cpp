@@ -0,0 +1,284 @@
+/*
+ * This source file is part of an OSTIS project. For the latest info, see http://ostis.net
+ * Distributed under the MIT License
+ * (See accompanying file COPYING.MIT or copy at http://opensource.org/licenses/MIT)
+ */
+
+#include "RuleDependencyGraph.hpp"
+
+#include <algorithm>
+#include <set>
+
+#include "ConjunctionExpressionNode.hpp"
+#include "ImplicationExpressionNode.hpp"
+#include "TemplateExpressionNode.hpp"
+
+namespace inference
+{
+void RuleDependencyGraph::addRule(
+    FormulaMetadataCache & formulaMetadataCache,
+    size_t ruleIndex,
+    LogicExpressionNode const & expressionRoot)
+{
+  RuleNode & rule = rules[ruleIndex];
+  LogicExpressionNode const * premise = &expressionRoot;
+  if (auto const * implication = dynamic_cast<ImplicationExpressionNode const *>(&expressionRoot))
+  {
+    premise = implication->getOperands()[0].get();
+    addAtoms(formulaMetadataCache, *implication->getOperands()[1], true, ruleIndex, rule);
+  }
+  addAtoms(formulaMetadataCache, *premise, false, ruleIndex, rule);
+
+  std::vector<LogicExpressionNode const *> premiseOperands;
+  if (auto const * conjunction = dynamic_cast<ConjunctionExpressionNode const *>(premise))
+  {
+    for (std::shared_ptr<LogicExpressionNode> const & operand : conjunction->getOperands())
+      premiseOperands.push_back(operand.get());
+  }
+  else
+    premiseOperands.push_back(premise);
+  for (LogicExpressionNode const * operand : premiseOperands)
+  {
+    auto const * atom = dynamic_cast<TemplateExpressionNode const *>(operand);
+    if (!atom)
+      continue;
+    size_t const atomIndex = getAtom(formulaMetadataCache, atom->getFormula());
+    if (!atoms[atomIndex].metadata->isFormulaToGenerate)
+      rule.requiredAtoms.push_back(atomIndex);
+  }
+}
+
+void RuleDependencyGraph::build()
+{
+  for (AtomNode & conclusionAtom : atoms)
+  {
+    conclusionAtom.matchedAtoms.clear();
+    for (size_t premiseAtomIndex = 0; premiseAtomIndex < atoms.size(); ++premiseAtomIndex)
+    {
+      AtomNode const & premiseAtom = atoms[premiseAtomIndex];
+      if (premiseAtom.premiseRules.empty())
+        continue;
+      bool const isMatched = std::any_of(
+          premiseAtom.metadata->triples.cbegin(),
+          premiseAtom.metadata->triples.cend(),
+          [&conclusionAtom](Triple const & premiseTriple)
+          {
+            return mayBeAdded(conclusionAtom, premiseTriple) ||
+                   std::any_of(
+                       conclusionAtom.metadata->triples.cbegin(),
+                       conclusionAtom.metadata->triples.cend(),
+                       [&premiseTriple](Triple const & generatedTriple)
+                       {
+                         return mayMatch(generatedTriple, premiseTriple);
+                       });
+          });
+      if (isMatched)
+        conclusionAtom.matchedAtoms.push_back(premiseAtomIndex);
+    }
+  }
+
+  std::set<size_t> rulesIndices;
+  for (auto & [ruleIndex, rule] : rules)
+  {
+    rulesIndices.insert(ruleIndex);
+    std::set<size_t> downstreamRules;
+    for (size_t const conclusionAtomIndex : rule.conclusionAtoms)
+    {
+      for (size_t const premiseAtomIndex : atoms[conclusionAtomIndex].matchedAtoms)
+      {
+        std::vector<size_t> const & premiseRules = atoms[premiseAtomIndex].premiseRules;
+        downstreamRules.insert(premiseRules.cbegin(), premiseRules.cend());
+      }
+    }
+    rule.downstreamRules.assign(downstreamRules.cbegin(), downstreamRules.cend());
+    rule.component = kNoComponent;
+  }
+
+  componentsAmount = 0;
+  ComponentsSearch search;
+  for (size_t const ruleIndex : rulesIndices)
+  {
+    if (!search.visitIndices.count(ruleIndex))
+      findComponent(ruleIndex, search);
+  }
+}
+
+std::vector<size_t> const & RuleDependencyGraph::getDownstreamRules(size_t ruleIndex) const
+{
+  static std::vector<size_t> const noRules;
+  auto const & ruleIterator = rules.find(ruleIndex);
+  return ruleIterator == rules.cend() ? noRules : ruleIterator->second.downstreamRules;
+}
+
+size_t RuleDependencyGraph::getComponent(size_t ruleIndex) const
+{
+  auto const & ruleIterator = rules.find(ruleIndex);
+  return ruleIterator == rules.cend() ? kNoComponent : ruleIterator->second.component;
+}
+
+bool RuleDependencyGraph::isRecursive(size_t ruleIndex) const
+{
+  auto const & ruleIterator = rules.find(ruleIndex);
+  return ruleIterator != rules.cend() && ruleIterator->second.isRecursive;
+}
+
+size_t RuleDependencyGraph::getComponentsAmount() const
+{
+  return componentsAmount;
+}
+
+bool RuleDependencyGraph::canFire(ScMemoryContext * context, size_t ruleIndex) const
+{
+  auto const & ruleIterator = rules.find(ruleIndex);
+  if (ruleIterator == rules.cend())
+    return true;
+  for (size_t const atomIndex : ruleIterator->second.requiredAtoms)
+  {
+    for (Triple const & triple : atoms[atomIndex].metadata->triples)
+    {
+      if (!hasConstantArc(context, triple))
+        return false;
+    }
+  }
+  return true;
+}
+
+size_t RuleDependencyGraph::getAtom(FormulaMetadataCache & formulaMetadataCache, ScAddr const & formula)
+{
+  auto const & [atomIterator, isCreated] = atomsIndices.emplace(formula, atoms.size());
+  if (isCreated)
+    atoms.emplace_back().metadata = formulaMetadataCache.getMetadata(formula);
+  return atomIterator->second;
+}
+
+void RuleDependencyGraph::addAtoms(
+    FormulaMetadataCache & formulaMetadataCache,
+    LogicExpressionNode const & expression,
+    bool isConclusion,
+    size_t ruleIndex,
+    RuleNode & rule)
+{
+  if (auto const * atom = dynamic_cast<TemplateExpressionNode const *>(&expression))
+  {
+    size_t const atomIndex = getAtom(formulaMetadataCache, atom->getFormula());
+    AtomNode & atomNode = atoms[atomIndex];
+    if (isConclusion || atomNode.metadata->isFormulaToGenerate)
+      rule.conclusionAtoms.push_back(atomIndex);
+    else if (atomNode.premiseRules.empty() || atomNode.premiseRules.back() != ruleIndex)
+      atomNode.premiseRules.push_back(ruleIndex);
+    return;
+  }
+
+  if (auto const * operatorExpression = dynamic_cast<OperatorLogicExpressionNode const *>(&expression))
+  {
+    for (std::shared_ptr<LogicExpressionNode> const & operand : operatorExpression->getOperands())
+      addAtoms(formulaMetadataCache, *operand, isConclusion, ruleIndex, rule);
+  }
+}
+
+// Tarjan's algorithm, a component is found when the search returns to its first visited rule
+void RuleDependencyGraph::findComponent(size_t ruleIndex, ComponentsSearch & search)
+{
+  size_t const visitIndex = search.visitsAmount++;
+  search.visitIndices[ruleIndex] = visitIndex;
+  search.lowLinks[ruleIndex] = visitIndex;
+  search.stack.push_back(ruleIndex);
+  search.isOnStack[ruleIndex] = true;
+
+  std::vector<size_t> const & dependentRules = rules.at(ruleIndex).downstreamRules;
+  for (size_t const dependentRuleIndex : dependentRules)
+  {
+    if (!search.visitIndices.count(dependentRuleIndex))
+    {
+      findComponent(dependentRuleIndex, search);
+      search.lowLinks[ruleIndex] = std::min(search.lowLinks[ruleIndex], search.lowLinks[dependentRuleIndex]);
+    }
+    else if (search.isOnStack[dependentRuleIndex])
+      search.lowLinks[ruleIndex] = std::min(search.lowLinks[ruleIndex], search.visitIndices[dependentRuleIndex]);
+  }
+  if (search.lowLinks[ruleIndex] != visitIndex)
+    return;
+
+  size_t const component = componentsAmount++;
+  std::vector<size_t> componentRules;
+  size_t componentRuleIndex;
+  do
+  {
+    componentRuleIndex = search.stack.back();
+    search.stack.pop_back();
+    search.isOnStack[componentRuleIndex] = false;
+    componentRules.push_back(componentRuleIndex);
+  } while (componentRuleIndex != ruleIndex);
+
+  bool const isRecursive =
+      componentRules.size() > 1 ||
+      std::binary_search(dependentRules.cbegin(), dependentRules.cend(), ruleIndex);
+  for (size_t const componentRule : componentRules)
+  {
+    rules.at(componentRule).component = component;
+    rules.at(componentRule).isRecursive = isRecursive;
+  }
+}
+
+// A generated arc is a new element, so it doesn't match a triple with a constant arc
+bool RuleDependencyGraph::mayMatch(Triple const & generatedTriple, Triple const & premiseTriple)
+{
+  return !premiseTriple[1].name.empty() && mayHaveSameEnds(generatedTriple, premiseTriple);
+}
+
+// Constants of the conclusion and existing arcs found by its triples are added to the output structure, premise triples
+// searched in structures may match them after that
+bool RuleDependencyGraph::mayBeAdded(AtomNode const & conclusionAtom, Triple const & premiseTriple)
+{
+  for (FormulaMetadata::TemplateItem const & item : premiseTriple)
+  {
+    if (item.name.empty() && conclusionAtom.metadata->constants.count(item.addr))
+      return true;
+  }
+  if (!premiseTriple[1].name.empty())
+    return false;
+  return std::any_of(
+      conclusionAtom.metadata->triples.cbegin(),
+      conclusionAtom.metadata->triples.cend(),
+      [&premiseTriple](Triple const & conclusionTriple)
+      {
+        return mayHaveSameEnds(conclusionTriple, premiseTriple);
+      });
+}
+
+bool RuleDependencyGraph::mayHaveSameEnds(Triple const & first, Triple const & second)
+{
+  for (size_t const itemIndex : {0, 2})
+  {
+    // Constants have no name in the compiled triples
+    if (first[itemIndex].name.empty() && second[itemIndex].name.empty() &&
+        first[itemIndex].addr != second[itemIndex].addr)
+      return false;
+  }
+  return true;
+}
+
+// Arcs of templates are variables, so only constant arcs are counted
+bool RuleDependencyGraph::hasConstantArc(ScMemoryContext * context, Triple const & triple)
+{
+  bool const isSourceConst = triple[0].name.empty();
+  bool const isTargetConst = triple[2].name.empty();
+  if (triple[1].name.empty() || (!isSourceConst && !isTargetConst))
+    return true;
+
+  ScIterator3Ptr arcsIterator;
+  if (isSourceConst && isTargetConst)
+    arcsIterator = context->CreateIterator3(triple[0].addr, ScType::Unknown, triple[2].addr);
+  else if (isSourceConst)
+    arcsIterator = context->CreateIterator3(triple[0].addr, ScType::Unknown, ScType::Unknown);
+  else
+    arcsIterator = context->CreateIterator3(ScType::Unknown, ScType::Unknown, triple[2].addr);
+  while (arcsIterator->Next())
+  {
+    if (context->GetElementType(arcsIterator->Get(1)).IsConst())
+      return true;
+  }
+  return false;
+}
+
+}  // namespace inference
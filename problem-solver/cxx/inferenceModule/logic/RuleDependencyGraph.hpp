@@ -0,0 +1,124 @@
+/*
+ * This source file is part of an OSTIS project. For the latest info, see http://ostis.net
+ * Distributed under the MIT License
+ * (See accompanying file COPYING.MIT or copy at http://opensource.org/licenses/MIT)
+ */
+
+#pragma once
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include <sc-memory/sc_memory.hpp>
+
+#include "searcher/templateSearcher/FormulaMetadataCache.hpp"
+
+#include "LogicExpressionNode.hpp"
+
+namespace inference
+{
+/**
+ * Dependencies between rules by their compiled atomic formulas. Atoms of conclusions and atoms to generate are linked
+ * with atoms of premises whose triples they may generate: a triple of a premise may match a generated triple if their
+ * arcs are variables and they have no different constant sources or targets, so relations and classes of triples are
+ * compared. Conclusions found in the knowledge base are added to the output structure with constants of their atoms,
+ * so an atom is also linked with premise atoms whose triples have its constants or whose constant arcs it may find.
+ * A rule depends on another rule if one of its premise atoms is linked with an atom generated by the other rule, so
+ * only downstream rules of a rule may be affected by its generation. Strongly connected components of rules are found
+ * when the graph is built, rules of a component with a cycle may generate premises of each other any number of times.
+ */
+class RuleDependencyGraph
+{
+public:
+  static size_t constexpr kNoComponent = static_cast<size_t>(-1);
+
+  /**
+   * @brief Add atoms of the rule to the graph
+   * @param formulaMetadataCache metadata of atomic formulas with their compiled triples
+   * @param ruleIndex identifier of the rule in the graph
+   * @param expressionRoot root of expression tree of the rule, premise of an implication is its first operand and
+   * conclusion is the second one, other formulas are premises as a whole
+   */
+  void addRule(
+      FormulaMetadataCache & formulaMetadataCache,
+      size_t ruleIndex,
+      LogicExpressionNode const & expressionRoot);
+
+  /// Link atoms and rules and find strongly connected components of rules, it is called after all rules are added
+  void build();
+
+  /**
+   * @brief Rules whose premises may be matched by elements the rule generates or adds to the output structure, the rule
+   * itself is among them if it may generate its own premise
+   * @returns indices of rules in ascending order, empty if the rule is not in the graph
+   */
+  std::vector<size_t> const & getDownstreamRules(size_t ruleIndex) const;
+  /// Returns index of strongly connected component of the rule or `kNoComponent` if the rule is not in the graph
+  size_t getComponent(size_t ruleIndex) const;
+  /// Check if the rule may generate its own premise directly or through other rules of its component
+  bool isRecursive(size_t ruleIndex) const;
+  size_t getComponentsAmount() const;
+
+  /**
+   * @brief Check if premise of the rule may have replacements in the knowledge base. An atom of a premise conjunction
+   * has no replacements if a constant of its triple has no constant arcs to match the triple. Premises with other
+   * operators are not checked
+   * @returns false if the rule can't be used until its premise atoms are generated
+   */
+  bool canFire(ScMemoryContext * context, size_t ruleIndex) const;
+
+private:
+  using Triple = std::array<FormulaMetadata::TemplateItem, 3>;
+
+  struct AtomNode
+  {
+    std::shared_ptr<FormulaMetadata const> metadata;
+    /// Atoms of premises that may be matched by triples generated by this atom
+    std::vector<size_t> matchedAtoms;
+    /// Rules with this atom in premises
+    std::vector<size_t> premiseRules;
+  };
+
+  struct RuleNode
+  {
+    std::vector<size_t> conclusionAtoms;
+    /// Atoms of the premise conjunction that must have replacements for the rule to be used
+    std::vector<size_t> requiredAtoms;
+    /// Rules that depend on this rule in ascending order
+    std::vector<size_t> downstreamRules;
+    size_t component = kNoComponent;
+    bool isRecursive = false;
+  };
+
+  /// State of depth first search of strongly connected components
+  struct ComponentsSearch
+  {
+    size_t visitsAmount = 0;
+    std::unordered_map<size_t, size_t> visitIndices;
+    std::unordered_map<size_t, size_t> lowLinks;
+    std::vector<size_t> stack;
+    std::unordered_map<size_t, bool> isOnStack;
+  };
+
+  std::vector<AtomNode> atoms;
+  std::unordered_map<ScAddr, size_t, ScAddrHashFunc> atomsIndices;
+  std::unordered_map<size_t, RuleNode> rules;
+  size_t componentsAmount = 0;
+
+  size_t getAtom(FormulaMetadataCache & formulaMetadataCache, ScAddr const & formula);
+  void addAtoms(
+      FormulaMetadataCache & formulaMetadataCache,
+      LogicExpressionNode const & expression,
+      bool isConclusion,
+      size_t ruleIndex,
+      RuleNode & rule);
+  void findComponent(size_t ruleIndex, ComponentsSearch & search);
+
+  static bool mayMatch(Triple const & generatedTriple, Triple const & premiseTriple);
+  static bool mayBeAdded(AtomNode const & conclusionAtom, Triple const & premiseTriple);
+  static bool mayHaveSameEnds(Triple const & first, Triple const & second);
+  static bool hasConstantArc(ScMemoryContext * context, Triple const & triple);
+};
+
+}  // namespace inference
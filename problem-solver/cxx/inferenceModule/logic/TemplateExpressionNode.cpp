@@ -7,28 +7,13 @@
 #include "TemplateExpressionNode.hpp"
 
 #include "inferenceConfig/InferenceConfig.hpp"
-
-#include "searcher/templateSearcher/TemplateSearcherGeneral.hpp"
+#include "utils/ThreadPool.hpp"
 
 #include "sc-agents-common/utils/GenerationUtils.hpp"
 
-TemplateExpressionNode::TemplateExpressionNode(
-    ScMemoryContext * context,
-    std::shared_ptr<TemplateSearcherAbstract> templateSearcher,
-    std::shared_ptr<TemplateManagerAbstract> templateManager,
-    std::shared_ptr<SolutionTreeManagerAbstract> solutionTreeManager,
-    ScAddr const & outputStructure,
-    ScAddr const & formula)
-  : context(context)
-  , templateSearcher(std::move(templateSearcher))
-  , templateManager(std::move(templateManager))
-  , solutionTreeManager(std::move(solutionTreeManager))
-  , outputStructure(outputStructure)
-  , formula(formula)
+TemplateExpressionNode::TemplateExpressionNode(ScAddr const & formula)
+  : formula(formula)
 {
-  this->templateSearcherGeneral = std::make_unique<TemplateSearcherGeneral>(context);
-  this->templateSearcherGeneral->setReplacementsUsingType(this->templateSearcher->getReplacementsUsingType());
-  this->templateSearcherGeneral->setOutputStructureFillingType(this->templateSearcher->getOutputStructureFillingType());
 }
 
 ScAddr TemplateExpressionNode::getFormula() const
@@ -36,59 +21,224 @@ ScAddr TemplateExpressionNode::getFormula() const
   return formula;
 }
 
-void TemplateExpressionNode::compute(LogicFormulaResult & result) const
+std::shared_ptr<FormulaMetadata const> TemplateExpressionNode::getMetadata(
+    LogicEvaluationContext const & evaluationContext) const
+{
+  return evaluationContext.templateSearcher->getFormulaMetadataCache()->getMetadata(formula);
+}
+
+void TemplateExpressionNode::compute(LogicEvaluationContext & evaluationContext, LogicFormulaResult & result) const
 {
+  ScAddrVector const & argumentVector = evaluationContext.argumentVector;
+  TemplateSearcherAbstract & templateSearcher = *evaluationContext.templateSearcher;
   SC_LOG_DEBUG(
       "TemplateExpressionNode: compute for " << (argumentVector.empty() ? "empty" : to_string(argumentVector.size()))
                                              << " arguments");
   ScAddrUnorderedSet variables;
-  result.replacements.clear();
-  templateSearcher->getVariables(formula, variables);
+  Replacements searchResult;
+  templateSearcher.getVariables(formula, variables);
+  size_t const searcherResultsLimit = templateSearcher.getResultsLimit();
+  templateSearcher.setResultsLimit(evaluationContext.resultsLimit);
   // Template params should be created only if argument vector is not empty. Else search with any possible replacements
   if (!argumentVector.empty())
   {
-    std::vector<ScTemplateParams> const & templateParamsVector = templateManager->createTemplateParams(formula);
-    templateSearcher->searchTemplate(formula, templateParamsVector, variables, result.replacements);
+    std::vector<ScTemplateParams> const & templateParamsVector =
+        evaluationContext.templateManager->createTemplateParams(formula);
+    templateSearcher.searchTemplate(formula, templateParamsVector, variables, searchResult);
   }
   else
   {
-    templateSearcher->searchTemplate(formula, ScTemplateParams(), variables, result.replacements);
+    templateSearcher.searchTemplate(formula, ScTemplateParams(), variables, searchResult);
   }
+  templateSearcher.setResultsLimit(searcherResultsLimit);
+  result.replacements = FactorizedReplacements(std::move(searchResult));
 
   result.value = !result.replacements.empty();
   SC_LOG_DEBUG(
-      "Compute atomic logical formula " << context->GetElementSystemIdentifier(formula)
+      "Compute atomic logical formula " << evaluationContext.context->GetElementSystemIdentifier(formula)
                                         << (result.value ? " true" : " false"));
 }
 
-LogicFormulaResult TemplateExpressionNode::find(Replacements & replacements) const
+void TemplateExpressionNode::computeInParallel(
+    LogicEvaluationContext & evaluationContext,
+    std::vector<LogicExpressionNode const *> const & operands,
+    std::vector<std::optional<LogicFormulaResult>> & results)
+{
+  results.clear();
+  results.resize(operands.size());
+  std::vector<TemplateExpressionNode const *> atoms;
+  std::vector<size_t> atomsIndices;
+  for (size_t operandIndex = 0; operandIndex < operands.size(); ++operandIndex)
+  {
+    auto atom = dynamic_cast<TemplateExpressionNode const *>(operands[operandIndex]);
+    if (atom)
+    {
+      atoms.push_back(atom);
+      atomsIndices.push_back(operandIndex);
+    }
+  }
+  if (!evaluationContext.operandsThreadPool || atoms.size() < 2)
+    return;
+
+  // Tasks do not use the context of the inference: metadata is cached and template params are created before them
+  ScAddrVector const & argumentVector = evaluationContext.argumentVector;
+  std::vector<std::vector<ScTemplateParams>> templateParamsVectors(atoms.size());
+  for (size_t atomIndex = 0; atomIndex < atoms.size(); ++atomIndex)
+  {
+    atoms[atomIndex]->getMetadata(evaluationContext);
+    if (!argumentVector.empty())
+      templateParamsVectors[atomIndex] =
+          evaluationContext.templateManager->createTemplateParams(atoms[atomIndex]->formula);
+  }
+
+  SC_LOG_DEBUG("TemplateExpressionNode: search " << atoms.size() << " atoms in parallel");
+  evaluationContext.operandsThreadPool->parallelFor(
+      atoms.size(),
+      [&](size_t atomIndex)
+      {
+        ScAddr const & atomFormula = atoms[atomIndex]->formula;
+        ScMemoryContext taskContext;
+        std::unique_ptr<TemplateSearcherAbstract> const templateSearcher =
+            evaluationContext.templateSearcher->copy(&taskContext);
+        templateSearcher->setResultsLimit(evaluationContext.resultsLimit);
+        ScAddrUnorderedSet variables;
+        templateSearcher->getVariables(atomFormula, variables);
+        Replacements searchResult;
+        if (!argumentVector.empty())
+          templateSearcher->searchTemplate(atomFormula, templateParamsVectors[atomIndex], variables, searchResult);
+        else
+          templateSearcher->searchTemplate(atomFormula, ScTemplateParams(), variables, searchResult);
+
+        // The result is constructed in place, so it is not copied to the memory resource of the calling thread here
+        LogicFormulaResult & result = results[atomsIndices[atomIndex]].emplace();
+        result.replacements = FactorizedReplacements(std::move(searchResult));
+        result.value = !result.replacements.empty();
+      });
+}
+
+LogicFormulaResult TemplateExpressionNode::find(
+    LogicEvaluationContext & evaluationContext,
+    FactorizedReplacements const & replacements) const
 {
+  TemplateSearcherAbstract & templateSearcher = *evaluationContext.templateSearcher;
   LogicFormulaResult result;
-  std::vector<ScTemplateParams> paramsVector;
-  ReplacementsUtils::getReplacementsToScTemplateParams(replacements, paramsVector);
-  result.replacements.clear();
+  Replacements searchResult;
   ScAddrUnorderedSet variables;
-  templateSearcher->getVariables(formula, variables);
+  templateSearcher.getVariables(formula, variables);
   SC_LOG_DEBUG(
-      "TemplateExpressionNode: call search for " << (paramsVector.empty() ? "empty" : to_string(paramsVector.size()))
-                                                 << " params");
-  templateSearcher->searchTemplate(formula, paramsVector, variables, result.replacements);
+      "TemplateExpressionNode: call search for "
+      << (replacements.empty() ? "empty" : to_string(replacements.getCombinationsAmount())) << " bindings");
+  size_t const searcherResultsLimit = templateSearcher.getResultsLimit();
+  templateSearcher.setResultsLimit(evaluationContext.resultsLimit);
+  templateSearcher.searchTemplateByDistinctBindings(formula, replacements, variables, searchResult);
+  templateSearcher.setResultsLimit(searcherResultsLimit);
+  result.replacements = FactorizedReplacements(std::move(searchResult));
   result.value = !result.replacements.empty();
 
-  std::string const idtf = context->GetElementSystemIdentifier(formula);
+  std::string const idtf = evaluationContext.context->GetElementSystemIdentifier(formula);
   SC_LOG_DEBUG("Find Statement " << idtf << (result.value ? " true" : " false"));
 
   return result;
 }
 
+// Delta and memories of the rete network need all replacements of the formula, so the searcher settings limiting them
+// are not used
+void TemplateExpressionNode::findAll(
+    LogicEvaluationContext const & evaluationContext,
+    ScTemplateParams const & params,
+    Replacements & searchResult) const
+{
+  std::vector<ScTemplateParams> const paramsVector = {params};
+  TemplateSearcherAbstract & templateSearcher = *evaluationContext.templateSearcher;
+  ScAddrUnorderedSet variables;
+  templateSearcher.getVariables(formula, variables);
+  ReplacementsUsingType const replacementsUsingType = templateSearcher.getReplacementsUsingType();
+  size_t const searcherResultsLimit = templateSearcher.getResultsLimit();
+  templateSearcher.setReplacementsUsingType(REPLACEMENTS_ALL);
+  templateSearcher.setResultsLimit(0);
+  templateSearcher.searchTemplate(formula, paramsVector, variables, searchResult);
+  templateSearcher.setReplacementsUsingType(replacementsUsingType);
+  templateSearcher.setResultsLimit(searcherResultsLimit);
+}
+
+size_t TemplateExpressionNode::findDelta(
+    LogicEvaluationContext const & evaluationContext,
+    ScAddrVector const & newArcs,
+    ScAddrUnorderedSet const & newArcsSet,
+    Replacements & delta) const
+{
+  auto const & bindItem =
+      [](FormulaMetadata::TemplateItem const & item, ScAddr const & value, ScTemplateParams & params) -> bool
+  {
+    // Constants have no name in the compiled triples
+    if (item.name.empty())
+      return item.addr == value;
+    ScAddr boundValue;
+    if (params.Get(item.addr, boundValue))
+      return boundValue == value;
+    params.Add(item.addr, value);
+    return true;
+  };
+
+  ScMemoryContext * context = evaluationContext.context;
+  std::shared_ptr<FormulaMetadata const> const metadata = getMetadata(evaluationContext);
+  size_t searchesAmount = 0;
+  for (std::array<FormulaMetadata::TemplateItem, 3> const & triple : metadata->triples)
+  {
+    if (triple[1].name.empty())
+      continue;
+    for (ScAddr const & arc : newArcs)
+    {
+      auto const [source, target] = context->GetConnectorIncidentElements(arc);
+      ScTemplateParams params;
+      if (!bindItem(triple[0], source, params) || !bindItem(triple[2], target, params))
+        continue;
+
+      ++searchesAmount;
+      Replacements tripleResult;
+      findAll(evaluationContext, params, tripleResult);
+      size_t const arcKeyIndex = tripleResult.findKeyIndex(triple[1].addr);
+      if (tripleResult.empty() || arcKeyIndex == Replacements::kNotFound)
+        continue;
+      std::vector<size_t> columnsWithArc;
+      for (size_t columnIndex = 0; columnIndex < tripleResult.getColumnsAmount(); ++columnIndex)
+      {
+        if (newArcsSet.count(tripleResult.get(columnIndex, arcKeyIndex)))
+          columnsWithArc.push_back(columnIndex);
+      }
+      tripleResult.keepColumns(columnsWithArc);
+      ReplacementsUtils::uniteReplacements(delta, tripleResult, delta);
+    }
+  }
+  return searchesAmount;
+}
+
+void TemplateExpressionNode::selectArcs(
+    ScMemoryContext * context,
+    ScAddrVector const & elements,
+    ScAddrVector & arcs,
+    ScAddrUnorderedSet & arcsSet)
+{
+  for (ScAddr const & element : elements)
+  {
+    if (context->GetElementType(element).IsEdge() && arcsSet.insert(element).second)
+      arcs.push_back(element);
+  }
+}
+
 /**
  * @brief Generate atomic logical formula using replacements
- * @param replacements variables and ScAddrs to use in generation
+ * @param factorizedReplacements variables and ScAddrs to use in generation, they are expanded to a table
  * @param result {bool: value, bool: isGenerated, Replacements: replacements}
  */
-void TemplateExpressionNode::generate(Replacements & replacements, LogicFormulaResult & result)
+void TemplateExpressionNode::generate(
+    LogicEvaluationContext & evaluationContext,
+    FactorizedReplacements & factorizedReplacements,
+    LogicFormulaResult & result) const
 {
+  ScMemoryContext * context = evaluationContext.context;
   result = {};
+  Replacements const & replacements = factorizedReplacements.materialize();
   if (ReplacementsUtils::getColumnsAmount(replacements) == 0)
   {
     SC_LOG_DEBUG("Atomic logical formula " << context->GetElementSystemIdentifier(formula) << " is not generated");
@@ -96,32 +246,39 @@ void TemplateExpressionNode::generate(Replacements & replacements, LogicFormulaR
   }
 
   ScAddrUnorderedSet formulaVariables;
-  templateSearcher->getVariables(formula, formulaVariables);
+  evaluationContext.templateSearcher->getVariables(formula, formulaVariables);
   // existingFormulaReplacements stores all replacements for atomic logical formula searched with
   // TemplateSearcherGeneral if condition in getSearchResultWithoutReplacementsIfNeeded() is true
-  Replacements const & existingFormulaReplacements = getSearchResultWithoutReplacementsIfNeeded();
+  Replacements const & existingFormulaReplacements = getSearchResultWithoutReplacementsIfNeeded(evaluationContext);
 
   size_t count = 0;
   Replacements searchResult;
   Replacements generatedReplacements;
-  if (templateManager->getGenerationType() == GENERATE_UNIQUE_FORMULAS)
+  std::vector<size_t> columnsToGenerate;
+  if (evaluationContext.templateManager->getGenerationType() == GENERATE_UNIQUE_FORMULAS)
   {
-    // replacementsNotInKb stores all replacements from passed to TemplateExpressionNode::generate parameter that don't
-    // have corresponding columns in existingFormulaReplacements
-    Replacements replacementsNotInKb;
-    ReplacementsUtils::subtractReplacements(replacements, existingFormulaReplacements, replacementsNotInKb);
-    // this generation is called with first parameter being replacementsNotInKb because there is no need to generate
-    // atomic logical formula for those replacements found and stored in existingFormulaReplacements
-    generateByReplacements(replacementsNotInKb, result, count, formulaVariables, searchResult, generatedReplacements);
+    // columnsToGenerate stores indices of columns from passed to TemplateExpressionNode::generate parameter that don't
+    // have corresponding columns in existingFormulaReplacements. There is no need to generate atomic logical formula
+    // for those replacements found and stored in existingFormulaReplacements
+    ReplacementsUtils::antiJoinReplacements(replacements, existingFormulaReplacements, columnsToGenerate);
+    TemplateParamsStream paramsStream(replacements, std::move(columnsToGenerate));
+    generateByReplacements(
+        evaluationContext, paramsStream, result, count, formulaVariables, searchResult, generatedReplacements);
   }
   else
-    generateByReplacements(replacements, result, count, formulaVariables, searchResult, generatedReplacements);
+  {
+    TemplateParamsStream paramsStream(replacements);
+    generateByReplacements(
+        evaluationContext, paramsStream, result, count, formulaVariables, searchResult, generatedReplacements);
+  }
 
-  fillOutputStructure(formulaVariables, replacements, existingFormulaReplacements, searchResult);
+  fillOutputStructure(evaluationContext, formulaVariables, replacements, existingFormulaReplacements, searchResult);
 
   Replacements intermediateUniteResult;
+  Replacements uniteResult;
   ReplacementsUtils::uniteReplacements(searchResult, existingFormulaReplacements, intermediateUniteResult);
-  ReplacementsUtils::uniteReplacements(intermediateUniteResult, generatedReplacements, result.replacements);
+  ReplacementsUtils::uniteReplacements(intermediateUniteResult, generatedReplacements, uniteResult);
+  result.replacements = FactorizedReplacements(std::move(uniteResult));
 
   SC_LOG_DEBUG(
       "Atomic logical formula " << context->GetElementSystemIdentifier(formula) << " is generated " << count
@@ -133,87 +290,105 @@ void TemplateExpressionNode::generate(Replacements & replacements, LogicFormulaR
  * replacements in entire knowledge base without any additional conditions
  * @return Empty replacements or all replacements for atomic logical formula
  */
-Replacements TemplateExpressionNode::getSearchResultWithoutReplacementsIfNeeded() const
+Replacements TemplateExpressionNode::getSearchResultWithoutReplacementsIfNeeded(
+    LogicEvaluationContext const & evaluationContext) const
 {
   Replacements resultWithoutReplacements;
-  if (templateSearcher->getAtomicLogicalFormulaSearchBeforeGenerationType() == SEARCH_WITHOUT_REPLACEMENTS)
+  if (evaluationContext.templateSearcher->getAtomicLogicalFormulaSearchBeforeGenerationType() ==
+      SEARCH_WITHOUT_REPLACEMENTS)
   {
+    TemplateSearcherAbstract & templateSearcherGeneral = *evaluationContext.templateSearcherGeneral;
     ScAddrUnorderedSet variables;
-    templateSearcherGeneral->getVariables(formula, variables);
-    templateSearcherGeneral->searchTemplate(formula, ScTemplateParams(), variables, resultWithoutReplacements);
+    templateSearcherGeneral.getVariables(formula, variables);
+    templateSearcherGeneral.searchTemplate(formula, ScTemplateParams(), variables, resultWithoutReplacements);
   }
   return resultWithoutReplacements;
 }
 
 void TemplateExpressionNode::generateByReplacements(
-    Replacements const & replacements,
+    LogicEvaluationContext & evaluationContext,
+    TemplateParamsStream & paramsStream,
     LogicFormulaResult & result,
     size_t & count,
     ScAddrUnorderedSet const & formulaVariables,
     Replacements & searchResult,
-    Replacements & generatedReplacements)
+    Replacements & generatedReplacements) const
 {
-  std::vector<ScTemplateParams> paramsVector;
-  ReplacementsUtils::getReplacementsToScTemplateParams(replacements, paramsVector);
-  processTemplateParams(paramsVector, formulaVariables, result, count, searchResult, generatedReplacements);
+  ScTemplateParams params;
+  while (paramsStream.next(params))
+  {
+    if (evaluationContext.templateManager->getReplacementsUsingType() == REPLACEMENTS_FIRST && result.isGenerated)
+      return;
+    processTemplateParams(
+        evaluationContext, params, formulaVariables, result, count, searchResult, generatedReplacements);
+  }
 }
 
 void TemplateExpressionNode::processTemplateParams(
-    vector<ScTemplateParams> const & paramsVector,
+    LogicEvaluationContext & evaluationContext,
+    ScTemplateParams const & params,
     ScAddrUnorderedSet const & formulaVariables,
     LogicFormulaResult & result,
     size_t & count,
     Replacements & searchResult,
-    Replacements & generatedReplacements)
+    Replacements & generatedReplacements) const
 {
-  for (ScTemplateParams const & params : paramsVector)
-  {
-    if (templateManager->getReplacementsUsingType() == REPLACEMENTS_FIRST && result.isGenerated)
-      return;
-    size_t const previousSearchSize = ReplacementsUtils::getColumnsAmount(searchResult);
-    if (templateManager->getGenerationType() == GENERATE_UNIQUE_FORMULAS)
-      templateSearcherGeneral->searchTemplate(formula, params, formulaVariables, searchResult);
-    if (templateManager->getGenerationType() != GENERATE_UNIQUE_FORMULAS ||
-        ReplacementsUtils::getColumnsAmount(searchResult) == previousSearchSize)
-      generateByParams(params, formulaVariables, generatedReplacements, result, count);
-  }
+  GenerationType const generationType = evaluationContext.templateManager->getGenerationType();
+  size_t const previousSearchSize = ReplacementsUtils::getColumnsAmount(searchResult);
+  if (generationType == GENERATE_UNIQUE_FORMULAS)
+    evaluationContext.templateSearcherGeneral->searchTemplate(formula, params, formulaVariables, searchResult);
+  if (generationType != GENERATE_UNIQUE_FORMULAS ||
+      ReplacementsUtils::getColumnsAmount(searchResult) == previousSearchSize)
+    generateByParams(evaluationContext, params, formulaVariables, generatedReplacements, result, count);
 }
 
 void TemplateExpressionNode::generateByParams(
+    LogicEvaluationContext & evaluationContext,
     ScTemplateParams const & params,
     ScAddrUnorderedSet const & formulaVariables,
     Replacements & generatedReplacements,
     LogicFormulaResult & result,
-    size_t & count)
+    size_t & count) const
 {
   ScTemplate generatedTemplate;
-  context->BuildTemplate(generatedTemplate, formula, params);
+  evaluationContext.templateSearcher->getFormulaMetadataCache()->buildTemplate(formula, params, generatedTemplate);
 
   ScTemplateGenResult generationResult;
-  context->GenerateByTemplate(generatedTemplate, generationResult);
+  evaluationContext.context->GenerateByTemplate(generatedTemplate, generationResult);
+  // Elements added to the output structure are recorded when they are added
+  if (!evaluationContext.outputStructure.IsValid())
+  {
+    for (size_t itemIndex = 0; itemIndex < generationResult.Size(); ++itemIndex)
+      evaluationContext.generatedElements.push_back(generationResult[itemIndex]);
+  }
   ++count;
   result.isGenerated = true;
   result.value = true;
-  for (ScAddr const & variable : formulaVariables)
+  if (generatedReplacements.getKeysAmount() == 0)
+    generatedReplacements = Replacements(formulaVariables);
+  ScAddrVector const & variables = generatedReplacements.getKeys();
+  ScAddr * generatedColumn = generatedReplacements.addColumn();
+  for (size_t variableIndex = 0; variableIndex < variables.size(); ++variableIndex)
   {
-    ScAddr outAddr;
-    if (generationResult.Get(variable, outAddr) || params.Get(variable, outAddr))
-      generatedReplacements[variable].push_back(outAddr);
-    else
+    ScAddr const & variable = variables[variableIndex];
+    ScAddr & outAddr = generatedColumn[variableIndex];
+    if (!generationResult.Get(variable, outAddr) && !params.Get(variable, outAddr))
       SC_THROW_EXCEPTION(
           utils::ExceptionInvalidState,
           "Generation result and template params do not have replacement for " << variable.Hash());
   }
-  addToOutputStructure(generationResult);
+  addToOutputStructure(evaluationContext, generationResult);
 }
 
 void TemplateExpressionNode::fillOutputStructure(
+    LogicEvaluationContext & evaluationContext,
     ScAddrUnorderedSet const & formulaVariables,
     Replacements const & replacements,
     Replacements const & resultWithoutReplacements,
-    Replacements const & searchResult)
+    Replacements const & searchResult) const
 {
-  if (outputStructure.IsValid() && templateManager->getFillingType() == SEARCHED_AND_GENERATED)
+  if (evaluationContext.outputStructure.IsValid() &&
+      evaluationContext.templateManager->getFillingType() == SEARCHED_AND_GENERATED)
   {
     if (ReplacementsUtils::getColumnsAmount(resultWithoutReplacements) > 0)
     {
@@ -222,65 +397,78 @@ void TemplateExpressionNode::fillOutputStructure(
           replacements, resultWithoutReplacements, alreadyExistedBeforeGenerationReplacements);
       if (ReplacementsUtils::getColumnsAmount(alreadyExistedBeforeGenerationReplacements) > 0)
       {
-        addToOutputStructure(alreadyExistedBeforeGenerationReplacements, formulaVariables);
-        addFormulaConstantsToOutputStructure();
+        addToOutputStructure(evaluationContext, alreadyExistedBeforeGenerationReplacements, formulaVariables);
+        addFormulaConstantsToOutputStructure(evaluationContext);
       }
     }
     if (ReplacementsUtils::getColumnsAmount(searchResult) > 0)
     {
-      addToOutputStructure(searchResult, formulaVariables);
-      addFormulaConstantsToOutputStructure();
+      addToOutputStructure(evaluationContext, searchResult, formulaVariables);
+      addFormulaConstantsToOutputStructure(evaluationContext);
     }
   }
 }
 
-void TemplateExpressionNode::addFormulaConstantsToOutputStructure()
+void TemplateExpressionNode::addFormulaConstantsToOutputStructure(LogicEvaluationContext & evaluationContext) const
 {
   ScAddrUnorderedSet formulaConstants;
-  templateSearcher->getConstants(formula, formulaConstants);
-  addToOutputStructure(formulaConstants);
+  evaluationContext.templateSearcher->getConstants(formula, formulaConstants);
+  addToOutputStructure(evaluationContext, formulaConstants);
 }
 
 void TemplateExpressionNode::addToOutputStructure(
+    LogicEvaluationContext & evaluationContext,
     Replacements const & replacements,
     ScAddrUnorderedSet const & variables)
 {
-  if (outputStructure.IsValid())
+  if (evaluationContext.outputStructure.IsValid())
   {
-    for (auto const & pair : replacements)
+    for (ScAddr const & key : replacements.getKeys())
     {
-      if (variables.find(pair.first) != variables.cend())
+      if (variables.find(key) != variables.cend())
       {
-        for (auto const & replacement : pair.second)
-          addToOutputStructure(replacement);
+        for (ScAddr const & replacement : replacements.getRow(key))
+          addToOutputStructure(evaluationContext, replacement);
       }
     }
   }
 }
 
-void TemplateExpressionNode::addToOutputStructure(ScAddrUnorderedSet const & elements)
+void TemplateExpressionNode::addToOutputStructure(
+    LogicEvaluationContext & evaluationContext,
+    ScAddrUnorderedSet const & elements)
 {
-  if (outputStructure.IsValid())
+  if (evaluationContext.outputStructure.IsValid())
   {
     for (auto const & element : elements)
-      addToOutputStructure(element);
+      addToOutputStructure(evaluationContext, element);
   }
 }
 
-void TemplateExpressionNode::addToOutputStructure(ScTemplateResultItem const & item)
+void TemplateExpressionNode::addToOutputStructure(
+    LogicEvaluationContext & evaluationContext,
+    ScTemplateResultItem const & item)
 {
-  if (outputStructure.IsValid())
+  if (evaluationContext.outputStructure.IsValid())
   {
     for (size_t i = 0; i < item.Size(); ++i)
-      addToOutputStructure(item[i]);
+      addToOutputStructure(evaluationContext, item[i]);
   }
 }
 
-void TemplateExpressionNode::addToOutputStructure(ScAddr const & element)
+// Elements known by the evaluation context were added by this formula usage, the structure itself is checked for
+// elements added by previous usages or by other agents, so they are not added and reported as generated again
+void TemplateExpressionNode::addToOutputStructure(LogicEvaluationContext & evaluationContext, ScAddr const & element)
 {
-  if (outputStructureElements.find(element) == outputStructureElements.cend())
+  if (!evaluationContext.outputStructureElements.insert(element).second)
+    return;
+
+  ScMemoryContext * context = evaluationContext.context;
+  if (!context->CheckConnector(evaluationContext.outputStructure, element, ScType::EdgeAccessConstPosPerm))
   {
-    context->GenerateConnector(ScType::EdgeAccessConstPosPerm, outputStructure, element);
-    outputStructureElements.insert(element);
+    context->GenerateConnector(ScType::EdgeAccessConstPosPerm, evaluationContext.outputStructure, element);
+    evaluationContext.templateSearcher->addStructureElement(evaluationContext.outputStructure, element);
+    // Existing elements become visible to searches in structures, so they may match premises as generated ones
+    evaluationContext.generatedElements.push_back(element);
   }
 }
@@ -6,74 +6,118 @@
 
 #pragma once
 
+#include <optional>
+#include <vector>
+
 #include <sc-memory/sc_template.hpp>
 
 #include "LogicExpression.hpp"
 
 #include "searcher/templateSearcher/TemplateSearcherAbstract.hpp"
 #include "manager/templateManager/TemplateManagerAbstract.hpp"
-#include "manager/solutionTreeManager/SolutionTreeManagerAbstract.hpp"
 
 using namespace inference;
 
 class TemplateExpressionNode : public LogicExpressionNode
 {
 public:
-  TemplateExpressionNode(
-      ScMemoryContext * context,
-      std::shared_ptr<TemplateSearcherAbstract> templateSearcher,
-      std::shared_ptr<TemplateManagerAbstract> templateManager,
-      std::shared_ptr<SolutionTreeManagerAbstract> solutionTreeManager,
-      ScAddr const & outputStructure,
-      ScAddr const & formula);
+  explicit TemplateExpressionNode(ScAddr const & formula);
 
-  void compute(LogicFormulaResult & result) const override;
+  void compute(LogicEvaluationContext & evaluationContext, LogicFormulaResult & result) const override;
   // TODO: remove useless method. Use compute instead of find
-  LogicFormulaResult find(Replacements & replacements) const;
-  void generate(Replacements & replacements, LogicFormulaResult & result) override;
+  LogicFormulaResult find(
+      LogicEvaluationContext & evaluationContext,
+      FactorizedReplacements const & replacements) const;
+  void generate(
+      LogicEvaluationContext & evaluationContext,
+      FactorizedReplacements & factorizedReplacements,
+      LogicFormulaResult & result) const override;
 
-  ScAddr getFormula() const override;
+  /**
+   * @brief Search all replacements of the formula with the given params, the results limit and replacements using type
+   * of the searcher are not applied
+   */
+  void findAll(
+      LogicEvaluationContext const & evaluationContext,
+      ScTemplateParams const & params,
+      Replacements & searchResult) const;
+  /**
+   * @brief Search replacements of the formula that contain the new arcs. For each triple with a variable arc the
+   * formula is searched with source and target of each new arc bound to the triple, and only replacements where the
+   * arc variable is one of the new arcs are kept. So types of new arcs are checked by the search, and replacements
+   * without new arcs are not found again
+   * @param newArcs arcs generated or added to the output structure, `newArcsSet` contains the same arcs
+   * @param delta out param, found replacements are united with it
+   * @returns amount of searches
+   */
+  size_t findDelta(
+      LogicEvaluationContext const & evaluationContext,
+      ScAddrVector const & newArcs,
+      ScAddrUnorderedSet const & newArcsSet,
+      Replacements & delta) const;
+  /// Select arcs of the elements without duplicates in the order of the elements
+  static void selectArcs(
+      ScMemoryContext * context,
+      ScAddrVector const & elements,
+      ScAddrVector & arcs,
+      ScAddrUnorderedSet & arcsSet);
 
-private:
-  ScMemoryContext * context;
+  ScAddr getFormula() const override;
+  /// Metadata of the formula, it is read from sc-memory once for all usages of the formula
+  std::shared_ptr<FormulaMetadata const> getMetadata(LogicEvaluationContext const & evaluationContext) const;
 
-  std::shared_ptr<TemplateSearcherAbstract> templateSearcher;
-  std::unique_ptr<TemplateSearcherAbstract> templateSearcherGeneral;
-  std::shared_ptr<TemplateManagerAbstract> templateManager;
-  std::shared_ptr<SolutionTreeManagerAbstract> solutionTreeManager;
+  /**
+   * @brief Search atoms among the operands concurrently on the operands thread pool of the evaluation context, as
+   * `compute` does. Each atom is searched with its own sc-memory context and copy of the template searcher, metadata
+   * and template params of atoms are read before the search. Nothing is computed if the pool is not set or there are
+   * less than two atoms
+   * @param operands operands of a conjunction or disjunction that are computed without results of each other
+   * @param results out param, results of atoms are placed at indices of the atoms, results of other operands are empty
+   */
+  static void computeInParallel(
+      LogicEvaluationContext & evaluationContext,
+      std::vector<LogicExpressionNode const *> const & operands,
+      std::vector<std::optional<LogicFormulaResult>> & results);
 
-  ScAddr outputStructure;
+private:
   ScAddr formula;
   void generateByReplacements(
-      Replacements const & replacements,
+      LogicEvaluationContext & evaluationContext,
+      TemplateParamsStream & paramsStream,
       LogicFormulaResult & result,
       size_t & count,
       ScAddrUnorderedSet const & formulaVariables,
       Replacements & searchResult,
-      Replacements & generatedReplacements);
+      Replacements & generatedReplacements) const;
 
   void generateByParams(
+      LogicEvaluationContext & evaluationContext,
       ScTemplateParams const & params,
       ScAddrUnorderedSet const & formulaVariables,
       Replacements & generatedReplacements,
       LogicFormulaResult & result,
-      size_t & count);
+      size_t & count) const;
   void processTemplateParams(
-      vector<ScTemplateParams> const & paramsVector,
+      LogicEvaluationContext & evaluationContext,
+      ScTemplateParams const & params,
       ScAddrUnorderedSet const & formulaVariables,
       LogicFormulaResult & result,
       size_t & count,
       Replacements & searchResult,
-      Replacements & generatedReplacements);
-  Replacements getSearchResultWithoutReplacementsIfNeeded() const;
+      Replacements & generatedReplacements) const;
+  Replacements getSearchResultWithoutReplacementsIfNeeded(LogicEvaluationContext const & evaluationContext) const;
   void fillOutputStructure(
+      LogicEvaluationContext & evaluationContext,
       ScAddrUnorderedSet const & formulaVariables,
       Replacements const & replacements,
       Replacements const & resultWithoutReplacements,
-      Replacements const & searchResult);
-  void addFormulaConstantsToOutputStructure();
-  void addToOutputStructure(Replacements const & replacements, ScAddrUnorderedSet const & variables);
-  void addToOutputStructure(ScAddrUnorderedSet const & elements);
-  void addToOutputStructure(ScTemplateResultItem const & item);
-  void addToOutputStructure(ScAddr const & element);
+      Replacements const & searchResult) const;
+  void addFormulaConstantsToOutputStructure(LogicEvaluationContext & evaluationContext) const;
+  static void addToOutputStructure(
+      LogicEvaluationContext & evaluationContext,
+      Replacements const & replacements,
+      ScAddrUnorderedSet const & variables);
+  static void addToOutputStructure(LogicEvaluationContext & evaluationContext, ScAddrUnorderedSet const & elements);
+  static void addToOutputStructure(LogicEvaluationContext & evaluationContext, ScTemplateResultItem const & item);
+  static void addToOutputStructure(LogicEvaluationContext & evaluationContext, ScAddr const & element);
 };
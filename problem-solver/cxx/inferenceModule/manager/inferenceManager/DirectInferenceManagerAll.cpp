@@ -6,7 +6,14 @@
 
 #include "DirectInferenceManagerAll.hpp"
 
+#include <optional>
+#include <unordered_map>
+#include <unordered_set>
+
 #include "keynodes/InferenceKeynodes.hpp"
+#include "logic/ImplicationExpressionNode.hpp"
+#include "logic/RuleDependencyGraph.hpp"
+#include "utils/ThreadPool.hpp"
 
 using namespace inference;
 
@@ -28,17 +35,74 @@ bool DirectInferenceManagerAll::applyInference(InferenceParams const & inference
     SC_THROW_EXCEPTION(utils::ExceptionItemNotFound, "No formulas sets found.");
   }
 
-  ScAddrQueue uncheckedFormulas;
+  // Formulas are identified by their first positions in priority sets, their dependencies are found before the inference
+  RuleDependencyGraph dependencyGraph;
+  std::unordered_map<ScAddr, size_t, ScAddrHashFunc> formulasIndices;
+  for (ScAddrQueue formulas : formulasQueuesByPriority)
+  {
+    for (; !formulas.empty(); formulas.pop())
+    {
+      auto const & [formulaIndexIterator, isFirstOccurrence] =
+          formulasIndices.emplace(formulas.front(), formulasIndices.size());
+      if (!isFirstOccurrence)
+        continue;
+      std::shared_ptr<LogicExpressionNode const> const expressionRoot = prepareFormula(formulas.front());
+      if (expressionRoot)
+        dependencyGraph.addRule(
+            *templateSearcher->getFormulaMetadataCache(), formulaIndexIterator->second, *expressionRoot);
+    }
+  }
+  dependencyGraph.build();
+
+  // Premises of formulas are checked when their set is reached, and the set is skipped if none of them may be used.
+  // A formula with a premise without replacements may be used only if a formula it depends on generates elements
+  // before it, then its premise is checked again right before the formula is used
+  std::vector<ScAddr> setFormulas;
+  std::vector<bool> firingFormulas;
+  std::unordered_set<size_t> downstreamFormulasIndices;
   ScAddr formula;
   LogicFormulaResult formulaResult;
   SC_LOG_DEBUG("Start formulas applying. There is " << formulasQueuesByPriority.size() << " formulas sets");
   for (size_t formulasQueueIndex = 0; formulasQueueIndex < formulasQueuesByPriority.size(); formulasQueueIndex++)
   {
-    uncheckedFormulas = formulasQueuesByPriority[formulasQueueIndex];
-    SC_LOG_DEBUG("There is " << uncheckedFormulas.size() << " formulas in " << (formulasQueueIndex + 1) << " set");
-    while (!uncheckedFormulas.empty())
+    setFormulas.clear();
+    firingFormulas.clear();
+    downstreamFormulasIndices.clear();
+    size_t firingFormulasAmount = 0;
+    for (ScAddrQueue formulas = formulasQueuesByPriority[formulasQueueIndex]; !formulas.empty(); formulas.pop())
+    {
+      setFormulas.push_back(formulas.front());
+      firingFormulas.push_back(dependencyGraph.canFire(context, formulasIndices.at(formulas.front())));
+      firingFormulasAmount += firingFormulas.back();
+    }
+    SC_LOG_DEBUG(
+        "There is " << firingFormulasAmount << " of " << setFormulas.size() << " formulas that may be used in "
+                    << (formulasQueueIndex + 1) << " set");
+    if (firingFormulasAmount == 0)
+      continue;
+
+    if (rulesEvaluationType == RULES_IN_PARALLEL && setFormulas.size() > 1)
     {
-      formula = uncheckedFormulas.front();
+      // Premises of the set are computed before its formulas generate anything, so they are checked once
+      ScAddrQueue formulasToUse;
+      for (size_t setFormulaIndex = 0; setFormulaIndex < setFormulas.size(); ++setFormulaIndex)
+      {
+        if (firingFormulas[setFormulaIndex])
+          formulasToUse.push(setFormulas[setFormulaIndex]);
+      }
+      result |= applyFormulasInParallel(formulasToUse, inferenceParamsConfig.outputStructure);
+      continue;
+    }
+    for (size_t setFormulaIndex = 0; setFormulaIndex < setFormulas.size(); ++setFormulaIndex)
+    {
+      formula = setFormulas[setFormulaIndex];
+      size_t const formulaIndex = formulasIndices.at(formula);
+      if (!firingFormulas[setFormulaIndex] &&
+          (!downstreamFormulasIndices.count(formulaIndex) || !dependencyGraph.canFire(context, formulaIndex)))
+      {
+        SC_LOG_DEBUG("Premise of formula " << context->GetElementSystemIdentifier(formula) << " has no replacements");
+        continue;
+      }
       SC_LOG_DEBUG("Trying to generate by formula: " << context->GetElementSystemIdentifier(formula));
       formulaResult = useFormula(formula, inferenceParamsConfig.outputStructure);
       SC_LOG_DEBUG("Logical formula is " << (formulaResult.isGenerated ? "generated" : "not generated"));
@@ -46,11 +110,90 @@ bool DirectInferenceManagerAll::applyInference(InferenceParams const & inference
       {
         result = true;
         solutionTreeManager->addNode(formula, formulaResult.replacements);
+        std::vector<size_t> const & downstreamRules = dependencyGraph.getDownstreamRules(formulaIndex);
+        downstreamFormulasIndices.insert(downstreamRules.cbegin(), downstreamRules.cend());
       }
+    }
+  }
+  formulaResult.replacements = {};
+  releaseReplacementsArena();
+  logCachesStatistics();
+  return result;
+}
+
+void DirectInferenceManagerAll::setRulesEvaluationType(RulesEvaluationType type)
+{
+  rulesEvaluationType = type;
+}
+
+RulesEvaluationType DirectInferenceManagerAll::getRulesEvaluationType() const
+{
+  return rulesEvaluationType;
+}
+
+bool DirectInferenceManagerAll::applyFormulasInParallel(ScAddrQueue formulas, ScAddr const & outputStructure)
+{
+  struct FormulaUsage
+  {
+    ScAddr formula;
+    std::shared_ptr<LogicExpressionNode const> expressionRoot;
+    LogicEvaluationContext evaluationContext;
+    std::optional<LogicFormulaResult> premiseResult;
+  };
 
-      uncheckedFormulas.pop();
+  // Template managers and expression trees are prepared with the context of the manager before the tasks
+  std::vector<FormulaUsage> usages;
+  std::vector<size_t> implicationsIndices;
+  for (; !formulas.empty(); formulas.pop())
+  {
+    FormulaUsage & usage = usages.emplace_back();
+    usage.formula = formulas.front();
+    usage.expressionRoot = prepareFormula(usage.formula);
+    if (!usage.expressionRoot)
+      continue;
+    usage.evaluationContext = createEvaluationContext(outputStructure);
+    if (dynamic_cast<ImplicationExpressionNode const *>(usage.expressionRoot.get()))
+      implicationsIndices.push_back(usages.size() - 1);
+  }
+
+  SC_LOG_DEBUG("Compute premises of " << implicationsIndices.size() << " formulas in parallel");
+  ThreadPool::getShared()->parallelFor(
+      implicationsIndices.size(),
+      [&usages, &implicationsIndices](size_t implicationIndex)
+      {
+        FormulaUsage & usage = usages[implicationsIndices[implicationIndex]];
+        ScMemoryContext taskContext;
+        LogicEvaluationContext taskEvaluationContext = copyEvaluationContext(usage.evaluationContext, &taskContext);
+        auto const & implication = static_cast<ImplicationExpressionNode const &>(*usage.expressionRoot);
+        // The result is constructed in place, so it is not copied to the memory resource of the calling thread here
+        implication.computePremise(taskEvaluationContext, usage.premiseResult.emplace());
+      });
+
+  bool result = false;
+  for (FormulaUsage & usage : usages)
+  {
+    if (!usage.expressionRoot)
+      continue;
+    SC_LOG_DEBUG("Trying to generate by formula: " << context->GetElementSystemIdentifier(usage.formula));
+    LogicFormulaResult const & formulaResult = computeInArena(
+        [&usage](LogicFormulaResult & arenaFormulaResult)
+        {
+          if (usage.premiseResult)
+          {
+            auto const & implication = static_cast<ImplicationExpressionNode const &>(*usage.expressionRoot);
+            implication.generateConclusion(usage.evaluationContext, *usage.premiseResult, arenaFormulaResult);
+            // Premise tables may be changed in the arena, so they are destroyed before it is reset
+            usage.premiseResult.reset();
+          }
+          else
+            usage.expressionRoot->compute(usage.evaluationContext, arenaFormulaResult);
+        });
+    SC_LOG_DEBUG("Logical formula is " << (formulaResult.isGenerated ? "generated" : "not generated"));
+    if (formulaResult.isGenerated)
+    {
+      result = true;
+      solutionTreeManager->addNode(usage.formula, formulaResult.replacements);
     }
   }
-  formulaResult.replacements.clear();
   return result;
 }
@@ -30,5 +30,20 @@ public:
   explicit DirectInferenceManagerAll(ScMemoryContext * context);
 
   bool applyInference(InferenceParams const & inferenceParamsConfig) override;
+
+  /**
+   * Premises of implications of a priority set are computed concurrently on the shared thread pool if rules are
+   * computed in parallel, each of them with its own sc-memory context. So rules of the set do not see knowledge
+   * generated by each other. Conclusions are generated and solution tree nodes are added one by one in the order of
+   * the set. Premises are computed without the output structure
+   */
+  void setRulesEvaluationType(RulesEvaluationType type);
+  RulesEvaluationType getRulesEvaluationType() const;
+
+private:
+  RulesEvaluationType rulesEvaluationType = RULES_SEQUENTIALLY;
+
+  /// Use formulas of the priority set, premises of implications are computed in parallel
+  bool applyFormulasInParallel(ScAddrQueue formulas, ScAddr const & outputStructure);
 };
 }  // namespace inference
@@ -8,7 +8,13 @@
 
 #include "sc-agents-common/utils/IteratorUtils.hpp"
 
-#include "utils/ContainersUtils.hpp"
+#include <deque>
+#include <numeric>
+#include <set>
+#include <unordered_map>
+
+#include "logic/PremisesIndex.hpp"
+#include "logic/RuleDependencyGraph.hpp"
 #include "utils/ReplacementsUtils.hpp"
 
 using namespace inference;
@@ -43,69 +49,237 @@ bool DirectInferenceManagerTarget::applyInference(InferenceParams const & infere
   inputStructures.insert(inferenceParamsConfig.outputStructure);
   templateSearcher->setInputStructures(inputStructures);
 
-  ScAddrVector checkedFormulas;
-  ScAddrQueue uncheckedFormulas;
+  // Formulas are identified by their first positions in priority sets. Their premises are indexed and their
+  // dependencies are found before the inference
+  ScAddrVector formulas;
+  std::unordered_map<ScAddr, size_t, ScAddrHashFunc> formulasIndices;
+  std::vector<std::vector<size_t>> formulasIndicesByPriority;
+  PremisesIndex premisesIndex;
+  RuleDependencyGraph dependencyGraph;
+  for (ScAddrQueue & formulasQueue : formulasQueuesByPriority)
+  {
+    std::vector<size_t> & setFormulasIndices = formulasIndicesByPriority.emplace_back();
+    for (; !formulasQueue.empty(); formulasQueue.pop())
+    {
+      auto const & [formulaIndexIterator, isFirstOccurrence] =
+          formulasIndices.emplace(formulasQueue.front(), formulas.size());
+      setFormulasIndices.push_back(formulaIndexIterator->second);
+      if (!isFirstOccurrence)
+        continue;
+      formulas.push_back(formulasQueue.front());
+      std::shared_ptr<LogicExpressionNode const> const expressionRoot = prepareFormula(formulas.back());
+      if (!expressionRoot)
+        continue;
+      premisesIndex.addFormula(*templateSearcher->getFormulaMetadataCache(), formulas.size() - 1, *expressionRoot);
+      dependencyGraph.addRule(*templateSearcher->getFormulaMetadataCache(), formulas.size() - 1, *expressionRoot);
+    }
+  }
+  dependencyGraph.build();
+  SC_LOG_DEBUG(
+      "Formulas dependencies are found: " << formulas.size() << " formulas in "
+                                          << dependencyGraph.getComponentsAmount() << " components");
+
+  // Waiting formulas are used again if they are downstream of the formula that generated elements in the dependency
+  // graph and the premises index finds that the elements may match their premises. A rule whose premise is
+  // computed by new elements is used again only with premise replacements that have elements generated since its
+  // previous usage, so it waits for new elements after it generated something too, and each its usage adds a solution
+  // tree node only with new replacements. Other formulas are computed again with all replacements, so they wait only
+  // if they generated nothing or only unique formulas are generated. Formulas of the recursive component of the
+  // formula that generated elements are used before other formulas, so the component is used until nothing new is
+  // generated
+  std::vector<bool> computedFormulas(formulas.size());
+  std::vector<ScAddrVector> newElementsByFormula(formulas.size());
+  // Premise replacements with new elements left by the results limit, they are created out of the replacements arena
+  std::vector<Replacements> restPremisesReplacements(formulas.size());
+  std::set<size_t> waitingFormulasIndices;
+  std::set<size_t> affectedFormulasIndices;
+  std::deque<size_t> uncheckedFormulas;
 
-  ScAddr formula;
   LogicFormulaResult formulaResult;
   SC_LOG_DEBUG("Start formulas applying. There is " << formulasQueuesByPriority.size() << " formulas sets");
-  for (size_t formulasQueueIndex = 0; formulasQueueIndex < formulasQueuesByPriority.size() && !targetAchieved;
+  for (size_t formulasQueueIndex = 0; formulasQueueIndex < formulasIndicesByPriority.size() && !targetAchieved;
        formulasQueueIndex++)
   {
-    uncheckedFormulas = formulasQueuesByPriority[formulasQueueIndex];
-    SC_LOG_DEBUG("There is " << uncheckedFormulas.size() << " formulas in " << (formulasQueueIndex + 1) << " set");
+    // Formulas with premise atoms that have no replacements wait until the atoms are generated, so their premises have
+    // no replacements without new elements
+    uncheckedFormulas.clear();
+    for (size_t const formulaIndex : formulasIndicesByPriority[formulasQueueIndex])
+    {
+      if (dependencyGraph.canFire(context, formulaIndex))
+        uncheckedFormulas.push_back(formulaIndex);
+      else
+      {
+        computedFormulas[formulaIndex] = true;
+        waitingFormulasIndices.insert(formulaIndex);
+      }
+    }
+    SC_LOG_DEBUG(
+        "There is " << uncheckedFormulas.size() << " of " << formulasIndicesByPriority[formulasQueueIndex].size()
+                    << " formulas that may be used in " << (formulasQueueIndex + 1) << " set");
     while (!uncheckedFormulas.empty())
     {
-      formula = uncheckedFormulas.front();
-      SC_LOG_DEBUG("Trying to generate by formula: " << context->GetElementSystemIdentifier(formula));
-      formulaResult = useFormula(formula, inferenceParamsConfig.outputStructure);
+      size_t const formulaIndex = uncheckedFormulas.front();
+      uncheckedFormulas.pop_front();
+      ScAddr const & formula = formulas[formulaIndex];
+      std::shared_ptr<LogicExpressionNode const> const expressionRoot = prepareFormula(formula);
+      if (!expressionRoot)
+        continue;
+      LogicEvaluationContext evaluationContext = createEvaluationContext(inferenceParamsConfig.outputStructure);
+      auto const * implication = dynamic_cast<ImplicationExpressionNode const *>(expressionRoot.get());
+      bool const isComputedByNewElements = implication && implication->canComputePremiseDelta(evaluationContext);
+      bool const isDeltaComputed = isComputedByNewElements && computedFormulas[formulaIndex];
+      ScAddrVector newElements;
+      newElements.swap(newElementsByFormula[formulaIndex]);
+      Replacements & restPremiseReplacements = restPremisesReplacements[formulaIndex];
+      if (isDeltaComputed && newElements.empty() && restPremiseReplacements.empty())
+      {
+        waitingFormulasIndices.insert(formulaIndex);
+        continue;
+      }
+
+      SC_LOG_DEBUG(
+          "Trying to generate by formula: " << context->GetElementSystemIdentifier(formula)
+                                            << (isDeltaComputed ? " with new elements" : ""));
+      formulaResult = computeInArena(
+          [&](LogicFormulaResult & result)
+          {
+            if (isDeltaComputed)
+            {
+              LogicFormulaResult premiseResult;
+              implication->computePremiseDelta(evaluationContext, newElements, premiseResult);
+              takePremiseReplacements(evaluationContext.resultsLimit, restPremiseReplacements, premiseResult);
+              implication->generateConclusion(evaluationContext, premiseResult, result);
+            }
+            else
+              expressionRoot->compute(evaluationContext, result);
+          });
+      computedFormulas[formulaIndex] = true;
       SC_LOG_DEBUG("Logical formula is " << (formulaResult.isGenerated ? "generated" : "not generated"));
+
+      if (!restPremiseReplacements.empty())
+        uncheckedFormulas.push_back(formulaIndex);
+      else if (
+          isComputedByNewElements || !formulaResult.isGenerated ||
+          templateManager->getGenerationType() == GENERATE_UNIQUE_FORMULAS)
+        waitingFormulasIndices.insert(formulaIndex);
       if (formulaResult.isGenerated)
       {
         solutionTreeManager->addNode(formula, formulaResult.replacements);
         // We need to check target with result generated replacements, not with input
-        std::vector<ScTemplateParams> paramsVector;
-        ReplacementsUtils::getReplacementsToScTemplateParams(formulaResult.replacements, paramsVector);
-        targetAchieved = isTargetAchieved(paramsVector);
+        targetAchieved = isTargetAchieved(formulaResult.replacements);
         if (targetAchieved)
         {
           SC_LOG_DEBUG("Target is achieved");
           break;
         }
-        else
-        {
-          ContainersUtils::addToQueue(checkedFormulas, uncheckedFormulas);
-          formulasQueueIndex = 0;
-          checkedFormulas.clear();
-        }
       }
-      else
+      // Formula that generated nothing may add existing constructions to the output structure
+      if (evaluationContext.generatedElements.empty())
+        continue;
+
+      affectedFormulasIndices.clear();
+      premisesIndex.findAffectedFormulas(context, evaluationContext.generatedElements, affectedFormulasIndices);
+      std::vector<size_t> const & downstreamFormulasIndices = dependencyGraph.getDownstreamRules(formulaIndex);
+      std::vector<size_t> componentFormulasIndices;
+      size_t scheduledFormulasAmount = 0;
+      for (size_t const downstreamFormulaIndex : downstreamFormulasIndices)
       {
-        checkedFormulas.push_back(formula);
+        if (!affectedFormulasIndices.count(downstreamFormulaIndex))
+          continue;
+        // Formulas that are not computed yet are computed with all elements
+        if (computedFormulas[downstreamFormulaIndex])
+        {
+          ScAddrVector & downstreamFormulaNewElements = newElementsByFormula[downstreamFormulaIndex];
+          downstreamFormulaNewElements.insert(
+              downstreamFormulaNewElements.cend(),
+              evaluationContext.generatedElements.cbegin(),
+              evaluationContext.generatedElements.cend());
+        }
+        if (!waitingFormulasIndices.erase(downstreamFormulaIndex))
+          continue;
+        ++scheduledFormulasAmount;
+        if (dependencyGraph.isRecursive(formulaIndex) &&
+            dependencyGraph.getComponent(downstreamFormulaIndex) == dependencyGraph.getComponent(formulaIndex))
+          componentFormulasIndices.push_back(downstreamFormulaIndex);
+        else
+          uncheckedFormulas.push_back(downstreamFormulaIndex);
       }
-
-      uncheckedFormulas.pop();
+      uncheckedFormulas.insert(
+          uncheckedFormulas.cbegin(), componentFormulasIndices.cbegin(), componentFormulasIndices.cend());
+      SC_LOG_DEBUG(
+          "Generated elements may match premises of " << affectedFormulasIndices.size() << " of "
+                                                      << premisesIndex.getFormulasAmount() << " formulas and "
+                                                      << downstreamFormulasIndices.size()
+                                                      << " formulas are downstream, " << scheduledFormulasAmount
+                                                      << " waiting formulas are used again, "
+                                                      << componentFormulasIndices.size()
+                                                      << " of them of the recursive component are used first");
     }
   }
 
+  releaseReplacementsArena();
+  logCachesStatistics();
   return targetAchieved;
 }
 
+// Replacements left by the limit before are taken first, the rest of them are copied to the table out of the arena
+void DirectInferenceManagerTarget::takePremiseReplacements(
+    size_t resultsLimit,
+    Replacements & restPremiseReplacements,
+    LogicFormulaResult & premiseResult)
+{
+  Replacements premiseReplacements;
+  ReplacementsUtils::uniteReplacements(
+      restPremiseReplacements, premiseResult.replacements.materialize(), premiseReplacements);
+  size_t const columnsAmount = ReplacementsUtils::getColumnsAmount(premiseReplacements);
+  if (resultsLimit != 0 && columnsAmount > resultsLimit)
+  {
+    std::vector<size_t> restColumns(columnsAmount - resultsLimit);
+    std::iota(restColumns.begin(), restColumns.end(), resultsLimit);
+    restPremiseReplacements = premiseReplacements;
+    restPremiseReplacements.keepColumns(restColumns);
+    premiseReplacements.resize(resultsLimit);
+  }
+  else
+    restPremiseReplacements.clear();
+  premiseResult.replacements = FactorizedReplacements(std::move(premiseReplacements));
+  premiseResult.value = !premiseResult.replacements.empty();
+}
+
 void DirectInferenceManagerTarget::setTargetStructure(ScAddr const & otherTargetStructure)
 {
   targetStructure = otherTargetStructure;
 }
 
 bool DirectInferenceManagerTarget::isTargetAchieved(std::vector<ScTemplateParams> const & templateParamsVector)
+{
+  return searchTarget(
+      [this, &templateParamsVector](ScAddrUnorderedSet const & variables, Replacements & result)
+      {
+        templateSearcher->searchTemplate(targetStructure, templateParamsVector, variables, result);
+      });
+}
+
+// Replacements are projected to the target variables, so the target is searched once per distinct binding of them
+bool DirectInferenceManagerTarget::isTargetAchieved(FactorizedReplacements const & replacements)
+{
+  return searchTarget(
+      [this, &replacements](ScAddrUnorderedSet const & variables, Replacements & result)
+      {
+        templateSearcher->searchTemplateByDistinctBindings(targetStructure, replacements, variables, result);
+      });
+}
+
+// One result is enough to achieve the target, so the search stops at the first binding that achieves it
+bool DirectInferenceManagerTarget::searchTarget(
+    std::function<void(ScAddrUnorderedSet const &, Replacements &)> const & search)
 {
   ScAddrUnorderedSet variables;
   templateSearcher->getVariables(targetStructure, variables);
-  return std::any_of(
-      templateParamsVector.cbegin(),
-      templateParamsVector.cend(),
-      [this, &variables](ScTemplateParams const & templateParams) -> bool {
-        Replacements result;
-        templateSearcher->searchTemplate(targetStructure, templateParams, variables, result);
-        return !result.empty();
-      });
+  size_t const searcherResultsLimit = templateSearcher->getResultsLimit();
+  templateSearcher->setResultsLimit(1);
+  Replacements result;
+  search(variables, result);
+  templateSearcher->setResultsLimit(searcherResultsLimit);
+  return !result.empty();
 }
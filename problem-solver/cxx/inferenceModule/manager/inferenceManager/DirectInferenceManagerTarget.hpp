@@ -6,11 +6,14 @@
 
 #pragma once
 
+#include <functional>
+
 #include "InferenceManagerAbstract.hpp"
 
 #include "sc-memory/sc_memory.hpp"
 #include "sc-memory/sc_addr.hpp"
 
+#include "logic/ImplicationExpressionNode.hpp"
 #include "logic/LogicExpressionNode.hpp"
 
 namespace inference
@@ -29,5 +32,22 @@ protected:
   void setTargetStructure(ScAddr const & otherTargetStructure);
 
   bool isTargetAchieved(std::vector<ScTemplateParams> const & templateParamsVector);
+  bool isTargetAchieved(FactorizedReplacements const & replacements);
+
+private:
+  /**
+   * @brief Take premise replacements with new elements by the results limit
+   * @param restPremiseReplacements replacements left by the limit at the previous usage of the rule, replacements that
+   * are not taken now are placed here
+   * @param premiseResult result of `ImplicationExpressionNode::computePremiseDelta`, its replacements are replaced by
+   * the taken ones
+   */
+  static void takePremiseReplacements(
+      size_t resultsLimit,
+      Replacements & restPremiseReplacements,
+      LogicFormulaResult & premiseResult);
+
+  /// Search the target with the given search function until the first result is found
+  bool searchTarget(std::function<void(ScAddrUnorderedSet const &, Replacements &)> const & search);
 };
 }  // namespace inference
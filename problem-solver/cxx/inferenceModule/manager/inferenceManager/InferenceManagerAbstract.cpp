@@ -11,13 +11,17 @@
 #include "sc-agents-common/utils/IteratorUtils.hpp"
 
 #include "manager/templateManager/TemplateManagerFixedArguments.hpp"
+#include "searcher/templateSearcher/TemplateSearcherGeneral.hpp"
 #include "utils/ContainersUtils.hpp"
+#include "utils/ThreadPool.hpp"
 #include "logic/LogicExpression.hpp"
 
 using namespace inference;
 
 InferenceManagerAbstract::InferenceManagerAbstract(ScMemoryContext * context)
   : context(context)
+  , compiledRulesCache(CompiledRulesCache::getShared())
+  , conjunctionPlanner(std::make_shared<ConjunctionPlanner>())
 {
 }
 
@@ -41,6 +45,77 @@ std::shared_ptr<SolutionTreeManagerAbstract> InferenceManagerAbstract::getSoluti
   return solutionTreeManager;
 }
 
+void InferenceManagerAbstract::setCompiledRulesCache(std::shared_ptr<CompiledRulesCache> cache)
+{
+  compiledRulesCache = std::move(cache);
+}
+
+std::shared_ptr<CompiledRulesCache> const & InferenceManagerAbstract::getCompiledRulesCache() const
+{
+  return compiledRulesCache;
+}
+
+void InferenceManagerAbstract::setResultsLimit(size_t limit)
+{
+  resultsLimit = limit;
+}
+
+size_t InferenceManagerAbstract::getResultsLimit() const
+{
+  return resultsLimit;
+}
+
+void InferenceManagerAbstract::setOperandsEvaluationType(OperandsEvaluationType type)
+{
+  operandsEvaluationType = type;
+}
+
+OperandsEvaluationType InferenceManagerAbstract::getOperandsEvaluationType() const
+{
+  return operandsEvaluationType;
+}
+
+std::shared_ptr<ConjunctionPlanner> const & InferenceManagerAbstract::getConjunctionPlanner() const
+{
+  return conjunctionPlanner;
+}
+
+ReplacementsArena::Statistics const & InferenceManagerAbstract::getReplacementsArenaStatistics() const
+{
+  return replacementsArena.getStatistics();
+}
+
+void InferenceManagerAbstract::releaseReplacementsArena()
+{
+  ReplacementsArena::Statistics const & statistics = replacementsArena.getStatistics();
+  SC_LOG_DEBUG(
+      "Replacements arena: " << statistics.allocationsAmount << " allocations of " << statistics.allocatedBytes
+                             << " bytes for " << statistics.resetsAmount << " formulas, at most "
+                             << statistics.maxFormulaAllocatedBytes << " bytes per formula");
+  replacementsArena.release();
+}
+
+void InferenceManagerAbstract::logCachesStatistics() const
+{
+  FormulaMetadataCache::Statistics const & statistics =
+      templateSearcher->getFormulaMetadataCache()->getStatistics();
+  SC_LOG_DEBUG(
+      "Formula metadata cache: " << statistics.hitsAmount << " hits, " << statistics.missesAmount << " misses, "
+                                 << statistics.invalidationsAmount << " invalidations");
+  if (compiledRulesCache)
+  {
+    CompiledRulesCache::Statistics const & rulesStatistics = compiledRulesCache->getStatistics();
+    SC_LOG_DEBUG(
+        "Compiled rules cache: " << rulesStatistics.hitsAmount << " hits, " << rulesStatistics.missesAmount
+                                 << " misses, " << rulesStatistics.invalidationsAmount << " invalidations");
+  }
+  ConjunctionPlanner::Statistics const & plannerStatistics = conjunctionPlanner->getStatistics();
+  SC_LOG_DEBUG(
+      "Conjunction planner: " << plannerStatistics.reorderedPlansAmount << " of " << plannerStatistics.plansAmount
+                              << " plans reordered, " << plannerStatistics.boundSearchesAmount
+                              << " atoms searched with bindings");
+}
+
 vector<ScAddrQueue> InferenceManagerAbstract::createFormulasQueuesListByPriority(ScAddr const & formulasSet)
 {
   vector<ScAddrQueue> formulasQueuesList;
@@ -71,12 +146,28 @@ ScAddrQueue InferenceManagerAbstract::createQueue(ScAddr const & set)
  * @returns LogicFormulaResult {bool: value, bool: isGenerated, Replacements: replacements}
  */
 LogicFormulaResult InferenceManagerAbstract::useFormula(ScAddr const & formula, ScAddr const & outputStructure)
+{
+  std::shared_ptr<LogicExpressionNode const> const expressionRoot = prepareFormula(formula);
+  if (!expressionRoot)
+  {
+    return {false, false, {}};
+  }
+
+  LogicEvaluationContext evaluationContext = createEvaluationContext(outputStructure);
+  return computeInArena(
+      [&expressionRoot, &evaluationContext](LogicFormulaResult & result)
+      {
+        expressionRoot->compute(evaluationContext, result);
+      });
+}
+
+std::shared_ptr<LogicExpressionNode const> InferenceManagerAbstract::prepareFormula(ScAddr const & formula)
 {
   ScAddr const & formulaRoot =
       utils::IteratorUtils::getAnyByOutRelation(context, formula, ScKeynodes::rrel_main_key_sc_element);
   if (!formulaRoot.IsValid())
   {
-    return {false, false, {}};
+    return nullptr;
   }
 
   // Choose template manager according to the formula specification (if fixed arguments exist)
@@ -90,15 +181,58 @@ LogicFormulaResult InferenceManagerAbstract::useFormula(ScAddr const & formula,
     resetTemplateManager(std::make_shared<TemplateManager>(context));
   }
 
-  LogicExpression logicExpression(context, templateSearcher, templateManager, solutionTreeManager, outputStructure);
+  if (compiledRulesCache)
+  {
+    return compiledRulesCache->getExpression(context, templateSearcher->getFormulaMetadataCache(), formulaRoot);
+  }
+  LogicExpression logicExpression(context, templateSearcher->getFormulaMetadataCache());
+  return logicExpression.build(formulaRoot);
+}
 
-  std::shared_ptr<LogicExpressionNode> expressionRoot = logicExpression.build(formulaRoot);
-  expressionRoot->setArgumentVector(templateManager->getArguments());
-  expressionRoot->setOutputStructureElements(outputStructureElements);
+LogicEvaluationContext InferenceManagerAbstract::createEvaluationContext(ScAddr const & outputStructure) const
+{
+  LogicEvaluationContext evaluationContext;
+  evaluationContext.context = context;
+  evaluationContext.templateSearcher = templateSearcher;
+  evaluationContext.templateSearcherGeneral = createTemplateSearcherGeneral();
+  evaluationContext.templateManager = templateManager;
+  evaluationContext.outputStructure = outputStructure;
+  evaluationContext.argumentVector = templateManager->getArguments();
+  evaluationContext.outputStructureElements = outputStructureElements;
+  evaluationContext.conjunctionPlanner = conjunctionPlanner;
+  evaluationContext.resultsLimit = resultsLimit;
+  if (operandsEvaluationType == OPERANDS_IN_PARALLEL)
+    evaluationContext.operandsThreadPool = ThreadPool::getShared();
+  return evaluationContext;
+}
 
-  LogicFormulaResult formulaResult;
-  expressionRoot->compute(formulaResult);
+LogicEvaluationContext InferenceManagerAbstract::copyEvaluationContext(
+    LogicEvaluationContext const & evaluationContext,
+    ScMemoryContext * otherContext)
+{
+  LogicEvaluationContext evaluationContextCopy;
+  evaluationContextCopy.context = otherContext;
+  evaluationContextCopy.templateSearcher = evaluationContext.templateSearcher->copy(otherContext);
+  evaluationContextCopy.templateSearcherGeneral = evaluationContext.templateSearcherGeneral->copy(otherContext);
+  evaluationContextCopy.templateManager = evaluationContext.templateManager->copy(otherContext);
+  evaluationContextCopy.argumentVector = evaluationContext.argumentVector;
+  evaluationContextCopy.conjunctionPlanner = evaluationContext.conjunctionPlanner;
+  evaluationContextCopy.resultsLimit = evaluationContext.resultsLimit;
+  evaluationContextCopy.operandsThreadPool = evaluationContext.operandsThreadPool;
+  return evaluationContextCopy;
+}
 
+LogicFormulaResult InferenceManagerAbstract::computeInArena(std::function<void(LogicFormulaResult &)> const & compute)
+{
+  LogicFormulaResult arenaFormulaResult;
+  replacementsArena.reset();
+  {
+    ReplacementsArena::Scope const arenaScope(replacementsArena);
+    compute(arenaFormulaResult);
+  }
+
+  // Factors of the result are copied after the arena scope is closed, so they are copied to the default memory resource
+  LogicFormulaResult formulaResult = arenaFormulaResult;
   return formulaResult;
 }
 
@@ -142,6 +276,17 @@ void InferenceManagerAbstract::resetTemplateManager(std::shared_ptr<TemplateMana
   otherTemplateManager->setFillingType(templateManager->getFillingType());
   templateManager = std::move(otherTemplateManager);
 }
+
+/// Searcher of atomic formulas before their generation, it reads formulas metadata from the cache of `templateSearcher`
+std::shared_ptr<TemplateSearcherAbstract> InferenceManagerAbstract::createTemplateSearcherGeneral() const
+{
+  std::shared_ptr<TemplateSearcherAbstract> templateSearcherGeneral =
+      std::make_shared<TemplateSearcherGeneral>(context, templateSearcher->getFormulaMetadataCache());
+  templateSearcherGeneral->setReplacementsUsingType(templateSearcher->getReplacementsUsingType());
+  templateSearcherGeneral->setOutputStructureFillingType(templateSearcher->getOutputStructureFillingType());
+  return templateSearcherGeneral;
+}
+
 InferenceManagerAbstract::~InferenceManagerAbstract()
 {
   outputStructureElements.clear();
@@ -6,14 +6,19 @@
 
 #pragma once
 
+#include <functional>
+
 #include "sc-memory/sc_memory.hpp"
 #include "sc-memory/sc_addr.hpp"
 
 #include "searcher/templateSearcher/TemplateSearcherAbstract.hpp"
 #include "manager/solutionTreeManager/SolutionTreeManager.hpp"
 #include "manager/templateManager/TemplateManager.hpp"
+#include "logic/CompiledRulesCache.hpp"
+#include "logic/ConjunctionPlanner.hpp"
 #include "logic/LogicExpressionNode.hpp"
 #include "inferenceConfig/InferenceConfig.hpp"
+#include "utils/ReplacementsArena.hpp"
 
 namespace inference
 {
@@ -33,6 +38,24 @@ public:
 
   std::shared_ptr<SolutionTreeManagerAbstract> getSolutionTreeManager();
 
+  /// Use expression trees of another cache, managers use `CompiledRulesCache::getShared()` by default
+  void setCompiledRulesCache(std::shared_ptr<CompiledRulesCache> cache);
+  std::shared_ptr<CompiledRulesCache> const & getCompiledRulesCache() const;
+
+  /// Use only the given amount of replacements of each rule premise, all of them are used if it is 0
+  void setResultsLimit(size_t limit);
+  size_t getResultsLimit() const;
+
+  /// Search atoms of conjunctions and disjunctions on threads of the shared pool if operands are computed in parallel
+  void setOperandsEvaluationType(OperandsEvaluationType type);
+  OperandsEvaluationType getOperandsEvaluationType() const;
+
+  /// Planner of conjunctions used by all formulas of the manager, it remembers amounts of atoms replacements
+  std::shared_ptr<ConjunctionPlanner> const & getConjunctionPlanner() const;
+
+  /// Returns statistics of replacements allocations of formulas used since the last inference end
+  ReplacementsArena::Statistics const & getReplacementsArenaStatistics() const;
+
   /**
    * @brief Iterate over formulas set and use formulas to generate knowledge
    * @param formulasSet is an oriented set of formulas sets to apply
@@ -43,6 +66,10 @@ public:
   virtual bool applyInference(InferenceParams const & inferenceParamsConfig) = 0;
 
   // TODO: Need to implement common logic of inference rules (e.g. modus ponens)
+  /**
+   * Expression tree of the formula is taken from the compiled rules cache if it is set, otherwise it is built.
+   * Replacements created while the formula is used are allocated in the arena, the result is copied out of it
+   */
   LogicFormulaResult useFormula(ScAddr const & formula, ScAddr const & outputStructure);
 
   void fillFormulaFixedArgumentsIdentifiers(ScAddr const & formula, ScAddr const & firstFixedArgument) const;
@@ -60,7 +87,39 @@ protected:
   std::shared_ptr<TemplateManagerAbstract> templateManager;
   std::shared_ptr<TemplateSearcherAbstract> templateSearcher;
   std::shared_ptr<SolutionTreeManagerAbstract> solutionTreeManager;
+  std::shared_ptr<CompiledRulesCache> compiledRulesCache;
+  std::shared_ptr<ConjunctionPlanner> conjunctionPlanner;
+  size_t resultsLimit = 0;
+  OperandsEvaluationType operandsEvaluationType = OPERANDS_SEQUENTIALLY;
 
   std::unordered_set<ScAddr, ScAddrHashFunc> outputStructureElements;
+
+  /**
+   * @brief Choose template manager of the formula and get its expression tree, it is built if there is no rules cache
+   * @returns root of the expression tree or nullptr if the formula has no main key element
+   */
+  std::shared_ptr<LogicExpressionNode const> prepareFormula(ScAddr const & formula);
+  /// Usage state of the formula prepared last, it is computed with the context of the manager
+  LogicEvaluationContext createEvaluationContext(ScAddr const & outputStructure) const;
+  /**
+   * @brief Create usage state with copies of searchers and template manager that use another context, so the formula
+   * may be computed concurrently with other formulas. The copy has no output structure
+   */
+  static LogicEvaluationContext copyEvaluationContext(
+      LogicEvaluationContext const & evaluationContext,
+      ScMemoryContext * otherContext);
+  /// Compute the formula with replacements allocated in the arena, the result is copied out of it
+  LogicFormulaResult computeInArena(std::function<void(LogicFormulaResult &)> const & compute);
+
+  /// Log allocations statistics and free memory of the arena, must be called at the end of `applyInference`
+  void releaseReplacementsArena();
+  /// Log how many times formulas metadata and expression trees were taken from caches and how many were read, and
+  /// how many conjunctions were reordered
+  void logCachesStatistics() const;
+
+private:
+  ReplacementsArena replacementsArena;
+
+  std::shared_ptr<TemplateSearcherAbstract> createTemplateSearcherGeneral() const;
 };
 }  // namespace inference
@@ -0,0 +1,141 @@
+/*
+ * This source file is part of an OSTIS project. For the latest info, see http://ostis.net
+ * Distributed under the MIT License
+ * (See accompanying file COPYING.MIT or copy at http://opensource.org/licenses/MIT)
+ */
+
+#include "ReteInferenceManager.hpp"
+
+#include <set>
+
+#include "logic/ImplicationExpressionNode.hpp"
+#include "logic/PremisesIndex.hpp"
+#include "logic/ReteNetwork.hpp"
+
+using namespace inference;
+
+ReteInferenceManager::ReteInferenceManager(ScMemoryContext * context)
+  : InferenceManagerAbstract(context)
+{
+}
+
+bool ReteInferenceManager::applyInference(InferenceParams const & inferenceParamsConfig)
+{
+  struct FormulaUsage
+  {
+    ScAddr formula;
+    std::shared_ptr<LogicExpressionNode const> expressionRoot;
+    bool isInNetwork = false;
+  };
+
+  templateManager->setArguments(inferenceParamsConfig.arguments);
+  templateSearcher->setInputStructures(inferenceParamsConfig.inputStructures);
+
+  vector<ScAddrQueue> formulasQueuesByPriority = createFormulasQueuesListByPriority(inferenceParamsConfig.formulasSet);
+  if (formulasQueuesByPriority.empty())
+  {
+    SC_THROW_EXCEPTION(utils::ExceptionItemNotFound, "No formulas sets found.");
+  }
+
+  // Extend input structures with output structure, so premises are matched with generated elements
+  ScAddrUnorderedSet inputStructures = templateSearcher->getInputStructures();
+  inputStructures.insert(inferenceParamsConfig.outputStructure);
+  templateSearcher->setInputStructures(inputStructures);
+
+  // Formulas are identified by their positions in priority sets, formulas waiting for usage are ordered by them
+  std::vector<FormulaUsage> usages;
+  for (ScAddrQueue & formulas : formulasQueuesByPriority)
+  {
+    for (; !formulas.empty(); formulas.pop())
+      usages.emplace_back().formula = formulas.front();
+  }
+
+  ReteNetwork network;
+  PremisesIndex premisesIndex;
+  std::set<size_t> formulasToUse;
+  for (size_t formulaIndex = 0; formulaIndex < usages.size(); ++formulaIndex)
+  {
+    FormulaUsage & usage = usages[formulaIndex];
+    usage.expressionRoot = prepareFormula(usage.formula);
+    if (!usage.expressionRoot)
+      continue;
+    // Formulas used with arguments are searched with template params, so their replacements are not kept
+    LogicEvaluationContext const & evaluationContext = createEvaluationContext(inferenceParamsConfig.outputStructure);
+    usage.isInNetwork = evaluationContext.argumentVector.empty() &&
+                        network.addRule(evaluationContext, formulaIndex, usage.expressionRoot);
+    if (!usage.isInNetwork)
+      premisesIndex.addFormula(*templateSearcher->getFormulaMetadataCache(), formulaIndex, *usage.expressionRoot);
+    formulasToUse.insert(formulaIndex);
+  }
+  ReteNetwork::Statistics const & compiledStatistics = network.getStatistics();
+  SC_LOG_DEBUG(
+      "Start formulas applying. " << compiledStatistics.rulesAmount << " of " << usages.size()
+                                  << " formulas are compiled to the network with "
+                                  << compiledStatistics.alphaMemoriesAmount << " atoms");
+
+  bool result = false;
+  std::set<size_t> waitingFormulasIndices;
+  std::set<size_t> affectedFormulasIndices;
+  while (!formulasToUse.empty())
+  {
+    size_t const formulaIndex = *formulasToUse.begin();
+    formulasToUse.erase(formulasToUse.begin());
+    FormulaUsage const & usage = usages[formulaIndex];
+    // Network is changed out of the arena, because its memories are kept between formulas usages. Only the limited
+    // amount of premise replacements is taken, so the rule is used again with the rest of them
+    Replacements premiseReplacements;
+    if (usage.isInNetwork && !network.takeActivation(formulaIndex, resultsLimit, premiseReplacements))
+      continue;
+    if (usage.isInNetwork && network.hasActivation(formulaIndex))
+      formulasToUse.insert(formulaIndex);
+
+    SC_LOG_DEBUG("Trying to generate by formula: " << context->GetElementSystemIdentifier(usage.formula));
+    // Template manager of the formula is chosen again, because it is replaced by other formulas
+    prepareFormula(usage.formula);
+    LogicEvaluationContext evaluationContext = createEvaluationContext(inferenceParamsConfig.outputStructure);
+    LogicFormulaResult const & formulaResult = computeInArena(
+        [&usage, &premiseReplacements, &evaluationContext](LogicFormulaResult & arenaFormulaResult)
+        {
+          if (!usage.isInNetwork)
+          {
+            usage.expressionRoot->compute(evaluationContext, arenaFormulaResult);
+            return;
+          }
+          LogicFormulaResult premiseResult;
+          premiseResult.value = true;
+          premiseResult.replacements = FactorizedReplacements(premiseReplacements);
+          auto const & implication = static_cast<ImplicationExpressionNode const &>(*usage.expressionRoot);
+          implication.generateConclusion(evaluationContext, premiseResult, arenaFormulaResult);
+        });
+    SC_LOG_DEBUG("Logical formula is " << (formulaResult.isGenerated ? "generated" : "not generated"));
+
+    if (!usage.isInNetwork &&
+        (!formulaResult.isGenerated || templateManager->getGenerationType() == GENERATE_UNIQUE_FORMULAS))
+      waitingFormulasIndices.insert(formulaIndex);
+    if (formulaResult.isGenerated)
+    {
+      result = true;
+      solutionTreeManager->addNode(usage.formula, formulaResult.replacements);
+    }
+    // Formula that generated nothing may add existing constructions to the output structure
+    if (evaluationContext.generatedElements.empty())
+      continue;
+
+    network.update(evaluationContext, evaluationContext.generatedElements, formulasToUse);
+    affectedFormulasIndices.clear();
+    premisesIndex.findAffectedFormulas(context, evaluationContext.generatedElements, affectedFormulasIndices);
+    for (size_t const affectedFormulaIndex : affectedFormulasIndices)
+    {
+      if (waitingFormulasIndices.erase(affectedFormulaIndex))
+        formulasToUse.insert(affectedFormulaIndex);
+    }
+  }
+
+  ReteNetwork::Statistics const & statistics = network.getStatistics();
+  SC_LOG_DEBUG(
+      "Rete network: " << statistics.deltaSearchesAmount << " atoms searched with generated arcs, "
+                       << statistics.activatedReplacementsAmount << " premise replacements passed to rules");
+  releaseReplacementsArena();
+  logCachesStatistics();
+  return result;
+}
@@ -0,0 +1,32 @@
+/*
+ * This source file is part of an OSTIS project. For the latest info, see http://ostis.net
+ * Distributed under the MIT License
+ * (See accompanying file COPYING.MIT or copy at http://opensource.org/licenses/MIT)
+ */
+
+#pragma once
+
+#include "InferenceManagerAbstract.hpp"
+
+#include "sc-memory/sc_memory.hpp"
+#include "sc-memory/sc_addr.hpp"
+
+#include "logic/LogicExpressionNode.hpp"
+
+namespace inference
+{
+/**
+ * Inference manager that uses formulas until nothing new can be generated by them. Premises of rules used without
+ * arguments are compiled to `ReteNetwork` once per inference, and a rule is used again only with premise replacements
+ * that appeared after its previous usage. Other formulas are computed by their expression trees and are used again
+ * only if generated elements may match their premises. Formulas waiting for usage are used in the order of priority
+ * sets, so a formula of a higher priority set is used first after each generation.
+ */
+class ReteInferenceManager : public InferenceManagerAbstract
+{
+public:
+  explicit ReteInferenceManager(ScMemoryContext * context);
+
+  bool applyInference(InferenceParams const & inferenceParamsConfig) override;
+};
+}  // namespace inference
@@ -4,7 +4,7 @@
  * (See accompanying file COPYING.MIT or copy at http://opensource.org/licenses/MIT)
  */
 
-#include "utils/ReplacementsUtils.hpp"
+#include "utils/TemplateParamsStream.hpp"
 
 #include "SolutionTreeManager.hpp"
 
@@ -15,14 +15,13 @@ SolutionTreeManager::SolutionTreeManager(ScMemoryContext * context)
 {
 }
 
-bool SolutionTreeManager::addNode(ScAddr const & formula, Replacements const & replacements)
+bool SolutionTreeManager::addNode(ScAddr const & formula, FactorizedReplacements const & replacements)
 {
-  std::vector<ScTemplateParams> templateParamsVector;
-  ReplacementsUtils::getReplacementsToScTemplateParams(replacements, templateParamsVector);
-  ScAddrUnorderedSet variables;
-  ReplacementsUtils::getKeySet(replacements, variables);
+  ScAddrUnorderedSet const variables(replacements.getKeys().cbegin(), replacements.getKeys().cend());
   bool result = true;
-  for (ScTemplateParams const & templateParams : templateParamsVector)
+  TemplateParamsStream templateParamsStream(replacements);
+  ScTemplateParams templateParams;
+  while (templateParamsStream.next(templateParams))
     result &= solutionTreeGenerator->addNode(formula, templateParams, variables);
   return result;
 }
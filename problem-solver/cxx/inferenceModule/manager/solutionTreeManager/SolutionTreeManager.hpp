@@ -21,7 +21,7 @@ class SolutionTreeManager : public SolutionTreeManagerAbstract
 public:
   explicit SolutionTreeManager(ScMemoryContext * context);
 
-  bool addNode(ScAddr const & formula, Replacements const & replacements) override;
+  bool addNode(ScAddr const & formula, FactorizedReplacements const & replacements) override;
 };
 
 }  // namespace inference
@@ -13,6 +13,7 @@
 
 #include "generator/SolutionTreeGenerator.hpp"
 #include "searcher/solutionTreeSearcher/SolutionTreeSearcher.hpp"
+#include "utils/FactorizedReplacements.hpp"
 #include "utils/Types.hpp"
 
 namespace inference
@@ -25,7 +26,7 @@ public:
 
   virtual ~SolutionTreeManagerAbstract() = default;
 
-  virtual bool addNode(ScAddr const & formula, Replacements const & replacements) = 0;
+  virtual bool addNode(ScAddr const & formula, FactorizedReplacements const & replacements) = 0;
 
   ScAddr createSolution(ScAddr const & outputStructure, bool targetAchieved);
 
@@ -21,7 +21,7 @@ class SolutionTreeManagerEmpty : public SolutionTreeManagerAbstract
 public:
   explicit SolutionTreeManagerEmpty(ScMemoryContext * context);
 
-  bool addNode(ScAddr const & formula, Replacements const & replacements) override;
+  bool addNode(ScAddr const & formula, FactorizedReplacements const & replacements) override;
 };
 
 }  // namespace inference
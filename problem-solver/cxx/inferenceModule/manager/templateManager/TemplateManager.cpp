@@ -15,6 +15,13 @@ TemplateManager::TemplateManager(ScMemoryContext * ms_context)
 {
 }
 
+std::unique_ptr<TemplateManagerAbstract> TemplateManager::copy(ScMemoryContext * otherContext) const
+{
+  auto manager = std::make_unique<TemplateManager>(*this);
+  manager->context = otherContext;
+  return manager;
+}
+
 /**
  * For all classes of the all template variables create map <varName, arguments>
  * Where arguments are elements from argumentList, and each argument class is the same as variable varName class
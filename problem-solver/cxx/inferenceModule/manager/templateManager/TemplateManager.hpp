@@ -8,6 +8,7 @@
 
 #include "TemplateManagerAbstract.hpp"
 
+#include <memory>
 #include <vector>
 
 #include "sc-memory/sc_memory.hpp"
@@ -20,5 +21,7 @@ public:
   explicit TemplateManager(ScMemoryContext * ms_context);
 
   std::vector<ScTemplateParams> createTemplateParams(ScAddr const & scTemplate) override;
+
+  std::unique_ptr<TemplateManagerAbstract> copy(ScMemoryContext * otherContext) const override;
 };
 }  // namespace inference
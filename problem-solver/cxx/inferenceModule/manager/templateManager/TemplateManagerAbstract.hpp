@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include <memory>
 #include <vector>
 
 #include "sc-memory/sc_memory.hpp"
@@ -30,6 +31,9 @@ public:
 
   virtual std::vector<ScTemplateParams> createTemplateParams(ScAddr const & scTemplate) = 0;
 
+  /// Create a manager with the same settings and arguments that reads templates with another context
+  virtual std::unique_ptr<TemplateManagerAbstract> copy(ScMemoryContext * otherContext) const = 0;
+
   void addFixedArgument(ScAddr const & fixedArgument)
   {
     fixedArguments.push_back(fixedArgument);
@@ -15,6 +15,13 @@ TemplateManagerFixedArguments::TemplateManagerFixedArguments(ScMemoryContext * c
 {
 }
 
+std::unique_ptr<TemplateManagerAbstract> TemplateManagerFixedArguments::copy(ScMemoryContext * otherContext) const
+{
+  auto manager = std::make_unique<TemplateManagerFixedArguments>(*this);
+  manager->context = otherContext;
+  return manager;
+}
+
 std::vector<ScTemplateParams> TemplateManagerFixedArguments::createTemplateParams(ScAddr const & scTemplate)
 {
   std::vector<ScTemplateParams> templateParamsVector;
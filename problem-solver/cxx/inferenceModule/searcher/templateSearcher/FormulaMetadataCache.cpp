@@ -0,0 +1,261 @@
+/*
+ * This source file is part of an OSTIS project. For the latest info, see http://ostis.net
+ * Distributed under the MIT License
+ * (See accompanying file COPYING.MIT or copy at http://opensource.org/licenses/MIT)
+ */
+
+#include "FormulaMetadataCache.hpp"
+
+#include "classifier/FormulaClassifier.hpp"
+#include "keynodes/InferenceKeynodes.hpp"
+
+#include <unordered_set>
+
+namespace inference
+{
+std::mutex FormulaMetadataCache::sharedCacheMutex;
+std::shared_ptr<FormulaMetadataCache> FormulaMetadataCache::sharedCache;
+
+FormulaMetadataCache::FormulaMetadataCache()
+  : ownContext(std::make_unique<ScMemoryContext>())
+  , context(ownContext.get())
+{
+}
+
+FormulaMetadataCache::FormulaMetadataCache(ScMemoryContext * context)
+  : context(context)
+{
+}
+
+FormulaMetadataCache::~FormulaMetadataCache()
+{
+  clear();
+}
+
+std::shared_ptr<FormulaMetadata const> FormulaMetadataCache::getMetadata(ScAddr const & formula)
+{
+  {
+    std::lock_guard<std::mutex> const lock(metadataMutex);
+    auto const & metadataIterator = formulasMetadata.find(formula);
+    if (metadataIterator != formulasMetadata.cend())
+    {
+      ++hitsAmount;
+      return metadataIterator->second;
+    }
+  }
+
+  ++missesAmount;
+  // Formula is subscribed to before it is read and its links after, so changes made while it is read are noticed by
+  // the generation of the formula or by content of the links
+  size_t const generation = getGeneration(formula);
+  std::vector<std::shared_ptr<ScEventSubscription>> formulaSubscriptions;
+  std::shared_ptr<FormulaMetadata const> metadata;
+  bool isLinksContentActual = true;
+  {
+    // Formulas of concurrently computed rules are read with the context of the cache by one thread at a time
+    std::lock_guard<std::mutex> const lock(readMutex);
+    subscribeToFormula(formula, formulaSubscriptions);
+    metadata = readMetadata(formula);
+    isLinksContentActual = subscribeToLinks(formula, *metadata, formulaSubscriptions);
+  }
+
+  // Replaced subscriptions are destroyed out of the lock as in `clear`
+  std::vector<std::shared_ptr<ScEventSubscription>> replacedSubscriptions;
+  {
+    std::lock_guard<std::mutex> const lock(metadataMutex);
+    if (isLinksContentActual && generations[formula] == generation)
+    {
+      formulasMetadata.insert_or_assign(formula, metadata);
+      std::vector<std::shared_ptr<ScEventSubscription>> & cachedSubscriptions = subscriptions[formula];
+      replacedSubscriptions.swap(cachedSubscriptions);
+      cachedSubscriptions.swap(formulaSubscriptions);
+    }
+  }
+  return metadata;
+}
+
+void FormulaMetadataCache::buildTemplate(
+    ScAddr const & formula,
+    ScTemplateParams const & templateParams,
+    ScTemplate & searchTemplate)
+{
+  std::shared_ptr<FormulaMetadata const> const metadata = getMetadata(formula);
+  // A variable is declared by its first item, the next items refer to it by name
+  std::unordered_set<std::string> declaredVariables;
+  auto const & createItem =
+      [&templateParams, &declaredVariables](FormulaMetadata::TemplateItem const & item) -> ScTemplateItem
+  {
+    if (item.name.empty())
+      return item.addr;
+    if (!declaredVariables.insert(item.name).second)
+      return item.name;
+    ScAddr value;
+    if (templateParams.Get(item.addr, value))
+      return value >> item.name;
+    return item.type >> item.name;
+  };
+
+  for (std::array<FormulaMetadata::TemplateItem, 3> const & triple : metadata->triples)
+  {
+    ScTemplateItem const & source = createItem(triple[0]);
+    ScTemplateItem const & arc = createItem(triple[1]);
+    ScTemplateItem const & target = createItem(triple[2]);
+    searchTemplate.Triple(source, arc, target);
+  }
+}
+
+FormulaMetadataCache::Statistics FormulaMetadataCache::getStatistics() const
+{
+  return {hitsAmount, missesAmount, invalidationsAmount};
+}
+
+// Subscriptions are destroyed out of the lock, because their destruction waits for callbacks that take the lock
+void FormulaMetadataCache::clear()
+{
+  std::unordered_map<ScAddr, std::vector<std::shared_ptr<ScEventSubscription>>, ScAddrHashFunc> clearedSubscriptions;
+  {
+    std::lock_guard<std::mutex> const lock(metadataMutex);
+    formulasMetadata.clear();
+    clearedSubscriptions.swap(subscriptions);
+  }
+  clearedSubscriptions.clear();
+}
+
+std::shared_ptr<FormulaMetadataCache> FormulaMetadataCache::getShared()
+{
+  std::lock_guard<std::mutex> const lock(sharedCacheMutex);
+  return sharedCache;
+}
+
+void FormulaMetadataCache::setShared(std::shared_ptr<FormulaMetadataCache> const & cache)
+{
+  std::shared_ptr<FormulaMetadataCache> previousCache = cache;
+  std::lock_guard<std::mutex> const lock(sharedCacheMutex);
+  sharedCache.swap(previousCache);
+}
+
+std::shared_ptr<FormulaMetadata const> FormulaMetadataCache::readMetadata(ScAddr const & formula) const
+{
+  auto metadata = std::make_shared<FormulaMetadata>();
+  metadata->type = FormulaClassifier::typeOfFormula(context, formula);
+  metadata->isFormulaWithConst = FormulaClassifier::isFormulaWithConst(context, formula);
+  metadata->isFormulaWithVar = FormulaClassifier::isFormulaWithVar(context, formula);
+  metadata->isFormulaToGenerate = FormulaClassifier::isFormulaToGenerate(context, formula);
+  metadata->isTemplateWithLinks = context->CheckConnector(
+      InferenceKeynodes::concept_template_with_links, formula, ScType::EdgeAccessConstPosPerm);
+
+  ScAddrVector formulaArcsVector;
+  ScAddrUnorderedSet formulaArcs;
+  ScIterator3Ptr const & elementsIterator =
+      context->CreateIterator3(formula, ScType::EdgeAccessConstPosPerm, ScType::Unknown);
+  while (elementsIterator->Next())
+  {
+    ScAddr const & element = elementsIterator->Get(2);
+    ScType const & elementType = context->GetElementType(element);
+    if (elementType.IsVar())
+      metadata->variables.insert(element);
+    else if (elementType.IsConst())
+      metadata->constants.insert(element);
+    if (elementType.IsLink())
+    {
+      FormulaMetadata::Link & link = metadata->links.emplace_back();
+      link.addr = element;
+      link.hasContent = context->GetLinkContent(element, link.content);
+    }
+    if (elementType.IsEdge() && formulaArcs.insert(element).second)
+      formulaArcsVector.push_back(element);
+  }
+
+  if (metadata->type == FormulaClassifier::ATOMIC)
+  {
+    ScAddrUnorderedSet compiledArcs;
+    for (ScAddr const & arc : formulaArcsVector)
+      compileTriple(arc, formulaArcs, compiledArcs, *metadata);
+  }
+  return metadata;
+}
+
+// Triples of arcs incident to the arc are compiled first, so variables of these arcs are declared before they are used
+void FormulaMetadataCache::compileTriple(
+    ScAddr const & arc,
+    ScAddrUnorderedSet const & formulaArcs,
+    ScAddrUnorderedSet & compiledArcs,
+    FormulaMetadata & metadata) const
+{
+  if (!compiledArcs.insert(arc).second)
+    return;
+  auto const [source, target] = context->GetConnectorIncidentElements(arc);
+  for (ScAddr const & element : {source, target})
+  {
+    if (formulaArcs.count(element))
+      compileTriple(element, formulaArcs, compiledArcs, metadata);
+  }
+  metadata.triples.push_back({compileItem(source), compileItem(arc), compileItem(target)});
+}
+
+FormulaMetadata::TemplateItem FormulaMetadataCache::compileItem(ScAddr const & element) const
+{
+  ScType const & type = context->GetElementType(element);
+  return {element, type, type.IsVar() ? std::to_string(element.Hash()) : std::string()};
+}
+
+size_t FormulaMetadataCache::getGeneration(ScAddr const & formula) const
+{
+  std::lock_guard<std::mutex> const lock(metadataMutex);
+  auto const & generationIterator = generations.find(formula);
+  return generationIterator == generations.cend() ? 0 : generationIterator->second;
+}
+
+void FormulaMetadataCache::subscribeToFormula(
+    ScAddr const & formula,
+    std::vector<std::shared_ptr<ScEventSubscription>> & formulaSubscriptions)
+{
+  if (!eventsContext)
+    eventsContext = std::make_unique<ScAgentContext>();
+  auto const & invalidateFormula = [this, formula](auto const &)
+  {
+    invalidate(formula);
+  };
+  formulaSubscriptions = {
+      eventsContext->CreateElementaryEventSubscription<ScEventAfterGenerateOutgoingArc<ScType::EdgeAccessConstPosPerm>>(
+          formula, invalidateFormula),
+      eventsContext->CreateElementaryEventSubscription<ScEventBeforeEraseOutgoingArc<ScType::EdgeAccessConstPosPerm>>(
+          formula, invalidateFormula),
+      eventsContext->CreateElementaryEventSubscription<ScEventAfterGenerateIncomingArc<ScType::EdgeAccessConstPosPerm>>(
+          formula, invalidateFormula),
+      eventsContext->CreateElementaryEventSubscription<ScEventBeforeEraseIncomingArc<ScType::EdgeAccessConstPosPerm>>(
+          formula, invalidateFormula)};
+}
+
+bool FormulaMetadataCache::subscribeToLinks(
+    ScAddr const & formula,
+    FormulaMetadata const & metadata,
+    std::vector<std::shared_ptr<ScEventSubscription>> & formulaSubscriptions)
+{
+  auto const & invalidateFormula = [this, formula](auto const &)
+  {
+    invalidate(formula);
+  };
+  bool isLinksContentActual = true;
+  std::string linkContent;
+  for (FormulaMetadata::Link const & link : metadata.links)
+  {
+    formulaSubscriptions.push_back(
+        eventsContext->CreateElementaryEventSubscription<ScEventBeforeChangeLinkContent>(link.addr, invalidateFormula));
+    linkContent.clear();
+    bool const hasContent = context->GetLinkContent(link.addr, linkContent);
+    if (hasContent != link.hasContent || linkContent != link.content)
+      isLinksContentActual = false;
+  }
+  return isLinksContentActual;
+}
+
+void FormulaMetadataCache::invalidate(ScAddr const & formula)
+{
+  std::lock_guard<std::mutex> const lock(metadataMutex);
+  ++generations[formula];
+  if (formulasMetadata.erase(formula))
+    ++invalidationsAmount;
+}
+
+}  // namespace inference
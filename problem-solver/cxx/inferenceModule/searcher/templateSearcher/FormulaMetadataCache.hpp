@@ -0,0 +1,136 @@
+/*
+ * This source file is part of an OSTIS project. For the latest info, see http://ostis.net
+ * Distributed under the MIT License
+ * (See accompanying file COPYING.MIT or copy at http://opensource.org/licenses/MIT)
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <sc-memory/sc_agent.hpp>
+#include <sc-memory/sc_memory.hpp>
+#include <sc-memory/sc_template.hpp>
+
+namespace inference
+{
+/// Everything inference reads from a formula structure, it is read from sc-memory once per formula
+struct FormulaMetadata
+{
+  struct TemplateItem
+  {
+    ScAddr addr;
+    ScType type;
+    /// Name of the variable in search template, it is empty for constants
+    std::string name;
+  };
+
+  struct Link
+  {
+    ScAddr addr;
+    bool hasContent = false;
+    std::string content;
+  };
+
+  /// One of `FormulaClassifier::FormulaClasses`
+  int type = 0;
+  bool isFormulaWithConst = false;
+  bool isFormulaWithVar = false;
+  bool isFormulaToGenerate = false;
+  bool isTemplateWithLinks = false;
+  ScAddrUnorderedSet variables;
+  ScAddrUnorderedSet constants;
+  std::vector<Link> links;
+  /// Triples of the search template without params, they are compiled only for atomic formulas
+  std::vector<std::array<TemplateItem, 3>> triples;
+};
+
+/**
+ * Metadata of formulas keyed by formula address. Template params are applied when the search template is created from
+ * cached triples, so one compiled formula is used for all params of the inference. Metadata of a formula is removed
+ * from the cache when an access arc from or to the formula is generated or erased, or content of its link is changed.
+ * Subscriptions to links follow the links of the last read metadata.
+ */
+class FormulaMetadataCache
+{
+public:
+  struct Statistics
+  {
+    size_t hitsAmount = 0;
+    size_t missesAmount = 0;
+    size_t invalidationsAmount = 0;
+  };
+
+  /// Create a cache that reads formulas with its own context, so it may outlive contexts of agents
+  FormulaMetadataCache();
+  explicit FormulaMetadataCache(ScMemoryContext * context);
+  ~FormulaMetadataCache();
+
+  FormulaMetadataCache(FormulaMetadataCache const & other) = delete;
+  FormulaMetadataCache & operator=(FormulaMetadataCache const & other) = delete;
+
+  /// Returns metadata of the formula, it is read from sc-memory if the formula is not in the cache
+  std::shared_ptr<FormulaMetadata const> getMetadata(ScAddr const & formula);
+
+  /**
+   * @brief Create search template of the atomic formula as `ScMemoryContext::BuildTemplate` does
+   * @param formula structure of the atomic logical formula
+   * @param templateParams values of formula variables, they replace variables in the search template
+   * @param searchTemplate out param, template with triples of the formula will be placed here
+   */
+  void buildTemplate(ScAddr const & formula, ScTemplateParams const & templateParams, ScTemplate & searchTemplate);
+
+  Statistics getStatistics() const;
+  /// Remove all formulas and unsubscribe from their events, statistics are kept
+  void clear();
+
+  /// Cache used by template searchers by default, it is empty if the inference module is not initialized
+  static std::shared_ptr<FormulaMetadataCache> getShared();
+  static void setShared(std::shared_ptr<FormulaMetadataCache> const & cache);
+
+private:
+  std::unique_ptr<ScMemoryContext> ownContext;
+  ScMemoryContext * context;
+  std::unique_ptr<ScAgentContext> eventsContext;
+  mutable std::mutex metadataMutex;
+  std::mutex readMutex;
+  std::unordered_map<ScAddr, std::shared_ptr<FormulaMetadata const>, ScAddrHashFunc> formulasMetadata;
+  std::unordered_map<ScAddr, std::vector<std::shared_ptr<ScEventSubscription>>, ScAddrHashFunc> subscriptions;
+  /// Amounts of invalidations of formulas, metadata is not cached if its formula was invalidated while it was read
+  std::unordered_map<ScAddr, size_t, ScAddrHashFunc> generations;
+  std::atomic<size_t> hitsAmount = 0;
+  std::atomic<size_t> missesAmount = 0;
+  std::atomic<size_t> invalidationsAmount = 0;
+
+  static std::mutex sharedCacheMutex;
+  static std::shared_ptr<FormulaMetadataCache> sharedCache;
+
+  std::shared_ptr<FormulaMetadata const> readMetadata(ScAddr const & formula) const;
+  void compileTriple(
+      ScAddr const & arc,
+      ScAddrUnorderedSet const & formulaArcs,
+      ScAddrUnorderedSet & compiledArcs,
+      FormulaMetadata & metadata) const;
+  FormulaMetadata::TemplateItem compileItem(ScAddr const & element) const;
+  size_t getGeneration(ScAddr const & formula) const;
+  void subscribeToFormula(
+      ScAddr const & formula,
+      std::vector<std::shared_ptr<ScEventSubscription>> & formulaSubscriptions);
+  /**
+   * @brief Subscribe to content changes of the formula links
+   * @returns false if content of some link was changed after it was read, so the metadata is stale
+   */
+  bool subscribeToLinks(
+      ScAddr const & formula,
+      FormulaMetadata const & metadata,
+      std::vector<std::shared_ptr<ScEventSubscription>> & formulaSubscriptions);
+  void invalidate(ScAddr const & formula);
+};
+
+}  // namespace inference
@@ -0,0 +1,50 @@
+/*
+ * This source file is part of an OSTIS project. For the latest info, see http://ostis.net
+ * Distributed under the MIT License
+ * (See accompanying file COPYING.MIT or copy at http://opensource.org/licenses/MIT)
+ */
+
+#include "StructuresMembershipIndex.hpp"
+
+namespace inference
+{
+// Structures may be changed between inferences, so indexed structures are read again too
+void StructuresMembershipIndex::build(ScMemoryContext * context, ScAddrUnorderedSet const & structures)
+{
+  clear();
+  for (ScAddr const & structure : structures)
+  {
+    indexedStructures.insert(structure);
+    ScIterator3Ptr const & elementsIterator =
+        context->CreateIterator3(structure, ScType::EdgeAccessConstPosPerm, ScType::Unknown);
+    while (elementsIterator->Next())
+      elements.insert(elementsIterator->Get(2));
+  }
+}
+
+void StructuresMembershipIndex::add(ScAddr const & element)
+{
+  elements.insert(element);
+}
+
+bool StructuresMembershipIndex::contains(ScAddr const & element) const
+{
+  return elements.find(element) != elements.cend();
+}
+
+bool StructuresMembershipIndex::isStructureIndexed(ScAddr const & structure) const
+{
+  return indexedStructures.find(structure) != indexedStructures.cend();
+}
+
+size_t StructuresMembershipIndex::getElementsAmount() const
+{
+  return elements.size();
+}
+
+void StructuresMembershipIndex::clear()
+{
+  indexedStructures.clear();
+  elements.clear();
+}
+}  // namespace inference
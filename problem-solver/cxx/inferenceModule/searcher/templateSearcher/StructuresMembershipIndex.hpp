@@ -0,0 +1,43 @@
+/*
+ * This source file is part of an OSTIS project. For the latest info, see http://ostis.net
+ * Distributed under the MIT License
+ * (See accompanying file COPYING.MIT or copy at http://opensource.org/licenses/MIT)
+ */
+
+#pragma once
+
+#include <sc-memory/sc_memory.hpp>
+
+namespace inference
+{
+/**
+ * Elements of the union of structures. It is built once per inference, so checking whether a found element belongs to
+ * any of input structures does not iterate over all structures of the element
+ */
+class StructuresMembershipIndex
+{
+public:
+  /**
+   * @brief Build the index of elements of the structures again, all structures are read, so elements added to or
+   * removed from them since the previous build are taken into account
+   * @param context context to read structures with
+   * @param structures structures to index
+   */
+  void build(ScMemoryContext * context, ScAddrUnorderedSet const & structures);
+
+  /// Add the element to the index, it is called when the element is added to one of indexed structures
+  void add(ScAddr const & element);
+
+  bool contains(ScAddr const & element) const;
+
+  bool isStructureIndexed(ScAddr const & structure) const;
+
+  size_t getElementsAmount() const;
+
+  void clear();
+
+private:
+  ScAddrUnorderedSet indexedStructures;
+  ScAddrUnorderedSet elements;
+};
+}  // namespace inference
@@ -17,6 +17,20 @@ TemplateSearcherAbstract::TemplateSearcherAbstract(
   : context(context)
   , replacementsUsingType(replacementsUsingType)
   , outputStructureFillingType(outputStructureFillingType)
+  , formulaMetadataCache(FormulaMetadataCache::getShared())
+{
+  // Searchers used without the inference module read formulas with their own cache
+  if (!formulaMetadataCache)
+    formulaMetadataCache = std::make_shared<FormulaMetadataCache>(context);
+}
+
+TemplateSearcherAbstract::TemplateSearcherAbstract(
+    ScMemoryContext * context,
+    std::shared_ptr<FormulaMetadataCache> formulaMetadataCache)
+  : context(context)
+  , replacementsUsingType(ReplacementsUsingType::REPLACEMENTS_FIRST)
+  , outputStructureFillingType(OutputStructureFillingType::GENERATED_ONLY)
+  , formulaMetadataCache(std::move(formulaMetadataCache))
 {
 }
 
@@ -25,6 +39,10 @@ void TemplateSearcherAbstract::setInputStructures(ScAddrUnorderedSet const & oth
   inputStructures = otherInputStructures;
 }
 
+void TemplateSearcherAbstract::addStructureElement(ScAddr const & structure, ScAddr const & element)
+{
+}
+
 ScAddrUnorderedSet TemplateSearcherAbstract::getInputStructures() const
 {
   return inputStructures;
@@ -36,64 +54,152 @@ void TemplateSearcherAbstract::searchTemplate(
     ScAddrUnorderedSet const & variables,
     Replacements & result)
 {
-  Replacements searchResults;
-  ScAddrVector variableReplacementValues;
-  ScAddr argument;
-
+  prepareResult(variables, result);
   for (ScTemplateParams const & scTemplateParams : scTemplateParamsVector)
   {
-    searchTemplate(templateAddr, scTemplateParams, variables, searchResults);
-    for (ScAddr const & variable : variables)
-    {
-      if (searchResults.count(variable))
-      {
-        variableReplacementValues = searchResults.at(variable);
-        if (scTemplateParams.Get(variable, argument))
-        {
-          result[variable].push_back(argument);
-        }
-        else if (!variableReplacementValues.empty())
-        {
-          result[variable] = variableReplacementValues;
-        }
-      }
-    }
+    if (isResultsLimitReached(result))
+      break;
+    searchTemplate(templateAddr, scTemplateParams, variables, result);
+  }
+}
+
+void TemplateSearcherAbstract::searchTemplate(
+    ScAddr const & templateAddr,
+    TemplateParamsStream & templateParamsStream,
+    ScAddrUnorderedSet const & variables,
+    Replacements & result)
+{
+  prepareResult(variables, result);
+  ScTemplateParams scTemplateParams;
+  while (!isResultsLimitReached(result) && templateParamsStream.next(scTemplateParams))
+    searchTemplate(templateAddr, scTemplateParams, variables, result);
+}
+
+void TemplateSearcherAbstract::searchTemplateByDistinctBindings(
+    ScAddr const & templateAddr,
+    FactorizedReplacements const & bindings,
+    ScAddrUnorderedSet const & variables,
+    Replacements & result)
+{
+  ScAddrVector templateKeys;
+  for (ScAddr const & key : bindings.getKeys())
+  {
+    if (variables.count(key))
+      templateKeys.push_back(key);
+  }
+  FactorizedReplacements const & templateBindings = bindings.project(templateKeys);
+  TemplateParamsStream templateParamsStream(templateBindings);
+  searchTemplate(templateAddr, templateParamsStream, variables, result);
+}
+
+void TemplateSearcherAbstract::prepareResult(ScAddrUnorderedSet const & variables, Replacements & result)
+{
+  if (result.getKeysAmount() == 0)
+    result = Replacements(variables);
+}
+
+void TemplateSearcherAbstract::addResultColumn(
+    ScTemplateSearchResultItem const & item,
+    ScTemplateParams const & templateParams,
+    Replacements & result)
+{
+  ScAddrVector const & keys = result.getKeys();
+  ScAddr * column = result.addColumn();
+  for (size_t keyIndex = 0; keyIndex < keys.size(); ++keyIndex)
+  {
+    if (!item.Get(keys[keyIndex], column[keyIndex]))
+      templateParams.Get(keys[keyIndex], column[keyIndex]);
   }
 }
 
 void TemplateSearcherAbstract::getVariables(ScAddr const & formula, ScAddrUnorderedSet & variables)
 {
-  ScIterator3Ptr const & formulaVariablesIterator =
-      context->CreateIterator3(formula, ScType::EdgeAccessConstPosPerm, ScType::Var);
-  while (formulaVariablesIterator->Next())
-    variables.insert(formulaVariablesIterator->Get(2));
+  ScAddrUnorderedSet const & formulaVariables = formulaMetadataCache->getMetadata(formula)->variables;
+  variables.insert(formulaVariables.cbegin(), formulaVariables.cend());
 }
 
 void TemplateSearcherAbstract::getConstants(ScAddr const & formula, ScAddrUnorderedSet & constants)
 {
-  ScIterator3Ptr const & formulaConstantsIterator =
-      context->CreateIterator3(formula, ScType::EdgeAccessConstPosPerm, ScType::Const);
-  while (formulaConstantsIterator->Next())
-    constants.insert(formulaConstantsIterator->Get(2));
+  ScAddrUnorderedSet const & formulaConstants = formulaMetadataCache->getMetadata(formula)->constants;
+  constants.insert(formulaConstants.cbegin(), formulaConstants.cend());
+}
+
+bool TemplateSearcherAbstract::findTemplateLinksValues(
+    TemplateLinksContent const & linksContent,
+    ScTemplateParams & templateParams,
+    TemplateLinksValues & linksValues) const
+{
+  for (auto const & [link, content] : linksContent)
+  {
+    if (content.empty())
+    {
+      linksValues.linksWithEmptyContent.push_back(link);
+      continue;
+    }
+
+    // Template links are in sc-memory too, so only constant links are values
+    ScAddrUnorderedSet values;
+    for (ScAddr const & foundLink : context->SearchLinksByContent(content))
+    {
+      if (context->GetElementType(foundLink).IsConst())
+        values.insert(foundLink);
+    }
+
+    ScAddr boundValue;
+    bool const isBound = templateParams.Get(link, boundValue);
+    // Content may be absent in the index, e.g. if it is longer than searchable strings, so it is checked by reading
+    // content of the values
+    if (values.empty())
+    {
+      if (!isBound)
+        linksValues.linksWithUnindexedContent.emplace(link, content);
+      else if (!isLinkContentEqual(boundValue, content))
+        return false;
+    }
+    else if (isBound)
+    {
+      if (!values.count(boundValue))
+        return false;
+    }
+    else if (values.size() == 1)
+      templateParams.Add(link, *values.cbegin());
+    else
+      linksValues.candidates.emplace(link, std::move(values));
+  }
+  return true;
 }
 
 bool TemplateSearcherAbstract::isContentIdentical(
     ScTemplateSearchResultItem const & item,
-    std::map<std::string, std::string> const & linksContentMap)
+    TemplateLinksValues const & linksValues) const
 {
-  bool result = true;
   ScAddr link;
+  for (auto const & [linkVariable, values] : linksValues.candidates)
+  {
+    if (!item.Get(linkVariable, link) || !values.count(link))
+      return false;
+  }
+
   std::string linkContent;
-  for (auto const & contentMap : linksContentMap)
+  for (ScAddr const & linkVariable : linksValues.linksWithEmptyContent)
   {
-    item.Get(contentMap.first, link);
+    if (!item.Get(linkVariable, link))
+      return false;
     context->GetLinkContent(link, linkContent);
-    if (contentMap.second != linkContent)
-    {
-      result = false;
-      break;
-    }
+    if (!linkContent.empty())
+      return false;
+  }
+
+  for (auto const & [linkVariable, content] : linksValues.linksWithUnindexedContent)
+  {
+    if (!item.Get(linkVariable, link) || !isLinkContentEqual(link, content))
+      return false;
   }
+  return true;
+}
 
-  return result;
+bool TemplateSearcherAbstract::isLinkContentEqual(ScAddr const & link, std::string const & content) const
+{
+  std::string linkContent;
+  return context->GetLinkContent(link, linkContent) && linkContent == content;
 }
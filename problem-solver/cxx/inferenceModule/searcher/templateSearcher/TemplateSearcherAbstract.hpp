@@ -9,14 +9,36 @@
 #include "inferenceConfig/InferenceConfig.hpp"
 
 #include "utils/ReplacementsUtils.hpp"
+#include "utils/TemplateParamsStream.hpp"
+
+#include "FormulaMetadataCache.hpp"
 
 #include <sc-agents-common/utils/CommonUtils.hpp>
 
+#include <string>
+#include <unordered_map>
 #include <vector>
 #include <algorithm>
+#include <memory>
 
 namespace inference
 {
+/// Contents of template links keyed by link variables
+using TemplateLinksContent = std::unordered_map<ScAddr, std::string, ScAddrHashFunc>;
+
+/// Values of template links found by their content before the search
+struct TemplateLinksValues
+{
+  /// Links found by content for link variables that have several of them
+  std::unordered_map<ScAddr, ScAddrUnorderedSet, ScAddrHashFunc> candidates;
+  /// Link variables with empty content, they are not searched in the links content index and are checked by reading
+  /// content of their values
+  ScAddrVector linksWithEmptyContent;
+  /// Contents of link variables that are not found in the links content index, e.g. content longer than the index
+  /// holds, they are checked by reading content of their values
+  TemplateLinksContent linksWithUnindexedContent;
+};
+
 /// Class to search atomic logical formulas and get replacements
 class TemplateSearcherAbstract
 {
@@ -26,8 +48,18 @@ public:
       ReplacementsUsingType replacementsUsingType = ReplacementsUsingType::REPLACEMENTS_FIRST,
       OutputStructureFillingType outputStructureFillingType = OutputStructureFillingType::GENERATED_ONLY);
 
+  /// Create a searcher with default settings that reads formulas metadata from the given cache
+  TemplateSearcherAbstract(ScMemoryContext * context, std::shared_ptr<FormulaMetadataCache> formulaMetadataCache);
+
   virtual ~TemplateSearcherAbstract() = default;
 
+  /**
+   * @brief Create a searcher with the same settings that uses another context, so both of them may search concurrently.
+   * The copy shares formulas metadata and indices of input structures with this searcher
+   * @param otherContext context of the copy, it must outlive the copy
+   */
+  virtual std::unique_ptr<TemplateSearcherAbstract> copy(ScMemoryContext * otherContext) const = 0;
+
   // TODO(MksmOrlov): implement searcher with default search template, configure searcher to use smart search or default
   virtual void searchTemplate(
       ScAddr const & templateAddr,
@@ -41,15 +73,50 @@ public:
       ScAddrUnorderedSet const & variables,
       Replacements & result);
 
+  /// Search by params created from replacements columns one by one, found replacements are added as they are found
+  virtual void searchTemplate(
+      ScAddr const & templateAddr,
+      TemplateParamsStream & templateParamsStream,
+      ScAddrUnorderedSet const & variables,
+      Replacements & result);
+
+  /**
+   * @brief Search by each distinct binding of a table. Bindings are projected to the template variables and
+   * deduplicated, so keys unknown to the template do not multiply searches, but the template is still searched once
+   * for each distinct binding of its variables
+   * @param bindings driving replacements, if they are empty then nothing is searched
+   * @param result out param, replacements found for all bindings are merged here
+   */
+  void searchTemplateByDistinctBindings(
+      ScAddr const & templateAddr,
+      FactorizedReplacements const & bindings,
+      ScAddrUnorderedSet const & variables,
+      Replacements & result);
+
   void getVariables(ScAddr const & formula, ScAddrUnorderedSet & variables);
 
   void getConstants(ScAddr const & formula, ScAddrUnorderedSet & constants);
 
-  bool isContentIdentical(
-      ScTemplateSearchResultItem const & item,
-      std::map<std::string, std::string> const & linksContentMap);
+  /**
+   * @brief Find values of template links in the sc-memory links content index, so found results are not checked by
+   * reading content of their links. A link variable with a single value is bound in the params
+   * @param linksContent contents of template links that should be equal to contents of their values
+   * @param templateParams in and out param, params of the search extended with the single values of links
+   * @param linksValues out param, values of link variables to check in found results
+   * @return false if a link variable bound in the params has other content, so the template has no results
+   */
+  bool findTemplateLinksValues(
+      TemplateLinksContent const & linksContent,
+      ScTemplateParams & templateParams,
+      TemplateLinksValues & linksValues) const;
+
+  /// Check that links of the search result item are among values found by `findTemplateLinksValues`
+  bool isContentIdentical(ScTemplateSearchResultItem const & item, TemplateLinksValues const & linksValues) const;
 
-  void setInputStructures(ScAddrUnorderedSet const & otherInputStructures);
+  virtual void setInputStructures(ScAddrUnorderedSet const & otherInputStructures);
+
+  /// Notify the searcher that the element was added to the structure while inference generated knowledge
+  virtual void addStructureElement(ScAddr const & structure, ScAddr const & element);
 
   ScAddrUnorderedSet getInputStructures() const;
 
@@ -69,11 +136,22 @@ public:
     atomicLogicalFormulaSearchBeforeGenerationType = otherAtomicLogicalFormulaSearchBeforeGenerationType;
   }
 
+  /// Stop search when the result has the given amount of columns, all found columns are added if it is 0
+  void setResultsLimit(size_t const otherResultsLimit)
+  {
+    resultsLimit = otherResultsLimit;
+  }
+
   ReplacementsUsingType getReplacementsUsingType() const
   {
     return replacementsUsingType;
   }
 
+  size_t getResultsLimit() const
+  {
+    return resultsLimit;
+  }
+
   OutputStructureFillingType getOutputStructureFillingType() const
   {
     return outputStructureFillingType;
@@ -84,20 +162,48 @@ public:
     return atomicLogicalFormulaSearchBeforeGenerationType;
   }
 
+  std::shared_ptr<FormulaMetadataCache> const & getFormulaMetadataCache() const
+  {
+    return formulaMetadataCache;
+  }
+
+  /// Use formulas metadata of another searcher, so formulas are read from sc-memory once for both of them
+  void setFormulaMetadataCache(std::shared_ptr<FormulaMetadataCache> const & otherFormulaMetadataCache)
+  {
+    formulaMetadataCache = otherFormulaMetadataCache;
+  }
+
 protected:
+  /// Set keys of the result without keys to the variables, so found constructions can be added as its columns
+  static void prepareResult(ScAddrUnorderedSet const & variables, Replacements & result);
+
+  /// Add search result item as a column of the result. Values of keys absent in the item are taken from the params
+  static void addResultColumn(
+      ScTemplateSearchResultItem const & item,
+      ScTemplateParams const & templateParams,
+      Replacements & result);
+
+  bool isLinkContentEqual(ScAddr const & link, std::string const & content) const;
+
+  bool isResultsLimitReached(Replacements const & result) const
+  {
+    return resultsLimit != 0 && result.getColumnsAmount() >= resultsLimit;
+  }
+
   ScMemoryContext * context;
   ScAddrUnorderedSet inputStructures;
   ReplacementsUsingType replacementsUsingType;
   OutputStructureFillingType outputStructureFillingType;
   AtomicLogicalFormulaSearchBeforeGenerationType atomicLogicalFormulaSearchBeforeGenerationType;
+  size_t resultsLimit = 0;
+  std::shared_ptr<FormulaMetadataCache> formulaMetadataCache;
 
 private:
   virtual void searchTemplateWithContent(
-      ScTemplate const & searchTemplate,
       ScAddr const & templateAddr,
       ScTemplateParams const & templateParams,
       Replacements & result) = 0;
 
-  virtual std::map<std::string, std::string> getTemplateLinksContent(ScAddr const & templateAddr) = 0;
+  virtual TemplateLinksContent getTemplateLinksContent(ScAddr const & templateAddr) = 0;
 };
 }  // namespace inference
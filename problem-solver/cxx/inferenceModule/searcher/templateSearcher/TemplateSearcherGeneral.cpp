@@ -6,8 +6,6 @@
 
 #include "TemplateSearcherGeneral.hpp"
 
-#include "keynodes/InferenceKeynodes.hpp"
-
 #include <memory>
 #include <algorithm>
 
@@ -18,35 +16,41 @@ TemplateSearcherGeneral::TemplateSearcherGeneral(ScMemoryContext * context)
 {
 }
 
+TemplateSearcherGeneral::TemplateSearcherGeneral(
+    ScMemoryContext * context,
+    std::shared_ptr<FormulaMetadataCache> formulaMetadataCache)
+  : TemplateSearcherAbstract(context, std::move(formulaMetadataCache))
+{
+}
+
+std::unique_ptr<TemplateSearcherAbstract> TemplateSearcherGeneral::copy(ScMemoryContext * otherContext) const
+{
+  auto searcher = std::make_unique<TemplateSearcherGeneral>(*this);
+  searcher->context = otherContext;
+  return searcher;
+}
+
 void TemplateSearcherGeneral::searchTemplate(
     ScAddr const & templateAddr,
     ScTemplateParams const & templateParams,
     ScAddrUnorderedSet const & variables,
     Replacements & result)
 {
-  ScTemplate searchTemplate;
-  context->BuildTemplate(searchTemplate, templateAddr, templateParams);
-  if (context->CheckConnector(
-          InferenceKeynodes::concept_template_with_links, templateAddr, ScType::EdgeAccessConstPosPerm))
+  prepareResult(variables, result);
+  if (formulaMetadataCache->getMetadata(templateAddr)->isTemplateWithLinks)
   {
-    searchTemplateWithContent(searchTemplate, templateAddr, templateParams, result);
+    searchTemplateWithContent(templateAddr, templateParams, result);
   }
   else
   {
+    ScTemplate searchTemplate;
+    formulaMetadataCache->buildTemplate(templateAddr, templateParams, searchTemplate);
     context->SearchByTemplateInterruptibly(
         searchTemplate,
-        [&templateParams, &result, &variables, this](
-            ScTemplateSearchResultItem const & item) -> ScTemplateSearchRequest {
+        [&templateParams, &result, this](ScTemplateSearchResultItem const & item) -> ScTemplateSearchRequest {
           // Add search result items to the result Replacements
-          for (ScAddr const & variable : variables)
-          {
-            ScAddr argument;
-            if (item.Get(variable, argument) || templateParams.Get(variable, argument))
-            {
-              result[variable].push_back(argument);
-            }
-          }
-          if (replacementsUsingType == ReplacementsUsingType::REPLACEMENTS_FIRST)
+          addResultColumn(item, templateParams, result);
+          if (replacementsUsingType == ReplacementsUsingType::REPLACEMENTS_FIRST || isResultsLimitReached(result))
             return ScTemplateSearchRequest::STOP;
           else
             return ScTemplateSearchRequest::CONTINUE;
@@ -55,51 +59,41 @@ void TemplateSearcherGeneral::searchTemplate(
 }
 
 void TemplateSearcherGeneral::searchTemplateWithContent(
-    ScTemplate const & searchTemplate,
     ScAddr const & templateAddr,
     ScTemplateParams const & templateParams,
     Replacements & result)
 {
-  std::map<std::string, std::string> linksContentMap = getTemplateLinksContent(templateAddr);
+  ScTemplateParams linksParams = templateParams;
+  TemplateLinksValues linksValues;
+  if (!findTemplateLinksValues(getTemplateLinksContent(templateAddr), linksParams, linksValues))
+    return;
   ScAddrUnorderedSet variables;
   getVariables(templateAddr, variables);
+  prepareResult(variables, result);
 
+  ScTemplate searchTemplate;
+  formulaMetadataCache->buildTemplate(templateAddr, linksParams, searchTemplate);
   context->SearchByTemplateInterruptibly(
       searchTemplate,
-      [templateParams, &result, &variables](ScTemplateSearchResultItem const & item) -> ScTemplateSearchRequest {
+      [&linksParams, &result](ScTemplateSearchResultItem const & item) -> ScTemplateSearchRequest {
         // Add search result items to the result Replacements
-        for (ScAddr const & variable : variables)
-        {
-          ScAddr argument;
-          if (item.Has(variable))
-          {
-            result[variable].push_back(item[variable]);
-          }
-          if (templateParams.Get(variable, argument))
-          {
-            result[variable].push_back(argument);
-          }
-        }
+        addResultColumn(item, linksParams, result);
         return ScTemplateSearchRequest::STOP;
       },
-      [&linksContentMap, this](ScTemplateSearchResultItem const & item) -> bool {
+      [&linksValues, this](ScTemplateSearchResultItem const & item) -> bool {
         // Filter result item by the same content
-        return isContentIdentical(item, linksContentMap);
+        return isContentIdentical(item, linksValues);
       });
 }
 
-std::map<std::string, std::string> TemplateSearcherGeneral::getTemplateLinksContent(ScAddr const & templateAddr)
+TemplateLinksContent TemplateSearcherGeneral::getTemplateLinksContent(ScAddr const & templateAddr)
 {
-  std::map<std::string, std::string> linksContent;
-  ScIterator3Ptr linksIterator = context->CreateIterator3(templateAddr, ScType::EdgeAccessConstPosPerm, ScType::Link);
-  while (linksIterator->Next())
+  std::shared_ptr<FormulaMetadata const> const metadata = formulaMetadataCache->getMetadata(templateAddr);
+  TemplateLinksContent linksContent;
+  for (FormulaMetadata::Link const & link : metadata->links)
   {
-    ScAddr const & linkAddr = linksIterator->Get(2);
-    std::string stringContent;
-    if (context->GetLinkContent(linkAddr, stringContent))
-    {
-      linksContent.emplace(to_string(linkAddr.Hash()), stringContent);
-    }
+    if (link.hasContent && metadata->variables.count(link.addr))
+      linksContent.emplace(link.addr, link.content);
   }
   return linksContent;
 }
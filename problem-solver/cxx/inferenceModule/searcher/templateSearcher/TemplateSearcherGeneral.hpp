@@ -22,6 +22,11 @@ class TemplateSearcherGeneral : public TemplateSearcherAbstract
 public:
   explicit TemplateSearcherGeneral(ScMemoryContext * ms_context);
 
+  /// Create a searcher that reads formulas metadata from the given cache
+  TemplateSearcherGeneral(ScMemoryContext * context, std::shared_ptr<FormulaMetadataCache> formulaMetadataCache);
+
+  std::unique_ptr<TemplateSearcherAbstract> copy(ScMemoryContext * otherContext) const override;
+
   void searchTemplate(
       ScAddr const & templateAddr,
       ScTemplateParams const & templateParams,
@@ -30,11 +35,10 @@ public:
 
 private:
   void searchTemplateWithContent(
-      ScTemplate const & searchTemplate,
       ScAddr const & templateAddr,
       ScTemplateParams const & templateParams,
       Replacements & result) override;
 
-  std::map<std::string, std::string> getTemplateLinksContent(ScAddr const & templateAddr) override;
+  TemplateLinksContent getTemplateLinksContent(ScAddr const & templateAddr) override;
 };
 }  // namespace inference
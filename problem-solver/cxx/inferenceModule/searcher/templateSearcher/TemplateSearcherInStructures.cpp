@@ -11,8 +11,6 @@
 
 #include "sc-agents-common/utils/CommonUtils.hpp"
 
-#include "keynodes/InferenceKeynodes.hpp"
-
 using namespace inference;
 
 TemplateSearcherInStructures::TemplateSearcherInStructures(
@@ -20,7 +18,7 @@ TemplateSearcherInStructures::TemplateSearcherInStructures(
     ScAddrUnorderedSet const & otherInputStructures)
   : TemplateSearcherAbstract(context)
 {
-  inputStructures = otherInputStructures;
+  TemplateSearcherInStructures::setInputStructures(otherInputStructures);
 }
 
 TemplateSearcherInStructures::TemplateSearcherInStructures(ScMemoryContext * context)
@@ -28,39 +26,46 @@ TemplateSearcherInStructures::TemplateSearcherInStructures(ScMemoryContext * con
 {
 }
 
+std::unique_ptr<TemplateSearcherAbstract> TemplateSearcherInStructures::copy(ScMemoryContext * otherContext) const
+{
+  auto searcher = std::make_unique<TemplateSearcherInStructures>(*this);
+  searcher->context = otherContext;
+  return searcher;
+}
+
+void TemplateSearcherInStructures::setInputStructures(ScAddrUnorderedSet const & otherInputStructures)
+{
+  TemplateSearcherAbstract::setInputStructures(otherInputStructures);
+  inputStructuresIndex->build(context, inputStructures);
+}
+
+void TemplateSearcherInStructures::addStructureElement(ScAddr const & structure, ScAddr const & element)
+{
+  if (inputStructuresIndex->isStructureIndexed(structure))
+    inputStructuresIndex->add(element);
+}
+
 void TemplateSearcherInStructures::searchTemplate(
     ScAddr const & templateAddr,
     ScTemplateParams const & templateParams,
     ScAddrUnorderedSet const & variables,
     Replacements & result)
 {
-  ScTemplate searchTemplate;
-  context->BuildTemplate(searchTemplate, templateAddr, templateParams);
-  if (context->CheckConnector(
-          InferenceKeynodes::concept_template_with_links, templateAddr, ScType::EdgeAccessConstPosPerm))
+  prepareResult(variables, result);
+  if (formulaMetadataCache->getMetadata(templateAddr)->isTemplateWithLinks)
   {
-    searchTemplateWithContent(searchTemplate, templateAddr, templateParams, result);
+    searchTemplateWithContent(templateAddr, templateParams, result);
   }
   else
   {
+    ScTemplate searchTemplate;
+    formulaMetadataCache->buildTemplate(templateAddr, templateParams, searchTemplate);
     context->SearchByTemplateInterruptibly(
         searchTemplate,
-        [templateParams, &result, &variables, this](
-            ScTemplateSearchResultItem const & item) -> ScTemplateSearchRequest {
+        [&templateParams, &result, this](ScTemplateSearchResultItem const & item) -> ScTemplateSearchRequest {
           // Add search result item to the answer container
-          ScAddr argument;
-          for (ScAddr const & variable : variables)
-          {
-            if (item.Has(variable))
-            {
-              result[variable].push_back(item[variable]);
-            }
-            else if (templateParams.Get(variable, argument))
-            {
-              result[variable].push_back(argument);
-            }
-          }
-          if (replacementsUsingType == ReplacementsUsingType::REPLACEMENTS_FIRST)
+          addResultColumn(item, templateParams, result);
+          if (replacementsUsingType == ReplacementsUsingType::REPLACEMENTS_FIRST || isResultsLimitReached(result))
             return ScTemplateSearchRequest::STOP;
           else
             return ScTemplateSearchRequest::CONTINUE;
@@ -73,35 +78,33 @@ void TemplateSearcherInStructures::searchTemplate(
 }
 
 void TemplateSearcherInStructures::searchTemplateWithContent(
-    ScTemplate const & searchTemplate,
     ScAddr const & templateAddr,
     ScTemplateParams const & templateParams,
     Replacements & result)
 {
   ScAddrUnorderedSet variables;
   getVariables(templateAddr, variables);
-  std::map<std::string, std::string> linksContentMap = getTemplateLinksContent(templateAddr);
+  prepareResult(variables, result);
+  ScTemplateParams linksParams = templateParams;
+  TemplateLinksValues linksValues;
+  if (!findTemplateLinksValues(getTemplateLinksContent(templateAddr), linksParams, linksValues))
+    return;
 
+  ScTemplate searchTemplate;
+  formulaMetadataCache->buildTemplate(templateAddr, linksParams, searchTemplate);
   context->SearchByTemplate(
       searchTemplate,
-      [templateParams, &result, &variables, this](ScTemplateSearchResultItem const & item) -> ScTemplateSearchRequest {
+      [&linksParams, &result, this](ScTemplateSearchResultItem const & item) -> ScTemplateSearchRequest {
         // Add search result item to the answer container
-        for (ScAddr const & variable : variables)
-        {
-          ScAddr argument;
-          if (item.Get(variable, argument) || templateParams.Get(variable, argument))
-          {
-            result[variable].push_back(argument);
-          }
-        }
-        if (replacementsUsingType == ReplacementsUsingType::REPLACEMENTS_FIRST)
+        addResultColumn(item, linksParams, result);
+        if (replacementsUsingType == ReplacementsUsingType::REPLACEMENTS_FIRST || isResultsLimitReached(result))
           return ScTemplateSearchRequest::STOP;
         else
           return ScTemplateSearchRequest::CONTINUE;
       },
-      [&linksContentMap, this](ScTemplateSearchResultItem const & item) -> bool {
+      [&linksValues, this](ScTemplateSearchResultItem const & item) -> bool {
         // Filter result item by the same content and belonging to any of the input structures
-        if (!isContentIdentical(item, linksContentMap))
+        if (!isContentIdentical(item, linksValues))
           return false;
         for (size_t i = 0; i < item.Size(); i++)
         {
@@ -113,20 +116,14 @@ void TemplateSearcherInStructures::searchTemplateWithContent(
       });
 }
 
-std::map<std::string, std::string> TemplateSearcherInStructures::getTemplateLinksContent(ScAddr const & templateAddr)
+TemplateLinksContent TemplateSearcherInStructures::getTemplateLinksContent(ScAddr const & templateAddr)
 {
-  std::map<std::string, std::string> linksContent;
-  ScIterator3Ptr const & linksIterator =
-      context->CreateIterator3(templateAddr, ScType::EdgeAccessConstPosPerm, ScType::Link);
-  while (linksIterator->Next())
+  std::shared_ptr<FormulaMetadata const> const metadata = formulaMetadataCache->getMetadata(templateAddr);
+  TemplateLinksContent linksContent;
+  for (FormulaMetadata::Link const & link : metadata->links)
   {
-    ScAddr const & linkAddr = linksIterator->Get(2);
-    std::string stringContent;
-    if (isValidElement(linkAddr))
-    {
-      context->GetLinkContent(linkAddr, stringContent);
-      linksContent.emplace(to_string(linkAddr.Hash()), stringContent);
-    }
+    if (metadata->variables.count(link.addr) && isValidElement(link.addr))
+      linksContent.emplace(link.addr, link.content);
   }
 
   return linksContent;
@@ -134,12 +131,5 @@ std::map<std::string, std::string> TemplateSearcherInStructures::getTemplateLink
 
 bool TemplateSearcherInStructures::isValidElement(ScAddr const & element) const
 {
-  auto const & structuresIterator =
-      context->CreateIterator3(ScType::NodeConstStruct, ScType::EdgeAccessConstPosPerm, element);
-  while (structuresIterator->Next())
-  {
-    if (inputStructures.count(structuresIterator->Get(0)))
-      return true;
-  }
-  return false;
+  return inputStructuresIndex->contains(element);
 }
@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include <memory>
 #include <queue>
 #include <vector>
 
@@ -13,6 +14,7 @@
 #include "sc-memory/sc_addr.hpp"
 
 #include "utils/ReplacementsUtils.hpp"
+#include "StructuresMembershipIndex.hpp"
 #include "TemplateSearcherAbstract.hpp"
 
 namespace inference
@@ -24,21 +26,31 @@ public:
 
   explicit TemplateSearcherInStructures(ScMemoryContext * ms_context);
 
+  std::unique_ptr<TemplateSearcherAbstract> copy(ScMemoryContext * otherContext) const override;
+
   void searchTemplate(
       ScAddr const & templateAddr,
       ScTemplateParams const & templateParams,
       ScAddrUnorderedSet const & variables,
       Replacements & result) override;
 
+  /// Set input structures and index their elements
+  void setInputStructures(ScAddrUnorderedSet const & otherInputStructures) override;
+
+  void addStructureElement(ScAddr const & structure, ScAddr const & element) override;
+
+protected:
+  /// Copies of the searcher share the index
+  std::shared_ptr<StructuresMembershipIndex> inputStructuresIndex = std::make_shared<StructuresMembershipIndex>();
+
+  virtual bool isValidElement(ScAddr const & element) const;
+
 private:
   void searchTemplateWithContent(
-      ScTemplate const & searchTemplate,
       ScAddr const & templateAddr,
       ScTemplateParams const & templateParams,
       Replacements & result) override;
 
-  std::map<std::string, std::string> getTemplateLinksContent(ScAddr const & templateAddr) override;
-
-  virtual bool isValidElement(ScAddr const & element) const;
+  TemplateLinksContent getTemplateLinksContent(ScAddr const & templateAddr) override;
 };
 }  // namespace inference
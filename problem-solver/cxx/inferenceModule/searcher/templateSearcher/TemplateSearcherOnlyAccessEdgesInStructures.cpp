@@ -23,8 +23,15 @@ TemplateSearcherOnlyAccessEdgesInStructures::TemplateSearcherOnlyAccessEdgesInSt
 {
 }
 
-map<std::string, std::string> TemplateSearcherOnlyAccessEdgesInStructures::getTemplateLinksContent(
-    ScAddr const & templateAddr)
+std::unique_ptr<TemplateSearcherAbstract> TemplateSearcherOnlyAccessEdgesInStructures::copy(
+    ScMemoryContext * otherContext) const
+{
+  auto searcher = std::make_unique<TemplateSearcherOnlyAccessEdgesInStructures>(*this);
+  searcher->context = otherContext;
+  return searcher;
+}
+
+TemplateLinksContent TemplateSearcherOnlyAccessEdgesInStructures::getTemplateLinksContent(ScAddr const & templateAddr)
 {
   // TODO(kilativ-dotcom): need to decide what to return here. Input structures contain only access edges so there are
   //  no links in them and map should be empty?
@@ -35,13 +42,6 @@ bool TemplateSearcherOnlyAccessEdgesInStructures::isValidElement(ScAddr const &
 {
   if (!context->GetElementType(element).BitAnd(ScType::EdgeAccess))
     return true;
-  auto const & structuresIterator =
-      context->CreateIterator3(ScType::NodeConstStruct, ScType::EdgeAccessConstPosPerm, element);
-  while (structuresIterator->Next())
-  {
-    if (inputStructures.count(structuresIterator->Get(0)))
-      return true;
-  }
-  return false;
+  return inputStructuresIndex->contains(element);
 }
 }  // namespace inference
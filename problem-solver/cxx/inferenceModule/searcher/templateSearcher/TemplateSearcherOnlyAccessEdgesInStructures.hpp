@@ -20,8 +20,10 @@ public:
 
   explicit TemplateSearcherOnlyAccessEdgesInStructures(ScMemoryContext * ms_context);
 
+  std::unique_ptr<TemplateSearcherAbstract> copy(ScMemoryContext * otherContext) const override;
+
 private:
-  map<std::string, std::string> getTemplateLinksContent(ScAddr const & templateAddr) override;
+  TemplateLinksContent getTemplateLinksContent(ScAddr const & templateAddr) override;
 
   bool isValidElement(ScAddr const & element) const override;
 };
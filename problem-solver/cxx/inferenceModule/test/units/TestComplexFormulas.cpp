@@ -5,10 +5,21 @@
  */
 
 #include "agent/DirectInferenceAgent.hpp"
+#include "keynodes/InferenceKeynodes.hpp"
+#include "logic/CompiledRulesCache.hpp"
+#include "logic/ConjunctionExpressionNode.hpp"
+#include "logic/ConjunctionPlanner.hpp"
+#include "logic/TemplateExpressionNode.hpp"
+#include "manager/templateManager/TemplateManager.hpp"
+#include "searcher/templateSearcher/TemplateSearcherGeneral.hpp"
+#include "utils/ThreadPool.hpp"
 
 #include <sc_test.hpp>
 #include <scs_loader.hpp>
 
+#include <chrono>
+#include <thread>
+
 using namespace inference;
 
 namespace directInferenceComplexFormulasTest
@@ -163,6 +174,212 @@ TEST_F(InferenceComplexFormulasTest, TrueConjunctionImplicationFormula)
   context.Destroy();
 }
 
+// Atoms are estimated by arcs of their constants until amount of their replacements is known
+TEST_F(InferenceComplexFormulasTest, ConjunctionPlanOrdersOperandsByCardinality)
+{
+  ScMemoryContext & context = *m_ctx;
+
+  loader.loadScsFile(context, TEST_FILES_DIR_PATH + "conjunctionImplicationTest.scs");
+
+  ScAddr const & firstFormula = context.SearchElementBySystemIdentifier("conj_1");
+  ScAddr const & secondFormula = context.SearchElementBySystemIdentifier("conj_2");
+  TemplateExpressionNode const firstAtom(firstFormula);
+  TemplateExpressionNode const secondAtom(secondFormula);
+  std::vector<LogicExpressionNode const *> const operands = {&firstAtom, &secondAtom};
+  LogicEvaluationContext evaluationContext;
+  evaluationContext.context = &context;
+  evaluationContext.templateSearcher = std::make_shared<TemplateSearcherGeneral>(&context);
+  ConjunctionPlanner planner;
+
+  std::vector<ConjunctionPlanner::Step> steps = planner.plan(evaluationContext, operands);
+  ASSERT_EQ(steps.size(), 2u);
+  EXPECT_EQ(steps[0].source, ConjunctionPlanner::EstimationSource::ARCS_COUNT);
+  EXPECT_EQ(steps[1].source, ConjunctionPlanner::EstimationSource::ARCS_COUNT);
+
+  size_t const firstAtomCardinality = 100;
+  planner.recordCardinality(firstFormula, firstAtomCardinality);
+  steps = planner.plan(evaluationContext, operands);
+  ASSERT_EQ(steps.size(), 2u);
+  EXPECT_EQ(steps[0].operandIndex, 1u);
+  EXPECT_EQ(steps[1].operandIndex, 0u);
+  EXPECT_EQ(steps[1].source, ConjunctionPlanner::EstimationSource::PREVIOUS_COMPUTATION);
+  EXPECT_EQ(steps[1].estimatedCardinality, firstAtomCardinality);
+  EXPECT_EQ(planner.getStatistics().plansAmount, 2u);
+  EXPECT_GE(planner.getStatistics().reorderedPlansAmount, 1u);
+}
+
+TEST_F(InferenceComplexFormulasTest, ConjunctionPlanEstimatesAllTriplesOfAtom)
+{
+  ScMemoryContext & context = *m_ctx;
+
+  loader.loadScsFile(context, TEST_FILES_DIR_PATH + "conjunctionPlanEstimationTest.scs");
+
+  TemplateExpressionNode const partlyBoundAtom(context.SearchElementBySystemIdentifier("partly_bound_formula"));
+  TemplateExpressionNode const independentAtom(context.SearchElementBySystemIdentifier("independent_formula"));
+  TemplateExpressionNode const selectiveAtom(context.SearchElementBySystemIdentifier("selective_formula"));
+  std::vector<LogicExpressionNode const *> const operands = {&partlyBoundAtom, &independentAtom, &selectiveAtom};
+  LogicEvaluationContext evaluationContext;
+  evaluationContext.context = &context;
+  evaluationContext.templateSearcher = std::make_shared<TemplateSearcherGeneral>(&context);
+  ConjunctionPlanner planner;
+
+  std::vector<ConjunctionPlanner::Step> const & steps = planner.plan(evaluationContext, operands);
+  size_t const classArcsAmount =
+      context.GetElementEdgesAndOutgoingArcsCount(context.SearchElementBySystemIdentifier("plan_class"));
+  ASSERT_EQ(steps.size(), 3u);
+  EXPECT_EQ(steps[0].operandIndex, 2u);
+  EXPECT_EQ(steps[0].source, ConjunctionPlanner::EstimationSource::ARCS_COUNT);
+  EXPECT_EQ(steps[0].estimatedCardinality, classArcsAmount);
+  EXPECT_EQ(steps[1].operandIndex, 1u);
+  EXPECT_EQ(steps[1].source, ConjunctionPlanner::EstimationSource::ARCS_COUNT);
+  EXPECT_EQ(steps[1].estimatedCardinality, classArcsAmount * classArcsAmount);
+  EXPECT_EQ(steps[2].operandIndex, 0u);
+  EXPECT_EQ(steps[2].source, ConjunctionPlanner::EstimationSource::UNKNOWN);
+}
+
+TEST_F(InferenceComplexFormulasTest, ConjunctionAtomIsSearchedWithSmallBindings)
+{
+  ScMemoryContext & context = *m_ctx;
+
+  loader.loadScsFile(context, TEST_FILES_DIR_PATH + "conjunctionImplicationTest.scs");
+
+  TemplateExpressionNode const atom(context.SearchElementBySystemIdentifier("conj_2"));
+  LogicEvaluationContext evaluationContext;
+  evaluationContext.context = &context;
+  evaluationContext.templateSearcher = std::make_shared<TemplateSearcherGeneral>(&context);
+  evaluationContext.templateSearcher->setReplacementsUsingType(REPLACEMENTS_ALL);
+  ConjunctionPlanner planner;
+  planner.setBoundSearchThreshold(1);
+
+  Replacements bindingsTable(ScAddrVector{context.SearchElementBySystemIdentifier("_arg")});
+  bindingsTable.addColumn()[0] = context.SearchElementBySystemIdentifier(ARGUMENT_IDENTIFIER);
+  FactorizedReplacements bindings(bindingsTable);
+  EXPECT_TRUE(planner.isBoundSearchUsed(evaluationContext, atom, bindings));
+
+  // Bindings above the threshold are intersected with the atom searched independently
+  bindingsTable.addColumn()[0] = context.SearchElementBySystemIdentifier("current_class");
+  bindings = FactorizedReplacements(bindingsTable);
+  EXPECT_FALSE(planner.isBoundSearchUsed(evaluationContext, atom, bindings));
+
+  // First replacements of the atom do not depend on bindings
+  evaluationContext.templateSearcher->setReplacementsUsingType(REPLACEMENTS_FIRST);
+  planner.setBoundSearchThreshold(ConjunctionPlanner::kDefaultBoundSearchThreshold);
+  EXPECT_FALSE(planner.isBoundSearchUsed(evaluationContext, atom, bindings));
+  EXPECT_EQ(planner.getStatistics().boundSearchesAmount, 1u);
+}
+
+// Atoms searched in parallel give the same replacements as atoms searched one by one
+TEST_F(InferenceComplexFormulasTest, ConjunctionAtomsAreSearchedInParallel)
+{
+  ScMemoryContext & context = *m_ctx;
+
+  loader.loadScsFile(context, TEST_FILES_DIR_PATH + "conjunctionImplicationTest.scs");
+
+  OperatorLogicExpressionNode::OperandsVector operands = {
+      std::make_shared<TemplateExpressionNode>(context.SearchElementBySystemIdentifier("conj_1")),
+      std::make_shared<TemplateExpressionNode>(context.SearchElementBySystemIdentifier("conj_2"))};
+  ConjunctionExpressionNode const conjunction(operands);
+  LogicEvaluationContext evaluationContext;
+  evaluationContext.context = &context;
+  evaluationContext.templateSearcher = std::make_shared<TemplateSearcherGeneral>(&context);
+  evaluationContext.templateSearcher->setReplacementsUsingType(REPLACEMENTS_ALL);
+
+  LogicFormulaResult sequentialResult;
+  conjunction.compute(evaluationContext, sequentialResult);
+  evaluationContext.operandsThreadPool = std::make_shared<ThreadPool>(2);
+  LogicFormulaResult parallelResult;
+  conjunction.compute(evaluationContext, parallelResult);
+
+  EXPECT_TRUE(sequentialResult.value);
+  EXPECT_TRUE(parallelResult.value);
+  Replacements const & replacements = parallelResult.replacements.materialize();
+  ASSERT_EQ(replacements.getColumnsAmount(), 1u);
+  EXPECT_EQ(
+      replacements.at(context.SearchElementBySystemIdentifier("_arg"))[0],
+      context.SearchElementBySystemIdentifier(ARGUMENT_IDENTIFIER));
+  EXPECT_EQ(
+      parallelResult.replacements.getCombinationsAmount(), sequentialResult.replacements.getCombinationsAmount());
+}
+
+// Elements already in the output structure are not added again and are not reported as generated by a next usage
+TEST_F(InferenceComplexFormulasTest, ExistingOutputStructureElementsAreNotAddedAgain)
+{
+  ScMemoryContext & context = *m_ctx;
+
+  loader.loadScsFile(context, TEST_FILES_DIR_PATH + "conjunctionImplicationTest.scs");
+
+  ScAddr const & formulaClass = context.SearchElementBySystemIdentifier("class_1");
+  TemplateExpressionNode const atom(context.SearchElementBySystemIdentifier("conj_2"));
+  ScAddr const & outputStructure = context.GenerateNode(ScType::NodeConstStruct);
+  auto const & templateSearcher = std::make_shared<TemplateSearcherGeneral>(&context);
+  templateSearcher->setAtomicLogicalFormulaSearchBeforeGenerationType(SEARCH_WITHOUT_REPLACEMENTS);
+  auto const & templateManager = std::make_shared<TemplateManager>(&context);
+  templateManager->setGenerationType(GENERATE_UNIQUE_FORMULAS);
+  templateManager->setFillingType(SEARCHED_AND_GENERATED);
+  Replacements replacements(ScAddrVector{context.SearchElementBySystemIdentifier("_arg")});
+  replacements.addColumn()[0] = context.SearchElementBySystemIdentifier(ARGUMENT_IDENTIFIER);
+
+  auto const & generate = [&]() -> ScAddrVector
+  {
+    LogicEvaluationContext evaluationContext;
+    evaluationContext.context = &context;
+    evaluationContext.templateSearcher = templateSearcher;
+    evaluationContext.templateSearcherGeneral = templateSearcher;
+    evaluationContext.templateManager = templateManager;
+    evaluationContext.outputStructure = outputStructure;
+    FactorizedReplacements factorizedReplacements(replacements);
+    LogicFormulaResult result;
+    atom.generate(evaluationContext, factorizedReplacements, result);
+    return evaluationContext.generatedElements;
+  };
+
+  EXPECT_FALSE(generate().empty());
+  EXPECT_TRUE(generate().empty());
+  size_t formulaClassArcsAmount = 0;
+  ScIterator3Ptr const & outputStructureIterator =
+      context.CreateIterator3(outputStructure, ScType::EdgeAccessConstPosPerm, formulaClass);
+  while (outputStructureIterator->Next())
+    ++formulaClassArcsAmount;
+  EXPECT_EQ(formulaClassArcsAmount, 1u);
+}
+
+TEST_F(InferenceComplexFormulasTest, CompiledRuleFollowsAddedSubFormula)
+{
+  ScMemoryContext & context = *m_ctx;
+
+  loader.loadScsFile(context, TEST_FILES_DIR_PATH + "conjunctionImplicationTest.scs");
+
+  ScAddr const & formulaRoot = context.SearchElementBySystemIdentifier("impl_tuple");
+  ScAddr const & conjunctionTuple = context.SearchElementBySystemIdentifier("conjunction_tuple");
+  auto const formulaMetadataCache = std::make_shared<FormulaMetadataCache>(&context);
+  CompiledRulesCache compiledRulesCache;
+  // Events are processed asynchronously, so invalidations are waited for
+  auto const & waitInvalidations = [&compiledRulesCache](size_t invalidationsAmount)
+  {
+    for (size_t attempt = 0; attempt < 100; ++attempt)
+    {
+      if (compiledRulesCache.getStatistics().invalidationsAmount >= invalidationsAmount)
+        return true;
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return false;
+  };
+
+  compiledRulesCache.getExpression(&context, formulaMetadataCache, formulaRoot);
+  ScAddr const & addedFormula = context.GenerateNode(ScType::NodeConstStruct);
+  context.GenerateConnector(ScType::EdgeAccessConstPosPerm, InferenceKeynodes::atomic_logical_formula, addedFormula);
+  context.GenerateConnector(ScType::EdgeAccessConstPosPerm, conjunctionTuple, addedFormula);
+  ASSERT_TRUE(waitInvalidations(1));
+
+  // Sub formula added to the rule is subscribed to when the rule is built again
+  compiledRulesCache.getExpression(&context, formulaMetadataCache, formulaRoot);
+  context.GenerateConnector(
+      ScType::EdgeAccessConstPosPerm, addedFormula, context.SearchElementBySystemIdentifier("class_1"));
+  EXPECT_TRUE(waitInvalidations(2));
+  compiledRulesCache.getExpression(&context, formulaMetadataCache, formulaRoot);
+  EXPECT_EQ(compiledRulesCache.getStatistics().missesAmount, 3u);
+}
+
 // TODO (MksmOrlov): doesn't pass because of empty negation replacements
 // (!a) -> b
 TEST_F(InferenceComplexFormulasTest, DISABLED_TrueNegationImplicationLogicRule)
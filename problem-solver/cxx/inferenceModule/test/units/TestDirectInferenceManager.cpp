@@ -46,6 +46,37 @@ INSTANTIATE_TEST_SUITE_P(
       return testParamInfo.param->getName();
     });
 
+// Replacements of solution tree nodes of the formula in order of the nodes
+std::vector<ScAddrUnorderedSet> getSolutionNodesReplacements(
+    ScMemoryContext & context,
+    ScAddr const & solution,
+    ScAddr const & formula)
+{
+  std::vector<ScAddrUnorderedSet> nodesReplacements;
+  ScAddr solutionNode = utils::IteratorUtils::getAnyByOutRelation(&context, solution, ScKeynodes::rrel_1);
+  while (solutionNode.IsValid())
+  {
+    if (utils::IteratorUtils::getAnyByOutRelation(&context, solutionNode, ScKeynodes::rrel_1) == formula)
+    {
+      ScAddrUnorderedSet & replacements = nodesReplacements.emplace_back();
+      ScAddr const & replacementsNode =
+          utils::IteratorUtils::getAnyByOutRelation(&context, solutionNode, ScKeynodes::rrel_2);
+      for (ScAddr const & pair : utils::IteratorUtils::getAllWithType(&context, replacementsNode, ScType::NodeConst))
+        replacements.insert(utils::IteratorUtils::getAnyByOutRelation(&context, pair, ScKeynodes::rrel_1));
+    }
+    ScIterator3Ptr const & solutionNodeArcIterator =
+        context.CreateIterator3(solution, ScType::EdgeAccessConstPosPerm, solutionNode);
+    solutionNode = ScAddr::Empty;
+    if (!solutionNodeArcIterator->Next())
+      break;
+    ScAddr const & nextArc = utils::IteratorUtils::getAnyByOutRelation(
+        &context, solutionNodeArcIterator->Get(1), ScKeynodes::nrel_basic_sequence);
+    if (nextArc.IsValid())
+      solutionNode = context.GetConnectorIncidentElements(nextArc).second;
+  }
+  return nodesReplacements;
+}
+
 TEST_P(InferenceManagerTest, SuccessApplyInference)
 {
   ScMemoryContext & context = *m_ctx;
@@ -86,6 +117,165 @@ TEST_P(InferenceManagerTest, SuccessApplyInference)
   EXPECT_TRUE(context.CheckConnector(targetClass, argument, ScType::EdgeAccessConstPosPerm));
 }
 
+// The rule used before the rule generating its premise is used again after the generation
+TEST_P(InferenceManagerTest, RuleAffectedByGeneratedElementsIsUsedAgain)
+{
+  ScMemoryContext & context = *m_ctx;
+
+  loader.loadScsFile(context, TEST_FILES_DIR_PATH + "chainedRulesTest.scs");
+
+  ScAddr const & targetTemplate = context.SearchElementBySystemIdentifier(TARGET_TEMPLATE);
+  ScAddr const & ruleSet = context.SearchElementBySystemIdentifier(RULES_SET);
+  ScAddr const & argumentSet = context.SearchElementBySystemIdentifier(ARGUMENT_SET);
+  ScAddr const & inputStructure = context.SearchElementBySystemIdentifier(INPUT_STRUCTURE);
+
+  InferenceConfig const & inferenceConfig = GetParam()->getInferenceConfig(
+      {GENERATE_UNIQUE_FORMULAS, REPLACEMENTS_FIRST, TREE_ONLY_OUTPUT_STRUCTURE, SEARCH_IN_STRUCTURES});
+  ScAddrVector const & argumentVector = utils::IteratorUtils::getAllWithType(&context, argumentSet, ScType::Node);
+  ScAddr const & outputStructure = context.GenerateNode(ScType::NodeConstStruct);
+  InferenceParams const & inferenceParams{ruleSet, argumentVector, {inputStructure}, outputStructure, targetTemplate};
+  std::unique_ptr<InferenceManagerAbstract> inferenceManager =
+      InferenceManagerFactory::constructDirectInferenceManagerTarget(&context, inferenceConfig);
+  EXPECT_TRUE(inferenceManager->applyInference(inferenceParams));
+
+  ScAddr const & argument = context.SearchElementBySystemIdentifier("argument");
+  ScAddr const & intermediateClass = context.SearchElementBySystemIdentifier("intermediate_node_class");
+  ScAddr const & targetClass = context.SearchElementBySystemIdentifier("target_node_class");
+  EXPECT_TRUE(context.CheckConnector(intermediateClass, argument, ScType::EdgeAccessConstPosPerm));
+  EXPECT_TRUE(context.CheckConnector(targetClass, argument, ScType::EdgeAccessConstPosPerm));
+}
+
+// The waiting rule of the first set is used again when the rule of the second set generates its premise
+TEST_P(InferenceManagerTest, RuleOfPreviousSetIsUsedAfterGenerationOfLaterSet)
+{
+  ScMemoryContext & context = *m_ctx;
+
+  loader.loadScsFile(context, TEST_FILES_DIR_PATH + "laterSetPremiseTest.scs");
+
+  ScAddr const & targetTemplate = context.SearchElementBySystemIdentifier(TARGET_TEMPLATE);
+  ScAddr const & ruleSet = context.SearchElementBySystemIdentifier(RULES_SET);
+  ScAddr const & inputStructure = context.SearchElementBySystemIdentifier(INPUT_STRUCTURE);
+
+  InferenceConfig const & inferenceConfig = GetParam()->getInferenceConfig(
+      {GENERATE_UNIQUE_FORMULAS, REPLACEMENTS_ALL, TREE_ONLY_OUTPUT_STRUCTURE, SEARCH_IN_STRUCTURES});
+  ScAddr const & outputStructure = context.GenerateNode(ScType::NodeConstStruct);
+  InferenceParams const & inferenceParams{ruleSet, {}, {inputStructure}, outputStructure, targetTemplate};
+  std::unique_ptr<InferenceManagerAbstract> inferenceManager =
+      InferenceManagerFactory::constructDirectInferenceManagerTarget(&context, inferenceConfig);
+  EXPECT_TRUE(inferenceManager->applyInference(inferenceParams));
+
+  ScAddr const & argument = context.SearchElementBySystemIdentifier("argument");
+  ScAddr const & intermediateClass = context.SearchElementBySystemIdentifier("intermediate_node_class");
+  ScAddr const & targetClass = context.SearchElementBySystemIdentifier("target_node_class");
+  EXPECT_TRUE(context.CheckConnector(intermediateClass, argument, ScType::EdgeAccessConstPosPerm));
+  EXPECT_TRUE(context.CheckConnector(targetClass, argument, ScType::EdgeAccessConstPosPerm));
+}
+
+// The rule that generated is used again only with the premise replacement generated by the rule of the next set, so
+// each usage of the rule adds a solution tree node with its own premise replacements
+TEST_P(InferenceManagerTest, RuleIsUsedAgainWithNewPremiseReplacements)
+{
+  ScMemoryContext & context = *m_ctx;
+
+  loader.loadScsFile(context, TEST_FILES_DIR_PATH + "newPremiseReplacementTest.scs");
+
+  ScAddr const & targetTemplate = context.SearchElementBySystemIdentifier(TARGET_TEMPLATE);
+  ScAddr const & ruleSet = context.SearchElementBySystemIdentifier(RULES_SET);
+  ScAddr const & inputStructure = context.SearchElementBySystemIdentifier(INPUT_STRUCTURE);
+
+  InferenceConfig const & inferenceConfig = GetParam()->getInferenceConfig(
+      {GENERATE_ALL_FORMULAS, REPLACEMENTS_ALL, TREE_FULL, SEARCH_IN_STRUCTURES});
+  ScAddr const & outputStructure = context.GenerateNode(ScType::NodeConstStruct);
+  InferenceParams const & inferenceParams{ruleSet, {}, {inputStructure}, outputStructure, targetTemplate};
+  std::unique_ptr<InferenceManagerAbstract> inferenceManager =
+      InferenceManagerFactory::constructDirectInferenceManagerTarget(&context, inferenceConfig);
+  bool const targetAchieved = inferenceManager->applyInference(inferenceParams);
+  EXPECT_TRUE(targetAchieved);
+
+  ScAddr const & targetClass = context.SearchElementBySystemIdentifier("target_node_class");
+  ScAddr const & firstArgument = context.SearchElementBySystemIdentifier("first_argument");
+  ScAddr const & secondArgument = context.SearchElementBySystemIdentifier("second_argument");
+  EXPECT_TRUE(context.CheckConnector(targetClass, secondArgument, ScType::EdgeAccessConstPosPerm));
+  // Conclusion of the first argument is not generated again
+  ScIterator3Ptr const & firstArgumentIterator =
+      context.CreateIterator3(targetClass, ScType::EdgeAccessConstPosPerm, firstArgument);
+  EXPECT_TRUE(firstArgumentIterator->Next());
+  EXPECT_FALSE(firstArgumentIterator->Next());
+
+  ScAddr const & solution = inferenceManager->getSolutionTreeManager()->createSolution(outputStructure, targetAchieved);
+  ScAddr const & targetRule = context.SearchElementBySystemIdentifier("target_logic_rule");
+  std::vector<ScAddrUnorderedSet> const & targetRuleReplacements =
+      getSolutionNodesReplacements(context, solution, targetRule);
+  ASSERT_EQ(targetRuleReplacements.size(), 2u);
+  EXPECT_TRUE(targetRuleReplacements[0].count(firstArgument));
+  EXPECT_FALSE(targetRuleReplacements[0].count(secondArgument));
+  EXPECT_TRUE(targetRuleReplacements[1].count(secondArgument));
+  EXPECT_FALSE(targetRuleReplacements[1].count(firstArgument));
+}
+
+// Existing conclusion added to the output structure makes the premise of the waiting rule found in structures
+TEST_P(InferenceManagerTest, RuleAffectedByExistingConclusionIsUsedAgain)
+{
+  ScMemoryContext & context = *m_ctx;
+
+  loader.loadScsFile(context, TEST_FILES_DIR_PATH + "existingConclusionTest.scs");
+
+  ScAddr const & targetTemplate = context.SearchElementBySystemIdentifier(TARGET_TEMPLATE);
+  ScAddr const & ruleSet = context.SearchElementBySystemIdentifier(RULES_SET);
+  ScAddr const & inputStructure = context.SearchElementBySystemIdentifier(INPUT_STRUCTURE);
+
+  InferenceConfig const & inferenceConfig = GetParam()->getInferenceConfig(
+      {GENERATE_UNIQUE_FORMULAS,
+       REPLACEMENTS_ALL,
+       TREE_ONLY_OUTPUT_STRUCTURE,
+       SEARCH_IN_STRUCTURES,
+       SEARCHED_AND_GENERATED});
+  ScAddr const & outputStructure = context.GenerateNode(ScType::NodeConstStruct);
+  InferenceParams const & inferenceParams{ruleSet, {}, {inputStructure}, outputStructure, targetTemplate};
+  std::unique_ptr<InferenceManagerAbstract> inferenceManager =
+      InferenceManagerFactory::constructDirectInferenceManagerTarget(&context, inferenceConfig);
+  EXPECT_TRUE(inferenceManager->applyInference(inferenceParams));
+
+  ScAddr const & knownClass = context.SearchElementBySystemIdentifier("known_node_class");
+  ScAddr const & targetClass = context.SearchElementBySystemIdentifier("target_node_class");
+  EXPECT_TRUE(context.CheckConnector(targetClass, knownClass, ScType::EdgeAccessConstPosPerm));
+}
+
+TEST_P(InferenceManagerTest, RulesOfCycleAreUsedUntilTargetIsAchieved)
+{
+  ScMemoryContext & context = *m_ctx;
+
+  loader.loadScsFile(context, TEST_FILES_DIR_PATH + "recursiveRulesTest.scs");
+
+  ScAddr const & targetTemplate = context.SearchElementBySystemIdentifier(TARGET_TEMPLATE);
+  ScAddr const & ruleSet = context.SearchElementBySystemIdentifier(RULES_SET);
+  ScAddr const & argumentSet = context.SearchElementBySystemIdentifier(ARGUMENT_SET);
+  ScAddr const & inputStructure = context.SearchElementBySystemIdentifier(INPUT_STRUCTURE);
+
+  InferenceConfig const & inferenceConfig = GetParam()->getInferenceConfig(
+      {GENERATE_UNIQUE_FORMULAS, REPLACEMENTS_FIRST, TREE_ONLY_OUTPUT_STRUCTURE, SEARCH_IN_STRUCTURES});
+  ScAddrVector const & argumentVector = utils::IteratorUtils::getAllWithType(&context, argumentSet, ScType::Node);
+  ScAddr const & outputStructure = context.GenerateNode(ScType::NodeConstStruct);
+  InferenceParams const & inferenceParams{ruleSet, argumentVector, {inputStructure}, outputStructure, targetTemplate};
+  std::unique_ptr<InferenceManagerAbstract> inferenceManager =
+      InferenceManagerFactory::constructDirectInferenceManagerTarget(&context, inferenceConfig);
+  EXPECT_TRUE(inferenceManager->applyInference(inferenceParams));
+
+  ScAddr const & argument = context.SearchElementBySystemIdentifier("argument");
+  ScAddr const & firstClass = context.SearchElementBySystemIdentifier("first_node_class");
+  ScAddr const & thirdClass = context.SearchElementBySystemIdentifier("third_node_class");
+  ScAddr const & targetClass = context.SearchElementBySystemIdentifier("target_node_class");
+  EXPECT_TRUE(context.CheckConnector(thirdClass, argument, ScType::EdgeAccessConstPosPerm));
+  EXPECT_TRUE(context.CheckConnector(targetClass, argument, ScType::EdgeAccessConstPosPerm));
+  // The cycle is closed by a formula that is already in the knowledge base, so it is not generated again
+  ScIterator3Ptr const & firstClassArcsIterator =
+      context.CreateIterator3(firstClass, ScType::EdgeAccessConstPosPerm, argument);
+  size_t firstClassArcsAmount = 0;
+  while (firstClassArcsIterator->Next())
+    ++firstClassArcsAmount;
+  EXPECT_EQ(firstClassArcsAmount, 1u);
+}
+
 TEST_P(InferenceManagerTest, SuccessGenerateInferenceConclusion)
 {
   ScMemoryContext & context = *m_ctx;
@@ -16,6 +16,8 @@
 #include <sc-agents-common/utils/IteratorUtils.hpp>
 #include <sc-agents-common/utils/GenerationUtils.hpp>
 
+#include <set>
+
 namespace inference::inferenceManagerBuilderTest
 {
 ScsLoader loader;
@@ -49,6 +51,57 @@ INSTANTIATE_TEST_SUITE_P(
       return testParamInfo.param->getName();
     });
 
+using SolutionNode = std::pair<ScAddr, std::set<std::pair<ScAddr::HashType, ScAddr::HashType>>>;
+
+// Formulas and pairs of variables and their replacements of solution tree nodes in order of the nodes
+std::vector<SolutionNode> getSolutionNodes(ScMemoryContext & context, ScAddr const & solution)
+{
+  std::vector<SolutionNode> nodes;
+  ScAddr solutionNode = utils::IteratorUtils::getAnyByOutRelation(&context, solution, ScKeynodes::rrel_1);
+  while (solutionNode.IsValid())
+  {
+    SolutionNode & node = nodes.emplace_back();
+    node.first = utils::IteratorUtils::getAnyByOutRelation(&context, solutionNode, ScKeynodes::rrel_1);
+    ScAddr const & replacementsNode =
+        utils::IteratorUtils::getAnyByOutRelation(&context, solutionNode, ScKeynodes::rrel_2);
+    for (ScAddr const & pair : utils::IteratorUtils::getAllWithType(&context, replacementsNode, ScType::NodeConst))
+    {
+      ScAddr const & replacement = utils::IteratorUtils::getAnyByOutRelation(&context, pair, ScKeynodes::rrel_1);
+      ScAddr const & variable = utils::IteratorUtils::getAnyByOutRelation(&context, pair, ScKeynodes::rrel_2);
+      node.second.emplace(variable.Hash(), replacement.Hash());
+    }
+    ScIterator3Ptr const & solutionNodeArcIterator =
+        context.CreateIterator3(solution, ScType::EdgeAccessConstPosPerm, solutionNode);
+    solutionNode = ScAddr::Empty;
+    if (!solutionNodeArcIterator->Next())
+      break;
+    ScAddr const & nextArc = utils::IteratorUtils::getAnyByOutRelation(
+        &context, solutionNodeArcIterator->Get(1), ScKeynodes::nrel_basic_sequence);
+    if (nextArc.IsValid())
+      solutionNode = context.GetConnectorIncidentElements(nextArc).second;
+  }
+  return nodes;
+}
+
+// Generated arcs differ between inferences, so arcs of the structure are compared by their sources and targets
+std::multiset<std::pair<ScAddr::HashType, ScAddr::HashType>> getStructureArcs(
+    ScMemoryContext & context,
+    ScAddr const & structure)
+{
+  std::multiset<std::pair<ScAddr::HashType, ScAddr::HashType>> arcs;
+  ScIterator3Ptr const & elementsIterator =
+      context.CreateIterator3(structure, ScType::EdgeAccessConstPosPerm, ScType::Unknown);
+  while (elementsIterator->Next())
+  {
+    ScAddr const & element = elementsIterator->Get(2);
+    if (!context.GetElementType(element).IsEdge())
+      continue;
+    auto const [source, target] = context.GetConnectorIncidentElements(element);
+    arcs.emplace(source.Hash(), target.Hash());
+  }
+  return arcs;
+}
+
 // Distributed input structures
 TEST_P(InferenceManagerBuilderTest, SingleSuccessApplyInference)
 {
@@ -94,6 +147,73 @@ TEST_P(InferenceManagerBuilderTest, SingleSuccessApplyInference)
   EXPECT_TRUE(context.CheckConnector(targetClass, argument, ScType::EdgeAccessConstPosPerm));
 }
 
+TEST_P(InferenceManagerBuilderTest, CompiledRulesAreReusedBetweenInferences)
+{
+  ScMemoryContext & context = *m_ctx;
+
+  loader.loadScsFile(context, TEST_FILES_DIR_PATH + "singleApplyTest.scs");
+
+  ScAddr const & inputStructure1 = context.ResolveElementSystemIdentifier(INPUT_STRUCTURE1);
+  ScAddr const & inputStructure2 = context.ResolveElementSystemIdentifier(INPUT_STRUCTURE2);
+  ScAddr const & argument = context.ResolveElementSystemIdentifier(ARGUMENT);
+  ScAddr const & formulasSet = context.ResolveElementSystemIdentifier(FORMULAS_SET);
+
+  InferenceConfig const & inferenceConfig = GetParam()->getInferenceConfig(
+      {GENERATE_ALL_FORMULAS, REPLACEMENTS_ALL, TREE_ONLY_OUTPUT_STRUCTURE, SEARCH_IN_STRUCTURES});
+  auto const compiledRulesCache = std::make_shared<inference::CompiledRulesCache>();
+  for (size_t inferenceIndex = 0; inferenceIndex < 2; ++inferenceIndex)
+  {
+    ScAddr const & outputStructure = context.GenerateNode(ScType::NodeConstStruct);
+    InferenceParams const & inferenceParams{
+        formulasSet, {argument}, {inputStructure1, inputStructure2}, outputStructure};
+    std::unique_ptr<inference::InferenceManagerAbstract> iterationStrategy =
+        inference::InferenceManagerFactory::constructDirectInferenceManagerAll(&context, inferenceConfig);
+    iterationStrategy->setCompiledRulesCache(compiledRulesCache);
+    iterationStrategy->applyInference(inferenceParams);
+  }
+
+  // Rule is built by the first inference only
+  inference::CompiledRulesCache::Statistics const & statistics = compiledRulesCache->getStatistics();
+  EXPECT_EQ(statistics.missesAmount, 1u);
+  EXPECT_GE(statistics.hitsAmount, 1u);
+
+  ScAddr const & targetClass = context.SearchElementBySystemIdentifier(TARGET_NODE_CLASS);
+  EXPECT_TRUE(context.CheckConnector(targetClass, argument, ScType::EdgeAccessConstPosPerm));
+}
+
+TEST_P(InferenceManagerBuilderTest, FormulaMetadataIsReusedBetweenInferences)
+{
+  ScMemoryContext & context = *m_ctx;
+
+  loader.loadScsFile(context, TEST_FILES_DIR_PATH + "singleApplyTest.scs");
+
+  ScAddr const & inputStructure1 = context.ResolveElementSystemIdentifier(INPUT_STRUCTURE1);
+  ScAddr const & inputStructure2 = context.ResolveElementSystemIdentifier(INPUT_STRUCTURE2);
+  ScAddr const & argument = context.ResolveElementSystemIdentifier(ARGUMENT);
+  ScAddr const & formulasSet = context.ResolveElementSystemIdentifier(FORMULAS_SET);
+
+  InferenceConfig const & inferenceConfig = GetParam()->getInferenceConfig(
+      {GENERATE_ALL_FORMULAS, REPLACEMENTS_ALL, TREE_ONLY_OUTPUT_STRUCTURE, SEARCH_IN_STRUCTURES});
+  auto const formulaMetadataCache = std::make_shared<inference::FormulaMetadataCache>();
+  inference::FormulaMetadataCache::setShared(formulaMetadataCache);
+  std::vector<size_t> missesAmounts;
+  for (size_t inferenceIndex = 0; inferenceIndex < 2; ++inferenceIndex)
+  {
+    ScAddr const & outputStructure = context.GenerateNode(ScType::NodeConstStruct);
+    InferenceParams const & inferenceParams{
+        formulasSet, {argument}, {inputStructure1, inputStructure2}, outputStructure};
+    std::unique_ptr<inference::InferenceManagerAbstract> iterationStrategy =
+        inference::InferenceManagerFactory::constructDirectInferenceManagerAll(&context, inferenceConfig);
+    iterationStrategy->applyInference(inferenceParams);
+    missesAmounts.push_back(formulaMetadataCache->getStatistics().missesAmount);
+  }
+  inference::FormulaMetadataCache::setShared(nullptr);
+
+  // Formulas are read by the first inference only
+  EXPECT_GT(missesAmounts[0], 0u);
+  EXPECT_EQ(missesAmounts[1], missesAmounts[0]);
+}
+
 TEST_P(InferenceManagerBuilderTest, GenerateNotUnique)
 {
   ScMemoryContext & context = *m_ctx;
@@ -315,6 +435,117 @@ TEST_P(InferenceManagerBuilderTest, GenerateFirst)
   EXPECT_FALSE(targetClassIterator->Next());
 }
 
+// Test if conclusion was generated only for the limited amount of premise replacements
+TEST_P(InferenceManagerBuilderTest, GenerateByLimitedReplacements)
+{
+  ScMemoryContext & context = *m_ctx;
+
+  loader.loadScsFile(context, TEST_FILES_DIR_PATH + "generateNotFirstTest.scs");
+
+  ScAddr const & inputStructure1 = context.ResolveElementSystemIdentifier(INPUT_STRUCTURE1);
+  ScAddr const & inputStructure2 = context.ResolveElementSystemIdentifier(INPUT_STRUCTURE2);
+  ScAddrUnorderedSet inputStructures{inputStructure1, inputStructure2};
+  ScAddr const & argument = context.ResolveElementSystemIdentifier(ARGUMENT);
+  ScAddrVector arguments{argument};
+  for (size_t i = 2; i < 6; i++)
+  {
+    arguments.push_back(context.ResolveElementSystemIdentifier(ARGUMENT + to_string(i)));
+  }
+  ScAddr const & rulesSet = context.ResolveElementSystemIdentifier(FORMULAS_SET);
+  ScAddr const & outputStructure = context.GenerateNode(ScType::NodeConstStruct);
+
+  InferenceConfig inferenceConfig = GetParam()->getInferenceConfig(
+      {GENERATE_ALL_FORMULAS, REPLACEMENTS_ALL, TREE_ONLY_OUTPUT_STRUCTURE, SEARCH_IN_STRUCTURES});
+  inferenceConfig.resultsLimit = 2;
+  std::unique_ptr<inference::InferenceManagerAbstract> iterationStrategy =
+      inference::InferenceManagerFactory::constructDirectInferenceManagerAll(&context, inferenceConfig);
+
+  InferenceParams const & inferenceParams{rulesSet, arguments, inputStructures, outputStructure};
+  EXPECT_TRUE(iterationStrategy->applyInference(inferenceParams));
+
+  ScAddr const & targetClass = context.SearchElementBySystemIdentifier(TARGET_NODE_CLASS);
+  ScIterator3Ptr const & targetClassIterator =
+      context.CreateIterator3(targetClass, ScType::EdgeAccessConstPosPerm, ScType::NodeConst);
+  EXPECT_TRUE(targetClassIterator->Next());
+  EXPECT_TRUE(targetClassIterator->Next());
+  EXPECT_FALSE(targetClassIterator->Next());
+}
+
+// Rules of one priority set are applied with premises computed in parallel. Rules of the set do not generate premises
+// of each other, so they generate the same elements and solution tree as rules applied sequentially
+TEST_P(InferenceManagerBuilderTest, ApplyRulesOfPrioritySetInParallel)
+{
+  ScMemoryContext & context = *m_ctx;
+
+  loader.loadScsFile(context, TEST_FILES_DIR_PATH + "parallelRulesTest.scs");
+
+  ScAddr const & inputStructure1 = context.ResolveElementSystemIdentifier(INPUT_STRUCTURE1);
+  ScAddr const & inputStructure2 = context.ResolveElementSystemIdentifier(INPUT_STRUCTURE2);
+  ScAddrUnorderedSet inputStructures{inputStructure1, inputStructure2};
+  ScAddr const & argument = context.ResolveElementSystemIdentifier(ARGUMENT);
+  ScAddrVector arguments{argument};
+  ScAddr const & rulesSet = context.ResolveElementSystemIdentifier(FORMULAS_SET);
+
+  InferenceConfig inferenceConfig =
+      GetParam()->getInferenceConfig({GENERATE_ALL_FORMULAS, REPLACEMENTS_ALL, TREE_FULL, SEARCH_IN_STRUCTURES});
+  ScAddr const & sequentialOutputStructure = context.GenerateNode(ScType::NodeConstStruct);
+  std::unique_ptr<inference::InferenceManagerAbstract> sequentialStrategy =
+      inference::InferenceManagerFactory::constructDirectInferenceManagerAll(&context, inferenceConfig);
+  InferenceParams const & sequentialInferenceParams{rulesSet, arguments, inputStructures, sequentialOutputStructure};
+  EXPECT_TRUE(sequentialStrategy->applyInference(sequentialInferenceParams));
+
+  inferenceConfig.rulesEvaluationType = RULES_IN_PARALLEL;
+  ScAddr const & outputStructure = context.GenerateNode(ScType::NodeConstStruct);
+  std::unique_ptr<inference::InferenceManagerAbstract> iterationStrategy =
+      inference::InferenceManagerFactory::constructDirectInferenceManagerAll(&context, inferenceConfig);
+  InferenceParams const & inferenceParams{rulesSet, arguments, inputStructures, outputStructure};
+  EXPECT_TRUE(iterationStrategy->applyInference(inferenceParams));
+
+  ScAddr const & targetClass = context.SearchElementBySystemIdentifier(TARGET_NODE_CLASS);
+  ScAddr const & secondTargetClass = context.SearchElementBySystemIdentifier("second_target_node_class");
+  EXPECT_TRUE(context.CheckConnector(targetClass, argument, ScType::EdgeAccessConstPosPerm));
+  EXPECT_TRUE(context.CheckConnector(secondTargetClass, argument, ScType::EdgeAccessConstPosPerm));
+  ScAddr const & fakeArgument = context.SearchElementBySystemIdentifier("fake_argument");
+  EXPECT_FALSE(context.CheckConnector(targetClass, fakeArgument, ScType::EdgeAccessConstPosPerm));
+
+  ScAddr const & sequentialSolution =
+      sequentialStrategy->getSolutionTreeManager()->createSolution(sequentialOutputStructure, true);
+  ScAddr const & solution = iterationStrategy->getSolutionTreeManager()->createSolution(outputStructure, true);
+  std::vector<SolutionNode> const & solutionNodes = getSolutionNodes(context, solution);
+  EXPECT_EQ(solutionNodes.size(), 2u);
+  EXPECT_EQ(solutionNodes, getSolutionNodes(context, sequentialSolution));
+  std::multiset<std::pair<ScAddr::HashType, ScAddr::HashType>> const & generatedArcs =
+      getStructureArcs(context, outputStructure);
+  EXPECT_FALSE(generatedArcs.empty());
+  EXPECT_EQ(generatedArcs, getStructureArcs(context, sequentialOutputStructure));
+}
+
+// The rule of the set is used with the premise generated by the rule used before it in the same set
+TEST_P(InferenceManagerBuilderTest, RuleUsesPremiseGeneratedInSameSet)
+{
+  ScMemoryContext & context = *m_ctx;
+
+  loader.loadScsFile(context, TEST_FILES_DIR_PATH + "sameSetPremiseTest.scs");
+
+  ScAddr const & inputStructure1 = context.ResolveElementSystemIdentifier(INPUT_STRUCTURE1);
+  ScAddr const & rulesSet = context.ResolveElementSystemIdentifier(FORMULAS_SET);
+  ScAddr const & outputStructure = context.GenerateNode(ScType::NodeConstStruct);
+
+  InferenceConfig const & inferenceConfig = GetParam()->getInferenceConfig(
+      {GENERATE_UNIQUE_FORMULAS, REPLACEMENTS_ALL, TREE_ONLY_OUTPUT_STRUCTURE, SEARCH_IN_ALL_KB});
+  std::unique_ptr<inference::InferenceManagerAbstract> iterationStrategy =
+      inference::InferenceManagerFactory::constructDirectInferenceManagerAll(&context, inferenceConfig);
+
+  InferenceParams const & inferenceParams{rulesSet, {}, {inputStructure1}, outputStructure};
+  EXPECT_TRUE(iterationStrategy->applyInference(inferenceParams));
+
+  ScAddr const & argument = context.SearchElementBySystemIdentifier(ARGUMENT);
+  ScAddr const & intermediateClass = context.SearchElementBySystemIdentifier("intermediate_node_class");
+  ScAddr const & targetClass = context.SearchElementBySystemIdentifier(TARGET_NODE_CLASS);
+  EXPECT_TRUE(context.CheckConnector(intermediateClass, argument, ScType::EdgeAccessConstPosPerm));
+  EXPECT_TRUE(context.CheckConnector(targetClass, argument, ScType::EdgeAccessConstPosPerm));
+}
+
 TEST_P(InferenceManagerBuilderTest, notGenerateSolutionTree)
 {
   ScMemoryContext & context = *m_ctx;
@@ -0,0 +1,682 @@
+/*
+ * This source file is part of an OSTIS project. For the latest info, see http://ostis.net
+ * Distributed under the MIT License
+ * (See accompanying file COPYING.MIT or copy at http://opensource.org/licenses/MIT)
+ */
+
+#include "utils/FactorizedReplacements.hpp"
+#include "utils/ReplacementsUtils.hpp"
+#include "utils/ReplacementsArena.hpp"
+#include "utils/ReplacementsKernels.hpp"
+#include "utils/TemplateParamsStream.hpp"
+#include "utils/ThreadPool.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <optional>
+#include <set>
+
+#include <sc_test.hpp>
+
+namespace inference::replacementsUtilsTest
+{
+using ReplacementsUtilsTest = ScMemoryTest;
+using ColumnsSet = std::multiset<std::vector<size_t>>;
+
+ScAddrVector generateNodes(ScMemoryContext & context, ScType const & type, size_t amount)
+{
+  ScAddrVector nodes;
+  for (size_t i = 0; i < amount; ++i)
+    nodes.push_back(context.GenerateNode(type));
+  return nodes;
+}
+
+Replacements createReplacements(ScAddrVector const & keys, std::vector<ScAddrVector> const & columns)
+{
+  Replacements replacements(keys);
+  for (ScAddrVector const & column : columns)
+    replacements.addColumn({column.data(), column.size()});
+  return replacements;
+}
+
+ScAddrVector getColumnValues(Replacements const & replacements, size_t columnIndex)
+{
+  Replacements::ColumnView const & column = replacements.getColumn(columnIndex);
+  return {column.begin(), column.end()};
+}
+
+// Columns of replacements with values ordered as `keys`, so tables with different keys order can be compared
+ColumnsSet getColumns(Replacements const & replacements, ScAddrVector const & keys)
+{
+  ColumnsSet columns;
+  for (size_t columnIndex = 0; columnIndex < replacements.getColumnsAmount(); ++columnIndex)
+  {
+    std::vector<size_t> column;
+    for (ScAddr const & key : keys)
+      column.push_back(replacements.get(columnIndex, replacements.getKeyIndex(key)).Hash());
+    columns.insert(column);
+  }
+  return columns;
+}
+
+TEST_F(ReplacementsUtilsTest, RowsAndColumnsViews)
+{
+  ScAddrVector const & vars = generateNodes(*m_ctx, ScType::NodeVar, 2);
+  ScAddrVector const & consts = generateNodes(*m_ctx, ScType::NodeConst, 4);
+
+  Replacements replacements = createReplacements(vars, {{consts[0], consts[1]}, {consts[2], consts[3]}});
+
+  EXPECT_EQ(replacements.getKeysAmount(), 2u);
+  EXPECT_EQ(replacements.getColumnsAmount(), 2u);
+  EXPECT_TRUE(replacements.hasKey(vars[1]));
+  EXPECT_FALSE(replacements.hasKey(consts[0]));
+  EXPECT_EQ(replacements.findKeyIndex(consts[0]), Replacements::kNotFound);
+
+  Replacements::ColumnView const & column = replacements.getColumn(1);
+  EXPECT_EQ(column.size(), 2u);
+  EXPECT_EQ(column[0], consts[2]);
+  EXPECT_EQ(column[1], consts[3]);
+
+  Replacements::RowView const & row = replacements.getRow(vars[1]);
+  EXPECT_EQ(row.size(), 2u);
+  EXPECT_EQ(row[0], consts[1]);
+  EXPECT_EQ(row[1], consts[3]);
+  ScAddrVector const rowValues(row.begin(), row.end());
+  EXPECT_EQ(rowValues, ScAddrVector({consts[1], consts[3]}));
+
+  std::vector<ScTemplateParams> templateParams;
+  ReplacementsUtils::getReplacementsToScTemplateParams(replacements, templateParams);
+  ASSERT_EQ(templateParams.size(), 2u);
+  ScAddr value;
+  EXPECT_TRUE(templateParams[1].Get(vars[0], value));
+  EXPECT_EQ(value, consts[2]);
+}
+
+TEST_F(ReplacementsUtilsTest, TemplateParamsStreamCreatesParamsForColumns)
+{
+  ScAddrVector const & vars = generateNodes(*m_ctx, ScType::NodeVar, 2);
+  ScAddrVector const & consts = generateNodes(*m_ctx, ScType::NodeConst, 6);
+  Replacements const & replacements =
+      createReplacements(vars, {{consts[0], consts[1]}, {consts[2], consts[3]}, {consts[4], consts[5]}});
+
+  TemplateParamsStream paramsStream(replacements, {2, 0});
+  EXPECT_EQ(paramsStream.getParamsAmount(), 2u);
+  ScTemplateParams params;
+  ScAddr value;
+  ASSERT_TRUE(paramsStream.next(params));
+  EXPECT_TRUE(params.Get(vars[1], value));
+  EXPECT_EQ(value, consts[5]);
+  ASSERT_TRUE(paramsStream.next(params));
+  EXPECT_TRUE(params.Get(vars[1], value));
+  EXPECT_EQ(value, consts[1]);
+  EXPECT_FALSE(paramsStream.next(params));
+
+  TemplateParamsStream allParamsStream(replacements);
+  size_t paramsAmount = 0;
+  while (allParamsStream.next(params))
+    ++paramsAmount;
+  EXPECT_EQ(paramsAmount, 3u);
+  allParamsStream.reset();
+  EXPECT_TRUE(allParamsStream.next(params));
+}
+
+TEST_F(ReplacementsUtilsTest, ReplacementsWithoutKeysHaveNoColumns)
+{
+  Replacements replacements;
+  replacements.addColumn();
+
+  EXPECT_TRUE(replacements.empty());
+  EXPECT_EQ(ReplacementsUtils::getColumnsAmount(replacements), 0u);
+}
+
+TEST_F(ReplacementsUtilsTest, ColumnHashDependsOnSegmentAndValuesOrder)
+{
+  ScAddr const firstAddr(sc_addr{1, 5});
+  ScAddr const secondAddr(sc_addr{2, 5});
+  EXPECT_NE(ReplacementsHash::hashAddr(firstAddr), ReplacementsHash::hashAddr(secondAddr));
+
+  ScAddrVector const column = {firstAddr, secondAddr};
+  EXPECT_EQ(ReplacementsHash::hashColumn(column.data(), {0, 1}), ReplacementsHash::hashColumn(column.data(), {0, 1}));
+  EXPECT_NE(ReplacementsHash::hashColumn(column.data(), {0, 1}), ReplacementsHash::hashColumn(column.data(), {1, 0}));
+  EXPECT_EQ(ReplacementsHash::hashColumn(column.data(), {}), ReplacementsHash::hashColumn(column.data() + 1, {}));
+}
+
+TEST_F(ReplacementsUtilsTest, KernelsGiveSameResultsForAllInstructionSets)
+{
+  ScAddrVector const & vars = generateNodes(*m_ctx, ScType::NodeVar, 10);
+  ScAddrVector const & consts = generateNodes(*m_ctx, ScType::NodeConst, 3);
+  std::vector<ScAddrVector> columns;
+  for (size_t columnIndex = 0; columnIndex < 11; ++columnIndex)
+  {
+    ScAddrVector column;
+    for (size_t keyIndex = 0; keyIndex < vars.size(); ++keyIndex)
+      column.push_back(consts[(columnIndex + keyIndex * columnIndex) % consts.size()]);
+    columns.push_back(column);
+  }
+  Replacements const & replacements = createReplacements(vars, columns);
+  // More than 8 keys are used to check gathering of values as well as comparison of the rest ones
+  std::vector<size_t> const keysIndices = {9, 0, 5, 3, 1, 7, 8, 6, 2};
+  std::vector<size_t> const otherKeysIndices = {9, 0, 5, 3, 1, 7, 8, 6, 4};
+
+  std::vector<uint64_t> expectedHashes;
+  for (size_t columnIndex = 0; columnIndex < columns.size(); ++columnIndex)
+    expectedHashes.push_back(ReplacementsHash::hashColumn(replacements.getColumnValues(columnIndex), keysIndices));
+
+  ReplacementsKernels::InstructionSet const instructionSet = ReplacementsKernels::getInstructionSet();
+  for (ReplacementsKernels::InstructionSet const testedInstructionSet :
+       {ReplacementsKernels::SCALAR, ReplacementsKernels::getSupportedInstructionSet()})
+  {
+    ReplacementsKernels::setInstructionSet(testedInstructionSet);
+    std::vector<uint64_t> hashes;
+    ReplacementsKernels::hashColumns(replacements, keysIndices, hashes);
+    EXPECT_EQ(hashes, expectedHashes);
+
+    for (size_t columnIndex = 0; columnIndex < columns.size(); ++columnIndex)
+    {
+      ScAddr const * column = replacements.getColumnValues(columnIndex);
+      EXPECT_TRUE(ReplacementsKernels::areValuesEqual(column, keysIndices, column, keysIndices));
+      EXPECT_EQ(
+          ReplacementsKernels::areValuesEqual(column, keysIndices, column, otherKeysIndices),
+          column[2] == column[4]);
+    }
+  }
+  ReplacementsKernels::setInstructionSet(instructionSet);
+}
+
+TEST_F(ReplacementsUtilsTest, RemoveDuplicateColumnsKeepsFirstOccurrences)
+{
+  ScAddrVector const & vars = generateNodes(*m_ctx, ScType::NodeVar, 2);
+  ScAddrVector const & consts = generateNodes(*m_ctx, ScType::NodeConst, 3);
+
+  Replacements replacements = createReplacements(
+      vars,
+      {{consts[0], consts[1]},
+       {consts[1], consts[0]},
+       {consts[0], consts[1]},
+       {consts[2], consts[2]},
+       {consts[1], consts[0]},
+       {consts[0], consts[1]}});
+
+  ReplacementsUtils::removeDuplicateColumns(replacements);
+
+  ASSERT_EQ(replacements.getColumnsAmount(), 3u);
+  EXPECT_EQ(getColumnValues(replacements, 0), ScAddrVector({consts[0], consts[1]}));
+  EXPECT_EQ(getColumnValues(replacements, 1), ScAddrVector({consts[1], consts[0]}));
+  EXPECT_EQ(getColumnValues(replacements, 2), ScAddrVector({consts[2], consts[2]}));
+}
+
+TEST_F(ReplacementsUtilsTest, IntersectWithCommonKeys)
+{
+  ScAddrVector const & vars = generateNodes(*m_ctx, ScType::NodeVar, 3);
+  ScAddrVector const & consts = generateNodes(*m_ctx, ScType::NodeConst, 6);
+
+  Replacements const & first = createReplacements(
+      {vars[0], vars[1]}, {{consts[0], consts[1]}, {consts[2], consts[3]}, {consts[2], consts[3]}});
+  Replacements const & second =
+      createReplacements({vars[2], vars[1]}, {{consts[4], consts[1]}, {consts[5], consts[1]}, {consts[5], consts[0]}});
+
+  Replacements intersection;
+  ReplacementsUtils::intersectReplacements(first, second, intersection);
+
+  EXPECT_EQ(intersection.getKeysAmount(), 3u);
+  EXPECT_EQ(
+      getColumns(intersection, vars),
+      ColumnsSet(
+          {{consts[0].Hash(), consts[1].Hash(), consts[4].Hash()},
+           {consts[0].Hash(), consts[1].Hash(), consts[5].Hash()}}));
+}
+
+// Columns of both tables are sorted by the common key, `second` has two columns for each value of `first`
+void testJoinStrategy(
+    ScMemoryContext & context,
+    size_t firstColumnsAmount,
+    bool areColumnsSorted,
+    ReplacementsUtils::JoinStrategy expectedJoinStrategy)
+{
+  ScAddrVector const & vars = generateNodes(context, ScType::NodeVar, 3);
+  ScAddrVector consts = generateNodes(context, ScType::NodeConst, firstColumnsAmount);
+  std::sort(consts.begin(), consts.end(), ScAddrLessFunc());
+  ScAddr const & otherConst = context.GenerateNode(ScType::NodeConst);
+
+  std::vector<ScAddrVector> firstColumns;
+  std::vector<ScAddrVector> secondColumns;
+  ColumnsSet expectedColumns;
+  for (size_t columnIndex = 0; columnIndex < firstColumnsAmount; ++columnIndex)
+  {
+    size_t const sourceIndex = areColumnsSorted ? columnIndex : firstColumnsAmount - columnIndex - 1;
+    ScAddr const & value = consts[sourceIndex];
+    firstColumns.push_back({otherConst, value});
+    secondColumns.push_back({value, consts[0]});
+    secondColumns.push_back({value, otherConst});
+    expectedColumns.insert({otherConst.Hash(), value.Hash(), consts[0].Hash()});
+    expectedColumns.insert({otherConst.Hash(), value.Hash(), otherConst.Hash()});
+  }
+  Replacements const & first = createReplacements({vars[0], vars[1]}, firstColumns);
+  Replacements const & second = createReplacements({vars[1], vars[2]}, secondColumns);
+
+  ReplacementsUtils::resetJoinsAmounts();
+  Replacements intersection;
+  ReplacementsUtils::intersectReplacements(first, second, intersection);
+
+  EXPECT_EQ(ReplacementsUtils::getJoinsAmount(expectedJoinStrategy), 1u);
+  EXPECT_EQ(getColumns(intersection, vars), expectedColumns);
+}
+
+TEST_F(ReplacementsUtilsTest, IntersectTinyReplacementsWithNestedLoopJoin)
+{
+  testJoinStrategy(*m_ctx, 2, false, ReplacementsUtils::NESTED_LOOP_JOIN);
+}
+
+TEST_F(ReplacementsUtilsTest, IntersectSortedReplacementsWithSortMergeJoin)
+{
+  testJoinStrategy(*m_ctx, 20, true, ReplacementsUtils::SORT_MERGE_JOIN);
+}
+
+TEST_F(ReplacementsUtilsTest, IntersectUnsortedReplacementsWithHashJoin)
+{
+  testJoinStrategy(*m_ctx, 20, false, ReplacementsUtils::HASH_JOIN);
+}
+
+TEST_F(ReplacementsUtilsTest, IntersectWithoutCommonKeys)
+{
+  ScAddrVector const & vars = generateNodes(*m_ctx, ScType::NodeVar, 2);
+  ScAddrVector const & consts = generateNodes(*m_ctx, ScType::NodeConst, 4);
+
+  Replacements const & first = createReplacements({vars[0]}, {{consts[0]}, {consts[1]}});
+  Replacements const & second = createReplacements({vars[1]}, {{consts[2]}, {consts[3]}});
+
+  Replacements intersection;
+  ReplacementsUtils::intersectReplacements(first, second, intersection);
+
+  EXPECT_EQ(intersection.getColumnsAmount(), 4u);
+}
+
+TEST_F(ReplacementsUtilsTest, IntersectIntoOperand)
+{
+  ScAddrVector const & vars = generateNodes(*m_ctx, ScType::NodeVar, 2);
+  ScAddrVector const & consts = generateNodes(*m_ctx, ScType::NodeConst, 3);
+
+  Replacements first = createReplacements({vars[0]}, {{consts[0]}, {consts[1]}});
+  Replacements const & second = createReplacements({vars[0], vars[1]}, {{consts[1], consts[2]}});
+
+  ReplacementsUtils::intersectReplacements(first, second, first);
+
+  EXPECT_EQ(getColumns(first, vars), ColumnsSet({{consts[1].Hash(), consts[2].Hash()}}));
+}
+
+TEST_F(ReplacementsUtilsTest, NarrowWithFiltersColumnsInPlace)
+{
+  ScAddrVector const & vars = generateNodes(*m_ctx, ScType::NodeVar, 3);
+  ScAddrVector const & consts = generateNodes(*m_ctx, ScType::NodeConst, 4);
+
+  Replacements accumulator = createReplacements(
+      {vars[0], vars[1]}, {{consts[0], consts[1]}, {consts[2], consts[3]}, {consts[0], consts[3]}});
+  ScAddr const * values = accumulator.getValues();
+
+  ReplacementsUtils::narrowWith(accumulator, createReplacements({vars[1]}, {{consts[3]}, {consts[2]}}));
+  EXPECT_EQ(accumulator.getValues(), values);
+  EXPECT_EQ(getColumnValues(accumulator, 0), ScAddrVector({consts[2], consts[3]}));
+  EXPECT_EQ(getColumnValues(accumulator, 1), ScAddrVector({consts[0], consts[3]}));
+
+  ReplacementsUtils::narrowWith(accumulator, createReplacements({vars[0], vars[2]}, {{consts[0], consts[1]}}));
+  EXPECT_EQ(getColumns(accumulator, vars), ColumnsSet({{consts[0].Hash(), consts[3].Hash(), consts[1].Hash()}}));
+}
+
+TEST_F(ReplacementsUtilsTest, SubtractReplacements)
+{
+  ScAddrVector const & vars = generateNodes(*m_ctx, ScType::NodeVar, 2);
+  ScAddrVector const & consts = generateNodes(*m_ctx, ScType::NodeConst, 4);
+
+  Replacements const & first = createReplacements(
+      {vars[0], vars[1]}, {{consts[0], consts[1]}, {consts[2], consts[3]}, {consts[0], consts[3]}});
+  Replacements const & second = createReplacements({vars[1]}, {{consts[1]}});
+
+  Replacements difference;
+  ReplacementsUtils::subtractReplacements(first, second, difference);
+
+  EXPECT_EQ(
+      getColumns(difference, vars),
+      ColumnsSet({{consts[2].Hash(), consts[3].Hash()}, {consts[0].Hash(), consts[3].Hash()}}));
+}
+
+TEST_F(ReplacementsUtilsTest, SemiJoinAndAntiJoinSelectColumnsOfFirst)
+{
+  ScAddrVector const & vars = generateNodes(*m_ctx, ScType::NodeVar, 3);
+  ScAddrVector const & consts = generateNodes(*m_ctx, ScType::NodeConst, 4);
+
+  Replacements const & first = createReplacements(
+      {vars[0], vars[1]}, {{consts[0], consts[1]}, {consts[2], consts[3]}, {consts[0], consts[3]}});
+  Replacements const & second = createReplacements({vars[2], vars[1]}, {{consts[0], consts[3]}});
+
+  std::vector<size_t> matchedColumns;
+  ReplacementsUtils::semiJoinReplacements(first, second, matchedColumns);
+  EXPECT_EQ(matchedColumns, std::vector<size_t>({1, 2}));
+
+  std::vector<size_t> unmatchedColumns;
+  ReplacementsUtils::antiJoinReplacements(first, second, unmatchedColumns);
+  EXPECT_EQ(unmatchedColumns, std::vector<size_t>({0}));
+
+  Replacements const & replacementsWithoutCommonKeys = createReplacements({vars[2]}, {{consts[0]}});
+  std::vector<size_t> columnsWithoutCommonKeys;
+  ReplacementsUtils::antiJoinReplacements(first, replacementsWithoutCommonKeys, columnsWithoutCommonKeys);
+  EXPECT_EQ(columnsWithoutCommonKeys, std::vector<size_t>({0, 1, 2}));
+}
+
+TEST_F(ReplacementsUtilsTest, UniteWithSameKeys)
+{
+  ScAddrVector const & vars = generateNodes(*m_ctx, ScType::NodeVar, 2);
+  ScAddrVector const & consts = generateNodes(*m_ctx, ScType::NodeConst, 4);
+
+  Replacements const & first =
+      createReplacements({vars[0], vars[1]}, {{consts[0], consts[1]}, {consts[2], consts[3]}});
+  Replacements const & second =
+      createReplacements({vars[1], vars[0]}, {{consts[1], consts[0]}, {consts[0], consts[1]}});
+
+  Replacements unionResult;
+  ReplacementsUtils::uniteReplacements(first, second, unionResult);
+
+  EXPECT_EQ(
+      getColumns(unionResult, vars),
+      ColumnsSet(
+          {{consts[0].Hash(), consts[1].Hash()},
+           {consts[2].Hash(), consts[3].Hash()},
+           {consts[1].Hash(), consts[0].Hash()}}));
+}
+
+TEST_F(ReplacementsUtilsTest, UniteWithDifferentKeys)
+{
+  ScAddrVector const & vars = generateNodes(*m_ctx, ScType::NodeVar, 3);
+  ScAddrVector const & consts = generateNodes(*m_ctx, ScType::NodeConst, 4);
+
+  Replacements const & first = createReplacements({vars[0], vars[1]}, {{consts[0], consts[1]}});
+  Replacements const & second = createReplacements({vars[0]}, {{consts[2]}, {consts[3]}});
+
+  Replacements unionResult;
+  ReplacementsUtils::uniteReplacements(first, second, unionResult);
+
+  EXPECT_EQ(unionResult.getKeysAmount(), 2u);
+  EXPECT_EQ(
+      getColumns(unionResult, {vars[0], vars[1]}),
+      ColumnsSet(
+          {{consts[0].Hash(), consts[1].Hash()},
+           {consts[2].Hash(), consts[1].Hash()},
+           {consts[3].Hash(), consts[1].Hash()}}));
+}
+
+TEST_F(ReplacementsUtilsTest, FactorizedUnionExpandsToUniteResult)
+{
+  ScAddrVector const & vars = generateNodes(*m_ctx, ScType::NodeVar, 4);
+  ScAddrVector const & consts = generateNodes(*m_ctx, ScType::NodeConst, 4);
+
+  Replacements const & first = createReplacements(
+      {vars[0], vars[1]}, {{consts[0], consts[1]}, {consts[1], consts[2]}, {consts[2], consts[1]}});
+  Replacements const & second =
+      createReplacements({vars[1], vars[2]}, {{consts[1], consts[3]}, {consts[2], consts[0]}});
+  Replacements const & third = createReplacements({vars[3]}, {{consts[0]}, {consts[3]}});
+
+  for (Replacements const * other : {&second, &third})
+  {
+    Replacements unionResult;
+    ReplacementsUtils::uniteReplacements(first, *other, unionResult);
+    FactorizedReplacements factorizedUnionResult;
+    FactorizedReplacements::unite(
+        FactorizedReplacements(first), FactorizedReplacements(*other), factorizedUnionResult);
+    Replacements expandedUnionResult;
+    factorizedUnionResult.expand(expandedUnionResult);
+
+    EXPECT_FALSE(factorizedUnionResult.isTable());
+    EXPECT_EQ(expandedUnionResult.getKeys(), unionResult.getKeys());
+    EXPECT_EQ(getColumns(expandedUnionResult, unionResult.getKeys()), getColumns(unionResult, unionResult.getKeys()));
+  }
+}
+
+TEST_F(ReplacementsUtilsTest, FactorizedNarrowingKeepsProduct)
+{
+  ScAddrVector const & vars = generateNodes(*m_ctx, ScType::NodeVar, 3);
+  ScAddrVector const & consts = generateNodes(*m_ctx, ScType::NodeConst, 4);
+
+  FactorizedReplacements replacements;
+  FactorizedReplacements::unite(
+      FactorizedReplacements(createReplacements({vars[0]}, {{consts[0]}, {consts[1]}})),
+      FactorizedReplacements(createReplacements({vars[1]}, {{consts[1]}, {consts[2]}, {consts[3]}})),
+      replacements);
+  EXPECT_EQ(replacements.getTermsAmount(), 1u);
+  EXPECT_EQ(replacements.getCombinationsAmount(), 6u);
+
+  replacements.narrowWith(FactorizedReplacements(createReplacements({vars[1]}, {{consts[1]}, {consts[3]}})));
+  replacements.narrowWith(FactorizedReplacements(createReplacements({vars[2]}, {{consts[0]}, {consts[2]}})));
+  EXPECT_EQ(replacements.getTermsAmount(), 1u);
+  EXPECT_EQ(replacements.getCombinationsAmount(), 8u);
+  EXPECT_FALSE(replacements.isTable());
+
+  FactorizedReplacements const replacementsCopy = replacements;
+  EXPECT_EQ(replacements.materialize().getColumnsAmount(), 8u);
+  EXPECT_TRUE(replacements.isTable());
+  EXPECT_FALSE(replacementsCopy.isTable());
+  EXPECT_EQ(replacements.getKeys(), ScAddrVector({vars[0], vars[1], vars[2]}));
+  EXPECT_EQ(
+      getColumns(replacements.getTable(), {vars[1]}),
+      ColumnsSet(
+          {{consts[1].Hash()},
+           {consts[1].Hash()},
+           {consts[1].Hash()},
+           {consts[1].Hash()},
+           {consts[3].Hash()},
+           {consts[3].Hash()},
+           {consts[3].Hash()},
+           {consts[3].Hash()}}));
+
+  replacements.narrowWith(FactorizedReplacements(createReplacements({vars[0], vars[1]}, {{consts[2], consts[1]}})));
+  EXPECT_TRUE(replacements.empty());
+}
+
+TEST_F(ReplacementsUtilsTest, FactorizedColumnsAreStreamedWithoutDuplicates)
+{
+  ScAddrVector const & vars = generateNodes(*m_ctx, ScType::NodeVar, 3);
+  ScAddrVector const & consts = generateNodes(*m_ctx, ScType::NodeConst, 3);
+
+  FactorizedReplacements replacements;
+  FactorizedReplacements::unite(
+      FactorizedReplacements(createReplacements({vars[0], vars[1]}, {{consts[0], consts[1]}, {consts[1], consts[1]}})),
+      FactorizedReplacements(createReplacements({vars[1], vars[2]}, {{consts[1], consts[2]}, {consts[1], consts[0]}})),
+      replacements);
+  EXPECT_EQ(replacements.getTermsAmount(), 2u);
+  EXPECT_EQ(replacements.getCombinationsAmount(), 8u);
+
+  std::set<std::vector<size_t>> columns;
+  size_t paramsAmount = 0;
+  TemplateParamsStream paramsStream(replacements);
+  ScTemplateParams params;
+  while (paramsStream.next(params))
+  {
+    std::vector<size_t> column;
+    for (ScAddr const & var : vars)
+    {
+      ScAddr value;
+      EXPECT_TRUE(params.Get(var, value));
+      column.push_back(value.Hash());
+    }
+    columns.insert(column);
+    ++paramsAmount;
+  }
+  EXPECT_EQ(paramsAmount, 4u);
+  EXPECT_EQ(columns.size(), 4u);
+}
+
+TEST_F(ReplacementsUtilsTest, FactorizedLimitKeepsFirstDistinctColumns)
+{
+  ScAddrVector const & vars = generateNodes(*m_ctx, ScType::NodeVar, 3);
+  ScAddrVector const & consts = generateNodes(*m_ctx, ScType::NodeConst, 3);
+
+  FactorizedReplacements replacements;
+  FactorizedReplacements::unite(
+      FactorizedReplacements(createReplacements({vars[0], vars[1]}, {{consts[0], consts[1]}, {consts[1], consts[1]}})),
+      FactorizedReplacements(createReplacements({vars[1], vars[2]}, {{consts[1], consts[2]}, {consts[1], consts[0]}})),
+      replacements);
+  Replacements allColumns;
+  replacements.expand(allColumns);
+
+  EXPECT_EQ(replacements.limit(3), 3u);
+  EXPECT_TRUE(replacements.isTable());
+  Replacements const & firstColumns = replacements.getTable();
+  EXPECT_EQ(firstColumns.getColumnsAmount(), 3u);
+  for (size_t columnIndex = 0; columnIndex < firstColumns.getColumnsAmount(); ++columnIndex)
+  {
+    for (ScAddr const & var : vars)
+      EXPECT_EQ(firstColumns.at(var)[columnIndex], allColumns.at(var)[columnIndex]);
+  }
+
+  EXPECT_EQ(replacements.limit(10), 3u);
+  EXPECT_EQ(replacements.limit(1), 1u);
+  EXPECT_EQ(replacements.getCombinationsAmount(), 1u);
+  EXPECT_EQ(FactorizedReplacements().limit(1), 0u);
+}
+
+TEST_F(ReplacementsUtilsTest, FactorizedProjectionKeepsDistinctColumns)
+{
+  ScAddrVector const & vars = generateNodes(*m_ctx, ScType::NodeVar, 3);
+  ScAddrVector const & consts = generateNodes(*m_ctx, ScType::NodeConst, 3);
+
+  FactorizedReplacements replacements;
+  FactorizedReplacements::unite(
+      FactorizedReplacements(createReplacements(
+          {vars[0], vars[1]}, {{consts[0], consts[1]}, {consts[0], consts[2]}, {consts[1], consts[1]}})),
+      FactorizedReplacements(createReplacements({vars[2]}, {{consts[0]}, {consts[1]}})),
+      replacements);
+
+  Replacements projection;
+  replacements.project({vars[2], vars[0]}).expand(projection);
+  EXPECT_EQ(projection.getKeys(), ScAddrVector({vars[0], vars[2]}));
+  EXPECT_EQ(
+      getColumns(projection, {vars[0], vars[2]}),
+      ColumnsSet(
+          {{consts[0].Hash(), consts[0].Hash()},
+           {consts[0].Hash(), consts[1].Hash()},
+           {consts[1].Hash(), consts[0].Hash()},
+           {consts[1].Hash(), consts[1].Hash()}}));
+
+  size_t paramsAmount = 0;
+  FactorizedReplacements const & emptyColumnProjection = replacements.project({});
+  TemplateParamsStream paramsStream(emptyColumnProjection);
+  ScTemplateParams params;
+  while (paramsStream.next(params))
+    ++paramsAmount;
+  EXPECT_EQ(paramsAmount, 1u);
+  EXPECT_TRUE(FactorizedReplacements().project({vars[0]}).empty());
+}
+
+TEST_F(ReplacementsUtilsTest, ReplacementsAreAllocatedInArenaOnlyInScope)
+{
+  ScAddrVector const & vars = generateNodes(*m_ctx, ScType::NodeVar, 2);
+  ScAddrVector const & consts = generateNodes(*m_ctx, ScType::NodeConst, 3);
+  Replacements const & first =
+      createReplacements(vars, {{consts[0], consts[1]}, {consts[1], consts[2]}, {consts[0], consts[1]}});
+
+  ReplacementsArena arena;
+  Replacements copyOutOfArena;
+  {
+    ReplacementsArena::Scope const arenaScope(arena);
+    Replacements arenaCopy = first;
+    ReplacementsUtils::removeDuplicateColumns(arenaCopy);
+    EXPECT_GT(arena.getStatistics().allocationsAmount, 0u);
+    copyOutOfArena = arenaCopy;
+  }
+  size_t const allocationsAmount = arena.getStatistics().allocationsAmount;
+  Replacements const other = copyOutOfArena;
+  EXPECT_EQ(arena.getStatistics().allocationsAmount, allocationsAmount);
+
+  arena.reset();
+  EXPECT_EQ(arena.getStatistics().resetsAmount, 1u);
+  EXPECT_EQ(arena.getStatistics().maxFormulaAllocatedBytes, arena.getStatistics().allocatedBytes);
+  EXPECT_EQ(other.getColumnsAmount(), 2u);
+  EXPECT_EQ(getColumnValues(other, 1), ScAddrVector({consts[1], consts[2]}));
+
+  arena.release();
+  EXPECT_EQ(arena.getStatistics().allocationsAmount, 0u);
+}
+
+TEST_F(ReplacementsUtilsTest, ReplacementsMovedOutOfArenaScopeAreCopied)
+{
+  ScAddrVector const & vars = generateNodes(*m_ctx, ScType::NodeVar, 2);
+  ScAddrVector const & consts = generateNodes(*m_ctx, ScType::NodeConst, 3);
+  Replacements const & first = createReplacements(vars, {{consts[0], consts[1]}, {consts[1], consts[2]}});
+
+  ReplacementsArena arena;
+  std::optional<Replacements> arenaCopy;
+  {
+    ReplacementsArena::Scope const arenaScope(arena);
+    arenaCopy.emplace(first);
+  }
+  size_t const allocationsAmount = arena.getStatistics().allocationsAmount;
+  Replacements const moved(std::move(*arenaCopy));
+  EXPECT_EQ(arena.getStatistics().allocationsAmount, allocationsAmount);
+  EXPECT_TRUE(arenaCopy->empty());
+  arenaCopy.reset();
+
+  arena.reset();
+  EXPECT_EQ(moved.getColumnsAmount(), 2u);
+  EXPECT_EQ(getColumnValues(moved, 1), ScAddrVector({consts[1], consts[2]}));
+}
+
+TEST_F(ReplacementsUtilsTest, ParallelJoinAndUnionGiveSameResultsAsSequential)
+{
+  ScAddrVector const & vars = generateNodes(*m_ctx, ScType::NodeVar, 3);
+  ScAddrVector const & consts = generateNodes(*m_ctx, ScType::NodeConst, 50);
+  // Values are shuffled by multiplication, so columns are not sorted and there are duplicates
+  Replacements first(ScAddrVector{vars[0], vars[1]});
+  for (size_t columnIndex = 0; columnIndex < 6000; ++columnIndex)
+  {
+    ScAddr * column = first.addColumn();
+    column[0] = consts[columnIndex * 7 % 50];
+    column[1] = consts[columnIndex * 13 % 47];
+  }
+  Replacements second(ScAddrVector{vars[1], vars[2]});
+  for (size_t columnIndex = 0; columnIndex < 3000; ++columnIndex)
+  {
+    ScAddr * column = second.addColumn();
+    column[0] = consts[columnIndex * 11 % 43];
+    column[1] = consts[columnIndex * 3 % 50];
+  }
+  Replacements third(ScAddrVector{vars[1], vars[0]});
+  for (size_t columnIndex = 0; columnIndex < 4000; ++columnIndex)
+  {
+    ScAddr * column = third.addColumn();
+    column[0] = consts[columnIndex * 17 % 49];
+    column[1] = consts[columnIndex * 9 % 50];
+  }
+
+  size_t const parallelColumnsThreshold = ReplacementsUtils::getParallelColumnsThreshold();
+  ReplacementsUtils::setParallelColumnsThreshold(std::numeric_limits<size_t>::max());
+  Replacements sequentialIntersection;
+  ReplacementsUtils::intersectReplacements(first, second, sequentialIntersection);
+  Replacements sequentialUnion;
+  ReplacementsUtils::uniteReplacements(first, third, sequentialUnion);
+
+  ReplacementsUtils::setParallelColumnsThreshold(1);
+  ThreadPool::setSharedThreadsAmount(4);
+  ReplacementsUtils::resetJoinsAmounts();
+  Replacements parallelIntersection;
+  ReplacementsUtils::intersectReplacements(first, second, parallelIntersection);
+  Replacements parallelUnion;
+  ReplacementsUtils::uniteReplacements(first, third, parallelUnion);
+  EXPECT_EQ(ReplacementsUtils::getJoinsAmount(ReplacementsUtils::PARALLEL_HASH_JOIN), 1u);
+  ReplacementsUtils::setParallelColumnsThreshold(parallelColumnsThreshold);
+  ThreadPool::setSharedThreadsAmount(std::thread::hardware_concurrency());
+
+  EXPECT_GT(sequentialIntersection.getColumnsAmount(), 0u);
+  EXPECT_EQ(parallelIntersection.getKeys(), sequentialIntersection.getKeys());
+  EXPECT_TRUE(std::equal(
+      parallelIntersection.getValues(),
+      parallelIntersection.getValues() + parallelIntersection.getColumnsAmount() * parallelIntersection.getKeysAmount(),
+      sequentialIntersection.getValues(),
+      sequentialIntersection.getValues()
+          + sequentialIntersection.getColumnsAmount() * sequentialIntersection.getKeysAmount()));
+  EXPECT_EQ(parallelUnion.getKeys(), sequentialUnion.getKeys());
+  EXPECT_TRUE(std::equal(
+      parallelUnion.getValues(),
+      parallelUnion.getValues() + parallelUnion.getColumnsAmount() * parallelUnion.getKeysAmount(),
+      sequentialUnion.getValues(),
+      sequentialUnion.getValues() + sequentialUnion.getColumnsAmount() * sequentialUnion.getKeysAmount()));
+}
+
+}  // namespace inference::replacementsUtilsTest
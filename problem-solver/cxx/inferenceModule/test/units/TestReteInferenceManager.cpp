@@ -0,0 +1,231 @@
+/*
+ * This source file is part of an OSTIS project. For the latest info, see http://ostis.net
+ * Distributed under the MIT License
+ * (See accompanying file COPYING.MIT or copy at http://opensource.org/licenses/MIT)
+ */
+
+#include "ConfigGenerators.hpp"
+
+#include "factory/InferenceManagerFactory.hpp"
+
+#include "keynodes/InferenceKeynodes.hpp"
+
+#include <sc_test.hpp>
+#include <scs_loader.hpp>
+
+using namespace inference;
+
+namespace reteInferenceManagerTest
+{
+ScsLoader loader;
+std::string const TEST_FILES_DIR_PATH = TEMPLATE_SEARCH_MODULE_TEST_SRC_PATH "/testStructures/ManagerModule/";
+
+std::string const TARGET_TEMPLATE = "target_template";
+std::string const RULES_SET = "rules_set";
+std::string const INPUT_STRUCTURE = "input_structure";
+
+class ReteInferenceManagerTest
+  : public ScMemoryTest
+  , public testing::WithParamInterface<std::shared_ptr<generatorTest::ConfigGenerator>>
+{
+protected:
+  size_t getArcsAmount(std::string const & sourceIdentifier, std::string const & targetIdentifier)
+  {
+    ScIterator3Ptr const & iterator = m_ctx->CreateIterator3(
+        m_ctx->SearchElementBySystemIdentifier(sourceIdentifier),
+        ScType::EdgeAccessConstPosPerm,
+        m_ctx->SearchElementBySystemIdentifier(targetIdentifier));
+    size_t arcsAmount = 0;
+    while (iterator->Next())
+      ++arcsAmount;
+    return arcsAmount;
+  }
+
+  size_t getElementsAmount(ScAddr const & structure)
+  {
+    ScIterator3Ptr const & iterator =
+        m_ctx->CreateIterator3(structure, ScType::EdgeAccessConstPosPerm, ScType::Unknown);
+    size_t elementsAmount = 0;
+    while (iterator->Next())
+      ++elementsAmount;
+    return elementsAmount;
+  }
+};
+
+std::shared_ptr<generatorTest::ConfigGenerator> generators[] = {
+    std::make_shared<generatorTest::ConfigGenerator>(),
+    std::make_shared<generatorTest::ConfigGeneratorSearchWithReplacements>(),
+    std::make_shared<generatorTest::ConfigGeneratorSearchWithoutReplacements>()};
+
+INSTANTIATE_TEST_SUITE_P(
+    ReteInferenceManagerTestInitiator,
+    ReteInferenceManagerTest,
+    testing::ValuesIn(generators),
+    [](testing::TestParamInfo<std::shared_ptr<generatorTest::ConfigGenerator>> const & testParamInfo) {
+      return testParamInfo.param->getName();
+    });
+
+// The rule used before the rule generating its premise is activated by the generated elements
+TEST_P(ReteInferenceManagerTest, RuleIsActivatedByGeneratedElements)
+{
+  ScMemoryContext & context = *m_ctx;
+
+  loader.loadScsFile(context, TEST_FILES_DIR_PATH + "chainedRulesTest.scs");
+
+  ScAddr const & targetTemplate = context.SearchElementBySystemIdentifier(TARGET_TEMPLATE);
+  ScAddr const & ruleSet = context.SearchElementBySystemIdentifier(RULES_SET);
+  ScAddr const & inputStructure = context.SearchElementBySystemIdentifier(INPUT_STRUCTURE);
+
+  InferenceConfig const & inferenceConfig = GetParam()->getInferenceConfig(
+      {GENERATE_UNIQUE_FORMULAS, REPLACEMENTS_ALL, TREE_ONLY_OUTPUT_STRUCTURE, SEARCH_IN_STRUCTURES});
+  ScAddr const & outputStructure = context.GenerateNode(ScType::NodeConstStruct);
+  InferenceParams const & inferenceParams{ruleSet, {}, {inputStructure}, outputStructure, targetTemplate};
+  std::unique_ptr<InferenceManagerAbstract> inferenceManager =
+      InferenceManagerFactory::constructReteInferenceManager(&context, inferenceConfig);
+  EXPECT_TRUE(inferenceManager->applyInference(inferenceParams));
+
+  EXPECT_EQ(getArcsAmount("intermediate_node_class", "argument"), 1u);
+  EXPECT_EQ(getArcsAmount("target_node_class", "argument"), 1u);
+}
+
+// Premise replacements over the results limit are kept in the activation and passed to the rule on the next usages
+TEST_P(ReteInferenceManagerTest, ActivationOverResultsLimitIsUsedLater)
+{
+  ScMemoryContext & context = *m_ctx;
+
+  loader.loadScsFile(context, TEST_FILES_DIR_PATH + "limitedActivationTest.scs");
+
+  ScAddr const & targetTemplate = context.SearchElementBySystemIdentifier(TARGET_TEMPLATE);
+  ScAddr const & ruleSet = context.SearchElementBySystemIdentifier(RULES_SET);
+  ScAddr const & inputStructure = context.SearchElementBySystemIdentifier(INPUT_STRUCTURE);
+
+  InferenceConfig inferenceConfig = GetParam()->getInferenceConfig(
+      {GENERATE_ALL_FORMULAS, REPLACEMENTS_ALL, TREE_ONLY_OUTPUT_STRUCTURE, SEARCH_IN_STRUCTURES});
+  inferenceConfig.resultsLimit = 1;
+  ScAddr const & outputStructure = context.GenerateNode(ScType::NodeConstStruct);
+  InferenceParams const & inferenceParams{ruleSet, {}, {inputStructure}, outputStructure, targetTemplate};
+  std::unique_ptr<InferenceManagerAbstract> inferenceManager =
+      InferenceManagerFactory::constructReteInferenceManager(&context, inferenceConfig);
+  EXPECT_TRUE(inferenceManager->applyInference(inferenceParams));
+
+  EXPECT_EQ(getArcsAmount("target_node_class", "first_argument"), 1u);
+  EXPECT_EQ(getArcsAmount("target_node_class", "second_argument"), 1u);
+  EXPECT_EQ(getArcsAmount("target_node_class", "third_argument"), 1u);
+}
+
+// Each replacement of the conjunction premise is passed to the rule once, even if all formulas are generated
+TEST_P(ReteInferenceManagerTest, ConjunctionIsJoinedWithGeneratedElements)
+{
+  ScMemoryContext & context = *m_ctx;
+
+  loader.loadScsFile(context, TEST_FILES_DIR_PATH + "reteConjunctionTest.scs");
+
+  ScAddr const & targetTemplate = context.SearchElementBySystemIdentifier(TARGET_TEMPLATE);
+  ScAddr const & ruleSet = context.SearchElementBySystemIdentifier(RULES_SET);
+  ScAddr const & inputStructure = context.SearchElementBySystemIdentifier(INPUT_STRUCTURE);
+
+  InferenceConfig const & inferenceConfig = GetParam()->getInferenceConfig(
+      {GENERATE_ALL_FORMULAS, REPLACEMENTS_ALL, TREE_ONLY_OUTPUT_STRUCTURE, SEARCH_IN_STRUCTURES});
+  ScAddr const & outputStructure = context.GenerateNode(ScType::NodeConstStruct);
+  InferenceParams const & inferenceParams{ruleSet, {}, {inputStructure}, outputStructure, targetTemplate};
+  std::unique_ptr<InferenceManagerAbstract> inferenceManager =
+      InferenceManagerFactory::constructReteInferenceManager(&context, inferenceConfig);
+  EXPECT_TRUE(inferenceManager->applyInference(inferenceParams));
+
+  EXPECT_EQ(getArcsAmount("intermediate_node_class", "argument"), 1u);
+  EXPECT_EQ(getArcsAmount("intermediate_node_class", "other_argument"), 1u);
+  EXPECT_EQ(getArcsAmount("target_node_class", "argument"), 1u);
+  EXPECT_EQ(getArcsAmount("target_node_class", "other_argument"), 0u);
+}
+
+// Rules of a cycle generate the same elements as `DirectInferenceManagerAll` applied until nothing is generated
+TEST_P(ReteInferenceManagerTest, RecursiveRulesGenerateAsDirectInferenceManagerAll)
+{
+  ScMemoryContext & context = *m_ctx;
+
+  loader.loadScsFile(context, TEST_FILES_DIR_PATH + "recursiveRulesComparisonTest.scs");
+
+  ScAddr const & targetTemplate = context.SearchElementBySystemIdentifier(TARGET_TEMPLATE);
+  ScAddr const & ruleSet = context.SearchElementBySystemIdentifier(RULES_SET);
+  ScAddr const & inputStructure = context.SearchElementBySystemIdentifier(INPUT_STRUCTURE);
+  ScAddr const & otherInputStructure = context.SearchElementBySystemIdentifier("other_input_structure");
+
+  // Premises are searched in input structures, so each manager uses the rules with its own argument
+  InferenceConfig const & inferenceConfig = GetParam()->getInferenceConfig(
+      {GENERATE_UNIQUE_FORMULAS, REPLACEMENTS_ALL, TREE_ONLY_OUTPUT_STRUCTURE, SEARCH_IN_STRUCTURES});
+  ScAddr const & outputStructureAll = context.GenerateNode(ScType::NodeConstStruct);
+  InferenceParams const & inferenceParamsAll{
+      ruleSet, {}, {inputStructure, outputStructureAll}, outputStructureAll, targetTemplate};
+  std::unique_ptr<InferenceManagerAbstract> inferenceManagerAll =
+      InferenceManagerFactory::constructDirectInferenceManagerAll(&context, inferenceConfig);
+  // Each formula is used once by an inference, so it is applied until nothing is generated
+  size_t const maxInferencesAmount = 10;
+  size_t inferencesAmount = 1;
+  while (inferencesAmount < maxInferencesAmount && inferenceManagerAll->applyInference(inferenceParamsAll))
+    ++inferencesAmount;
+  EXPECT_LT(inferencesAmount, maxInferencesAmount);
+
+  ScAddr const & outputStructureRete = context.GenerateNode(ScType::NodeConstStruct);
+  InferenceParams const & inferenceParamsRete{ruleSet, {}, {otherInputStructure}, outputStructureRete, targetTemplate};
+  std::unique_ptr<InferenceManagerAbstract> inferenceManagerRete =
+      InferenceManagerFactory::constructReteInferenceManager(&context, inferenceConfig);
+  EXPECT_TRUE(inferenceManagerRete->applyInference(inferenceParamsRete));
+
+  for (std::string const & nodeClass :
+       {"first_node_class", "second_node_class", "third_node_class", "target_node_class"})
+  {
+    EXPECT_EQ(getArcsAmount(nodeClass, "argument"), 1u);
+    EXPECT_EQ(getArcsAmount(nodeClass, "other_argument"), 1u);
+  }
+  EXPECT_EQ(getElementsAmount(outputStructureRete), getElementsAmount(outputStructureAll));
+}
+
+// The rule of the first set is activated when the rule of the second set generates its premise
+TEST_P(ReteInferenceManagerTest, RuleIsActivatedByGenerationOfLaterSet)
+{
+  ScMemoryContext & context = *m_ctx;
+
+  loader.loadScsFile(context, TEST_FILES_DIR_PATH + "laterSetPremiseTest.scs");
+
+  ScAddr const & targetTemplate = context.SearchElementBySystemIdentifier(TARGET_TEMPLATE);
+  ScAddr const & ruleSet = context.SearchElementBySystemIdentifier(RULES_SET);
+  ScAddr const & inputStructure = context.SearchElementBySystemIdentifier(INPUT_STRUCTURE);
+
+  InferenceConfig const & inferenceConfig = GetParam()->getInferenceConfig(
+      {GENERATE_UNIQUE_FORMULAS, REPLACEMENTS_ALL, TREE_ONLY_OUTPUT_STRUCTURE, SEARCH_IN_STRUCTURES});
+  ScAddr const & outputStructure = context.GenerateNode(ScType::NodeConstStruct);
+  InferenceParams const & inferenceParams{ruleSet, {}, {inputStructure}, outputStructure, targetTemplate};
+  std::unique_ptr<InferenceManagerAbstract> inferenceManager =
+      InferenceManagerFactory::constructReteInferenceManager(&context, inferenceConfig);
+  EXPECT_TRUE(inferenceManager->applyInference(inferenceParams));
+
+  EXPECT_EQ(getArcsAmount("intermediate_node_class", "argument"), 1u);
+  EXPECT_EQ(getArcsAmount("target_node_class", "argument"), 1u);
+}
+
+// Existing conclusion added to the output structure is searched in alpha memories as generated elements
+TEST_P(ReteInferenceManagerTest, RuleIsActivatedByExistingConclusion)
+{
+  ScMemoryContext & context = *m_ctx;
+
+  loader.loadScsFile(context, TEST_FILES_DIR_PATH + "existingConclusionTest.scs");
+
+  ScAddr const & targetTemplate = context.SearchElementBySystemIdentifier(TARGET_TEMPLATE);
+  ScAddr const & ruleSet = context.SearchElementBySystemIdentifier(RULES_SET);
+  ScAddr const & inputStructure = context.SearchElementBySystemIdentifier(INPUT_STRUCTURE);
+
+  InferenceConfig const & inferenceConfig = GetParam()->getInferenceConfig(
+      {GENERATE_UNIQUE_FORMULAS,
+       REPLACEMENTS_ALL,
+       TREE_ONLY_OUTPUT_STRUCTURE,
+       SEARCH_IN_STRUCTURES,
+       SEARCHED_AND_GENERATED});
+  ScAddr const & outputStructure = context.GenerateNode(ScType::NodeConstStruct);
+  InferenceParams const & inferenceParams{ruleSet, {}, {inputStructure}, outputStructure, targetTemplate};
+  std::unique_ptr<InferenceManagerAbstract> inferenceManager =
+      InferenceManagerFactory::constructReteInferenceManager(&context, inferenceConfig);
+  EXPECT_TRUE(inferenceManager->applyInference(inferenceParams));
+
+  EXPECT_EQ(getArcsAmount("target_node_class", "known_node_class"), 1u);
+}
+}  // namespace reteInferenceManagerTest
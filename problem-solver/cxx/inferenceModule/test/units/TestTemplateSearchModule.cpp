@@ -4,6 +4,7 @@
  * (See accompanying file COPYING.MIT or copy at http://opensource.org/licenses/MIT)
  */
 
+#include "classifier/FormulaClassifier.hpp"
 #include "keynodes/InferenceKeynodes.hpp"
 
 #include "searcher/templateSearcher/TemplateSearcherGeneral.hpp"
@@ -12,6 +13,9 @@
 #include "utils/ReplacementsUtils.hpp"
 
 #include <algorithm>
+#include <chrono>
+#include <set>
+#include <thread>
 
 #include <sc_test.hpp>
 #include <scs_loader.hpp>
@@ -83,7 +87,7 @@ TEST_F(TemplateSearchManagerTest, SearchWithContent_SingleResultTestCase)
 
   ScAddrVector const & vars = utils::IteratorUtils::getAllWithType(&context, searchTemplateAddr, ScType::Var);
   ScAddrUnorderedSet templateVars = {vars.cbegin(), vars.cend()};
-  EXPECT_EQ(searchResults.size(), templateVars.size());
+  EXPECT_EQ(searchResults.getKeysAmount(), templateVars.size());
   EXPECT_EQ(
       searchResults.at(context.SearchElementBySystemIdentifier(searchLinkIdentifier))[0],
       context.SearchElementBySystemIdentifier(correctResultLinkIdentifier));
@@ -92,6 +96,62 @@ TEST_F(TemplateSearchManagerTest, SearchWithContent_SingleResultTestCase)
       context.SearchElementBySystemIdentifier(firstConstantNode));
 }
 
+TEST_F(TemplateSearchManagerTest, SearchWithContent_LongContentTestCase)
+{
+  ScMemoryContext & context = *m_ctx;
+
+  loader.loadScsFile(context, TEST_FILES_DIR_PATH + "searchWithContentSingleResultTestStructure.scs");
+
+  // Content longer than searchable strings of the links content index is checked by reading content of found links
+  std::string const longContent(100000, 'a');
+  ScAddr const & searchLink = context.SearchElementBySystemIdentifier("search_link");
+  ScAddr const & correctResultLink = context.SearchElementBySystemIdentifier("correct_result_link");
+  context.SetLinkContent(searchLink, longContent);
+  context.SetLinkContent(correctResultLink, longContent);
+
+  ScAddr searchTemplateAddr = context.SearchElementBySystemIdentifier(TEST_SEARCH_TEMPLATE_ID);
+  inference::TemplateSearcherGeneral templateSearcher(&context);
+  ScTemplateParams templateParams;
+  inference::Replacements searchResults;
+  ScAddrUnorderedSet variables;
+  templateSearcher.getVariables(searchTemplateAddr, variables);
+  templateSearcher.searchTemplate(searchTemplateAddr, templateParams, variables, searchResults);
+
+  ASSERT_EQ(searchResults.getColumnsAmount(), 1u);
+  EXPECT_EQ(searchResults.at(searchLink)[0], correctResultLink);
+  EXPECT_EQ(
+      searchResults.at(context.SearchElementBySystemIdentifier("_node"))[0],
+      context.SearchElementBySystemIdentifier("first_constant_node"));
+}
+
+TEST_F(TemplateSearchManagerTest, SearchWithContent_SeveralLinksWithContentTestCase)
+{
+  ScMemoryContext & context = *m_ctx;
+
+  loader.loadScsFile(context, TEST_FILES_DIR_PATH + "searchWithContentMultipleResultTestStucture.scs");
+
+  ScAddr searchTemplateAddr = context.SearchElementBySystemIdentifier(TEST_SEARCH_TEMPLATE_ID);
+  ScAddr const & nodeVariable = context.SearchElementBySystemIdentifier("_node");
+  ScAddr const & searchLink = context.SearchElementBySystemIdentifier("search_link");
+  std::unique_ptr<inference::TemplateSearcherAbstract> templateSearcher =
+      std::make_unique<inference::TemplateSearcherGeneral>(&context);
+  ScAddrUnorderedSet variables;
+  templateSearcher->getVariables(searchTemplateAddr, variables);
+
+  ScTemplateParams templateParams;
+  templateParams.Add(nodeVariable, context.SearchElementBySystemIdentifier("second_constant_node"));
+  inference::Replacements searchResults;
+  templateSearcher->searchTemplate(searchTemplateAddr, templateParams, variables, searchResults);
+  EXPECT_EQ(searchResults.getColumnsAmount(), 1u);
+  EXPECT_EQ(searchResults.at(searchLink)[0], context.SearchElementBySystemIdentifier("second_correct_result_link"));
+
+  templateParams = ScTemplateParams();
+  templateParams.Add(nodeVariable, context.SearchElementBySystemIdentifier("third_constant_node"));
+  searchResults = inference::Replacements();
+  templateSearcher->searchTemplate(searchTemplateAddr, templateParams, variables, searchResults);
+  EXPECT_EQ(searchResults.getColumnsAmount(), 0u);
+}
+
 TEST_F(TemplateSearchManagerTest, SearchInMultipleStructuresWithContent_SingleResultTestCase)
 {
   std::string correctResultLinkIdentifier = "correct_result_link";
@@ -116,7 +176,7 @@ TEST_F(TemplateSearchManagerTest, SearchInMultipleStructuresWithContent_SingleRe
 
   ScAddrVector const & vars = utils::IteratorUtils::getAllWithType(&context, searchTemplateAddr, ScType::Var);
   ScAddrUnorderedSet templateVars = {vars.cbegin(), vars.cend()};
-  EXPECT_EQ(searchResults.size(), templateVars.size());
+  EXPECT_EQ(searchResults.getKeysAmount(), templateVars.size());
   EXPECT_EQ(
       searchResults.at(context.SearchElementBySystemIdentifier(searchLinkIdentifier))[0],
       context.SearchElementBySystemIdentifier(correctResultLinkIdentifier));
@@ -164,7 +224,7 @@ TEST_F(TemplateSearchManagerTest, SearchWithoutContent_SingleResultTestCase)
 
   ScAddrVector const & vars = utils::IteratorUtils::getAllWithType(&context, searchTemplateAddr, ScType::Var);
   ScAddrUnorderedSet templateVars = {vars.cbegin(), vars.cend()};
-  EXPECT_EQ(searchResults.size(), templateVars.size());
+  EXPECT_EQ(searchResults.getKeysAmount(), templateVars.size());
 
   EXPECT_EQ(
       searchResults.at(context.SearchElementBySystemIdentifier(searchLinkIdentifier))[0],
@@ -193,7 +253,7 @@ TEST_F(TemplateSearchManagerTest, SearchWithoutContent_EmptyLinkTestCase)
 
   ScAddrVector const & vars = utils::IteratorUtils::getAllWithType(&context, searchTemplateAddr, ScType::Var);
   ScAddrUnorderedSet templateVars = {vars.cbegin(), vars.cend()};
-  EXPECT_EQ(searchResults.size(), templateVars.size());
+  EXPECT_EQ(searchResults.getKeysAmount(), templateVars.size());
   EXPECT_EQ(
       searchResults.at(context.SearchElementBySystemIdentifier(searchLinkIdentifier))[0],
       context.SearchElementBySystemIdentifier(correctResultLinkIdentifier));
@@ -218,7 +278,7 @@ TEST_F(TemplateSearchManagerTest, SearchWithContent_EmptyLinkTestCase)
 
   ScAddrVector const & vars = utils::IteratorUtils::getAllWithType(&context, searchTemplateAddr, ScType::Var);
   ScAddrUnorderedSet templateVars = {vars.cbegin(), vars.cend()};
-  EXPECT_EQ(searchResults.size(), templateVars.size());
+  EXPECT_EQ(searchResults.getKeysAmount(), templateVars.size());
   EXPECT_EQ(
       searchResults.at(context.SearchElementBySystemIdentifier(searchLinkIdentifier))[0],
       context.SearchElementBySystemIdentifier(correctResultLinkIdentifier));
@@ -251,10 +311,79 @@ TEST_F(TemplateSearchManagerTest, SearchWithExistedConstructionsTest)
       {templateVars.cbegin(), templateVars.cend()},
       searchResults);
 
-  EXPECT_EQ(searchResults.size(), templateVars.size());
+  EXPECT_EQ(searchResults.getKeysAmount(), templateVars.size());
   EXPECT_EQ(inference::ReplacementsUtils::getColumnsAmount(searchResults), 1u);
 }
 
+TEST_F(TemplateSearchManagerTest, SearchInStructuresWithAddedElement)
+{
+  ScMemoryContext & context = *m_ctx;
+
+  loader.loadScsFile(context, TEST_FILES_DIR_PATH + "searchWithExistedConstructionsStructure.scs");
+
+  ScAddr searchTemplateAddr = context.SearchElementBySystemIdentifier(TEST_SEARCH_TEMPLATE_ID);
+  ScAddrVector templateVars = utils::IteratorUtils::getAllWithType(&context, searchTemplateAddr, ScType::Var);
+  ScAddrUnorderedSet const variables{templateVars.cbegin(), templateVars.cend()};
+  ScAddr const & structure1 = context.SearchElementBySystemIdentifier("test_structure_1");
+  ScAddr const & structure2 = context.SearchElementBySystemIdentifier("test_structure_2");
+  ScAddr const & thirdClass = context.SearchElementBySystemIdentifier("class_3");
+
+  std::unique_ptr<inference::TemplateSearcherAbstract> templateSearcher =
+      std::make_unique<inference::TemplateSearcherOnlyAccessEdgesInStructures>(&context);
+  templateSearcher->setInputStructures({structure1, structure2});
+  inference::Replacements searchResults;
+  templateSearcher->searchTemplate(searchTemplateAddr, std::vector<ScTemplateParams>{{}}, variables, searchResults);
+  EXPECT_EQ(inference::ReplacementsUtils::getColumnsAmount(searchResults), 0u);
+
+  // Arc is added to the indexed structure as inference adds generated elements to the output structure
+  ScIterator3Ptr const & thirdClassArcsIterator =
+      context.CreateIterator3(thirdClass, ScType::EdgeAccessConstPosPerm, ScType::Unknown);
+  EXPECT_TRUE(thirdClassArcsIterator->Next());
+  templateSearcher->addStructureElement(structure2, thirdClassArcsIterator->Get(1));
+  searchResults = {};
+  templateSearcher->searchTemplate(searchTemplateAddr, std::vector<ScTemplateParams>{{}}, variables, searchResults);
+  EXPECT_EQ(inference::ReplacementsUtils::getColumnsAmount(searchResults), 1u);
+}
+
+TEST_F(TemplateSearchManagerTest, SearchInStructuresChangedBetweenInferences)
+{
+  ScMemoryContext & context = *m_ctx;
+
+  loader.loadScsFile(context, TEST_FILES_DIR_PATH + "searchWithExistedConstructionsStructure.scs");
+
+  ScAddr searchTemplateAddr = context.SearchElementBySystemIdentifier(TEST_SEARCH_TEMPLATE_ID);
+  ScAddrVector templateVars = utils::IteratorUtils::getAllWithType(&context, searchTemplateAddr, ScType::Var);
+  ScAddrUnorderedSet const variables{templateVars.cbegin(), templateVars.cend()};
+  ScAddr const & structure1 = context.SearchElementBySystemIdentifier("test_structure_1");
+  ScAddr const & structure2 = context.SearchElementBySystemIdentifier("test_structure_2");
+  ScAddr const & thirdClass = context.SearchElementBySystemIdentifier("class_3");
+
+  std::unique_ptr<inference::TemplateSearcherAbstract> templateSearcher =
+      std::make_unique<inference::TemplateSearcherOnlyAccessEdgesInStructures>(&context);
+  templateSearcher->setInputStructures({structure1, structure2});
+  inference::Replacements searchResults;
+  templateSearcher->searchTemplate(searchTemplateAddr, std::vector<ScTemplateParams>{{}}, variables, searchResults);
+  EXPECT_EQ(inference::ReplacementsUtils::getColumnsAmount(searchResults), 0u);
+
+  // Arc is added to the structure by another agent, the next inference is applied with the same input structures
+  ScIterator3Ptr const & thirdClassArcsIterator =
+      context.CreateIterator3(thirdClass, ScType::EdgeAccessConstPosPerm, ScType::Unknown);
+  EXPECT_TRUE(thirdClassArcsIterator->Next());
+  ScAddr const & structureArc =
+      context.GenerateConnector(ScType::EdgeAccessConstPosPerm, structure2, thirdClassArcsIterator->Get(1));
+  templateSearcher->setInputStructures({structure1, structure2});
+  searchResults = {};
+  templateSearcher->searchTemplate(searchTemplateAddr, std::vector<ScTemplateParams>{{}}, variables, searchResults);
+  EXPECT_EQ(inference::ReplacementsUtils::getColumnsAmount(searchResults), 1u);
+
+  // Removed arc is not found by the next inference too
+  context.EraseElement(structureArc);
+  templateSearcher->setInputStructures({structure1, structure2});
+  searchResults = {};
+  templateSearcher->searchTemplate(searchTemplateAddr, std::vector<ScTemplateParams>{{}}, variables, searchResults);
+  EXPECT_EQ(inference::ReplacementsUtils::getColumnsAmount(searchResults), 0u);
+}
+
 TEST_F(TemplateSearchManagerTest, SearchWithoutAccessEdgesTest)
 {
   ScMemoryContext & context = *m_ctx;
@@ -277,7 +406,261 @@ TEST_F(TemplateSearchManagerTest, SearchWithoutAccessEdgesTest)
       {templateVars.cbegin(), templateVars.cend()},
       searchResults);
 
-  EXPECT_EQ(searchResults.size(), templateVars.size());
+  EXPECT_EQ(searchResults.getKeysAmount(), templateVars.size());
+  EXPECT_EQ(inference::ReplacementsUtils::getColumnsAmount(searchResults), 1u);
+}
+TEST_F(TemplateSearchManagerTest, SearchByParamsUsesCompiledTemplate)
+{
+  ScMemoryContext & context = *m_ctx;
+
+  loader.loadScsFile(context, TEST_FILES_DIR_PATH + "searchWithoutContentMultipleResultTestStucture.scs");
+
+  ScAddr searchTemplateAddr = context.SearchElementBySystemIdentifier(TEST_SEARCH_TEMPLATE_ID);
+  ScAddr const & nodeVariable = context.SearchElementBySystemIdentifier("_node");
+  std::vector<ScTemplateParams> templateParamsVector(2);
+  templateParamsVector[0].Add(nodeVariable, context.SearchElementBySystemIdentifier("first_constant_node"));
+  templateParamsVector[1].Add(nodeVariable, context.SearchElementBySystemIdentifier("second_constant_node"));
+
+  std::unique_ptr<inference::TemplateSearcherAbstract> templateSearcher =
+      std::make_unique<inference::TemplateSearcherGeneral>(&context);
+  inference::Replacements searchResults;
+  ScAddrUnorderedSet variables;
+  templateSearcher->getVariables(searchTemplateAddr, variables);
+  templateSearcher->searchTemplate(searchTemplateAddr, templateParamsVector, variables, searchResults);
+
+  EXPECT_EQ(inference::ReplacementsUtils::getColumnsAmount(searchResults), 2u);
+  EXPECT_EQ(searchResults.at(nodeVariable)[0], context.SearchElementBySystemIdentifier("first_constant_node"));
+  EXPECT_EQ(searchResults.at(nodeVariable)[1], context.SearchElementBySystemIdentifier("second_constant_node"));
+  inference::FormulaMetadataCache::Statistics const & statistics =
+      templateSearcher->getFormulaMetadataCache()->getStatistics();
+  EXPECT_EQ(statistics.missesAmount, 1u);
+  EXPECT_GT(statistics.hitsAmount, 1u);
+}
+
+TEST_F(TemplateSearchManagerTest, FormulaMetadataIsReadOnce)
+{
+  ScMemoryContext & context = *m_ctx;
+
+  loader.loadScsFile(context, TEST_FILES_DIR_PATH + "searchWithoutContentMultipleResultTestStucture.scs");
+
+  ScAddr searchTemplateAddr = context.SearchElementBySystemIdentifier(TEST_SEARCH_TEMPLATE_ID);
+  ScAddr const & nodeVariable = context.SearchElementBySystemIdentifier("_node");
+
+  inference::FormulaMetadataCache formulaMetadataCache(&context);
+  std::shared_ptr<inference::FormulaMetadata const> const & metadata =
+      formulaMetadataCache.getMetadata(searchTemplateAddr);
+
+  EXPECT_EQ(metadata->type, inference::FormulaClassifier::ATOMIC);
+  EXPECT_TRUE(metadata->isFormulaWithVar);
+  EXPECT_FALSE(metadata->isTemplateWithLinks);
+  EXPECT_EQ(metadata->variables.count(nodeVariable), 1u);
+  EXPECT_FALSE(metadata->triples.empty());
+  EXPECT_EQ(formulaMetadataCache.getMetadata(searchTemplateAddr), metadata);
+  EXPECT_EQ(formulaMetadataCache.getStatistics().missesAmount, 1u);
+  EXPECT_EQ(formulaMetadataCache.getStatistics().hitsAmount, 1u);
+}
+
+TEST_F(TemplateSearchManagerTest, FormulaMetadataFollowsAddedLink)
+{
+  ScMemoryContext & context = *m_ctx;
+
+  loader.loadScsFile(context, TEST_FILES_DIR_PATH + "searchWithContentSingleResultTestStructure.scs");
+
+  ScAddr searchTemplateAddr = context.SearchElementBySystemIdentifier(TEST_SEARCH_TEMPLATE_ID);
+  inference::FormulaMetadataCache formulaMetadataCache(&context);
+  // Events are processed asynchronously, so invalidations are waited for
+  auto const & waitInvalidations = [&formulaMetadataCache](size_t invalidationsAmount)
+  {
+    for (size_t attempt = 0; attempt < 100; ++attempt)
+    {
+      if (formulaMetadataCache.getStatistics().invalidationsAmount >= invalidationsAmount)
+        return true;
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return false;
+  };
+
+  EXPECT_EQ(formulaMetadataCache.getMetadata(searchTemplateAddr)->links.size(), 1u);
+  ScAddr const & addedLink = context.GenerateLink(ScType::LinkVar);
+  context.SetLinkContent(addedLink, "first content");
+  context.GenerateConnector(ScType::EdgeAccessConstPosPerm, searchTemplateAddr, addedLink);
+  ASSERT_TRUE(waitInvalidations(1));
+  EXPECT_EQ(formulaMetadataCache.getMetadata(searchTemplateAddr)->links.size(), 2u);
+
+  // Link added to the formula is subscribed to when the metadata is read again
+  context.SetLinkContent(addedLink, "second content");
+  ASSERT_TRUE(waitInvalidations(2));
+  std::shared_ptr<inference::FormulaMetadata const> const & metadata =
+      formulaMetadataCache.getMetadata(searchTemplateAddr);
+  auto const & addedLinkIterator = std::find_if(
+      metadata->links.cbegin(),
+      metadata->links.cend(),
+      [&addedLink](inference::FormulaMetadata::Link const & link)
+      {
+        return link.addr == addedLink;
+      });
+  ASSERT_NE(addedLinkIterator, metadata->links.cend());
+  EXPECT_EQ(addedLinkIterator->content, "second content");
+}
+
+TEST_F(TemplateSearchManagerTest, SearchByBindingsTableOncePerDistinctBinding)
+{
+  ScMemoryContext & context = *m_ctx;
+
+  loader.loadScsFile(context, TEST_FILES_DIR_PATH + "searchWithoutContentMultipleResultTestStucture.scs");
+
+  ScAddr searchTemplateAddr = context.SearchElementBySystemIdentifier(TEST_SEARCH_TEMPLATE_ID);
+  ScAddr const & nodeVariable = context.SearchElementBySystemIdentifier("_node");
+  ScAddr const & firstConstantNode = context.SearchElementBySystemIdentifier("first_constant_node");
+  ScAddr const & secondConstantNode = context.SearchElementBySystemIdentifier("second_constant_node");
+  // The key unknown to the template doubles bindings, but not searches
+  ScAddr const & otherVariable = context.GenerateNode(ScType::NodeVar);
+  inference::Replacements bindings(ScAddrVector{nodeVariable, otherVariable});
+  for (ScAddr const & node : {firstConstantNode, secondConstantNode})
+  {
+    for (ScAddr const & otherValue : {context.GenerateNode(ScType::NodeConst), context.GenerateNode(ScType::NodeConst)})
+    {
+      ScAddr * column = bindings.addColumn();
+      column[0] = node;
+      column[1] = otherValue;
+    }
+  }
+
+  std::unique_ptr<inference::TemplateSearcherAbstract> templateSearcher =
+      std::make_unique<inference::TemplateSearcherGeneral>(&context);
+  templateSearcher->setReplacementsUsingType(inference::REPLACEMENTS_ALL);
+  inference::Replacements searchResults;
+  ScAddrUnorderedSet variables;
+  templateSearcher->getVariables(searchTemplateAddr, variables);
+  templateSearcher->searchTemplateByDistinctBindings(
+      searchTemplateAddr, inference::FactorizedReplacements(bindings), variables, searchResults);
+
+  EXPECT_EQ(searchResults.getKeysAmount(), variables.size());
+  EXPECT_EQ(inference::ReplacementsUtils::getColumnsAmount(searchResults), 2u);
+  EXPECT_EQ(searchResults.at(nodeVariable)[0], firstConstantNode);
+  EXPECT_EQ(searchResults.at(nodeVariable)[1], secondConstantNode);
+}
+
+TEST_F(TemplateSearchManagerTest, SearchByBindingsTableStopsAtResultsLimit)
+{
+  ScMemoryContext & context = *m_ctx;
+
+  loader.loadScsFile(context, TEST_FILES_DIR_PATH + "searchWithoutContentMultipleResultTestStucture.scs");
+
+  ScAddr searchTemplateAddr = context.SearchElementBySystemIdentifier(TEST_SEARCH_TEMPLATE_ID);
+  ScAddr const & nodeVariable = context.SearchElementBySystemIdentifier("_node");
+  ScAddr const & firstConstantNode = context.SearchElementBySystemIdentifier("first_constant_node");
+  inference::Replacements bindings(ScAddrVector{nodeVariable});
+  for (ScAddr const & node : {firstConstantNode, context.SearchElementBySystemIdentifier("second_constant_node")})
+    bindings.addColumn()[0] = node;
+
+  std::unique_ptr<inference::TemplateSearcherAbstract> templateSearcher =
+      std::make_unique<inference::TemplateSearcherGeneral>(&context);
+  templateSearcher->setReplacementsUsingType(inference::REPLACEMENTS_ALL);
+  templateSearcher->setResultsLimit(1);
+  inference::Replacements searchResults;
+  ScAddrUnorderedSet variables;
+  templateSearcher->getVariables(searchTemplateAddr, variables);
+  templateSearcher->searchTemplateByDistinctBindings(
+      searchTemplateAddr, inference::FactorizedReplacements(bindings), variables, searchResults);
+
+  // The second binding is not searched, because the first one has reached the limit
   EXPECT_EQ(inference::ReplacementsUtils::getColumnsAmount(searchResults), 1u);
+  EXPECT_EQ(searchResults.at(nodeVariable)[0], firstConstantNode);
+}
+
+class FormulaTemplateTest
+  : public ScMemoryTest
+  , public testing::WithParamInterface<std::string>
+{
+};
+
+INSTANTIATE_TEST_SUITE_P(
+    FormulaTemplateTestInitiator,
+    FormulaTemplateTest,
+    testing::Values(
+        "searchStructuresWithoutAccessEdges",
+        "searchWithContentEmptyLinkTest",
+        "searchWithContentEmptyResultsTestStucture",
+        "searchWithContentMultipleResultTestStucture",
+        "searchWithContentNoStructures",
+        "searchWithContentSingleResultTestStructure",
+        "searchWithExistedConstructionsStructure",
+        "searchWithoutContentEmptyLinkTest",
+        "searchWithoutContentMultipleResultTestStucture",
+        "searchWithoutContentNoStructures",
+        "searchWithoutContentSingleResultTestStucture"),
+    [](testing::TestParamInfo<std::string> const & testParamInfo) {
+      return testParamInfo.param;
+    });
+
+// Values of the variables in each found construction, the order of constructions is not compared
+std::set<std::vector<ScAddr::HashType>> searchVariablesValues(
+    ScMemoryContext & context,
+    ScTemplate const & searchTemplate,
+    ScAddrVector const & variables)
+{
+  std::set<std::vector<ScAddr::HashType>> variablesValues;
+  context.SearchByTemplate(
+      searchTemplate,
+      [&variables, &variablesValues](ScTemplateSearchResultItem const & item)
+      {
+        std::vector<ScAddr::HashType> values;
+        for (ScAddr const & variable : variables)
+        {
+          ScAddr value;
+          item.Get(variable, value);
+          values.push_back(value.Hash());
+        }
+        variablesValues.insert(values);
+      });
+  return variablesValues;
+}
+
+TEST_P(FormulaTemplateTest, CompiledTemplateFindsSameAsBuiltTemplate)
+{
+  ScMemoryContext & context = *m_ctx;
+
+  loader.loadScsFile(context, TEST_FILES_DIR_PATH + GetParam() + ".scs");
+
+  ScAddr const & formula = context.SearchElementBySystemIdentifier(TEST_SEARCH_TEMPLATE_ID);
+  inference::FormulaMetadataCache formulaMetadataCache(&context);
+  std::shared_ptr<inference::FormulaMetadata const> const & metadata = formulaMetadataCache.getMetadata(formula);
+  ScAddrVector variables(metadata->variables.cbegin(), metadata->variables.cend());
+
+  auto const & expectSameConstructions = [&](ScTemplateParams const & templateParams)
+  {
+    ScTemplate builtTemplate;
+    context.BuildTemplate(builtTemplate, formula, templateParams);
+    ScTemplate compiledTemplate;
+    formulaMetadataCache.buildTemplate(formula, templateParams, compiledTemplate);
+    EXPECT_EQ(
+        searchVariablesValues(context, compiledTemplate, variables),
+        searchVariablesValues(context, builtTemplate, variables));
+  };
+
+  expectSameConstructions(ScTemplateParams());
+
+  // A variable is bound to the value it has in a found construction
+  std::set<std::vector<ScAddr::HashType>> const & constructions = [&]()
+  {
+    ScTemplate builtTemplate;
+    context.BuildTemplate(builtTemplate, formula);
+    return searchVariablesValues(context, builtTemplate, variables);
+  }();
+  for (size_t variableIndex = 0; variableIndex < variables.size() && !constructions.empty(); ++variableIndex)
+  {
+    ScTemplateParams templateParams;
+    templateParams.Add(variables[variableIndex], ScAddr(constructions.cbegin()->at(variableIndex)));
+    expectSameConstructions(templateParams);
+  }
+
+  // Params of constants are not variables of the template
+  for (ScAddr const & constant : metadata->constants)
+  {
+    ScTemplateParams templateParams;
+    templateParams.Add(constant, context.GenerateNode(ScType::NodeConst));
+    expectSameConstructions(templateParams);
+  }
 }
 }  // namespace inferenceTest
@@ -0,0 +1,532 @@
+/*
+ * This source file is part of an OSTIS project. For the latest info, see http://ostis.net
+ * Distributed under the MIT License
+ * (See accompanying file COPYING.MIT or copy at http://opensource.org/licenses/MIT)
+ */
+
+#include "FactorizedReplacements.hpp"
+
+#include <algorithm>
+#include <numeric>
+
+#include <sc-memory/sc_utils.hpp>
+
+namespace inference
+{
+FactorizedReplacements::ColumnsStream::ColumnsStream(FactorizedReplacements const & replacements)
+  : replacements(replacements)
+{
+  ScAddrVector const & keys = replacements.getKeys();
+  for (Term const & term : replacements.terms)
+  {
+    std::vector<std::vector<size_t>> & termRowsIndices = factorsRowsIndices.emplace_back();
+    for (Factor const & factor : term)
+    {
+      std::vector<size_t> & rowsIndices = termRowsIndices.emplace_back();
+      for (ScAddr const & factorKey : factor->getKeys())
+        rowsIndices.push_back(std::find(keys.cbegin(), keys.cend(), factorKey) - keys.cbegin());
+    }
+  }
+  reset();
+}
+
+bool FactorizedReplacements::ColumnsStream::next(ScAddr * column)
+{
+  while (nextTermColumn())
+  {
+    Term const & term = replacements.terms[termIndex];
+    for (size_t factorIndex = 0; factorIndex < term.size(); ++factorIndex)
+    {
+      ScAddr const * factorColumn = term[factorIndex]->getColumnValues(factorsColumns[factorIndex]);
+      std::vector<size_t> const & rowsIndices = factorsRowsIndices[termIndex][factorIndex];
+      for (size_t factorKeyIndex = 0; factorKeyIndex < rowsIndices.size(); ++factorKeyIndex)
+        column[rowsIndices[factorKeyIndex]] = factorColumn[factorKeyIndex];
+    }
+    if (!isInPreviousTerms(column))
+      return true;
+  }
+  return false;
+}
+
+void FactorizedReplacements::ColumnsStream::reset()
+{
+  termIndex = 0;
+  isTermStarted = false;
+}
+
+// Columns of factors are incremented as digits of a number: the last factor changes first
+bool FactorizedReplacements::ColumnsStream::nextTermColumn()
+{
+  while (termIndex < replacements.terms.size())
+  {
+    Term const & term = replacements.terms[termIndex];
+    if (!isTermStarted)
+    {
+      factorsColumns.assign(term.size(), 0);
+      isTermStarted = true;
+      return true;
+    }
+    for (size_t factorIndex = term.size(); factorIndex > 0; --factorIndex)
+    {
+      size_t & factorColumn = factorsColumns[factorIndex - 1];
+      if (++factorColumn < term[factorIndex - 1]->getColumnsAmount())
+        return true;
+      factorColumn = 0;
+    }
+    ++termIndex;
+    isTermStarted = false;
+  }
+  return false;
+}
+
+// The column is in the term if its values of keys of each factor are a column of this factor
+bool FactorizedReplacements::ColumnsStream::isInPreviousTerms(ScAddr const * column)
+{
+  for (size_t previousTermIndex = 0; previousTermIndex < termIndex; ++previousTermIndex)
+  {
+    Term const & term = replacements.terms[previousTermIndex];
+    bool isInTerm = true;
+    for (size_t factorIndex = 0; factorIndex < term.size() && isInTerm; ++factorIndex)
+    {
+      Replacements const & factor = *term[factorIndex];
+      std::vector<size_t> const & rowsIndices = factorsRowsIndices[previousTermIndex][factorIndex];
+      factorValues.resize(rowsIndices.size());
+      for (size_t factorKeyIndex = 0; factorKeyIndex < rowsIndices.size(); ++factorKeyIndex)
+        factorValues[factorKeyIndex] = column[rowsIndices[factorKeyIndex]];
+
+      FactorIndex const & factorIndexHashes = getFactorIndex(factor);
+      auto const & hashPairIterator = factorIndexHashes.hashes.find(
+          ReplacementsHash::hashColumn(factorValues.data(), factorIndexHashes.keysIndices));
+      isInTerm = hashPairIterator != factorIndexHashes.hashes.cend() &&
+                 std::any_of(
+                     hashPairIterator->second.cbegin(),
+                     hashPairIterator->second.cend(),
+                     [&](size_t factorColumnIndex)
+                     {
+                       ScAddr const * factorColumn = factor.getColumnValues(factorColumnIndex);
+                       return std::equal(factorValues.cbegin(), factorValues.cend(), factorColumn);
+                     });
+    }
+    if (isInTerm)
+      return true;
+  }
+  return false;
+}
+
+FactorizedReplacements::ColumnsStream::FactorIndex const & FactorizedReplacements::ColumnsStream::getFactorIndex(
+    Replacements const & factor)
+{
+  auto const & factorIndexIterator = factorsIndices.find(&factor);
+  if (factorIndexIterator != factorsIndices.cend())
+    return factorIndexIterator->second;
+
+  FactorIndex & factorIndex =
+      factorsIndices.emplace(&factor, FactorIndex{{}, ReplacementsHashes(ReplacementsArena::getResource())})
+          .first->second;
+  factorIndex.keysIndices.resize(factor.getKeysAmount());
+  std::iota(factorIndex.keysIndices.begin(), factorIndex.keysIndices.end(), 0);
+  std::vector<uint64_t> columnsHashes;
+  ReplacementsKernels::hashColumns(factor, factorIndex.keysIndices, columnsHashes);
+  for (size_t columnIndex = 0; columnIndex < columnsHashes.size(); ++columnIndex)
+    factorIndex.hashes[columnsHashes[columnIndex]].push_back(columnIndex);
+  return factorIndex;
+}
+
+FactorizedReplacements::FactorizedReplacements(Replacements replacements)
+  : keys(replacements.getKeys())
+{
+  if (!replacements.empty())
+  {
+    ReplacementsUtils::removeDuplicateColumns(replacements);
+    terms.push_back({std::make_shared<Replacements>(std::move(replacements))});
+  }
+}
+
+FactorizedReplacements::FactorizedReplacements(FactorizedReplacements const & other)
+  : keys(other.keys)
+{
+  copyFactors(other);
+}
+
+FactorizedReplacements & FactorizedReplacements::operator=(FactorizedReplacements const & other)
+{
+  if (this != &other)
+  {
+    keys = other.keys;
+    copyFactors(other);
+  }
+  return *this;
+}
+
+ScAddrVector const & FactorizedReplacements::getKeys() const
+{
+  return keys;
+}
+
+bool FactorizedReplacements::empty() const
+{
+  return terms.empty();
+}
+
+bool FactorizedReplacements::isTable() const
+{
+  return terms.size() == 1 && terms[0].size() == 1 && terms[0][0]->getKeys() == keys;
+}
+
+Replacements const & FactorizedReplacements::getTable() const
+{
+  if (!isTable())
+    SC_THROW_EXCEPTION(
+        utils::ExceptionInvalidState,
+        "FactorizedReplacements: replacements of " << terms.size() << " terms are not a table");
+  return *terms[0][0];
+}
+
+size_t FactorizedReplacements::getTermsAmount() const
+{
+  return terms.size();
+}
+
+size_t FactorizedReplacements::getCombinationsAmount() const
+{
+  size_t combinationsAmount = 0;
+  for (Term const & term : terms)
+  {
+    size_t termColumnsAmount = 1;
+    for (Factor const & factor : term)
+      termColumnsAmount *= factor->getColumnsAmount();
+    combinationsAmount += termColumnsAmount;
+  }
+  return combinationsAmount;
+}
+
+void FactorizedReplacements::expand(Replacements & table) const
+{
+  if (isTable())
+  {
+    table = getTable();
+    return;
+  }
+  Replacements result(keys);
+  ColumnsStream columnsStream(*this);
+  ScAddrVector column(keys.size());
+  while (columnsStream.next(column.data()))
+    std::copy(column.cbegin(), column.cend(), result.addColumn());
+  table = std::move(result);
+}
+
+Replacements const & FactorizedReplacements::materialize()
+{
+  if (!isTable() && !empty())
+  {
+    Replacements table;
+    expand(table);
+    terms = {{std::make_shared<Replacements>(std::move(table))}};
+  }
+  if (empty())
+    terms = {{std::make_shared<Replacements>(keys)}};
+  return *terms[0][0];
+}
+
+size_t FactorizedReplacements::limit(size_t columnsAmount)
+{
+  if (isTable())
+  {
+    if (getTable().getColumnsAmount() > columnsAmount)
+      getOwnFactor(terms[0][0]).resize(columnsAmount);
+    return getTable().getColumnsAmount();
+  }
+  if (empty())
+    return 0;
+
+  Replacements result(keys);
+  ColumnsStream columnsStream(*this);
+  ScAddrVector column(keys.size());
+  while (result.getColumnsAmount() < columnsAmount && columnsStream.next(column.data()))
+    std::copy(column.cbegin(), column.cend(), result.addColumn());
+  size_t const resultColumnsAmount = result.getColumnsAmount();
+  terms = {{std::make_shared<Replacements>(std::move(result))}};
+  return resultColumnsAmount;
+}
+
+FactorizedReplacements FactorizedReplacements::project(ScAddrVector const & projectionKeys) const
+{
+  FactorizedReplacements projection;
+  for (ScAddr const & key : keys)
+  {
+    if (std::find(projectionKeys.cbegin(), projectionKeys.cend(), key) != projectionKeys.cend())
+      projection.keys.push_back(key);
+  }
+  // Projected factors have no duplicate columns, equal columns of different terms are skipped by the stream
+  projectTerms(*this, projection.keys, projection.terms);
+  return projection;
+}
+
+void FactorizedReplacements::narrowWith(FactorizedReplacements const & other)
+{
+  if (other.empty())
+    return;
+  if (other.isTable())
+  {
+    narrowWith(other.getTable());
+    return;
+  }
+  // Intersection does not depend on the order of operands, so the factorized one is narrowed by the table
+  if (isTable())
+  {
+    FactorizedReplacements result = other;
+    result.narrowWith(getTable());
+    *this = std::move(result);
+    return;
+  }
+  if (empty())
+  {
+    *this = other;
+    return;
+  }
+  Replacements otherTable;
+  other.expand(otherTable);
+  narrowWith(otherTable);
+}
+
+void FactorizedReplacements::narrowWith(Replacements const & other)
+{
+  if (other.empty())
+    return;
+  if (empty())
+  {
+    *this = FactorizedReplacements(other);
+    return;
+  }
+
+  ScAddrVector const & otherKeys = other.getKeys();
+  Factor otherFactor;
+  std::unordered_map<Replacements const *, Factor> narrowedFactors;
+  for (Term & term : terms)
+  {
+    std::vector<size_t> touchedFactorsIndices;
+    for (size_t factorIndex = 0; factorIndex < term.size(); ++factorIndex)
+    {
+      ScAddrVector const & factorKeys = term[factorIndex]->getKeys();
+      if (std::any_of(
+              factorKeys.cbegin(),
+              factorKeys.cend(),
+              [&otherKeys](ScAddr const & key)
+              {
+                return std::find(otherKeys.cbegin(), otherKeys.cend(), key) != otherKeys.cend();
+              }))
+        touchedFactorsIndices.push_back(factorIndex);
+    }
+
+    if (touchedFactorsIndices.empty())
+    {
+      if (!otherFactor)
+        otherFactor = FactorizedReplacements(other).terms[0][0];
+      term.push_back(otherFactor);
+      continue;
+    }
+
+    // A factor shared by several terms is narrowed once
+    Factor & touchedFactor = term[touchedFactorsIndices[0]];
+    if (touchedFactorsIndices.size() == 1)
+    {
+      Factor & narrowedFactor = narrowedFactors[touchedFactor.get()];
+      if (!narrowedFactor)
+      {
+        narrowedFactor = touchedFactor;
+        ReplacementsUtils::narrowWith(getOwnFactor(narrowedFactor), other);
+      }
+      touchedFactor = narrowedFactor;
+      continue;
+    }
+    Factor mergedFactor = multiplyFactors(term, touchedFactorsIndices);
+    ReplacementsUtils::narrowWith(*mergedFactor, other);
+    touchedFactor = std::move(mergedFactor);
+    for (size_t index = touchedFactorsIndices.size() - 1; index > 0; --index)
+      term.erase(term.begin() + static_cast<std::ptrdiff_t>(touchedFactorsIndices[index]));
+  }
+
+  for (ScAddr const & otherKey : otherKeys)
+  {
+    if (std::find(keys.cbegin(), keys.cend(), otherKey) == keys.cend())
+      keys.push_back(otherKey);
+  }
+  terms.erase(
+      std::remove_if(
+          terms.begin(),
+          terms.end(),
+          [](Term const & term)
+          {
+            return std::any_of(
+                term.cbegin(),
+                term.cend(),
+                [](Factor const & factor)
+                {
+                  return factor->empty();
+                });
+          }),
+      terms.end());
+}
+
+void FactorizedReplacements::unite(
+    FactorizedReplacements const & first,
+    FactorizedReplacements const & second,
+    FactorizedReplacements & unionResult)
+{
+  if (first.empty())
+  {
+    unionResult = second;
+    return;
+  }
+  if (second.empty())
+  {
+    unionResult = first;
+    return;
+  }
+
+  ScAddrVector firstUniqueKeys;
+  for (ScAddr const & key : first.keys)
+  {
+    if (std::find(second.keys.cbegin(), second.keys.cend(), key) == second.keys.cend())
+      firstUniqueKeys.push_back(key);
+  }
+  ScAddrVector secondUniqueKeys;
+  for (ScAddr const & key : second.keys)
+  {
+    if (std::find(first.keys.cbegin(), first.keys.cend(), key) == first.keys.cend())
+      secondUniqueKeys.push_back(key);
+  }
+  // Union of tables with the same keys has no combinations of columns
+  if (first.isTable() && second.isTable() && firstUniqueKeys.empty() && secondUniqueKeys.empty())
+  {
+    Replacements table;
+    ReplacementsUtils::uniteReplacements(first.getTable(), second.getTable(), table);
+    unionResult = FactorizedReplacements(std::move(table));
+    return;
+  }
+
+  FactorizedReplacements result;
+  result.keys = first.keys;
+  result.keys.insert(result.keys.cend(), secondUniqueKeys.cbegin(), secondUniqueKeys.cend());
+
+  std::vector<Term> secondProjectionTerms;
+  if (!secondUniqueKeys.empty())
+    projectTerms(second, secondUniqueKeys, secondProjectionTerms);
+  for (Term const & firstTerm : first.terms)
+  {
+    if (secondUniqueKeys.empty())
+      result.terms.push_back(firstTerm);
+    for (Term const & secondProjectionTerm : secondProjectionTerms)
+    {
+      Term & term = result.terms.emplace_back(firstTerm);
+      term.insert(term.cend(), secondProjectionTerm.cbegin(), secondProjectionTerm.cend());
+    }
+  }
+
+  // If there are no common keys then all combinations of columns are already in the first terms
+  if (secondUniqueKeys.size() != second.keys.size())
+  {
+    std::vector<Term> firstProjectionTerms;
+    if (!firstUniqueKeys.empty())
+      projectTerms(first, firstUniqueKeys, firstProjectionTerms);
+    for (Term const & secondTerm : second.terms)
+    {
+      if (firstUniqueKeys.empty())
+        result.terms.push_back(secondTerm);
+      for (Term const & firstProjectionTerm : firstProjectionTerms)
+      {
+        Term & term = result.terms.emplace_back(secondTerm);
+        term.insert(term.cend(), firstProjectionTerm.cbegin(), firstProjectionTerm.cend());
+      }
+    }
+  }
+  unionResult = std::move(result);
+}
+
+Replacements & FactorizedReplacements::getOwnFactor(Factor & factor)
+{
+  if (factor.use_count() > 1)
+    factor = std::make_shared<Replacements>(*factor);
+  return *factor;
+}
+
+FactorizedReplacements::Factor FactorizedReplacements::multiplyFactors(
+    Term const & term,
+    std::vector<size_t> const & factorsIndices)
+{
+  Term factors;
+  ScAddrVector productKeys;
+  size_t columnsAmount = 1;
+  for (size_t const factorIndex : factorsIndices)
+  {
+    factors.push_back(term[factorIndex]);
+    productKeys.insert(productKeys.cend(), factors.back()->getKeys().cbegin(), factors.back()->getKeys().cend());
+    columnsAmount *= factors.back()->getColumnsAmount();
+  }
+
+  FactorizedReplacements product;
+  product.keys = productKeys;
+  product.terms = {std::move(factors)};
+  auto result = std::make_shared<Replacements>(productKeys);
+  result->reserve(columnsAmount);
+  ColumnsStream columnsStream(product);
+  ScAddrVector column(productKeys.size());
+  while (columnsStream.next(column.data()))
+    std::copy(column.cbegin(), column.cend(), result->addColumn());
+  return result;
+}
+
+void FactorizedReplacements::projectTerms(
+    FactorizedReplacements const & replacements,
+    ScAddrVector const & projectionKeys,
+    std::vector<Term> & projectionTerms)
+{
+  std::unordered_map<Replacements const *, Factor> projectedFactors;
+  for (Term const & term : replacements.terms)
+  {
+    Term & projectionTerm = projectionTerms.emplace_back();
+    for (Factor const & factor : term)
+    {
+      Factor & projectedFactor = projectedFactors[factor.get()];
+      if (!projectedFactor)
+      {
+        ScAddrUnorderedSet keysToRemove;
+        for (ScAddr const & key : factor->getKeys())
+        {
+          if (std::find(projectionKeys.cbegin(), projectionKeys.cend(), key) == projectionKeys.cend())
+            keysToRemove.insert(key);
+        }
+        if (keysToRemove.empty())
+          projectedFactor = factor;
+        else if (keysToRemove.size() != factor->getKeysAmount())
+        {
+          projectedFactor = std::make_shared<Replacements>(ReplacementsUtils::removeRows(*factor, keysToRemove));
+          ReplacementsUtils::removeDuplicateColumns(*projectedFactor);
+        }
+      }
+      if (projectedFactor)
+        projectionTerm.push_back(projectedFactor);
+    }
+  }
+}
+
+// Factors shared by terms stay shared by copies of these terms
+void FactorizedReplacements::copyFactors(FactorizedReplacements const & other)
+{
+  std::unordered_map<Replacements const *, Factor> copiedFactors;
+  std::vector<Term> copiedTerms;
+  for (Term const & term : other.terms)
+  {
+    Term & copiedTerm = copiedTerms.emplace_back();
+    for (Factor const & factor : term)
+    {
+      Factor & copiedFactor = copiedFactors[factor.get()];
+      if (!copiedFactor)
+        copiedFactor = std::make_shared<Replacements>(*factor);
+      copiedTerm.push_back(copiedFactor);
+    }
+  }
+  terms = std::move(copiedTerms);
+}
+
+}  // namespace inference
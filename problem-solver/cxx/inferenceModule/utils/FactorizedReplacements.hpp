@@ -0,0 +1,149 @@
+/*
+ * This source file is part of an OSTIS project. For the latest info, see http://ostis.net
+ * Distributed under the MIT License
+ * (See accompanying file COPYING.MIT or copy at http://opensource.org/licenses/MIT)
+ */
+
+#pragma once
+
+#include "Replacements.hpp"
+#include "ReplacementsUtils.hpp"
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace inference
+{
+/**
+ * Replacements stored as a union of terms, where each term is a cartesian product of factors. Factors are tables
+ * without duplicate columns, keys of factors of one term do not intersect and together they are all keys of the
+ * replacements. Union and product of tables with different keys are stored this way instead of every combination of
+ * their columns, so columns are created only when they are iterated by `ColumnsStream` or expanded to a table.
+ * Replacements without terms are empty. Replacements of one term with one factor are a plain table.
+ * Factors may be shared by terms and by other factorized replacements, they are copied before change if they are
+ * shared. Copies of factorized replacements have own factors, so they may be used out of the arena scope.
+ */
+class FactorizedReplacements
+{
+public:
+  /**
+   * Distinct columns of factorized replacements created one by one. Columns of each term are iterated as digits of a
+   * number, where the first factor is the slowest digit, and columns that are in previous terms are skipped.
+   * Replacements must not be changed while the stream is used
+   */
+  class ColumnsStream
+  {
+  public:
+    explicit ColumnsStream(FactorizedReplacements const & replacements);
+
+    /**
+     * @brief Create the next distinct column
+     * @param column out param, values of the next column ordered as keys of replacements will be placed here
+     * @returns false if all columns are already created
+     */
+    bool next(ScAddr * column);
+    /// Start streaming from the first column again
+    void reset();
+
+  private:
+    /// Hashes of factor columns to check if a column of the next term is in the factor
+    struct FactorIndex
+    {
+      std::vector<size_t> keysIndices;
+      ReplacementsHashes hashes;
+    };
+
+    FactorizedReplacements const & replacements;
+    /// Row indices of factor keys in replacements for each factor of each term
+    std::vector<std::vector<std::vector<size_t>>> factorsRowsIndices;
+    std::unordered_map<Replacements const *, FactorIndex> factorsIndices;
+    size_t termIndex;
+    std::vector<size_t> factorsColumns;
+    bool isTermStarted;
+    ScAddrVector factorValues;
+
+    bool nextTermColumn();
+    bool isInPreviousTerms(ScAddr const * column);
+    FactorIndex const & getFactorIndex(Replacements const & factor);
+  };
+
+  FactorizedReplacements() = default;
+  explicit FactorizedReplacements(Replacements replacements);
+  FactorizedReplacements(FactorizedReplacements const & other);
+  FactorizedReplacements(FactorizedReplacements && other) noexcept = default;
+  ~FactorizedReplacements() = default;
+
+  FactorizedReplacements & operator=(FactorizedReplacements const & other);
+  FactorizedReplacements & operator=(FactorizedReplacements && other) noexcept = default;
+
+  ScAddrVector const & getKeys() const;
+  /// Returns true if there are no columns
+  bool empty() const;
+  /// Returns true if replacements are one table with the same keys order, it is returned by `getTable`
+  bool isTable() const;
+  /// Returns the table, throws utils::ExceptionInvalidState if replacements are not a table
+  Replacements const & getTable() const;
+  size_t getTermsAmount() const;
+  /// Returns amount of columns of all terms, columns present in several terms are counted several times
+  size_t getCombinationsAmount() const;
+
+  /// Create all distinct columns in the order of `ColumnsStream`
+  void expand(Replacements & table) const;
+  /// Replace terms with one table of all distinct columns and return it
+  Replacements const & materialize();
+  /**
+   * @brief Keep the first distinct columns in the order of `ColumnsStream`
+   * @param columnsAmount amount of columns to keep, replacements with not more columns are not changed
+   * @returns amount of distinct columns after limitation, it is less than `columnsAmount` only if there are not
+   * enough of them
+   */
+  size_t limit(size_t columnsAmount);
+
+  /**
+   * @brief Distinct columns of replacements with values of the given keys only. Factors without these keys are removed
+   * from terms, so replacements of keys not used by a consumer do not multiply its columns
+   * @param projectionKeys keys to keep, keys absent in replacements are ignored
+   * @returns replacements with keys ordered as in these replacements. If all keys are removed then non-empty
+   * replacements have one empty column
+   */
+  FactorizedReplacements project(ScAddrVector const & projectionKeys) const;
+
+  /**
+   * @brief Intersect replacements with `other` in place as `ReplacementsUtils::narrowWith` does. If `other` has common
+   * keys only with one factor of a term then only this factor is narrowed and the term stays a product. If `other` has
+   * no common keys with a term then it is added to the term as a new factor
+   * @param other replacements to intersect with, it is expanded if it is factorized and these replacements are not
+   */
+  void narrowWith(FactorizedReplacements const & other);
+  /**
+   * @brief Unite replacements as `ReplacementsUtils::uniteReplacements` does without creation of their combinations:
+   * columns of `first` are multiplied by columns of `second` projected to its unique keys and vice versa
+   * @param unionResult out param, it may be the same object as `first` or `second`
+   */
+  static void unite(
+      FactorizedReplacements const & first,
+      FactorizedReplacements const & second,
+      FactorizedReplacements & unionResult);
+
+private:
+  using Factor = std::shared_ptr<Replacements>;
+  using Term = std::vector<Factor>;
+
+  ScAddrVector keys;
+  std::vector<Term> terms;
+
+  void narrowWith(Replacements const & other);
+  /// Replace the factor with its copy if it is shared, so it may be changed
+  static Replacements & getOwnFactor(Factor & factor);
+  /// Create a factor with all combinations of columns of the given factors of the term
+  static Factor multiplyFactors(Term const & term, std::vector<size_t> const & factorsIndices);
+  /// Terms of replacements where each factor keeps only keys from `projectionKeys`
+  static void projectTerms(
+      FactorizedReplacements const & replacements,
+      ScAddrVector const & projectionKeys,
+      std::vector<Term> & projectionTerms);
+  void copyFactors(FactorizedReplacements const & other);
+};
+
+}  // namespace inference
@@ -0,0 +1,259 @@
+/*
+ * This source file is part of an OSTIS project. For the latest info, see http://ostis.net
+ * Distributed under the MIT License
+ * (See accompanying file COPYING.MIT or copy at http://opensource.org/licenses/MIT)
+ */
+
+#include "Replacements.hpp"
+
+#include <algorithm>
+
+#include <sc-memory/sc_utils.hpp>
+
+namespace inference
+{
+Replacements::ColumnView::ColumnView(ScAddr const * values, size_t size)
+  : values(values)
+  , valuesAmount(size)
+{
+}
+
+ScAddr const & Replacements::ColumnView::operator[](size_t rowIndex) const
+{
+  return values[rowIndex];
+}
+
+size_t Replacements::ColumnView::size() const
+{
+  return valuesAmount;
+}
+
+ScAddr const * Replacements::ColumnView::begin() const
+{
+  return values;
+}
+
+ScAddr const * Replacements::ColumnView::end() const
+{
+  return values + valuesAmount;
+}
+
+Replacements::RowView::Iterator::Iterator(ScAddr const * value, size_t stride)
+  : value(value)
+  , stride(stride)
+{
+}
+
+Replacements::RowView::Iterator::reference Replacements::RowView::Iterator::operator*() const
+{
+  return *value;
+}
+
+Replacements::RowView::Iterator::pointer Replacements::RowView::Iterator::operator->() const
+{
+  return value;
+}
+
+Replacements::RowView::Iterator & Replacements::RowView::Iterator::operator++()
+{
+  value += stride;
+  return *this;
+}
+
+Replacements::RowView::Iterator Replacements::RowView::Iterator::operator++(int)
+{
+  Iterator previous = *this;
+  value += stride;
+  return previous;
+}
+
+bool Replacements::RowView::Iterator::operator==(Iterator const & other) const
+{
+  return value == other.value;
+}
+
+bool Replacements::RowView::Iterator::operator!=(Iterator const & other) const
+{
+  return value != other.value;
+}
+
+Replacements::RowView::RowView(ScAddr const * values, size_t stride, size_t size)
+  : values(values)
+  , stride(stride)
+  , valuesAmount(size)
+{
+}
+
+ScAddr const & Replacements::RowView::operator[](size_t columnIndex) const
+{
+  return values[columnIndex * stride];
+}
+
+size_t Replacements::RowView::size() const
+{
+  return valuesAmount;
+}
+
+bool Replacements::RowView::empty() const
+{
+  return valuesAmount == 0;
+}
+
+Replacements::RowView::Iterator Replacements::RowView::begin() const
+{
+  return {values, stride};
+}
+
+Replacements::RowView::Iterator Replacements::RowView::end() const
+{
+  return {values + valuesAmount * stride, stride};
+}
+
+Replacements::Replacements(ScAddrVector keys)
+  : keys(std::move(keys))
+{
+}
+
+Replacements::Replacements(ScAddrUnorderedSet const & keys)
+  : keys(keys.cbegin(), keys.cend())
+{
+}
+
+Replacements::Replacements(Replacements const & other)
+  : keys(other.keys)
+  , values(other.values, ReplacementsArena::getResource())
+{
+}
+
+Replacements::Replacements(Replacements && other) noexcept
+  : keys(std::move(other.keys))
+  , values(std::move(other.values), ReplacementsArena::getResource())
+{
+  other.keys.clear();
+  other.values.clear();
+}
+
+ScAddrVector const & Replacements::getKeys() const
+{
+  return keys;
+}
+
+size_t Replacements::getKeysAmount() const
+{
+  return keys.size();
+}
+
+bool Replacements::hasKey(ScAddr const & key) const
+{
+  return findKeyIndex(key) != kNotFound;
+}
+
+// Formulas have a few variables, so linear search is faster than hashing here
+size_t Replacements::findKeyIndex(ScAddr const & key) const
+{
+  auto const & keyIterator = std::find(keys.cbegin(), keys.cend(), key);
+  return keyIterator == keys.cend() ? kNotFound : static_cast<size_t>(keyIterator - keys.cbegin());
+}
+
+size_t Replacements::getKeyIndex(ScAddr const & key) const
+{
+  size_t const keyIndex = findKeyIndex(key);
+  if (keyIndex == kNotFound)
+    SC_THROW_EXCEPTION(utils::ExceptionItemNotFound, "Replacements: there is no key " << key.Hash());
+  return keyIndex;
+}
+
+size_t Replacements::getColumnsAmount() const
+{
+  return keys.empty() ? 0 : values.size() / keys.size();
+}
+
+bool Replacements::empty() const
+{
+  return values.empty();
+}
+
+void Replacements::clear()
+{
+  keys.clear();
+  values.clear();
+}
+
+void Replacements::reserve(size_t columnsAmount)
+{
+  values.reserve(columnsAmount * keys.size());
+}
+
+void Replacements::resize(size_t columnsAmount)
+{
+  values.resize(columnsAmount * keys.size());
+}
+
+Replacements::ColumnView Replacements::getColumn(size_t columnIndex) const
+{
+  return {getColumnValues(columnIndex), keys.size()};
+}
+
+Replacements::RowView Replacements::getRow(ScAddr const & key) const
+{
+  return {values.data() + getKeyIndex(key), keys.size(), getColumnsAmount()};
+}
+
+Replacements::RowView Replacements::at(ScAddr const & key) const
+{
+  return getRow(key);
+}
+
+ScAddr const & Replacements::get(size_t columnIndex, size_t rowIndex) const
+{
+  return values[columnIndex * keys.size() + rowIndex];
+}
+
+ScAddr const * Replacements::getColumnValues(size_t columnIndex) const
+{
+  return values.data() + columnIndex * keys.size();
+}
+
+ScAddr * Replacements::getColumnValues(size_t columnIndex)
+{
+  return values.data() + columnIndex * keys.size();
+}
+
+ScAddr const * Replacements::getValues() const
+{
+  return values.data();
+}
+
+ScAddr * Replacements::addColumn()
+{
+  size_t const columnBegin = values.size();
+  values.resize(columnBegin + keys.size());
+  return values.data() + columnBegin;
+}
+
+void Replacements::addColumn(ColumnView const & column)
+{
+  if (column.size() != keys.size())
+    SC_THROW_EXCEPTION(
+        utils::ExceptionInvalidParams,
+        "Replacements: column has " << column.size() << " values, but there are " << keys.size() << " keys");
+  values.insert(values.cend(), column.begin(), column.end());
+}
+
+void Replacements::keepColumns(std::vector<size_t> const & columnsIndices)
+{
+  size_t const keysAmount = keys.size();
+  size_t keptColumnsAmount = 0;
+  for (size_t const columnIndex : columnsIndices)
+  {
+    if (keptColumnsAmount != columnIndex)
+    {
+      ScAddr const * column = getColumnValues(columnIndex);
+      std::copy(column, column + keysAmount, getColumnValues(keptColumnsAmount));
+    }
+    ++keptColumnsAmount;
+  }
+  resize(keptColumnsAmount);
+}
+
+}  // namespace inference
@@ -0,0 +1,153 @@
+/*
+ * This source file is part of an OSTIS project. For the latest info, see http://ostis.net
+ * Distributed under the MIT License
+ * (See accompanying file COPYING.MIT or copy at http://opensource.org/licenses/MIT)
+ */
+
+#pragma once
+
+#include <iterator>
+#include <memory_resource>
+#include <vector>
+
+#include <sc-memory/sc_addr.hpp>
+
+#include "ReplacementsArena.hpp"
+
+namespace inference
+{
+/**
+ * Table of variables replacements. Every key (variable) is a row of the table and every column is a set of values
+ * for all keys. The schema maps each key to a dense row index, and all values are stored in one contiguous buffer
+ * column by column: value of the key with row index `row` in the column `column` is
+ * `values[column * keysAmount + row]`.
+ * A table without keys has no columns.
+ * Values are allocated in the memory resource of the current `ReplacementsArena::Scope`, copies are allocated there
+ * too.
+ */
+class Replacements
+{
+public:
+  /// Values of all keys in one column, ordered by row indices of keys
+  class ColumnView
+  {
+  public:
+    ColumnView(ScAddr const * values, size_t size);
+
+    ScAddr const & operator[](size_t rowIndex) const;
+
+    size_t size() const;
+
+    ScAddr const * begin() const;
+    ScAddr const * end() const;
+
+  private:
+    ScAddr const * values;
+    size_t valuesAmount;
+  };
+
+  /// Values of one key in all columns
+  class RowView
+  {
+  public:
+    class Iterator
+    {
+    public:
+      using iterator_category = std::forward_iterator_tag;
+      using value_type = ScAddr;
+      using difference_type = std::ptrdiff_t;
+      using pointer = ScAddr const *;
+      using reference = ScAddr const &;
+
+      Iterator(ScAddr const * value, size_t stride);
+
+      reference operator*() const;
+      pointer operator->() const;
+      Iterator & operator++();
+      Iterator operator++(int);
+      bool operator==(Iterator const & other) const;
+      bool operator!=(Iterator const & other) const;
+
+    private:
+      ScAddr const * value;
+      size_t stride;
+    };
+
+    RowView(ScAddr const * values, size_t stride, size_t size);
+
+    ScAddr const & operator[](size_t columnIndex) const;
+
+    size_t size() const;
+    bool empty() const;
+
+    Iterator begin() const;
+    Iterator end() const;
+
+  private:
+    ScAddr const * values;
+    size_t stride;
+    size_t valuesAmount;
+  };
+
+  static size_t constexpr kNotFound = static_cast<size_t>(-1);
+
+  Replacements() = default;
+  explicit Replacements(ScAddrVector keys);
+  explicit Replacements(ScAddrUnorderedSet const & keys);
+  Replacements(Replacements const & other);
+  /**
+   * Values are moved if `other` uses the memory resource of the current scope, otherwise they are copied to it, so a
+   * table moved out of an arena scope doesn't refer to the arena after its reset. The copy may only fail on allocation
+   */
+  Replacements(Replacements && other) noexcept;
+  ~Replacements() = default;
+
+  /// Values are copied to the memory resource of this table
+  Replacements & operator=(Replacements const & other) = default;
+  /// Values are moved if both tables use the same memory resource, otherwise they are copied
+  Replacements & operator=(Replacements && other) = default;
+
+  ScAddrVector const & getKeys() const;
+  size_t getKeysAmount() const;
+  bool hasKey(ScAddr const & key) const;
+  /// Returns row index of the key or `kNotFound`
+  size_t findKeyIndex(ScAddr const & key) const;
+  /// Returns row index of the key, throws utils::ExceptionItemNotFound if there is no such key
+  size_t getKeyIndex(ScAddr const & key) const;
+
+  size_t getColumnsAmount() const;
+  /// Returns true if there are no columns
+  bool empty() const;
+  /// Removes keys and values
+  void clear();
+  void reserve(size_t columnsAmount);
+  /// Keeps only first `columnsAmount` columns or adds columns of empty values
+  void resize(size_t columnsAmount);
+
+  ColumnView getColumn(size_t columnIndex) const;
+  RowView getRow(ScAddr const & key) const;
+  RowView at(ScAddr const & key) const;
+  ScAddr const & get(size_t columnIndex, size_t rowIndex) const;
+
+  ScAddr const * getColumnValues(size_t columnIndex) const;
+  ScAddr * getColumnValues(size_t columnIndex);
+  ScAddr const * getValues() const;
+
+  /**
+   * @brief Add column of empty values to the end of the table
+   * @returns pointer to the first value of the added column, it is valid until the next change of the table size
+   */
+  ScAddr * addColumn();
+  void addColumn(ColumnView const & column);
+  /**
+   * @brief Keep only the given columns, they are moved to the beginning of the table without reallocation
+   * @param columnsIndices indices of columns to keep in ascending order
+   */
+  void keepColumns(std::vector<size_t> const & columnsIndices);
+
+private:
+  ScAddrVector keys;
+  std::pmr::vector<ScAddr> values{ReplacementsArena::getResource()};
+};
+
+}  // namespace inference
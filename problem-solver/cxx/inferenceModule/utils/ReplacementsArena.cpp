@@ -0,0 +1,91 @@
+/*
+ * This source file is part of an OSTIS project. For the latest info, see http://ostis.net
+ * Distributed under the MIT License
+ * (See accompanying file COPYING.MIT or copy at http://opensource.org/licenses/MIT)
+ */
+
+#include "ReplacementsArena.hpp"
+
+#include <algorithm>
+
+namespace inference
+{
+thread_local std::pmr::memory_resource * ReplacementsArena::currentResource = nullptr;
+
+ReplacementsArena::Scope::Scope(ReplacementsArena & arena)
+  : previousResource(currentResource)
+{
+  currentResource = &arena;
+}
+
+ReplacementsArena::Scope::~Scope()
+{
+  currentResource = previousResource;
+}
+
+ReplacementsArena::ReplacementsArena()
+{
+  createResource(kMinBufferSize);
+}
+
+ReplacementsArena::~ReplacementsArena() = default;
+
+std::pmr::memory_resource * ReplacementsArena::getResource()
+{
+  return currentResource ? currentResource : std::pmr::get_default_resource();
+}
+
+void ReplacementsArena::reset()
+{
+  statistics.maxFormulaAllocatedBytes = std::max(statistics.maxFormulaAllocatedBytes, formulaAllocatedBytes);
+  ++statistics.resetsAmount;
+  // Memory allocated after the buffer was exhausted is taken from the heap in chunks, so the buffer is grown to fit
+  // the whole formula next time
+  size_t const requiredBufferSize = std::min(formulaAllocatedBytes, kMaxBufferSize);
+  formulaAllocatedBytes = 0;
+  if (requiredBufferSize > bufferSize)
+    createResource(requiredBufferSize);
+  else
+    resource->release();
+}
+
+void ReplacementsArena::release()
+{
+  formulaAllocatedBytes = 0;
+  statistics = {};
+  createResource(kMinBufferSize);
+}
+
+ReplacementsArena::Statistics const & ReplacementsArena::getStatistics() const
+{
+  return statistics;
+}
+
+void * ReplacementsArena::do_allocate(size_t bytes, size_t alignment)
+{
+  ++statistics.allocationsAmount;
+  statistics.allocatedBytes += bytes;
+  formulaAllocatedBytes += bytes;
+  return resource->allocate(bytes, alignment);
+}
+
+// Monotonic resource frees memory only on release
+void ReplacementsArena::do_deallocate(void * pointer, size_t bytes, size_t alignment)
+{
+  resource->deallocate(pointer, bytes, alignment);
+}
+
+bool ReplacementsArena::do_is_equal(std::pmr::memory_resource const & other) const noexcept
+{
+  return this == &other;
+}
+
+void ReplacementsArena::createResource(size_t otherBufferSize)
+{
+  resource.reset();
+  bufferSize = otherBufferSize;
+  buffer = std::make_unique<std::byte[]>(bufferSize);
+  resource.emplace(buffer.get(), bufferSize, std::pmr::new_delete_resource());
+}
+
+}  // namespace inference
@@ -0,0 +1,86 @@
+/*
+ * This source file is part of an OSTIS project. For the latest info, see http://ostis.net
+ * Distributed under the MIT License
+ * (See accompanying file COPYING.MIT or copy at http://opensource.org/licenses/MIT)
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <optional>
+
+namespace inference
+{
+/**
+ * Monotonic memory resource for replacements tables created while one formula is used. Memory is never freed by
+ * tables, it is released at once by `reset`. The arena keeps one buffer as large as the largest formula needed, so
+ * after a few formulas memory is allocated from the heap only for formulas that need more.
+ * The arena is used by `Replacements` and hash tables of `ReplacementsUtils` created in the `Scope` on the same thread,
+ * tables created out of scope or on other threads use the default memory resource. All tables allocated in the arena
+ * must be destroyed before `reset`.
+ */
+class ReplacementsArena : public std::pmr::memory_resource
+{
+public:
+  struct Statistics
+  {
+    size_t allocationsAmount = 0;
+    size_t allocatedBytes = 0;
+    /// The biggest amount of bytes allocated between two resets
+    size_t maxFormulaAllocatedBytes = 0;
+    size_t resetsAmount = 0;
+  };
+
+  /// Makes the arena the memory resource of tables created on the current thread until destruction
+  class Scope
+  {
+  public:
+    explicit Scope(ReplacementsArena & arena);
+    ~Scope();
+
+    Scope(Scope const & other) = delete;
+    Scope & operator=(Scope const & other) = delete;
+
+  private:
+    std::pmr::memory_resource * previousResource;
+  };
+
+  ReplacementsArena();
+  ~ReplacementsArena() override;
+
+  ReplacementsArena(ReplacementsArena const & other) = delete;
+  ReplacementsArena & operator=(ReplacementsArena const & other) = delete;
+
+  /// Returns memory resource of the current scope or the default one if there is no scope
+  static std::pmr::memory_resource * getResource();
+
+  /// Frees all memory allocated in the arena, the buffer is kept and grown for the next formula
+  void reset();
+  /// Frees all memory including the buffer and clears statistics
+  void release();
+
+  Statistics const & getStatistics() const;
+
+protected:
+  void * do_allocate(size_t bytes, size_t alignment) override;
+  void do_deallocate(void * pointer, size_t bytes, size_t alignment) override;
+  bool do_is_equal(std::pmr::memory_resource const & other) const noexcept override;
+
+private:
+  static size_t constexpr kMinBufferSize = 64 * 1024;
+  /// Bigger buffers are not kept between formulas in order not to hold memory of a single huge formula
+  static size_t constexpr kMaxBufferSize = 64 * 1024 * 1024;
+  static thread_local std::pmr::memory_resource * currentResource;
+
+  std::unique_ptr<std::byte[]> buffer;
+  size_t bufferSize = 0;
+  std::optional<std::pmr::monotonic_buffer_resource> resource;
+  size_t formulaAllocatedBytes = 0;
+  Statistics statistics;
+
+  void createResource(size_t otherBufferSize);
+};
+
+}  // namespace inference
@@ -0,0 +1,41 @@
+/*
+ * This source file is part of an OSTIS project. For the latest info, see http://ostis.net
+ * Distributed under the MIT License
+ * (See accompanying file COPYING.MIT or copy at http://opensource.org/licenses/MIT)
+ */
+
+#include "ReplacementsHash.hpp"
+
+namespace inference
+{
+uint64_t ReplacementsHash::hashAddr(ScAddr const & addr)
+{
+  return mix(getAddrBits(addr));
+}
+
+// Mixing after each step makes the result depend on the order of combined values
+uint64_t ReplacementsHash::combine(uint64_t seed, uint64_t valueHash)
+{
+  return mix(seed * kCombineMultiplier + valueHash);
+}
+
+uint64_t ReplacementsHash::hashColumn(ScAddr const * column, std::vector<size_t> const & keysIndices)
+{
+  uint64_t hash = kGoldenRatio;
+  for (size_t const keyIndex : keysIndices)
+    hash = combine(hash, hashAddr(column[keyIndex]));
+  return hash;
+}
+
+// Finalizer of splitmix64: every bit of the input affects every bit of the result
+uint64_t ReplacementsHash::mix(uint64_t value)
+{
+  value ^= value >> 30;
+  value *= kMixFirstMultiplier;
+  value ^= value >> 27;
+  value *= kMixSecondMultiplier;
+  value ^= value >> 31;
+  return value;
+}
+
+}  // namespace inference
@@ -0,0 +1,49 @@
+/*
+ * This source file is part of an OSTIS project. For the latest info, see http://ostis.net
+ * Distributed under the MIT License
+ * (See accompanying file COPYING.MIT or copy at http://opensource.org/licenses/MIT)
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <sc-memory/sc_addr.hpp>
+
+namespace inference
+{
+/**
+ * Hashes of replacements columns (tuples of values) that are used to find equal columns in joins.
+ * Both segment and offset of each value are mixed to 64 bits, and values are combined in keys order, so columns
+ * with the same values for different keys have different hashes.
+ */
+class ReplacementsHash
+{
+public:
+  // Hashing constants are shared with vectorized kernels, they must give the same hashes
+  static uint64_t constexpr kGoldenRatio = 0x9e3779b97f4a7c15ull;
+  static uint64_t constexpr kCombineMultiplier = 0xff51afd7ed558ccdull;
+  static uint64_t constexpr kMixFirstMultiplier = 0xbf58476d1ce4e5b9ull;
+  static uint64_t constexpr kMixSecondMultiplier = 0x94d049bb133111ebull;
+
+  /// Segment and offset of the addr packed to one number, it is defined here to be inlined to vectorized kernels
+  static uint64_t getAddrBits(ScAddr const & addr)
+  {
+    sc_addr const realAddr = addr.GetRealAddr();
+    return (static_cast<uint64_t>(realAddr.seg) << 32) | static_cast<uint64_t>(realAddr.offset);
+  }
+
+  static uint64_t hashAddr(ScAddr const & addr);
+  static uint64_t combine(uint64_t seed, uint64_t valueHash);
+  /**
+   * @brief Hash values of the column for the given keys
+   * @param column values of the column ordered by keys row indices
+   * @param keysIndices row indices of keys to hash values of, their order is taken into account
+   * @returns hash of values, it is the same for all columns if there are no keys
+   */
+  static uint64_t hashColumn(ScAddr const * column, std::vector<size_t> const & keysIndices);
+  static uint64_t mix(uint64_t value);
+};
+
+}  // namespace inference
@@ -0,0 +1,205 @@
+/*
+ * This source file is part of an OSTIS project. For the latest info, see http://ostis.net
+ * Distributed under the MIT License
+ * (See accompanying file COPYING.MIT or copy at http://opensource.org/licenses/MIT)
+ */
+
+#include "ReplacementsKernels.hpp"
+
+#include "ReplacementsHash.hpp"
+
+// AVX2 functions are compiled with the target attribute, so the module itself is built for any x86-64 CPU
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#  define INFERENCE_AVX2_KERNELS
+#  define INFERENCE_TARGET_AVX2 __attribute__((target("avx2")))
+#  include <immintrin.h>
+#endif
+
+namespace inference
+{
+std::atomic<ReplacementsKernels::InstructionSet> ReplacementsKernels::instructionSet =
+    ReplacementsKernels::getSupportedInstructionSet();
+
+ReplacementsKernels::InstructionSet ReplacementsKernels::getSupportedInstructionSet()
+{
+#ifdef INFERENCE_AVX2_KERNELS
+  // CPU features may be not initialized yet, because it is called during static initialization
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2"))
+    return AVX2;
+#endif
+  return SCALAR;
+}
+
+ReplacementsKernels::InstructionSet ReplacementsKernels::getInstructionSet()
+{
+  return instructionSet.load(std::memory_order_relaxed);
+}
+
+void ReplacementsKernels::setInstructionSet(InstructionSet otherInstructionSet)
+{
+  instructionSet = otherInstructionSet <= getSupportedInstructionSet() ? otherInstructionSet : SCALAR;
+}
+
+bool ReplacementsKernels::areValuesEqual(
+    ScAddr const * firstColumn,
+    std::vector<size_t> const & firstKeysIndices,
+    ScAddr const * secondColumn,
+    std::vector<size_t> const & secondKeysIndices)
+{
+  if (getInstructionSet() == AVX2 && firstKeysIndices.size() >= kGatherMinKeysAmount)
+    return areValuesEqualAvx2(firstColumn, firstKeysIndices, secondColumn, secondKeysIndices);
+  return areValuesEqualScalar(firstColumn, firstKeysIndices, secondColumn, secondKeysIndices, 0);
+}
+
+void ReplacementsKernels::hashColumns(
+    Replacements const & replacements,
+    std::vector<size_t> const & keysIndices,
+    std::vector<uint64_t> & hashes)
+{
+  hashes.resize(replacements.getColumnsAmount());
+  hashColumns(replacements, keysIndices, 0, hashes.size(), hashes.data());
+}
+
+void ReplacementsKernels::hashColumns(
+    Replacements const & replacements,
+    std::vector<size_t> const & keysIndices,
+    size_t columnsBegin,
+    size_t columnsEnd,
+    uint64_t * hashes)
+{
+  if (getInstructionSet() == AVX2)
+    hashColumnsAvx2(replacements, keysIndices, columnsBegin, columnsEnd, hashes);
+  else
+    hashColumnsScalar(replacements, keysIndices, columnsBegin, columnsEnd, hashes);
+}
+
+bool ReplacementsKernels::areValuesEqualScalar(
+    ScAddr const * firstColumn,
+    std::vector<size_t> const & firstKeysIndices,
+    ScAddr const * secondColumn,
+    std::vector<size_t> const & secondKeysIndices,
+    size_t firstKeyPosition)
+{
+  for (size_t i = firstKeyPosition; i < firstKeysIndices.size(); ++i)
+  {
+    if (firstColumn[firstKeysIndices[i]] != secondColumn[secondKeysIndices[i]])
+      return false;
+  }
+  return true;
+}
+
+void ReplacementsKernels::hashColumnsScalar(
+    Replacements const & replacements,
+    std::vector<size_t> const & keysIndices,
+    size_t columnsBegin,
+    size_t columnsEnd,
+    uint64_t * hashes)
+{
+  for (size_t columnIndex = columnsBegin; columnIndex < columnsEnd; ++columnIndex)
+    hashes[columnIndex - columnsBegin] =
+        ReplacementsHash::hashColumn(replacements.getColumnValues(columnIndex), keysIndices);
+}
+
+#ifdef INFERENCE_AVX2_KERNELS
+
+// AVX2 has no 64-bit multiplication, so it is composed of 32-bit ones: the product of high halves is out of 64 bits
+INFERENCE_TARGET_AVX2 static inline __m256i multiply64(__m256i value, __m256i multiplier)
+{
+  __m256i const lowProduct = _mm256_mul_epu32(value, multiplier);
+  __m256i const highLowProduct = _mm256_mul_epu32(_mm256_srli_epi64(value, 32), multiplier);
+  __m256i const lowHighProduct = _mm256_mul_epu32(value, _mm256_srli_epi64(multiplier, 32));
+  __m256i const crossProducts = _mm256_add_epi64(highLowProduct, lowHighProduct);
+  return _mm256_add_epi64(lowProduct, _mm256_slli_epi64(crossProducts, 32));
+}
+
+INFERENCE_TARGET_AVX2 static inline __m256i mix(__m256i value)
+{
+  value = _mm256_xor_si256(value, _mm256_srli_epi64(value, 30));
+  value = multiply64(value, _mm256_set1_epi64x(static_cast<long long>(ReplacementsHash::kMixFirstMultiplier)));
+  value = _mm256_xor_si256(value, _mm256_srli_epi64(value, 27));
+  value = multiply64(value, _mm256_set1_epi64x(static_cast<long long>(ReplacementsHash::kMixSecondMultiplier)));
+  return _mm256_xor_si256(value, _mm256_srli_epi64(value, 31));
+}
+
+// Values of 4 keys are gathered by 64-bit row indices and compared at once, the rest keys are compared one by one
+INFERENCE_TARGET_AVX2 bool ReplacementsKernels::areValuesEqualAvx2(
+    ScAddr const * firstColumn,
+    std::vector<size_t> const & firstKeysIndices,
+    ScAddr const * secondColumn,
+    std::vector<size_t> const & secondKeysIndices)
+{
+  size_t keyPosition = 0;
+  if constexpr (sizeof(ScAddr) == sizeof(int32_t) && sizeof(size_t) == sizeof(long long))
+  {
+    auto const * firstValues = reinterpret_cast<int const *>(firstColumn);
+    auto const * secondValues = reinterpret_cast<int const *>(secondColumn);
+    for (; keyPosition + 4 <= firstKeysIndices.size(); keyPosition += 4)
+    {
+      __m128i const first = _mm256_i64gather_epi32(
+          firstValues, _mm256_loadu_si256(reinterpret_cast<__m256i const *>(&firstKeysIndices[keyPosition])), 4);
+      __m128i const second = _mm256_i64gather_epi32(
+          secondValues, _mm256_loadu_si256(reinterpret_cast<__m256i const *>(&secondKeysIndices[keyPosition])), 4);
+      if (_mm_movemask_epi8(_mm_cmpeq_epi32(first, second)) != 0xffff)
+        return false;
+    }
+  }
+  return areValuesEqualScalar(firstColumn, firstKeysIndices, secondColumn, secondKeysIndices, keyPosition);
+}
+
+// 4 columns are hashed at once, each 64-bit lane holds a hash of one column
+INFERENCE_TARGET_AVX2 void ReplacementsKernels::hashColumnsAvx2(
+    Replacements const & replacements,
+    std::vector<size_t> const & keysIndices,
+    size_t columnsBegin,
+    size_t columnsEnd,
+    uint64_t * hashes)
+{
+  size_t const keysAmount = replacements.getKeysAmount();
+  ScAddr const * values = replacements.getValues();
+  __m256i const combineMultiplier =
+      _mm256_set1_epi64x(static_cast<long long>(ReplacementsHash::kCombineMultiplier));
+
+  size_t columnIndex = columnsBegin;
+  for (; columnIndex + 4 <= columnsEnd; columnIndex += 4)
+  {
+    __m256i hash = _mm256_set1_epi64x(static_cast<long long>(ReplacementsHash::kGoldenRatio));
+    ScAddr const * columns = values + columnIndex * keysAmount;
+    for (size_t const keyIndex : keysIndices)
+    {
+      __m256i const addrBits = _mm256_setr_epi64x(
+          static_cast<long long>(ReplacementsHash::getAddrBits(columns[keyIndex])),
+          static_cast<long long>(ReplacementsHash::getAddrBits(columns[keysAmount + keyIndex])),
+          static_cast<long long>(ReplacementsHash::getAddrBits(columns[2 * keysAmount + keyIndex])),
+          static_cast<long long>(ReplacementsHash::getAddrBits(columns[3 * keysAmount + keyIndex])));
+      hash = mix(_mm256_add_epi64(multiply64(hash, combineMultiplier), mix(addrBits)));
+    }
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(hashes + columnIndex - columnsBegin), hash);
+  }
+  hashColumnsScalar(replacements, keysIndices, columnIndex, columnsEnd, hashes + columnIndex - columnsBegin);
+}
+
+#else
+
+bool ReplacementsKernels::areValuesEqualAvx2(
+    ScAddr const * firstColumn,
+    std::vector<size_t> const & firstKeysIndices,
+    ScAddr const * secondColumn,
+    std::vector<size_t> const & secondKeysIndices)
+{
+  return areValuesEqualScalar(firstColumn, firstKeysIndices, secondColumn, secondKeysIndices, 0);
+}
+
+void ReplacementsKernels::hashColumnsAvx2(
+    Replacements const & replacements,
+    std::vector<size_t> const & keysIndices,
+    size_t columnsBegin,
+    size_t columnsEnd,
+    uint64_t * hashes)
+{
+  hashColumnsScalar(replacements, keysIndices, columnsBegin, columnsEnd, hashes);
+}
+
+#endif
+
+}  // namespace inference
@@ -0,0 +1,102 @@
+/*
+ * This source file is part of an OSTIS project. For the latest info, see http://ostis.net
+ * Distributed under the MIT License
+ * (See accompanying file COPYING.MIT or copy at http://opensource.org/licenses/MIT)
+ */
+
+#pragma once
+
+#include "Replacements.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+namespace inference
+{
+/**
+ * Kernels for comparison and hashing of replacements columns. AVX2 implementations are chosen at runtime if the CPU
+ * supports them, otherwise scalar implementations are used. All implementations give the same results.
+ */
+class ReplacementsKernels
+{
+public:
+  enum InstructionSet
+  {
+    SCALAR = 0,
+    AVX2 = 1
+  };
+
+  /// Returns the best instruction set supported by the CPU
+  static InstructionSet getSupportedInstructionSet();
+  static InstructionSet getInstructionSet();
+  /// Use the instruction set if it is supported by the CPU, otherwise scalar implementations are used
+  static void setInstructionSet(InstructionSet instructionSet);
+
+  /**
+   * @brief Check if values of the first column for the first keys are equal to values of the second column for the
+   * second keys
+   * @param firstColumn values of the first column
+   * @param firstKeysIndices row indices of keys to compare values of the first column
+   * @param secondColumn values of the second column
+   * @param secondKeysIndices row indices of keys to compare values of the second column, their amount must be equal
+   * to amount of `firstKeysIndices`
+   */
+  static bool areValuesEqual(
+      ScAddr const * firstColumn,
+      std::vector<size_t> const & firstKeysIndices,
+      ScAddr const * secondColumn,
+      std::vector<size_t> const & secondKeysIndices);
+
+  /**
+   * @brief Hash values of all columns for the given keys, hashes are equal to hashes of `ReplacementsHash::hashColumn`
+   * @param replacements to hash columns of
+   * @param keysIndices row indices of keys to hash values of
+   * @param hashes out param, hashes of columns in columns order will be placed here
+   */
+  static void hashColumns(
+      Replacements const & replacements,
+      std::vector<size_t> const & keysIndices,
+      std::vector<uint64_t> & hashes);
+  /**
+   * @brief Hash values of columns from `columnsBegin` to `columnsEnd` for the given keys
+   * @param hashes out param, hash of the column `columnsBegin + i` will be placed to `hashes[i]`
+   */
+  static void hashColumns(
+      Replacements const & replacements,
+      std::vector<size_t> const & keysIndices,
+      size_t columnsBegin,
+      size_t columnsEnd,
+      uint64_t * hashes);
+
+private:
+  /// Gathering of values is slower than comparison one by one with early exit if there are less keys
+  static size_t constexpr kGatherMinKeysAmount = 8;
+  static std::atomic<InstructionSet> instructionSet;
+
+  static bool areValuesEqualScalar(
+      ScAddr const * firstColumn,
+      std::vector<size_t> const & firstKeysIndices,
+      ScAddr const * secondColumn,
+      std::vector<size_t> const & secondKeysIndices,
+      size_t firstKeyPosition);
+  static void hashColumnsScalar(
+      Replacements const & replacements,
+      std::vector<size_t> const & keysIndices,
+      size_t columnsBegin,
+      size_t columnsEnd,
+      uint64_t * hashes);
+  static bool areValuesEqualAvx2(
+      ScAddr const * firstColumn,
+      std::vector<size_t> const & firstKeysIndices,
+      ScAddr const * secondColumn,
+      std::vector<size_t> const & secondKeysIndices);
+  static void hashColumnsAvx2(
+      Replacements const & replacements,
+      std::vector<size_t> const & keysIndices,
+      size_t columnsBegin,
+      size_t columnsEnd,
+      uint64_t * hashes);
+};
+
+}  // namespace inference
@@ -6,10 +6,15 @@
 
 #include "ReplacementsUtils.hpp"
 
+#include <algorithm>
+#include <numeric>
+
 #include <sc-memory/sc_agent.hpp>
 
 namespace inference
 {
+std::array<std::atomic<size_t>, 4> ReplacementsUtils::joinsAmounts = {};
+std::atomic<size_t> ReplacementsUtils::parallelColumnsThreshold = kDefaultParallelColumnsThreshold;
 
 void ReplacementsUtils::intersectReplacements(
     Replacements const & first,
@@ -17,10 +22,6 @@ void ReplacementsUtils::intersectReplacements(
     Replacements & intersection)
 {
   std::vector<std::pair<size_t, size_t>> firstSecondPairs;
-  ScAddrUnorderedSet firstKeys;
-  getKeySet(first, firstKeys);
-  ScAddrUnorderedSet secondKeys;
-  getKeySet(second, secondKeys);
   size_t firstAmountOfColumns = getColumnsAmount(first);
   size_t secondAmountOfColumns = getColumnsAmount(second);
 
@@ -35,58 +36,336 @@ void ReplacementsUtils::intersectReplacements(
     return;
   }
 
-  ScAddrUnorderedSet commonKeysSet;
-  getCommonKeys(firstKeys, secondKeys, commonKeysSet);
+  std::vector<size_t> firstCommonKeysIndices;
+  std::vector<size_t> secondCommonKeysIndices;
+  getCommonKeys(first, second, firstCommonKeysIndices, secondCommonKeysIndices);
+  std::vector<size_t> secondUniqueKeysIndices;
+  getUniqueKeys(second, first, secondUniqueKeysIndices);
+
+  JoinStrategy const joinStrategy = chooseJoinStrategy(first, firstCommonKeysIndices, second, secondCommonKeysIndices);
+  ++joinsAmounts[joinStrategy];
+  switch (joinStrategy)
+  {
+    case NESTED_LOOP_JOIN:
+      nestedLoopJoin(first, firstCommonKeysIndices, second, secondCommonKeysIndices, firstSecondPairs);
+      break;
+    case HASH_JOIN:
+      hashJoin(first, firstCommonKeysIndices, second, secondCommonKeysIndices, firstSecondPairs);
+      break;
+    case SORT_MERGE_JOIN:
+      sortMergeJoin(first, firstCommonKeysIndices, second, secondCommonKeysIndices, firstSecondPairs);
+      break;
+    case PARALLEL_HASH_JOIN:
+      parallelHashJoin(
+          *ThreadPool::getShared(),
+          first,
+          firstCommonKeysIndices,
+          second,
+          secondCommonKeysIndices,
+          firstSecondPairs);
+      break;
+  }
+
+  ScAddrVector resultKeys = first.getKeys();
+  for (size_t const secondKeyIndex : secondUniqueKeysIndices)
+    resultKeys.push_back(second.getKeys()[secondKeyIndex]);
+  Replacements result(std::move(resultKeys));
+  result.resize(firstSecondPairs.size());
+
+  size_t const firstKeysAmount = first.getKeysAmount();
+  auto const & fillColumns = [&](size_t columnsBegin, size_t columnsEnd)
+  {
+    for (size_t columnIndex = columnsBegin; columnIndex < columnsEnd; ++columnIndex)
+    {
+      auto const & [firstColumnIndex, secondColumnIndex] = firstSecondPairs[columnIndex];
+      ScAddr * resultColumn = result.getColumnValues(columnIndex);
+      ScAddr const * firstColumn = first.getColumnValues(firstColumnIndex);
+      std::copy(firstColumn, firstColumn + firstKeysAmount, resultColumn);
+      for (size_t i = 0; i < secondUniqueKeysIndices.size(); ++i)
+        resultColumn[firstKeysAmount + i] = second.get(secondColumnIndex, secondUniqueKeysIndices[i]);
+    }
+  };
+  std::shared_ptr<ThreadPool> const & pool = getParallelPool(firstSecondPairs.size());
+  if (pool)
+    parallelForChunks(*pool, firstSecondPairs.size(), fillColumns);
+  else
+    fillColumns(0, firstSecondPairs.size());
+  removeDuplicateColumns(result);
+  intersection = std::move(result);
+}
+
+/**
+ * @brief Intersect `accumulator` with `other` and put the result to `accumulator`. If `other` has no keys absent in
+ * `accumulator` then intersection only filters columns of `accumulator`, so they are filtered in place without
+ * allocation of a new table. Filtering adds no duplicate columns, so duplicates are not searched in this case
+ * @param accumulator replacements to narrow, the result is placed here
+ * @param other replacements to intersect with
+ */
+void ReplacementsUtils::narrowWith(Replacements & accumulator, Replacements const & other)
+{
+  if (getColumnsAmount(accumulator) == 0)
+  {
+    accumulator = other;
+    return;
+  }
+  if (getColumnsAmount(other) == 0)
+    return;
+
+  std::vector<size_t> otherUniqueKeysIndices;
+  getUniqueKeys(other, accumulator, otherUniqueKeysIndices);
+  if (!otherUniqueKeysIndices.empty())
+  {
+    intersectReplacements(accumulator, other, accumulator);
+    return;
+  }
+
+  std::vector<size_t> accumulatorColumns;
+  semiJoinReplacements(accumulator, other, accumulatorColumns);
+  accumulator.keepColumns(accumulatorColumns);
+}
+
+size_t ReplacementsUtils::getJoinsAmount(JoinStrategy joinStrategy)
+{
+  return joinsAmounts[joinStrategy].load();
+}
+
+void ReplacementsUtils::resetJoinsAmounts()
+{
+  for (auto & joinsAmount : joinsAmounts)
+    joinsAmount = 0;
+}
+
+size_t ReplacementsUtils::getParallelColumnsThreshold()
+{
+  return parallelColumnsThreshold.load();
+}
+
+void ReplacementsUtils::setParallelColumnsThreshold(size_t columnsAmount)
+{
+  parallelColumnsThreshold = columnsAmount;
+}
+
+/**
+ * @brief Choose the cheapest way to find pairs of columns with equal values of common keys. Nested loop join compares
+ * each pair of columns and needs no additional memory, so it is used for tiny inputs and for cartesian product.
+ * Columns that are already sorted by common keys are merged. Otherwise the smaller side is hashed, partitioned
+ * hashing is used for big tables if there are several threads in the shared pool
+ */
+ReplacementsUtils::JoinStrategy ReplacementsUtils::chooseJoinStrategy(
+    Replacements const & first,
+    std::vector<size_t> const & firstCommonKeysIndices,
+    Replacements const & second,
+    std::vector<size_t> const & secondCommonKeysIndices)
+{
+  size_t const firstAmountOfColumns = getColumnsAmount(first);
+  size_t const secondAmountOfColumns = getColumnsAmount(second);
+  if (firstCommonKeysIndices.empty() ||
+      firstAmountOfColumns * secondAmountOfColumns <=
+          kHashJoinColumnCost * (firstAmountOfColumns + secondAmountOfColumns))
+    return NESTED_LOOP_JOIN;
+  if (areColumnsSorted(first, firstCommonKeysIndices) && areColumnsSorted(second, secondCommonKeysIndices))
+    return SORT_MERGE_JOIN;
+  if (getParallelPool(std::max(firstAmountOfColumns, secondAmountOfColumns)))
+    return PARALLEL_HASH_JOIN;
+  return HASH_JOIN;
+}
+
+void ReplacementsUtils::nestedLoopJoin(
+    Replacements const & first,
+    std::vector<size_t> const & firstCommonKeysIndices,
+    Replacements const & second,
+    std::vector<size_t> const & secondCommonKeysIndices,
+    std::vector<std::pair<size_t, size_t>> & firstSecondPairs)
+{
+  size_t const firstAmountOfColumns = getColumnsAmount(first);
+  size_t const secondAmountOfColumns = getColumnsAmount(second);
+  for (size_t columnIndexInFirst = 0; columnIndexInFirst < firstAmountOfColumns; ++columnIndexInFirst)
+  {
+    for (size_t columnIndexInSecond = 0; columnIndexInSecond < secondAmountOfColumns; ++columnIndexInSecond)
+    {
+      if (areColumnsEqual(
+              first, columnIndexInFirst, firstCommonKeysIndices, second, columnIndexInSecond, secondCommonKeysIndices))
+        firstSecondPairs.emplace_back(columnIndexInFirst, columnIndexInSecond);
+    }
+  }
+}
+
+// Hash table is built for the smaller side and columns of the bigger side are looked up in it
+void ReplacementsUtils::hashJoin(
+    Replacements const & first,
+    std::vector<size_t> const & firstCommonKeysIndices,
+    Replacements const & second,
+    std::vector<size_t> const & secondCommonKeysIndices,
+    std::vector<std::pair<size_t, size_t>> & firstSecondPairs)
+{
+  bool const isFirstBuildSide = getColumnsAmount(first) <= getColumnsAmount(second);
+  Replacements const & buildSide = isFirstBuildSide ? first : second;
+  std::vector<size_t> const & buildKeysIndices = isFirstBuildSide ? firstCommonKeysIndices : secondCommonKeysIndices;
+  Replacements const & probeSide = isFirstBuildSide ? second : first;
+  std::vector<size_t> const & probeKeysIndices = isFirstBuildSide ? secondCommonKeysIndices : firstCommonKeysIndices;
 
-  ReplacementsHashes firstHashes;
-  calculateHashesForCommonKeys(first, commonKeysSet, firstHashes);
-  ReplacementsHashes secondHashes;
-  calculateHashesForCommonKeys(second, commonKeysSet, secondHashes);
-  for (auto const & firstHashPair : firstHashes)
+  ReplacementsHashes buildHashes(ReplacementsArena::getResource());
+  calculateHashesForCommonKeys(buildSide, buildKeysIndices, buildHashes);
+  std::vector<uint64_t> probeHashes;
+  ReplacementsKernels::hashColumns(probeSide, probeKeysIndices, probeHashes);
+  for (size_t probeColumnIndex = 0; probeColumnIndex < probeHashes.size(); ++probeColumnIndex)
   {
-    auto const & secondHashPairIterator = secondHashes.find(firstHashPair.first);
-    if (secondHashPairIterator == secondHashes.cend())
+    auto const & buildHashPairIterator = buildHashes.find(probeHashes[probeColumnIndex]);
+    if (buildHashPairIterator == buildHashes.cend())
       continue;
-    for (auto const & columnIndexInFirst : firstHashPair.second)
+    for (size_t const buildColumnIndex : buildHashPairIterator->second)
     {
-      for (auto const & columnIndexInSecond : secondHashPairIterator->second)
+      if (!areColumnsEqual(
+              buildSide, buildColumnIndex, buildKeysIndices, probeSide, probeColumnIndex, probeKeysIndices))
+        continue;
+      if (isFirstBuildSide)
+        firstSecondPairs.emplace_back(buildColumnIndex, probeColumnIndex);
+      else
+        firstSecondPairs.emplace_back(probeColumnIndex, buildColumnIndex);
+    }
+  }
+}
+
+/**
+ * Both sides are split into partitions by hashes, so equal columns are in the same partition and partitions are joined
+ * independently. Pairs are placed in the order of `hashJoin`: by probe column, then by build column. Amount of pairs of
+ * each probe column is counted first, so each partition knows where to place its pairs
+ */
+void ReplacementsUtils::parallelHashJoin(
+    ThreadPool & pool,
+    Replacements const & first,
+    std::vector<size_t> const & firstCommonKeysIndices,
+    Replacements const & second,
+    std::vector<size_t> const & secondCommonKeysIndices,
+    std::vector<std::pair<size_t, size_t>> & firstSecondPairs)
+{
+  bool const isFirstBuildSide = getColumnsAmount(first) <= getColumnsAmount(second);
+  Replacements const & buildSide = isFirstBuildSide ? first : second;
+  std::vector<size_t> const & buildKeysIndices = isFirstBuildSide ? firstCommonKeysIndices : secondCommonKeysIndices;
+  Replacements const & probeSide = isFirstBuildSide ? second : first;
+  std::vector<size_t> const & probeKeysIndices = isFirstBuildSide ? secondCommonKeysIndices : firstCommonKeysIndices;
+
+  std::vector<uint64_t> buildHashes;
+  hashColumnsInParallel(pool, buildSide, buildKeysIndices, buildHashes);
+  std::vector<uint64_t> probeHashes;
+  hashColumnsInParallel(pool, probeSide, probeKeysIndices, probeHashes);
+  std::vector<size_t> buildColumns;
+  std::vector<size_t> buildPartitionsBegins;
+  partitionColumnsByHashes(pool, buildHashes, buildColumns, buildPartitionsBegins);
+  std::vector<size_t> probeColumns;
+  std::vector<size_t> probePartitionsBegins;
+  partitionColumnsByHashes(pool, probeHashes, probeColumns, probePartitionsBegins);
+
+  size_t const partitionsAmount = buildPartitionsBegins.size() - 1;
+  std::vector<std::vector<size_t>> partitionsMatches(partitionsAmount);
+  std::vector<size_t> probeMatchesAmounts(probeHashes.size());
+  pool.parallelFor(
+      partitionsAmount,
+      [&](size_t partition)
       {
-        bool commonPartsAreIdentical = true;
-        for (ScAddr const & commonKey : commonKeysSet)
+        ReplacementsHashes partitionHashes(std::pmr::get_default_resource());
+        for (size_t position = buildPartitionsBegins[partition]; position < buildPartitionsBegins[partition + 1];
+             ++position)
+          partitionHashes[buildHashes[buildColumns[position]]].push_back(buildColumns[position]);
+
+        std::vector<size_t> & matches = partitionsMatches[partition];
+        for (size_t position = probePartitionsBegins[partition]; position < probePartitionsBegins[partition + 1];
+             ++position)
         {
-          if (first.at(commonKey).at(columnIndexInFirst) != second.at(commonKey).at(columnIndexInSecond))
+          size_t const probeColumnIndex = probeColumns[position];
+          auto const & buildHashPairIterator = partitionHashes.find(probeHashes[probeColumnIndex]);
+          if (buildHashPairIterator == partitionHashes.cend())
+            continue;
+          size_t const matchesBegin = matches.size();
+          for (size_t const buildColumnIndex : buildHashPairIterator->second)
           {
-            commonPartsAreIdentical = false;
-            break;
+            if (areColumnsEqual(
+                    buildSide, buildColumnIndex, buildKeysIndices, probeSide, probeColumnIndex, probeKeysIndices))
+              matches.push_back(buildColumnIndex);
           }
+          probeMatchesAmounts[probeColumnIndex] = matches.size() - matchesBegin;
         }
-        if (commonPartsAreIdentical)
-          firstSecondPairs.emplace_back(columnIndexInFirst, columnIndexInSecond);
-      }
-    }
-  }
+      });
 
-  Replacements result;
-  for (ScAddr const & firstKey : firstKeys)
-    result[firstKey].reserve(firstSecondPairs.size());
-  for (ScAddr const & secondKey : secondKeys)
-  {
-    if (!commonKeysSet.count(secondKey))
-      result[secondKey].reserve(firstSecondPairs.size());
-  }
+  size_t const pairsAmount = std::accumulate(probeMatchesAmounts.cbegin(), probeMatchesAmounts.cend(), size_t(0));
+  std::vector<size_t> & probePairsBegins = probeMatchesAmounts;
+  std::exclusive_scan(probeMatchesAmounts.cbegin(), probeMatchesAmounts.cend(), probePairsBegins.begin(), size_t(0));
+  size_t const previousPairsAmount = firstSecondPairs.size();
+  firstSecondPairs.resize(previousPairsAmount + pairsAmount);
+  pool.parallelFor(
+      partitionsAmount,
+      [&](size_t partition)
+      {
+        std::vector<size_t> const & matches = partitionsMatches[partition];
+        size_t matchIndex = 0;
+        for (size_t position = probePartitionsBegins[partition];
+             position < probePartitionsBegins[partition + 1] && matchIndex < matches.size();
+             ++position)
+        {
+          size_t const probeColumnIndex = probeColumns[position];
+          size_t const probeMatchesEnd = probeColumnIndex + 1 < probePairsBegins.size()
+                                             ? probePairsBegins[probeColumnIndex + 1]
+                                             : pairsAmount;
+          for (size_t pairIndex = probePairsBegins[probeColumnIndex]; pairIndex < probeMatchesEnd; ++pairIndex)
+          {
+            size_t const buildColumnIndex = matches[matchIndex++];
+            std::pair<size_t, size_t> & firstSecondPair = firstSecondPairs[previousPairsAmount + pairIndex];
+            if (isFirstBuildSide)
+              firstSecondPair = {buildColumnIndex, probeColumnIndex};
+            else
+              firstSecondPair = {probeColumnIndex, buildColumnIndex};
+          }
+        }
+      });
+}
 
-  for (auto const & firstSecondPair : firstSecondPairs)
+// Both sides must be sorted by common keys, then each group of equal columns in first is paired with the group of
+// equal columns in second
+void ReplacementsUtils::sortMergeJoin(
+    Replacements const & first,
+    std::vector<size_t> const & firstCommonKeysIndices,
+    Replacements const & second,
+    std::vector<size_t> const & secondCommonKeysIndices,
+    std::vector<std::pair<size_t, size_t>> & firstSecondPairs)
+{
+  size_t const firstAmountOfColumns = getColumnsAmount(first);
+  size_t const secondAmountOfColumns = getColumnsAmount(second);
+  size_t columnIndexInFirst = 0;
+  size_t columnIndexInSecond = 0;
+  while (columnIndexInFirst < firstAmountOfColumns && columnIndexInSecond < secondAmountOfColumns)
   {
-    for (ScAddr const & firstKey : firstKeys)
-      result.at(firstKey).push_back(first.at(firstKey).at(firstSecondPair.first));
-    for (ScAddr const & secondKey : secondKeys)
+    int const comparison = compareColumns(
+        first, columnIndexInFirst, firstCommonKeysIndices, second, columnIndexInSecond, secondCommonKeysIndices);
+    if (comparison < 0)
+    {
+      ++columnIndexInFirst;
+      continue;
+    }
+    if (comparison > 0)
+    {
+      ++columnIndexInSecond;
+      continue;
+    }
+
+    size_t firstGroupEnd = columnIndexInFirst + 1;
+    while (firstGroupEnd < firstAmountOfColumns &&
+           areColumnsEqual(
+               first, columnIndexInFirst, firstCommonKeysIndices, first, firstGroupEnd, firstCommonKeysIndices))
+      ++firstGroupEnd;
+    size_t secondGroupEnd = columnIndexInSecond + 1;
+    while (secondGroupEnd < secondAmountOfColumns &&
+           areColumnsEqual(
+               second, columnIndexInSecond, secondCommonKeysIndices, second, secondGroupEnd, secondCommonKeysIndices))
+      ++secondGroupEnd;
+
+    for (size_t firstGroupColumn = columnIndexInFirst; firstGroupColumn < firstGroupEnd; ++firstGroupColumn)
     {
-      if (!commonKeysSet.count(secondKey))
-        result.at(secondKey).push_back(second.at(secondKey).at(firstSecondPair.second));
+      for (size_t secondGroupColumn = columnIndexInSecond; secondGroupColumn < secondGroupEnd; ++secondGroupColumn)
+        firstSecondPairs.emplace_back(firstGroupColumn, secondGroupColumn);
     }
+    columnIndexInFirst = firstGroupEnd;
+    columnIndexInSecond = secondGroupEnd;
   }
-  removeDuplicateColumns(result);
-  intersection = result;
 }
 
 void ReplacementsUtils::subtractReplacements(
@@ -94,89 +373,115 @@ void ReplacementsUtils::subtractReplacements(
     Replacements const & second,
     Replacements & difference)
 {
-  ScAddrUnorderedSet firstKeys;
-  getKeySet(first, firstKeys);
-  ScAddrUnorderedSet secondKeys;
-  getKeySet(second, secondKeys);
-  size_t firstAmountOfColumns = getColumnsAmount(first);
-  size_t secondAmountOfColumns = getColumnsAmount(second);
   std::vector<size_t> firstColumns;
-  firstColumns.reserve(firstAmountOfColumns);
-
-  if (firstAmountOfColumns == 0 || secondAmountOfColumns == 0)
+  antiJoinReplacements(first, second, firstColumns);
+  if (firstColumns.size() == getColumnsAmount(first))
   {
     difference = first;
     return;
   }
 
-  ScAddrUnorderedSet commonKeysSet;
-  getCommonKeys(firstKeys, secondKeys, commonKeysSet);
+  Replacements result(first.getKeys());
+  result.reserve(firstColumns.size());
+  for (size_t const firstColumn : firstColumns)
+    result.addColumn(first.getColumn(firstColumn));
+  removeDuplicateColumns(result);
+  difference = std::move(result);
+}
 
-  if (commonKeysSet.empty())
+/**
+ * @brief Select columns of `first` that have a column with the same values of common keys in `second`. If there are no
+ * common keys then each column of `first` matches each column of `second`
+ * @param first replacements to select columns from
+ * @param second replacements to find matches in
+ * @param firstColumns out param, indices of selected columns of `first` in ascending order will be placed here
+ */
+void ReplacementsUtils::semiJoinReplacements(
+    Replacements const & first,
+    Replacements const & second,
+    std::vector<size_t> & firstColumns)
+{
+  std::vector<size_t> firstCommonKeysIndices;
+  std::vector<size_t> secondCommonKeysIndices;
+  getCommonKeys(first, second, firstCommonKeysIndices, secondCommonKeysIndices);
+  selectColumnsByMatches(first, firstCommonKeysIndices, second, secondCommonKeysIndices, true, firstColumns);
+}
+
+/**
+ * @brief Select columns of `first` that have no column with the same values of common keys in `second`, these are
+ * columns kept by `subtractReplacements`. If there are no common keys then all columns are selected
+ * @param first replacements to select columns from
+ * @param second replacements to find matches in
+ * @param firstColumns out param, indices of selected columns of `first` in ascending order will be placed here
+ */
+void ReplacementsUtils::antiJoinReplacements(
+    Replacements const & first,
+    Replacements const & second,
+    std::vector<size_t> & firstColumns)
+{
+  std::vector<size_t> firstCommonKeysIndices;
+  std::vector<size_t> secondCommonKeysIndices;
+  getCommonKeys(first, second, firstCommonKeysIndices, secondCommonKeysIndices);
+  if (firstCommonKeysIndices.empty())
   {
-    difference = first;
+    size_t const firstAmountOfColumns = getColumnsAmount(first);
+    firstColumns.reserve(firstColumns.size() + firstAmountOfColumns);
+    for (size_t columnIndex = 0; columnIndex < firstAmountOfColumns; ++columnIndex)
+      firstColumns.push_back(columnIndex);
     return;
   }
+  selectColumnsByMatches(first, firstCommonKeysIndices, second, secondCommonKeysIndices, false, firstColumns);
+}
 
-  ReplacementsHashes firstHashes;
-  calculateHashesForCommonKeys(first, commonKeysSet, firstHashes);
-  ReplacementsHashes secondHashes;
-  calculateHashesForCommonKeys(second, commonKeysSet, secondHashes);
-  for (auto const & firstHashPair : firstHashes)
+// Columns of `second` are hashed and columns of `first` are looked up in them one by one, so nothing is copied
+void ReplacementsUtils::selectColumnsByMatches(
+    Replacements const & first,
+    std::vector<size_t> const & firstCommonKeysIndices,
+    Replacements const & second,
+    std::vector<size_t> const & secondCommonKeysIndices,
+    bool hasMatch,
+    std::vector<size_t> & firstColumns)
+{
+  ReplacementsHashes secondHashes(ReplacementsArena::getResource());
+  calculateHashesForCommonKeys(second, secondCommonKeysIndices, secondHashes);
+  std::vector<uint64_t> firstHashes;
+  ReplacementsKernels::hashColumns(first, firstCommonKeysIndices, firstHashes);
+  for (size_t columnIndexInFirst = 0; columnIndexInFirst < firstHashes.size(); ++columnIndexInFirst)
   {
-    auto const & secondHashPairIterator = secondHashes.find(firstHashPair.first);
-    if (secondHashPairIterator == secondHashes.cend())
+    bool hasPairWithSimilarValues = false;
+    auto const & secondHashPairIterator = secondHashes.find(firstHashes[columnIndexInFirst]);
+    if (secondHashPairIterator != secondHashes.cend())
     {
-      firstColumns.insert(firstColumns.end(), firstHashPair.second.cbegin(), firstHashPair.second.cend());
-      continue;
-    }
-    for (auto const & columnIndexInFirst : firstHashPair.second)
-    {
-      bool hasPairWithSimilarValues = false;
-      for (auto const & columnIndexInSecond : secondHashPairIterator->second)
+      for (size_t const columnIndexInSecond : secondHashPairIterator->second)
       {
-        bool hasDifferentValuesForAnyKey = false;
-        for (ScAddr const & commonKey : commonKeysSet)
-        {
-          if (first.at(commonKey).at(columnIndexInFirst) != second.at(commonKey).at(columnIndexInSecond))
-          {
-            hasDifferentValuesForAnyKey = true;
-            break;
-          }
-        }
-        hasPairWithSimilarValues = !hasDifferentValuesForAnyKey;
+        hasPairWithSimilarValues = areColumnsEqual(
+            first,
+            columnIndexInFirst,
+            firstCommonKeysIndices,
+            second,
+            columnIndexInSecond,
+            secondCommonKeysIndices);
         if (hasPairWithSimilarValues)
           break;
       }
-      if (!hasPairWithSimilarValues)
-        firstColumns.push_back(columnIndexInFirst);
     }
+    if (hasPairWithSimilarValues == hasMatch)
+      firstColumns.push_back(columnIndexInFirst);
   }
-
-  Replacements result;
-  for (ScAddr const & firstKey : firstKeys)
-    result[firstKey].reserve(firstColumns.size());
-
-  for (auto const & firstColumn : firstColumns)
-  {
-    for (ScAddr const & firstKey : firstKeys)
-      result.at(firstKey).push_back(first.at(firstKey).at(firstColumn));
-  }
-  removeDuplicateColumns(result);
-  difference = result;
 }
 
+/**
+ * @brief Unite replacements. If keys of `first` and `second` differ then each column from one of them is combined with
+ * each column of the other for the keys that are absent in the first one
+ * @param first replacements to unite
+ * @param second replacements to unite
+ * @param unionResult out param, replacements with keys of `first` and `second` will be placed here
+ */
 void ReplacementsUtils::uniteReplacements(
     Replacements const & first,
     Replacements const & second,
     Replacements & unionResult)
 {
-  ScAddrUnorderedSet firstKeys;
-  getKeySet(first, firstKeys);
-  ScAddrUnorderedSet secondKeys;
-  getKeySet(second, secondKeys);
-  ScAddrUnorderedSet commonKeysSet;
-  getCommonKeys(firstKeys, secondKeys, commonKeysSet);
   size_t firstAmountOfColumns = getColumnsAmount(first);
   if (firstAmountOfColumns == 0)
   {
@@ -190,122 +495,141 @@ void ReplacementsUtils::uniteReplacements(
     return;
   }
 
-  ReplacementsHashes firstHashes;
-  calculateHashesForCommonKeys(first, commonKeysSet, firstHashes);
-  ReplacementsHashes secondHashes;
-  calculateHashesForCommonKeys(second, commonKeysSet, secondHashes);
-  std::unordered_set<size_t> columnsFromSecondToSkip;
+  std::vector<size_t> firstCommonKeysIndices;
+  std::vector<size_t> secondCommonKeysIndices;
+  getCommonKeys(first, second, firstCommonKeysIndices, secondCommonKeysIndices);
+  std::vector<size_t> firstUniqueKeysIndices;
+  getUniqueKeys(first, second, firstUniqueKeysIndices);
+  std::vector<size_t> secondUniqueKeysIndices;
+  getUniqueKeys(second, first, secondUniqueKeysIndices);
 
-  // insert into columnsFromSecondToSkip all column indices from second that are equal to at least one column from first
-  for (auto const & pairForFirst : firstHashes)
-  {
-    std::vector<size_t> const & columnsFromFirst = pairForFirst.second;
-    std::vector<size_t> const & columnsFromSecond =
-        secondHashes.count(pairForFirst.first) ? secondHashes.at(pairForFirst.first) : std::vector<size_t>();
-    for (auto const & columnFromSecond : columnsFromSecond)
-    {
-      bool isColumnFromSecondIdenticalToColumnFromFirst = true;
-      for (auto const & columnFromFirst : columnsFromFirst)
-      {
-        for (auto const & commonKey : commonKeysSet)
-        {
-          if (first.at(commonKey).at(columnFromFirst) != second.at(commonKey).at(columnFromSecond))
-            isColumnFromSecondIdenticalToColumnFromFirst = false;
-          break;
-        }
-        if (!isColumnFromSecondIdenticalToColumnFromFirst)
-          break;
-      }
-      if (isColumnFromSecondIdenticalToColumnFromFirst)
-        columnsFromSecondToSkip.insert(columnFromSecond);
-    }
-  }
+  ScAddrVector resultKeys = first.getKeys();
+  for (size_t const secondKeyIndex : secondUniqueKeysIndices)
+    resultKeys.push_back(second.getKeys()[secondKeyIndex]);
+  Replacements result(std::move(resultKeys));
+  size_t const firstKeysAmount = first.getKeysAmount();
 
-  Replacements result;
   // make all possible combinations for each column from first with each column from second with common keys values
   // taken from first
-  for (auto const & pairForFirst : firstHashes)
+  size_t const firstColumnRepeatsAmount = secondUniqueKeysIndices.empty() ? 1 : secondAmountOfColumns;
+  for (size_t columnFromFirst = 0; columnFromFirst < firstAmountOfColumns; ++columnFromFirst)
   {
-    std::vector<size_t> const & columnsFromFirst = pairForFirst.second;
-    for (auto const & columnFromFirst : columnsFromFirst)
+    ScAddr const * firstColumn = first.getColumnValues(columnFromFirst);
+    for (size_t repeatIndex = 0; repeatIndex < firstColumnRepeatsAmount; ++repeatIndex)
     {
-      for (auto const & firstKey : firstKeys)
-      {
-        std::vector<ScAddr> const sameValuesToInsert(
-            firstKeys.size() > commonKeysSet.size() ? secondAmountOfColumns : 1,
-            first.at(firstKey).at(columnFromFirst));
-        result[firstKey].insert(result.at(firstKey).cend(), sameValuesToInsert.cbegin(), sameValuesToInsert.cend());
-      }
-      for (auto const & secondKey : secondKeys)
-      {
-        if (!firstKeys.count(secondKey))
-          result[secondKey].insert(
-              result[secondKey].cend(), second.at(secondKey).cbegin(), second.at(secondKey).cend());
-      }
+      ScAddr * resultColumn = result.addColumn();
+      std::copy(firstColumn, firstColumn + firstKeysAmount, resultColumn);
+      for (size_t i = 0; i < secondUniqueKeysIndices.size(); ++i)
+        resultColumn[firstKeysAmount + i] = second.get(repeatIndex, secondUniqueKeysIndices[i]);
     }
   }
 
   // make all possible combinations for each column from second with each column from first with common keys values
-  // taken from second, skipping those columns from second that have same values as at least one column from first for
-  // each common key
-  for (auto const & pairForSecond : secondHashes)
+  // taken from second. If there are no common keys then all these combinations are already added
+  if (!firstCommonKeysIndices.empty())
   {
-    std::vector<size_t> const & columnsFromSecond = pairForSecond.second;
-    for (auto const & columnFromSecond : columnsFromSecond)
+    size_t const secondColumnRepeatsAmount = firstUniqueKeysIndices.empty() ? 1 : firstAmountOfColumns;
+    for (size_t columnFromSecond = 0; columnFromSecond < secondAmountOfColumns; ++columnFromSecond)
     {
-      if (columnsFromSecondToSkip.count(columnFromSecond))
-        continue;
-      for (auto const & secondKey : secondKeys)
+      for (size_t repeatIndex = 0; repeatIndex < secondColumnRepeatsAmount; ++repeatIndex)
       {
-        std::vector<ScAddr> const sameValuesToInsert(
-            secondKeys.size() > commonKeysSet.size() ? firstAmountOfColumns : 1,
-            second.at(secondKey).at(columnFromSecond));
-        result[secondKey].insert(result.at(secondKey).cend(), sameValuesToInsert.cbegin(), sameValuesToInsert.cend());
-      }
-      for (auto const & firstKey : firstKeys)
-      {
-        if (!secondKeys.count(firstKey))
-          result[firstKey].insert(result[firstKey].cend(), first.at(firstKey).cbegin(), first.at(firstKey).cend());
+        ScAddr * resultColumn = result.addColumn();
+        for (size_t i = 0; i < firstCommonKeysIndices.size(); ++i)
+          resultColumn[firstCommonKeysIndices[i]] = second.get(columnFromSecond, secondCommonKeysIndices[i]);
+        for (size_t const firstKeyIndex : firstUniqueKeysIndices)
+          resultColumn[firstKeyIndex] = first.get(repeatIndex, firstKeyIndex);
+        for (size_t i = 0; i < secondUniqueKeysIndices.size(); ++i)
+          resultColumn[firstKeysAmount + i] = second.get(columnFromSecond, secondUniqueKeysIndices[i]);
       }
     }
   }
   removeDuplicateColumns(result);
-  unionResult = result;
+  unionResult = std::move(result);
 }
 
 void ReplacementsUtils::getKeySet(Replacements const & map, ScAddrUnorderedSet & keySet)
 {
-  for (auto const & pair : map)
-    keySet.insert(pair.first);
+  keySet.insert(map.getKeys().cbegin(), map.getKeys().cend());
 }
 
 void ReplacementsUtils::getCommonKeys(
-    ScAddrUnorderedSet const & first,
-    ScAddrUnorderedSet const & second,
-    ScAddrUnorderedSet & commonKeys)
+    Replacements const & first,
+    Replacements const & second,
+    std::vector<size_t> & firstCommonKeysIndices,
+    std::vector<size_t> & secondCommonKeysIndices)
 {
-  ScAddrUnorderedSet result;
-  for (ScAddr const & key : first)
+  for (size_t firstKeyIndex = 0; firstKeyIndex < first.getKeysAmount(); ++firstKeyIndex)
   {
-    if (second.find(key) != second.end())
-      commonKeys.insert(key);
+    size_t const secondKeyIndex = second.findKeyIndex(first.getKeys()[firstKeyIndex]);
+    if (secondKeyIndex != Replacements::kNotFound)
+    {
+      firstCommonKeysIndices.push_back(firstKeyIndex);
+      secondCommonKeysIndices.push_back(secondKeyIndex);
+    }
   }
 }
 
-Replacements ReplacementsUtils::copyReplacements(Replacements const & replacements)
+void ReplacementsUtils::getUniqueKeys(
+    Replacements const & replacements,
+    Replacements const & other,
+    std::vector<size_t> & uniqueKeysIndices)
 {
-  Replacements result;
-  for (auto const & pair : replacements)
+  for (size_t keyIndex = 0; keyIndex < replacements.getKeysAmount(); ++keyIndex)
   {
-    ScAddr const & key = pair.first;
-    for (ScAddr const & value : replacements.at(key))
-      result[key].push_back(value);
+    if (!other.hasKey(replacements.getKeys()[keyIndex]))
+      uniqueKeysIndices.push_back(keyIndex);
   }
-  return result;
+}
+
+bool ReplacementsUtils::areColumnsEqual(
+    Replacements const & first,
+    size_t firstColumnIndex,
+    std::vector<size_t> const & firstKeysIndices,
+    Replacements const & second,
+    size_t secondColumnIndex,
+    std::vector<size_t> const & secondKeysIndices)
+{
+  return ReplacementsKernels::areValuesEqual(
+      first.getColumnValues(firstColumnIndex),
+      firstKeysIndices,
+      second.getColumnValues(secondColumnIndex),
+      secondKeysIndices);
+}
+
+// Columns are compared lexicographically by hashes of addrs of keys values
+int ReplacementsUtils::compareColumns(
+    Replacements const & first,
+    size_t firstColumnIndex,
+    std::vector<size_t> const & firstKeysIndices,
+    Replacements const & second,
+    size_t secondColumnIndex,
+    std::vector<size_t> const & secondKeysIndices)
+{
+  ScAddr const * firstColumn = first.getColumnValues(firstColumnIndex);
+  ScAddr const * secondColumn = second.getColumnValues(secondColumnIndex);
+  for (size_t i = 0; i < firstKeysIndices.size(); ++i)
+  {
+    ScAddr::HashType const firstHash = firstColumn[firstKeysIndices[i]].Hash();
+    ScAddr::HashType const secondHash = secondColumn[secondKeysIndices[i]].Hash();
+    if (firstHash != secondHash)
+      return firstHash < secondHash ? -1 : 1;
+  }
+  return 0;
+}
+
+bool ReplacementsUtils::areColumnsSorted(Replacements const & replacements, std::vector<size_t> const & keysIndices)
+{
+  size_t const columnsAmount = getColumnsAmount(replacements);
+  for (size_t columnIndex = 1; columnIndex < columnsAmount; ++columnIndex)
+  {
+    if (compareColumns(replacements, columnIndex - 1, keysIndices, replacements, columnIndex, keysIndices) > 0)
+      return false;
+  }
+  return true;
 }
 
 /**
- * @brief The size of the all ScAddrVector of variables is the same (it is a matrix)
+ * @brief Each column of replacements is converted to ScTemplateParams
  * @param replacements to convert to vector<ScTemplateParams>
  * @param templateParams out param, converted replacements will be placed here
  */
@@ -313,104 +637,269 @@ void ReplacementsUtils::getReplacementsToScTemplateParams(
     Replacements const & replacements,
     std::vector<ScTemplateParams> & templateParams)
 {
-  ScAddrUnorderedSet keys;
-  getKeySet(replacements, keys);
-  if (keys.empty())
-    return;
-
-  size_t columnsAmount = replacements.begin()->second.size();
+  size_t const columnsAmount = getColumnsAmount(replacements);
+  templateParams.reserve(templateParams.size() + columnsAmount);
   for (size_t columnIndex = 0; columnIndex < columnsAmount; ++columnIndex)
   {
     ScTemplateParams params;
-    for (ScAddr const & key : keys)
-      params.Add(key, replacements.at(key).at(columnIndex));
+    getColumnToScTemplateParams(replacements, columnIndex, params);
     templateParams.push_back(params);
   }
 }
 
+void ReplacementsUtils::getColumnToScTemplateParams(
+    Replacements const & replacements,
+    size_t columnIndex,
+    ScTemplateParams & templateParams)
+{
+  ScAddrVector const & keys = replacements.getKeys();
+  ScAddr const * column = replacements.getColumnValues(columnIndex);
+  for (size_t keyIndex = 0; keyIndex < keys.size(); ++keyIndex)
+    templateParams.Add(keys[keyIndex], column[keyIndex]);
+}
+
 size_t ReplacementsUtils::getColumnsAmount(Replacements const & replacements)
 {
-  return (replacements.empty() ? 0 : replacements.begin()->second.size());
+  return replacements.getColumnsAmount();
 }
 
+/**
+ * @brief Remove duplicate columns in one pass. Each column is compared only with kept columns that have the same hash,
+ * and kept columns are moved to the beginning of the table in their original order
+ * @param replacements to remove duplicate columns from
+ */
 void ReplacementsUtils::removeDuplicateColumns(Replacements & replacements)
 {
-  ScAddrUnorderedSet keys;
-  getKeySet(replacements, keys);
-  if (keys.empty())
+  size_t const keysAmount = replacements.getKeysAmount();
+  size_t const columnsAmount = getColumnsAmount(replacements);
+  if (columnsAmount < 2)
     return;
-  ReplacementsHashes replacementsHashes;
-  calculateHashesForCommonKeys(replacements, keys, replacementsHashes);
-  std::unordered_map<ScAddr, ScAddr, ScAddrHashFunc> column;
-  std::set<size_t> columnsToRemove;
-  for (auto const & replacementsHash : replacementsHashes)
+  std::shared_ptr<ThreadPool> const & pool = getParallelPool(columnsAmount);
+  if (pool)
   {
-    auto const & columnsForHash = replacementsHash.second;
-    if (columnsForHash.size() > 1)
+    removeDuplicateColumnsInParallel(*pool, replacements);
+    return;
+  }
+  std::vector<size_t> keysIndices(keysAmount);
+  for (size_t keyIndex = 0; keyIndex < keysAmount; ++keyIndex)
+    keysIndices[keyIndex] = keyIndex;
+
+  std::vector<uint64_t> columnsHashes;
+  ReplacementsKernels::hashColumns(replacements, keysIndices, columnsHashes);
+
+  // kept columns with the same hash are linked in a list: map stores the last one, vector stores the previous one
+  std::pmr::unordered_map<uint64_t, size_t> lastKeptColumnsByHashes(ReplacementsArena::getResource());
+  lastKeptColumnsByHashes.reserve(columnsAmount);
+  std::vector<size_t> previousKeptColumns;
+  previousKeptColumns.reserve(columnsAmount);
+  size_t keptColumnsAmount = 0;
+  for (size_t columnIndex = 0; columnIndex < columnsAmount; ++columnIndex)
+  {
+    ScAddr const * column = replacements.getColumnValues(columnIndex);
+    auto const & lastKeptColumnIterator =
+        lastKeptColumnsByHashes.emplace(columnsHashes[columnIndex], Replacements::kNotFound);
+    size_t & lastKeptColumn = lastKeptColumnIterator.first->second;
+
+    bool isDuplicate = false;
+    for (size_t keptColumn = lastKeptColumn; keptColumn != Replacements::kNotFound;
+         keptColumn = previousKeptColumns[keptColumn])
     {
-      for (size_t firstColumnIndex = 0; firstColumnIndex < columnsForHash.size(); ++firstColumnIndex)
+      if (std::equal(column, column + keysAmount, replacements.getColumnValues(keptColumn)))
       {
-        if (columnsToRemove.count(firstColumnIndex))
-          continue;
-        for (auto const & key : keys)
-          column[key] = replacements.at(key).at(columnsForHash[firstColumnIndex]);
-        for (size_t comparedColumnIndex = firstColumnIndex + 1; comparedColumnIndex < columnsForHash.size();
-             ++comparedColumnIndex)
+        isDuplicate = true;
+        break;
+      }
+    }
+    if (isDuplicate)
+      continue;
+
+    if (keptColumnsAmount != columnIndex)
+      std::copy(column, column + keysAmount, replacements.getColumnValues(keptColumnsAmount));
+    previousKeptColumns.push_back(lastKeptColumn);
+    lastKeptColumn = keptColumnsAmount;
+    ++keptColumnsAmount;
+  }
+  replacements.resize(keptColumnsAmount);
+}
+
+// Duplicates are in the same partition, so the first of them is found in each partition independently
+void ReplacementsUtils::removeDuplicateColumnsInParallel(ThreadPool & pool, Replacements & replacements)
+{
+  size_t const keysAmount = replacements.getKeysAmount();
+  std::vector<size_t> keysIndices(keysAmount);
+  std::iota(keysIndices.begin(), keysIndices.end(), 0);
+
+  std::vector<uint64_t> columnsHashes;
+  hashColumnsInParallel(pool, replacements, keysIndices, columnsHashes);
+  std::vector<size_t> partitionedColumns;
+  std::vector<size_t> partitionsBegins;
+  partitionColumnsByHashes(pool, columnsHashes, partitionedColumns, partitionsBegins);
+
+  // char is used instead of bool, because elements of vector<bool> can not be written from different threads
+  std::vector<char> areColumnsKept(columnsHashes.size(), false);
+  pool.parallelFor(
+      partitionsBegins.size() - 1,
+      [&](size_t partition)
+      {
+        ReplacementsHashes keptColumnsByHashes(std::pmr::get_default_resource());
+        for (size_t position = partitionsBegins[partition]; position < partitionsBegins[partition + 1]; ++position)
         {
-          if (columnsToRemove.count(comparedColumnIndex))
+          size_t const columnIndex = partitionedColumns[position];
+          ScAddr const * column = replacements.getColumnValues(columnIndex);
+          std::pmr::vector<size_t> & keptColumns = keptColumnsByHashes[columnsHashes[columnIndex]];
+          bool const isDuplicate = std::any_of(
+              keptColumns.cbegin(),
+              keptColumns.cend(),
+              [&](size_t keptColumn)
+              {
+                return std::equal(column, column + keysAmount, replacements.getColumnValues(keptColumn));
+              });
+          if (isDuplicate)
             continue;
-          bool columnIsUnique = false;
-          for (auto const & key : keys)
-          {
-            if (column[key] != replacements.at(key).at(columnsForHash[comparedColumnIndex]))
-            {
-              columnIsUnique = true;
-              break;
-            }
-          }
-          if (!columnIsUnique)
-            columnsToRemove.insert(columnsForHash[comparedColumnIndex]);
+          keptColumns.push_back(columnIndex);
+          areColumnsKept[columnIndex] = true;
         }
-      }
-    }
+      });
+
+  std::vector<size_t> keptColumnsIndices;
+  for (size_t columnIndex = 0; columnIndex < areColumnsKept.size(); ++columnIndex)
+  {
+    if (areColumnsKept[columnIndex])
+      keptColumnsIndices.push_back(columnIndex);
   }
-  for (auto columnToRemove = columnsToRemove.crbegin(); columnToRemove != columnsToRemove.crend(); columnToRemove++)
+  replacements.keepColumns(keptColumnsIndices);
+}
+
+std::shared_ptr<ThreadPool> ReplacementsUtils::getParallelPool(size_t columnsAmount)
+{
+  if (columnsAmount < getParallelColumnsThreshold())
+    return nullptr;
+  std::shared_ptr<ThreadPool> pool = ThreadPool::getShared();
+  return pool->getThreadsAmount() > 1 ? pool : nullptr;
+}
+
+void ReplacementsUtils::parallelForChunks(
+    ThreadPool & pool,
+    size_t columnsAmount,
+    std::function<void(size_t columnsBegin, size_t columnsEnd)> const & task)
+{
+  size_t const chunksAmount = (columnsAmount + kParallelChunkColumnsAmount - 1) / kParallelChunkColumnsAmount;
+  pool.parallelFor(
+      chunksAmount,
+      [&](size_t chunk)
+      {
+        size_t const columnsBegin = chunk * kParallelChunkColumnsAmount;
+        task(columnsBegin, std::min(columnsBegin + kParallelChunkColumnsAmount, columnsAmount));
+      });
+}
+
+void ReplacementsUtils::hashColumnsInParallel(
+    ThreadPool & pool,
+    Replacements const & replacements,
+    std::vector<size_t> const & keysIndices,
+    std::vector<uint64_t> & hashes)
+{
+  hashes.resize(getColumnsAmount(replacements));
+  parallelForChunks(
+      pool,
+      hashes.size(),
+      [&](size_t columnsBegin, size_t columnsEnd)
+      {
+        ReplacementsKernels::hashColumns(replacements, keysIndices, columnsBegin, columnsEnd, &hashes[columnsBegin]);
+      });
+}
+
+/**
+ * @brief Split columns into partitions by highest bits of their hashes. Each chunk of columns counts its columns in
+ * each partition, then it knows where to place them, so columns of each partition stay in ascending order
+ * @param partitionedColumns out param, columns indices of partitions one after another will be placed here
+ * @param partitionsBegins out param, position of the first column of each partition in `partitionedColumns` and the
+ * amount of columns at the end will be placed here
+ */
+void ReplacementsUtils::partitionColumnsByHashes(
+    ThreadPool & pool,
+    std::vector<uint64_t> const & hashes,
+    std::vector<size_t> & partitionedColumns,
+    std::vector<size_t> & partitionsBegins)
+{
+  size_t const partitionsAmount = size_t(1) << kPartitionsBits;
+  size_t const chunksAmount = (hashes.size() + kParallelChunkColumnsAmount - 1) / kParallelChunkColumnsAmount;
+  auto const & getPartition = [](uint64_t hash)
   {
-    for (auto const & key : keys)
+    return static_cast<size_t>(hash >> (64 - kPartitionsBits));
+  };
+
+  // positions[chunk * partitionsAmount + partition] is the amount and then the position of chunk columns in partition
+  std::vector<size_t> positions(chunksAmount * partitionsAmount);
+  parallelForChunks(
+      pool,
+      hashes.size(),
+      [&](size_t columnsBegin, size_t columnsEnd)
+      {
+        size_t * chunkPositions = &positions[columnsBegin / kParallelChunkColumnsAmount * partitionsAmount];
+        for (size_t columnIndex = columnsBegin; columnIndex < columnsEnd; ++columnIndex)
+          ++chunkPositions[getPartition(hashes[columnIndex])];
+      });
+
+  partitionsBegins.assign(partitionsAmount + 1, 0);
+  size_t position = 0;
+  for (size_t partition = 0; partition < partitionsAmount; ++partition)
+  {
+    partitionsBegins[partition] = position;
+    for (size_t chunk = 0; chunk < chunksAmount; ++chunk)
     {
-      ScAddrVector & replacementValues = replacements.at(key);
-      replacementValues.erase(replacementValues.begin() + static_cast<long>(*columnToRemove));
+      size_t const chunkColumnsAmount = positions[chunk * partitionsAmount + partition];
+      positions[chunk * partitionsAmount + partition] = position;
+      position += chunkColumnsAmount;
     }
   }
+  partitionsBegins[partitionsAmount] = position;
+
+  partitionedColumns.resize(hashes.size());
+  parallelForChunks(
+      pool,
+      hashes.size(),
+      [&](size_t columnsBegin, size_t columnsEnd)
+      {
+        size_t * chunkPositions = &positions[columnsBegin / kParallelChunkColumnsAmount * partitionsAmount];
+        for (size_t columnIndex = columnsBegin; columnIndex < columnsEnd; ++columnIndex)
+          partitionedColumns[chunkPositions[getPartition(hashes[columnIndex])]++] = columnIndex;
+      });
 }
 
 void ReplacementsUtils::calculateHashesForCommonKeys(
     Replacements const & replacements,
-    ScAddrUnorderedSet const & commonKeys,
+    std::vector<size_t> const & commonKeysIndices,
     ReplacementsHashes & hashes)
 {
-  size_t const columnsAmount = ReplacementsUtils::getColumnsAmount(replacements);
-  size_t const commonKeysAmount = commonKeys.empty() ? 1 : commonKeys.size();
-  std::vector<size_t> primes = {7, 13, 17, 19, 31, 41, 43};
-  for (size_t columnNumber = 0; columnNumber < columnsAmount; ++columnNumber)
-  {
-    int primeInd = 0;
-    size_t offsets = 0;
-    for (auto const & commonKey : commonKeys)
-      offsets +=
-          replacements.at(commonKey).at(columnNumber).GetRealAddr().offset * primes.at(primeInd++ % primes.size());
-    hashes[offsets / commonKeysAmount].push_back(columnNumber);
-  }
+  std::vector<uint64_t> columnsHashes;
+  ReplacementsKernels::hashColumns(replacements, commonKeysIndices, columnsHashes);
+  hashes.reserve(columnsHashes.size());
+  for (size_t columnNumber = 0; columnNumber < columnsHashes.size(); ++columnNumber)
+    hashes[columnsHashes[columnNumber]].push_back(columnNumber);
 }
 
 Replacements ReplacementsUtils::removeRows(Replacements const & replacements, ScAddrUnorderedSet & keysToRemove)
 {
-  Replacements result;
-  for (auto const & replacement : replacements)
+  std::vector<size_t> keptKeysIndices;
+  ScAddrVector keptKeys;
+  for (size_t keyIndex = 0; keyIndex < replacements.getKeysAmount(); ++keyIndex)
   {
-    if (keysToRemove.count(replacement.first))
+    ScAddr const & key = replacements.getKeys()[keyIndex];
+    if (keysToRemove.count(key))
       continue;
-    result[replacement.first].assign(replacement.second.cbegin(), replacement.second.cend());
+    keptKeysIndices.push_back(keyIndex);
+    keptKeys.push_back(key);
+  }
+
+  Replacements result(std::move(keptKeys));
+  size_t const columnsAmount = getColumnsAmount(replacements);
+  result.reserve(columnsAmount);
+  for (size_t columnIndex = 0; columnIndex < columnsAmount; ++columnIndex)
+  {
+    ScAddr * resultColumn = result.addColumn();
+    for (size_t i = 0; i < keptKeysIndices.size(); ++i)
+      resultColumn[i] = replacements.get(columnIndex, keptKeysIndices[i]);
   }
   return result;
 }
@@ -7,11 +7,20 @@
 #pragma once
 
 #include "Types.hpp"
+#include "ReplacementsHash.hpp"
+#include "ReplacementsKernels.hpp"
+#include "ThreadPool.hpp"
+
+#include <array>
+#include <atomic>
+#include <memory_resource>
+#include <unordered_map>
 
 #include <sc-memory/sc_addr.hpp>
 #include <sc-memory/sc_template.hpp>
 
-using ReplacementsHashes = std::unordered_map<size_t, std::vector<size_t>>;
+/// Columns indices by hashes of their values, allocated in the memory resource of the current replacements arena
+using ReplacementsHashes = std::pmr::unordered_map<uint64_t, std::pmr::vector<size_t>>;
 using namespace std;
 
 namespace inference
@@ -19,29 +28,142 @@ namespace inference
 class ReplacementsUtils
 {
 public:
+  enum JoinStrategy
+  {
+    NESTED_LOOP_JOIN = 0,
+    HASH_JOIN = 1,
+    SORT_MERGE_JOIN = 2,
+    PARALLEL_HASH_JOIN = 3
+  };
+
   static void intersectReplacements(
       Replacements const & first,
       Replacements const & second,
       Replacements & intersection);
+  static void narrowWith(Replacements & accumulator, Replacements const & other);
   static void uniteReplacements(Replacements const & first, Replacements const & second, Replacements & unionResult);
   static void subtractReplacements(Replacements const & first, Replacements const & second, Replacements & difference);
+  static void semiJoinReplacements(
+      Replacements const & first,
+      Replacements const & second,
+      std::vector<size_t> & firstColumns);
+  static void antiJoinReplacements(
+      Replacements const & first,
+      Replacements const & second,
+      std::vector<size_t> & firstColumns);
   static Replacements removeRows(Replacements const & replacements, ScAddrUnorderedSet & keysToRemove);
   static void getReplacementsToScTemplateParams(
       Replacements const & replacements,
       std::vector<ScTemplateParams> & templateParams);
+  static void getColumnToScTemplateParams(
+      Replacements const & replacements,
+      size_t columnIndex,
+      ScTemplateParams & templateParams);
   static size_t getColumnsAmount(Replacements const & replacements);
   static void getKeySet(Replacements const & map, ScAddrUnorderedSet & keySet);
+  static void removeDuplicateColumns(Replacements & replacements);
+  /// Returns how many times the strategy was chosen by `intersectReplacements` since the last reset
+  static size_t getJoinsAmount(JoinStrategy joinStrategy);
+  static void resetJoinsAmounts();
+  /**
+   * Tables with at least this amount of columns are joined and deduplicated on the shared thread pool, results are
+   * the same as results of sequential computation
+   */
+  static size_t getParallelColumnsThreshold();
+  static void setParallelColumnsThreshold(size_t columnsAmount);
 
 private:
+  /// Cost of hashing a column and putting it to the hash table measured in columns comparisons
+  static size_t constexpr kHashJoinColumnCost = 4;
+  static size_t constexpr kDefaultParallelColumnsThreshold = 1 << 17;
+  /// Columns are hashed and partitioned by chunks of this size in parallel
+  static size_t constexpr kParallelChunkColumnsAmount = 1 << 12;
+  /// Columns are split into 2^kPartitionsBits partitions by highest bits of their hashes
+  static size_t constexpr kPartitionsBits = 8;
+  static std::array<std::atomic<size_t>, 4> joinsAmounts;
+  static std::atomic<size_t> parallelColumnsThreshold;
+
+  static JoinStrategy chooseJoinStrategy(
+      Replacements const & first,
+      std::vector<size_t> const & firstCommonKeysIndices,
+      Replacements const & second,
+      std::vector<size_t> const & secondCommonKeysIndices);
+  static void nestedLoopJoin(
+      Replacements const & first,
+      std::vector<size_t> const & firstCommonKeysIndices,
+      Replacements const & second,
+      std::vector<size_t> const & secondCommonKeysIndices,
+      std::vector<std::pair<size_t, size_t>> & firstSecondPairs);
+  static void hashJoin(
+      Replacements const & first,
+      std::vector<size_t> const & firstCommonKeysIndices,
+      Replacements const & second,
+      std::vector<size_t> const & secondCommonKeysIndices,
+      std::vector<std::pair<size_t, size_t>> & firstSecondPairs);
+  static void parallelHashJoin(
+      ThreadPool & pool,
+      Replacements const & first,
+      std::vector<size_t> const & firstCommonKeysIndices,
+      Replacements const & second,
+      std::vector<size_t> const & secondCommonKeysIndices,
+      std::vector<std::pair<size_t, size_t>> & firstSecondPairs);
+  static void selectColumnsByMatches(
+      Replacements const & first,
+      std::vector<size_t> const & firstCommonKeysIndices,
+      Replacements const & second,
+      std::vector<size_t> const & secondCommonKeysIndices,
+      bool hasMatch,
+      std::vector<size_t> & firstColumns);
+  static void sortMergeJoin(
+      Replacements const & first,
+      std::vector<size_t> const & firstCommonKeysIndices,
+      Replacements const & second,
+      std::vector<size_t> const & secondCommonKeysIndices,
+      std::vector<std::pair<size_t, size_t>> & firstSecondPairs);
   static void getCommonKeys(
-      ScAddrUnorderedSet const & first,
-      ScAddrUnorderedSet const & second,
-      ScAddrUnorderedSet & commonKeys);
-  static Replacements copyReplacements(Replacements const & replacements);
-  static void removeDuplicateColumns(Replacements & replacements);
+      Replacements const & first,
+      Replacements const & second,
+      std::vector<size_t> & firstCommonKeysIndices,
+      std::vector<size_t> & secondCommonKeysIndices);
+  static void getUniqueKeys(
+      Replacements const & replacements,
+      Replacements const & other,
+      std::vector<size_t> & uniqueKeysIndices);
+  static bool areColumnsEqual(
+      Replacements const & first,
+      size_t firstColumnIndex,
+      std::vector<size_t> const & firstKeysIndices,
+      Replacements const & second,
+      size_t secondColumnIndex,
+      std::vector<size_t> const & secondKeysIndices);
+  static int compareColumns(
+      Replacements const & first,
+      size_t firstColumnIndex,
+      std::vector<size_t> const & firstKeysIndices,
+      Replacements const & second,
+      size_t secondColumnIndex,
+      std::vector<size_t> const & secondKeysIndices);
+  static bool areColumnsSorted(Replacements const & replacements, std::vector<size_t> const & keysIndices);
+  /// Returns the shared pool if it has several threads and there are enough columns to compute in parallel
+  static std::shared_ptr<ThreadPool> getParallelPool(size_t columnsAmount);
+  static void parallelForChunks(
+      ThreadPool & pool,
+      size_t columnsAmount,
+      std::function<void(size_t columnsBegin, size_t columnsEnd)> const & task);
+  static void hashColumnsInParallel(
+      ThreadPool & pool,
+      Replacements const & replacements,
+      std::vector<size_t> const & keysIndices,
+      std::vector<uint64_t> & hashes);
+  static void partitionColumnsByHashes(
+      ThreadPool & pool,
+      std::vector<uint64_t> const & hashes,
+      std::vector<size_t> & partitionedColumns,
+      std::vector<size_t> & partitionsBegins);
+  static void removeDuplicateColumnsInParallel(ThreadPool & pool, Replacements & replacements);
   static void calculateHashesForCommonKeys(
       Replacements const & replacements,
-      ScAddrUnorderedSet const & commonKeys,
+      std::vector<size_t> const & commonKeysIndices,
       ReplacementsHashes & hashes);
 };
 
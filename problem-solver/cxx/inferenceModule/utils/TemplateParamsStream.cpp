@@ -0,0 +1,82 @@
+/*
+ * This source file is part of an OSTIS project. For the latest info, see http://ostis.net
+ * Distributed under the MIT License
+ * (See accompanying file COPYING.MIT or copy at http://opensource.org/licenses/MIT)
+ */
+
+#include "TemplateParamsStream.hpp"
+
+#include "ReplacementsUtils.hpp"
+
+namespace inference
+{
+TemplateParamsStream::TemplateParamsStream(Replacements const & replacements)
+  : replacements(&replacements)
+  , isAllColumns(true)
+  , position(0)
+  , factorizedReplacements(nullptr)
+{
+}
+
+TemplateParamsStream::TemplateParamsStream(Replacements const & replacements, std::vector<size_t> columns)
+  : replacements(&replacements)
+  , columns(std::move(columns))
+  , isAllColumns(false)
+  , position(0)
+  , factorizedReplacements(nullptr)
+{
+}
+
+// A table is streamed by column indices, other factorized replacements are streamed by their columns stream
+TemplateParamsStream::TemplateParamsStream(FactorizedReplacements const & replacements)
+  : replacements(nullptr)
+  , isAllColumns(true)
+  , position(0)
+  , factorizedReplacements(&replacements)
+{
+  if (replacements.isTable())
+    this->replacements = &replacements.getTable();
+  else
+  {
+    columnsStream.emplace(replacements);
+    column.resize(replacements.getKeys().size());
+  }
+}
+
+bool TemplateParamsStream::next(ScTemplateParams & templateParams)
+{
+  if (columnsStream)
+  {
+    if (!columnsStream->next(column.data()))
+      return false;
+    ++position;
+    templateParams = ScTemplateParams();
+    ScAddrVector const & keys = factorizedReplacements->getKeys();
+    for (size_t keyIndex = 0; keyIndex < keys.size(); ++keyIndex)
+      templateParams.Add(keys[keyIndex], column[keyIndex]);
+    return true;
+  }
+  if (position == getParamsAmount())
+    return false;
+  size_t const columnIndex = isAllColumns ? position : columns[position];
+  ++position;
+  templateParams = ScTemplateParams();
+  ReplacementsUtils::getColumnToScTemplateParams(*replacements, columnIndex, templateParams);
+  return true;
+}
+
+void TemplateParamsStream::reset()
+{
+  position = 0;
+  if (columnsStream)
+    columnsStream->reset();
+}
+
+size_t TemplateParamsStream::getParamsAmount() const
+{
+  if (columnsStream)
+    return factorizedReplacements->getCombinationsAmount();
+  return isAllColumns ? ReplacementsUtils::getColumnsAmount(*replacements) : columns.size();
+}
+
+}  // namespace inference
@@ -0,0 +1,56 @@
+/*
+ * This source file is part of an OSTIS project. For the latest info, see http://ostis.net
+ * Distributed under the MIT License
+ * (See accompanying file COPYING.MIT or copy at http://opensource.org/licenses/MIT)
+ */
+
+#pragma once
+
+#include "FactorizedReplacements.hpp"
+#include "Replacements.hpp"
+
+#include <optional>
+#include <vector>
+
+#include <sc-memory/sc_template.hpp>
+
+namespace inference
+{
+/**
+ * Template params created from replacements columns one by one on demand, so search or generation by the first
+ * columns starts before the whole table is converted and memory is needed only for params of one column.
+ * Replacements must not be changed while the stream is used
+ */
+class TemplateParamsStream
+{
+public:
+  /// Stream params for all columns of the replacements
+  explicit TemplateParamsStream(Replacements const & replacements);
+  /// Stream params only for the given columns in the given order
+  TemplateParamsStream(Replacements const & replacements, std::vector<size_t> columns);
+  /// Stream params for all distinct columns of factorized replacements without expanding them to a table
+  explicit TemplateParamsStream(FactorizedReplacements const & replacements);
+
+  /**
+   * @brief Create params for the next column
+   * @param templateParams out param, params with values of all keys of the next column will be placed here
+   * @returns false if params for all columns are already created
+   */
+  bool next(ScTemplateParams & templateParams);
+  /// Start streaming from the first column again
+  void reset();
+
+  /// Returns amount of columns, it is an upper bound for factorized replacements with several terms
+  size_t getParamsAmount() const;
+
+private:
+  Replacements const * replacements;
+  std::vector<size_t> columns;
+  bool isAllColumns;
+  size_t position;
+  FactorizedReplacements const * factorizedReplacements;
+  std::optional<FactorizedReplacements::ColumnsStream> columnsStream;
+  ScAddrVector column;
+};
+
+}  // namespace inference
@@ -0,0 +1,137 @@
+/*
+ * This source file is part of an OSTIS project. For the latest info, see http://ostis.net
+ * Distributed under the MIT License
+ * (See accompanying file COPYING.MIT or copy at http://opensource.org/licenses/MIT)
+ */
+
+#include "ThreadPool.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+
+namespace inference
+{
+std::mutex ThreadPool::sharedPoolMutex;
+std::shared_ptr<ThreadPool> ThreadPool::sharedPool;
+
+struct ThreadPool::Batch
+{
+  Batch(std::function<void(size_t)> const & task, size_t tasksAmount)
+    : task(task)
+    , tasksAmount(tasksAmount)
+  {
+  }
+
+  std::function<void(size_t)> const & task;
+  size_t const tasksAmount;
+  std::atomic<size_t> nextTask = 0;
+  std::mutex finishMutex;
+  std::condition_variable finishCondition;
+  size_t finishedTasksAmount = 0;
+  std::exception_ptr exception;
+};
+
+ThreadPool::ThreadPool(size_t threadsAmount)
+  : threadsAmount(std::max<size_t>(threadsAmount, 1))
+{
+  for (size_t workerIndex = 1; workerIndex < this->threadsAmount; ++workerIndex)
+    workers.emplace_back(&ThreadPool::work, this);
+}
+
+ThreadPool::~ThreadPool()
+{
+  {
+    std::lock_guard<std::mutex> const lock(jobsMutex);
+    isStopped = true;
+  }
+  jobsCondition.notify_all();
+  for (std::thread & worker : workers)
+    worker.join();
+}
+
+size_t ThreadPool::getThreadsAmount() const
+{
+  return threadsAmount;
+}
+
+void ThreadPool::parallelFor(size_t tasksAmount, std::function<void(size_t)> const & task)
+{
+  if (tasksAmount == 0)
+    return;
+  auto batch = std::make_shared<Batch>(task, tasksAmount);
+  size_t const helpersAmount = std::min(workers.size(), tasksAmount - 1);
+  if (helpersAmount > 0)
+  {
+    {
+      std::lock_guard<std::mutex> const lock(jobsMutex);
+      // A helper may start after all tasks are taken, then it finds no task and does nothing
+      for (size_t helperIndex = 0; helperIndex < helpersAmount; ++helperIndex)
+        jobs.emplace_back([batch] { executeTasks(*batch); });
+    }
+    jobsCondition.notify_all();
+  }
+  executeTasks(*batch);
+
+  std::unique_lock<std::mutex> lock(batch->finishMutex);
+  batch->finishCondition.wait(lock, [&batch] { return batch->finishedTasksAmount == batch->tasksAmount; });
+  if (batch->exception)
+    std::rethrow_exception(batch->exception);
+}
+
+std::shared_ptr<ThreadPool> ThreadPool::getShared()
+{
+  std::lock_guard<std::mutex> const lock(sharedPoolMutex);
+  if (!sharedPool)
+    sharedPool = std::make_shared<ThreadPool>(std::thread::hardware_concurrency());
+  return sharedPool;
+}
+
+void ThreadPool::setSharedThreadsAmount(size_t threadsAmount)
+{
+  auto pool = std::make_shared<ThreadPool>(threadsAmount);
+  std::lock_guard<std::mutex> const lock(sharedPoolMutex);
+  sharedPool.swap(pool);
+}
+
+void ThreadPool::work()
+{
+  while (true)
+  {
+    std::function<void()> job;
+    {
+      std::unique_lock<std::mutex> lock(jobsMutex);
+      jobsCondition.wait(lock, [this] { return isStopped || !jobs.empty(); });
+      if (jobs.empty())
+        return;
+      job = std::move(jobs.front());
+      jobs.pop_front();
+    }
+    job();
+  }
+}
+
+void ThreadPool::executeTasks(Batch & batch)
+{
+  size_t taskIndex;
+  while ((taskIndex = batch.nextTask.fetch_add(1)) < batch.tasksAmount)
+  {
+    std::exception_ptr exception;
+    try
+    {
+      batch.task(taskIndex);
+    }
+    catch (...)
+    {
+      exception = std::current_exception();
+    }
+
+    std::lock_guard<std::mutex> const lock(batch.finishMutex);
+    if (exception && !batch.exception)
+      batch.exception = exception;
+    if (++batch.finishedTasksAmount == batch.tasksAmount)
+      batch.finishCondition.notify_all();
+  }
+}
+
+}  // namespace inference
@@ -0,0 +1,65 @@
+/*
+ * This source file is part of an OSTIS project. For the latest info, see http://ostis.net
+ * Distributed under the MIT License
+ * (See accompanying file COPYING.MIT or copy at http://opensource.org/licenses/MIT)
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace inference
+{
+/**
+ * Fixed set of worker threads. The thread that calls `parallelFor` executes tasks too and waits only for tasks that
+ * are already executed by workers, so `parallelFor` may be called from tasks of the same pool.
+ */
+class ThreadPool
+{
+public:
+  /// @param threadsAmount amount of threads including the calling one, the pool with one thread has no workers
+  explicit ThreadPool(size_t threadsAmount);
+  ~ThreadPool();
+
+  ThreadPool(ThreadPool const & other) = delete;
+  ThreadPool & operator=(ThreadPool const & other) = delete;
+
+  size_t getThreadsAmount() const;
+
+  /**
+   * @brief Execute `task` for each index from 0 to `tasksAmount` on threads of the pool. Tasks are taken in ascending
+   * order of indices, but may be finished in any order
+   * @throws Rethrows the first exception thrown by tasks after all taken tasks are finished
+   */
+  void parallelFor(size_t tasksAmount, std::function<void(size_t)> const & task);
+
+  /// Returns the pool shared by inference, it has a thread per hardware thread by default
+  static std::shared_ptr<ThreadPool> getShared();
+  /// Replace the shared pool, the previous one is destroyed when it is not used anymore
+  static void setSharedThreadsAmount(size_t threadsAmount);
+
+private:
+  struct Batch;
+
+  size_t const threadsAmount;
+  std::vector<std::thread> workers;
+  std::mutex jobsMutex;
+  std::condition_variable jobsCondition;
+  std::deque<std::function<void()>> jobs;
+  bool isStopped = false;
+
+  static std::mutex sharedPoolMutex;
+  static std::shared_ptr<ThreadPool> sharedPool;
+
+  void work();
+  static void executeTasks(Batch & batch);
+};
+
+}  // namespace inference
@@ -5,7 +5,4 @@
 
 #include <sc-memory/sc_addr.hpp>
 
-namespace inference
-{
-using Replacements = std::unordered_map<ScAddr, ScAddrVector, ScAddrHashFunc>;
-}  // namespace inference
+#include "Replacements.hpp"